@@ -0,0 +1,113 @@
+/*
+ * libherdstat -- benchmarks/backtrace_context.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/*
+ * Compares building backtrace contexts up front (string concatenation,
+ * as libherdstat used to) with the deferred BacktraceContext, on a scan
+ * of keywords.
+ */
+
+#include <vector>
+#include <iterator>
+#include <herdstat/exceptions.hh>
+#include <herdstat/util/string.hh>
+#include <herdstat/portage/keywords.hh>
+#include "benchmark.hh"
+
+static std::vector<std::string> keywords;
+
+struct EagerContext
+{
+    void operator()() const
+    {
+        std::vector<std::string>::const_iterator i;
+        for (i = keywords.begin() ; i != keywords.end() ; ++i)
+        {
+            herdstat::BacktraceContext c("portage::Keyword::Keyword("+*i+")");
+            benchmark_sink += i->size();
+        }
+    }
+};
+
+struct DeferredContext
+{
+    void operator()() const
+    {
+        std::vector<std::string>::const_iterator i;
+        for (i = keywords.begin() ; i != keywords.end() ; ++i)
+        {
+            herdstat::BacktraceContext c("portage::Keyword::Keyword(%s)", *i);
+            benchmark_sink += i->size();
+        }
+    }
+};
+
+struct KeywordScan
+{
+    void operator()() const
+    {
+        std::vector<std::string>::const_iterator i;
+        for (i = keywords.begin() ; i != keywords.end() ; ++i)
+        {
+            const herdstat::portage::Keyword kw(*i);
+            benchmark_sink += kw.arch().size();
+        }
+    }
+};
+
+struct InvalidKeyword
+{
+    void operator()() const
+    {
+        try
+        {
+            const herdstat::portage::Keyword kw("!x86");
+        }
+        catch (const herdstat::BaseException& e)
+        {
+            benchmark_sink += e.backtrace(":").size();
+        }
+    }
+};
+
+int
+main()
+{
+    herdstat::util::split(
+        "alpha amd64 arm hppa ia64 ~mips ppc ppc64 s390 sparc x86 -x86-fbsd",
+        std::back_inserter(keywords));
+
+    benchmark("eager BacktraceContext (12 keywords)", 100000,
+        EagerContext());
+    benchmark("deferred BacktraceContext (12 keywords)", 100000,
+        DeferredContext());
+    benchmark("portage::Keyword (12 keywords)", 20000, KeywordScan());
+    benchmark("portage::Keyword (invalid, caught)", 20000,
+        InvalidKeyword());
+
+    return benchmark_status();
+}
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
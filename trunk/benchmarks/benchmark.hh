@@ -0,0 +1,300 @@
+/*
+ * libherdstat -- benchmarks/benchmark.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_BENCHMARKS_BENCHMARK_HH
+#define _HAVE_BENCHMARKS_BENCHMARK_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file benchmarks/benchmark.hh
+ * @brief Minimal benchmark harness shared by the programs in benchmarks/.
+ *
+ * Allocations are counted by libinstrument (see instrument/alloc.hh),
+ * which every benchmark program is linked with.
+ *
+ * Set BENCHMARK_OUTPUT in the environment to have each result appended
+ * to that file as a tab-separated line (name, samples, median ns/op, p95
+ * ns/op, allocs/op).
+ *
+ * Set BENCHMARK_BASELINE to such a file from an earlier run to compare each
+ * result against it.  A result regresses if it makes more allocations per
+ * operation than the baseline, or is more than BENCHMARK_TOLERANCE percent
+ * (default 20) slower; benchmark_status() then returns EXIT_FAILURE.
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/time.h>
+#include <instrument/alloc.hh>
+
+/* benchmarked functions add their results here so they aren't optimized
+ * away */
+static volatile unsigned long benchmark_sink = 0;
+
+/* scale factor for iteration counts (BENCHMARK_SCALE in the environment) */
+static unsigned long
+benchmark_scale()
+{
+    const char *scale = std::getenv("BENCHMARK_SCALE");
+    const unsigned long n = (scale ? std::strtoul(scale, NULL, 10) : 1);
+    return (n > 0 ? n : 1);
+}
+
+/* number of results that regressed against the baseline */
+static unsigned long benchmark_regressions = 0;
+
+/* baseline results: name -> (median ns/op, allocs/op) */
+typedef std::map<std::string, std::pair<double, double> > benchmark_baseline_type;
+
+static const benchmark_baseline_type&
+benchmark_baseline()
+{
+    static benchmark_baseline_type *baseline = NULL;
+    if (baseline)
+        return *baseline;
+
+    baseline = new benchmark_baseline_type();
+
+    const char *path = std::getenv("BENCHMARK_BASELINE");
+    if (not path or not *path)
+        return *baseline;
+
+    std::ifstream stream(path);
+    if (not stream)
+    {
+        std::cerr << "Failed to open baseline " << path << std::endl;
+        return *baseline;
+    }
+
+    std::string line;
+    while (std::getline(stream, line))
+    {
+        if (line.empty() or line[0] == '#')
+            continue;
+
+        std::vector<std::string> fields;
+        std::string::size_type begin = 0, end;
+        while ((end = line.find('\t', begin)) != std::string::npos)
+        {
+            fields.push_back(line.substr(begin, end - begin));
+            begin = end + 1;
+        }
+        fields.push_back(line.substr(begin));
+
+        /* name, samples, median ns/op, p95 ns/op, allocs/op */
+        if (fields.size() < 5)
+            continue;
+
+        (*baseline)[fields[0]] = std::make_pair(
+            std::strtod(fields[2].c_str(), NULL),
+            std::strtod(fields[4].c_str(), NULL));
+    }
+
+    return *baseline;
+}
+
+/* compare a result against the baseline, if there is one for it */
+static void
+benchmark_compare(const std::string& name, double median, double allocs)
+{
+    const benchmark_baseline_type& baseline(benchmark_baseline());
+    benchmark_baseline_type::const_iterator i = baseline.find(name);
+    if (i == baseline.end() or i->second.first <= 0)
+        return;
+
+    const char *tolerance = std::getenv("BENCHMARK_TOLERANCE");
+    const double limit = (tolerance ? std::strtod(tolerance, NULL) : 20.0);
+    const double change = (median / i->second.first - 1) * 100;
+    double extra = allocs - i->second.second;
+    if (extra > -0.005 and extra < 0.005)
+        extra = 0;
+
+    /* allocation counts are deterministic, so any increase is a
+     * regression (allowing for the rounding in the file) */
+    const bool regressed =
+        (change > limit or extra > 0);
+    if (regressed)
+        ++benchmark_regressions;
+
+    std::cout << "    vs baseline: " << std::showpos << std::fixed
+        << std::setprecision(1) << change << "% ns/op, "
+        << std::setprecision(2) << extra
+        << " allocs/op" << std::noshowpos
+        << (regressed ? "  REGRESSION" : "") << std::endl;
+}
+
+/**
+ * Get the exit status for a benchmark program.
+ * @returns EXIT_FAILURE if any result regressed against the baseline,
+ * otherwise EXIT_SUCCESS.
+ */
+
+static int
+benchmark_status()
+{
+    if (benchmark_regressions == 0)
+        return EXIT_SUCCESS;
+
+    std::cout << benchmark_regressions << " result(s) regressed" << std::endl;
+    return EXIT_FAILURE;
+}
+
+static double
+benchmark_now()
+{
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return (tv.tv_sec * 1e9 + tv.tv_usec * 1e3);
+}
+
+/**
+ * Print (and, if BENCHMARK_OUTPUT is set in the environment, append to that
+ * file as a tab-separated line) the median and 95th percentile of the
+ * given samples, and compare them against the baseline.
+ * @param name Name of benchmark.
+ * @param ns Nanoseconds per operation, one entry per sample.
+ * @param allocs Allocations per operation.
+ * @returns Median nanoseconds per operation.
+ */
+
+static double
+benchmark_report(const std::string& name, std::vector<double> ns,
+                 double allocs)
+{
+    std::sort(ns.begin(), ns.end());
+    const double median = ns[ns.size() / 2];
+    const double p95 = ns[std::min(ns.size() - 1, (ns.size() * 95) / 100)];
+
+    std::cout << std::left << std::setw(44) << name << std::right
+        << std::fixed << std::setprecision(1) << std::setw(12) << median
+        << " ns/op (p95 " << std::setw(12) << p95 << ")"
+        << std::setprecision(2) << std::setw(10) << allocs
+        << " allocs/op" << std::endl;
+
+    benchmark_compare(name, median, allocs);
+
+    const char *path = std::getenv("BENCHMARK_OUTPUT");
+    std::FILE *f = (path ? std::fopen(path, "a") : NULL);
+    if (not f)
+        return median;
+
+    /* name, samples, median ns/op, p95 ns/op, allocs/op */
+    std::fprintf(f, "%s\t%lu\t%.1f\t%.1f\t%.2f\n", name.c_str(),
+        static_cast<unsigned long>(ns.size()), median, p95, allocs);
+    std::fclose(f);
+    return median;
+}
+
+/**
+ * Call f() the given number of times (after one untimed call to warm up),
+ * in batches, then report the time per call (median and 95th percentile
+ * over the batches) and allocations per call.
+ * @param name Name to print.
+ * @param iterations Number of calls (multiplied by BENCHMARK_SCALE).
+ * @param f Nullary function object.
+ * @returns Median nanoseconds per call.
+ */
+
+template <typename Function>
+double
+benchmark(const std::string& name, unsigned long iterations, Function f)
+{
+    static const unsigned long batches = 10;
+
+    iterations *= benchmark_scale();
+    const unsigned long per_batch = std::max(iterations / batches, 1UL);
+
+    f();
+
+    std::vector<double> ns;
+    ns.reserve(batches);
+    const instrument::AllocScope scope;
+
+    for (unsigned long b = 0 ; b < batches ; ++b)
+    {
+        const double begin = benchmark_now();
+        for (unsigned long n = 0 ; n < per_batch ; ++n)
+            f();
+        ns.push_back((benchmark_now() - begin) / per_batch);
+    }
+
+    return benchmark_report(name, ns,
+        static_cast<double>(scope.stats().allocations) /
+            (batches * per_batch));
+}
+
+/**
+ * Time each of the given number of calls to f() separately, calling
+ * setup() (untimed) before each; suited to operations that are too slow
+ * to batch or that need resetting in between (eg evicting caches for a
+ * cold run).  Reports the median and 95th percentile.
+ * @param name Name to print.
+ * @param samples Number of calls (multiplied by BENCHMARK_SCALE).
+ * @param f Nullary function object.
+ * @param setup Nullary function object.
+ * @returns Median nanoseconds per call.
+ */
+
+template <typename Function, typename Setup>
+double
+benchmark_samples(const std::string& name, unsigned long samples,
+                  Function f, Setup setup)
+{
+    samples *= benchmark_scale();
+
+    std::vector<double> ns;
+    ns.reserve(samples);
+    unsigned long allocs = 0;
+
+    for (unsigned long n = 0 ; n < samples ; ++n)
+    {
+        setup();
+
+        const instrument::AllocScope scope;
+        const double begin = benchmark_now();
+        f();
+        ns.push_back(benchmark_now() - begin);
+        allocs += scope.stats().allocations;
+    }
+
+    return benchmark_report(name, ns, static_cast<double>(allocs) / samples);
+}
+
+/// setup function object for benchmark_samples() that does nothing.
+struct benchmark_nothing
+{
+    void operator()() const { }
+};
+
+#endif /* _HAVE_BENCHMARKS_BENCHMARK_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
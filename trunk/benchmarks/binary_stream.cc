@@ -0,0 +1,100 @@
+/*
+ * libherdstat -- benchmarks/binary_stream.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/*
+ * Reads back a serialized list of a few hundred thousand package names
+ * through buffered and memory mapped streams.
+ */
+
+#include <cstdio>
+#include <unistd.h>
+#include <herdstat/io/binary_stream_iterator.hh>
+#include "benchmark.hh"
+
+#define BINARY_STREAM_BENCH_FILE     "binary_stream.bench"
+#define BINARY_STREAM_BENCH_RECORDS  300000
+
+template <typename T>
+struct ReadAll
+{
+    ReadAll(bool mapped) : mapped(mapped) { }
+
+    void operator()() const
+    {
+        herdstat::io::BinaryIStream stream(BINARY_STREAM_BENCH_FILE, mapped);
+        herdstat::io::BinaryIStreamIterator<T> i(stream), end;
+        for ( ; i != end ; ++i)
+            benchmark_sink += i->size();
+    }
+
+    const bool mapped;
+};
+
+struct ReadAllDoubles
+{
+    ReadAllDoubles(bool mapped) : mapped(mapped) { }
+
+    void operator()() const
+    {
+        herdstat::io::BinaryIStream stream(BINARY_STREAM_BENCH_FILE ".dbl",
+            mapped);
+        herdstat::io::BinaryIStreamIterator<double> i(stream), end;
+        for ( ; i != end ; ++i)
+            benchmark_sink += static_cast<unsigned long>(*i);
+    }
+
+    const bool mapped;
+};
+
+int
+main()
+{
+    {
+        herdstat::io::BinaryOStream names(BINARY_STREAM_BENCH_FILE);
+        herdstat::io::BinaryOStream values(BINARY_STREAM_BENCH_FILE ".dbl");
+        char buf[64];
+        for (int n = 0 ; n < BINARY_STREAM_BENCH_RECORDS ; ++n)
+        {
+            std::sprintf(buf, "app-misc/package-number-%d", n);
+            names << buf;
+            values << static_cast<double>(n);
+        }
+    }
+
+    benchmark("BinaryIStream<std::string>", 10,
+        ReadAll<std::string>(false));
+    benchmark("BinaryIStream<std::string> (mapped)", 10,
+        ReadAll<std::string>(true));
+    benchmark("BinaryIStream<util::StringView> (mapped)", 10,
+        ReadAll<herdstat::util::StringView>(true));
+    benchmark("BinaryIStream<double>", 10, ReadAllDoubles(false));
+    benchmark("BinaryIStream<double> (mapped)", 10, ReadAllDoubles(true));
+
+    unlink(BINARY_STREAM_BENCH_FILE);
+    unlink(BINARY_STREAM_BENCH_FILE ".dbl");
+    return benchmark_status();
+}
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,398 @@
+/*
+ * libherdstat -- benchmarks/containers.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/*
+ * Times lookups in and iteration over the sorted containers (Categories,
+ * Archs, Keywords, Versions, VersionComponents and the variables of an
+ * Ebuild), filled from a generated tree, and prints their footprint.  Herds
+ * and Developers are filled with made up names.  Each
+ * lookup operation does one search; each iteration operation walks one whole
+ * container.  Set BENCHMARK_TREE to change the shape of the tree (see
+ * tree_generator.hh).
+ */
+
+#include <cstdlib>
+#include <iomanip>
+#include <herdstat/util/memory.hh>
+#include <herdstat/util/string.hh>
+#include <herdstat/portage/archs.hh>
+#include <herdstat/portage/categories.hh>
+#include <herdstat/portage/developer.hh>
+#include <herdstat/portage/ebuild.hh>
+#include <herdstat/portage/herd.hh>
+#include <herdstat/portage/keywords.hh>
+#include <herdstat/portage/version.hh>
+#include "generator.hh"
+#include "tree_generator.hh"
+#include "benchmark.hh"
+
+/* number of packages whose ebuilds are loaded */
+#define CONTAINERS_PACKAGES 100
+/* number of made up herds and developers */
+#define CONTAINERS_HERDS    150
+#define CONTAINERS_DEVS     800
+
+/* call f on one container per operation, cycling through them */
+template <typename T, typename Function>
+struct EachOf
+{
+    EachOf(const std::vector<T>& items, Function f)
+        : items(items), f(f), next(0) { }
+
+    void operator()()
+    {
+        f(items[next]);
+        if (++next == items.size())
+            next = 0;
+    }
+
+    const std::vector<T>& items;
+    Function f;
+    std::size_t next;
+};
+
+template <typename T, typename Function>
+static void
+run(const std::string& name, unsigned long iterations,
+    const std::vector<T>& items, Function f)
+{
+    if (items.empty())
+        std::cerr << name << ": nothing to do" << std::endl;
+    else
+        benchmark(name, iterations, EachOf<T, Function>(items, f));
+}
+
+/* search c for each key in turn (about half of them exist) */
+template <typename C, typename K>
+struct Count
+{
+    Count(const C& c, const std::vector<K>& keys) : c(c), keys(keys) { }
+
+    void operator()(const std::size_t& n) const
+    { benchmark_sink += c.count(keys[n]); }
+
+    const C& c;
+    const std::vector<K>& keys;
+};
+
+/* find each key in c in turn */
+template <typename C, typename K>
+struct Find
+{
+    Find(const C& c, const std::vector<K>& keys) : c(c), keys(keys) { }
+
+    void operator()(const std::size_t& n) const
+    { benchmark_sink += (c.find(keys[n]) != c.end()); }
+
+    const C& c;
+    const std::vector<K>& keys;
+};
+
+/* is the last component of each path in c (as is_category() does it) */
+template <typename C>
+struct CountBasename
+{
+    CountBasename(const C& c, const std::vector<std::string>& paths)
+        : c(c), paths(paths) { }
+
+    void operator()(const std::size_t& n) const
+    { benchmark_sink += c.count(herdstat::util::basename(paths[n])); }
+
+    const C& c;
+    const std::vector<std::string>& paths;
+};
+
+template <typename C>
+struct CountBasenameView
+{
+    CountBasenameView(const C& c, const std::vector<std::string>& paths)
+        : c(c), paths(paths) { }
+
+    void operator()(const std::size_t& n) const
+    { benchmark_sink += c.count(herdstat::util::basename_view(paths[n])); }
+
+    const C& c;
+    const std::vector<std::string>& paths;
+};
+
+template <typename C>
+struct Iterate
+{
+    void operator()(const C *c) const
+    {
+        typename C::const_iterator i;
+        for (i = c->begin() ; i != c->end() ; ++i)
+            benchmark_sink += reinterpret_cast<unsigned long>(&*i);
+    }
+};
+
+struct CountVersions
+{
+    void operator()(const std::pair<const herdstat::portage::Versions *,
+                                    herdstat::portage::VersionString>& p) const
+    { benchmark_sink += p.first->count(p.second); }
+};
+
+struct FindVersion
+{
+    void operator()(const std::pair<const herdstat::portage::Versions *,
+                                    std::string>& p) const
+    { benchmark_sink += (p.first->find(p.second) != p.first->end()); }
+};
+
+struct LookupComponent
+{
+    void operator()(const std::pair<const herdstat::portage::VersionComponents *,
+                                    std::string>& p) const
+    { benchmark_sink += (*p.first)[p.second].size(); }
+};
+
+struct FindVar
+{
+    void operator()(const std::pair<const herdstat::portage::Ebuild *,
+                                    std::string>& p) const
+    { benchmark_sink += (p.first->find(p.second) != p.first->end()); }
+};
+
+struct AssignKeywords
+{
+    void operator()(const std::vector<std::string>& keywords) const
+    {
+        herdstat::portage::Keywords kw;
+        kw.assign(keywords.begin(), keywords.end());
+        benchmark_sink += kw.size();
+    }
+};
+
+template <typename T>
+static void
+footprint(const std::string& name, const std::vector<T *>& v)
+{
+    herdstat::util::MemoryUsage mem;
+    typename std::vector<T *>::const_iterator i;
+    for (i = v.begin() ; i != v.end() ; ++i)
+        mem += herdstat::util::memory_usage(**i);
+
+    std::cout << name << " footprint: " << std::fixed << std::setprecision(2)
+        << mem.total() / 1024.0 << " KB (" << mem << ")" << std::endl;
+}
+
+template <typename T>
+static void
+delete_all(std::vector<T *>& v)
+{
+    typename std::vector<T *>::iterator i;
+    for (i = v.begin() ; i != v.end() ; ++i)
+        delete *i;
+    v.clear();
+}
+
+int
+main()
+{
+    using herdstat::portage::Archs;
+    using herdstat::portage::Categories;
+    using herdstat::portage::Developer;
+    using herdstat::portage::Developers;
+    using herdstat::portage::Ebuild;
+    using herdstat::portage::Herd;
+    using herdstat::portage::Herds;
+    using herdstat::portage::Keywords;
+    using herdstat::portage::VersionComponents;
+    using herdstat::portage::VersionString;
+    using herdstat::portage::Versions;
+
+    char tmp[] = "/tmp/herdstat-containers.XXXXXX";
+    if (not mkdtemp(tmp))
+        return EXIT_FAILURE;
+
+    const std::string root(std::string(tmp) + "/tree");
+    const TreeOptions opts;
+    const Tree tree(generate_tree(root, opts));
+
+    /* keywords are checked against the tree's arch.list */
+    setenv("PORTDIR", tree.portdir.c_str(), 1);
+    setenv("PORTDIR_OVERLAY", "", 1);
+
+    const Categories categories(tree.portdir);
+    const Archs archs(tree.portdir);
+
+    /* every element, plus as many that don't exist */
+    std::vector<std::string> category_keys, category_paths, arch_keys;
+    Categories::const_iterator c;
+    for (c = categories.begin() ; c != categories.end() ; ++c)
+    {
+        category_keys.push_back(*c);
+        category_keys.push_back(*c + "-nope");
+        category_paths.push_back(tree.portdir + "/" + category_keys.end()[-2]);
+        category_paths.push_back(tree.portdir + "/" + category_keys.back());
+    }
+    Archs::const_iterator a;
+    for (a = archs.begin() ; a != archs.end() ; ++a)
+    {
+        arch_keys.push_back(*a);
+        arch_keys.push_back(*a + "-nope");
+    }
+
+    Herds herds;
+    Developers developers;
+    std::vector<std::string> herd_keys, developer_keys;
+    for (std::size_t n = 0 ; n < CONTAINERS_HERDS ; ++n)
+    {
+        herd_keys.push_back(herdstat::util::sprintf("herd%03lu",
+            static_cast<unsigned long>(n)));
+        herds.insert(Herd(herd_keys.back()));
+        herd_keys.push_back(herd_keys.back() + "-nope");
+    }
+    for (std::size_t n = 0 ; n < CONTAINERS_DEVS ; ++n)
+    {
+        developer_keys.push_back(herdstat::util::sprintf("dev%04lu",
+            static_cast<unsigned long>(n)));
+        developers.insert(Developer(developer_keys.back()));
+        developer_keys.push_back(developer_keys.back() + "-nope");
+    }
+
+    std::vector<Versions *> versions;
+    std::vector<Keywords *> keywords;
+    std::vector<VersionComponents *> components;
+    std::vector<Ebuild *> ebuilds;
+    std::vector<std::vector<std::string> > keyword_strings;
+    std::vector<std::pair<const Versions *, VersionString> > version_keys;
+    std::vector<std::pair<const Versions *, std::string> > version_paths;
+    std::vector<std::pair<const VersionComponents *, std::string> >
+        component_keys;
+    std::vector<std::pair<const Ebuild *, std::string> > var_keys;
+
+    const char *vars[] = { "KEYWORDS", "DESCRIPTION", "SLOT", "PN", "NOPE" };
+    const char *vcomps[] = { "P", "PN", "PV", "PR", "PVR", "PF" };
+
+    const std::size_t step = std::max<std::size_t>(
+        tree.packages.size() / CONTAINERS_PACKAGES, 1);
+    for (std::size_t n = 0 ; n < tree.packages.size() ; n += step)
+    {
+        versions.push_back(new Versions(tree.portdir+"/"+tree.packages[n]));
+
+        Versions::const_iterator v;
+        for (v = versions.back()->begin() ; v != versions.back()->end() ; ++v)
+        {
+            version_keys.push_back(std::make_pair(versions.back(), *v));
+            version_paths.push_back(
+                std::make_pair(versions.back(), v->ebuild()));
+
+            components.push_back(new VersionComponents(v->ebuild()));
+            for (std::size_t i = 0 ; i < countof(vcomps) ; ++i)
+                component_keys.push_back(
+                    std::make_pair(components.back(), vcomps[i]));
+
+            ebuilds.push_back(new Ebuild(v->ebuild()));
+            for (std::size_t i = 0 ; i < countof(vars) ; ++i)
+                var_keys.push_back(std::make_pair(ebuilds.back(), vars[i]));
+
+            keywords.push_back(new Keywords());
+            if (not keywords.back()->try_assign(*ebuilds.back()))
+            {
+                delete keywords.back();
+                keywords.pop_back();
+                continue;
+            }
+
+            keyword_strings.push_back(std::vector<std::string>());
+            herdstat::util::split((*ebuilds.back())["KEYWORDS"],
+                std::back_inserter(keyword_strings.back()));
+        }
+
+        /* and one that doesn't exist */
+        const std::string nope(tree.portdir+"/"+tree.packages[n]+
+            "/nope-0.ebuild");
+        version_keys.push_back(std::make_pair(versions.back(),
+            VersionString(nope)));
+        version_paths.push_back(std::make_pair(versions.back(), nope));
+    }
+
+    std::cout << "Tree: " << categories.size() << " categories, "
+        << archs.size() << " arches, " << versions.size() << " packages, "
+        << ebuilds.size() << " ebuilds" << std::endl;
+
+    std::vector<std::size_t> category_index, arch_index, herd_index,
+                             developer_index;
+    for (std::size_t n = 0 ; n < category_keys.size() ; ++n)
+        category_index.push_back(n);
+    for (std::size_t n = 0 ; n < arch_keys.size() ; ++n)
+        arch_index.push_back(n);
+    for (std::size_t n = 0 ; n < herd_keys.size() ; ++n)
+        herd_index.push_back(n);
+    for (std::size_t n = 0 ; n < developer_keys.size() ; ++n)
+        developer_index.push_back(n);
+
+    std::vector<const Categories *> all_categories(1, &categories);
+    std::vector<const Archs *> all_archs(1, &archs);
+
+    run("portage::Categories::count()", 1000000, category_index,
+        Count<Categories, std::string>(categories, category_keys));
+    run("portage::Categories::count(basename())", 1000000, category_index,
+        CountBasename<Categories>(categories, category_paths));
+    run("portage::Categories::count(basename_view())", 1000000,
+        category_index,
+        CountBasenameView<Categories>(categories, category_paths));
+    run("portage::Categories (iterate)", 100000, all_categories,
+        Iterate<Categories>());
+    run("portage::Archs::count()", 1000000, arch_index,
+        Count<Archs, std::string>(archs, arch_keys));
+    run("portage::Archs (iterate)", 100000, all_archs, Iterate<Archs>());
+    run("portage::Keywords::assign()", 100000, keyword_strings,
+        AssignKeywords());
+    run("portage::Keywords (iterate)", 1000000, keywords,
+        Iterate<Keywords>());
+    run("portage::Versions::count()", 1000000, version_keys,
+        CountVersions());
+    run("portage::Versions::find()", 1000000, version_paths,
+        FindVersion());
+    run("portage::Versions (iterate)", 1000000, versions,
+        Iterate<Versions>());
+    run("portage::VersionComponents::operator[]()", 1000000, component_keys,
+        LookupComponent());
+    run("portage::VersionComponents (iterate)", 1000000, components,
+        Iterate<VersionComponents>());
+    run("util::Vars::find()", 1000000, var_keys, FindVar());
+    run("util::Vars (iterate)", 1000000, ebuilds, Iterate<Ebuild>());
+    run("portage::Herds::find()", 1000000, herd_index,
+        Find<Herds, std::string>(herds, herd_keys));
+    run("portage::Developers::find()", 1000000, developer_index,
+        Find<Developers, std::string>(developers, developer_keys));
+
+    footprint("portage::Versions", versions);
+    footprint("portage::VersionComponents", components);
+
+    delete_all(versions);
+    delete_all(keywords);
+    delete_all(components);
+    delete_all(ebuilds);
+
+    remove_tree(tmp);
+    return benchmark_status();
+}
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
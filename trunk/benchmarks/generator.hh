@@ -0,0 +1,125 @@
+/*
+ * libherdstat -- benchmarks/generator.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_BENCHMARKS_GENERATOR_HH
+#define _HAVE_BENCHMARKS_GENERATOR_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file benchmarks/generator.hh
+ * @brief Helpers shared by the synthetic data generators.
+ */
+
+#include <string>
+#include <cstdio>
+#include <ftw.h>
+#include <unistd.h>
+#include <herdstat/exceptions.hh>
+
+#define countof(a) (sizeof(a) / sizeof(a[0]))
+
+/// Pseudo-random numbers that are the same on every platform, unlike rand().
+class Random
+{
+    public:
+        Random(unsigned long seed) : _state(seed * 2654435761UL + 1) { }
+
+        /// Get a number in [0,n).
+        unsigned long operator()(unsigned long n)
+        {
+            _state = _state * 1103515245UL + 12345UL;
+            return ((_state >> 16) & 0x7fffffffUL) % n;
+        }
+
+    private:
+        unsigned long _state;
+};
+
+/**
+ * Get an option from a "name=value,name=value" string.
+ * @param opts Options string.
+ * @param name Option name.
+ * @returns Value (empty if not present).
+ */
+
+inline std::string
+generator_option(const std::string& opts, const char *name)
+{
+    const std::string key(std::string(name) + "=");
+    std::string::size_type pos = 0;
+
+    while ((pos = opts.find(key, pos)) != std::string::npos)
+    {
+        if (pos == 0 or opts[pos-1] == ',')
+        {
+            pos += key.size();
+            return opts.substr(pos, opts.find(',', pos) - pos);
+        }
+        ++pos;
+    }
+
+    return std::string();
+}
+
+/**
+ * Write a file.
+ * @param path Path.
+ * @param contents Contents.
+ * @exception FileException
+ */
+
+inline void
+write_file(const std::string& path, const std::string& contents)
+{
+    std::FILE *f = std::fopen(path.c_str(), "w");
+    if (not f)
+        throw herdstat::FileException(path);
+    std::fwrite(contents.data(), 1, contents.size(), f);
+    if (std::fclose(f) != 0)
+        throw herdstat::FileException(path);
+}
+
+static inline int
+generator_remove_file(const char *path, const struct stat *st,
+                      int flag, struct FTW *ftw)
+{
+    (void)st; (void)ftw;
+    return ((flag == FTW_DP ? rmdir(path) : unlink(path)) == 0 ? 0 : -1);
+}
+
+/**
+ * Remove a directory and everything under it.
+ * @param root Directory to remove.
+ */
+
+inline void
+remove_tree(const std::string& root)
+{
+    nftw(root.c_str(), generator_remove_file, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+#endif /* _HAVE_BENCHMARKS_GENERATOR_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,300 @@
+/*
+ * libherdstat -- benchmarks/primitives.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/*
+ * Times the primitives everything else is built on (version parsing and
+ * comparison, keywords, splitting, whitespace tidying and path handling)
+ * over corpora taken from the test data in $TEST_DATA.  Each operation
+ * handles one item, cycling through the corpus.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <ftw.h>
+#include <herdstat/util/string.hh>
+#include <herdstat/portage/util.hh>
+#include <herdstat/portage/version.hh>
+#include <herdstat/portage/keywords.hh>
+#include "benchmark.hh"
+
+/* ebuild paths */
+static std::vector<std::string> ebuilds;
+/* package directories */
+static std::vector<std::string> packages;
+/* KEYWORDS values */
+static std::vector<std::string> keyword_lines;
+/* individual keywords */
+static std::vector<std::string> keywords;
+/* text from herds.xml and metadata.xml, as it appears in the files */
+static std::vector<std::string> texts;
+
+static std::string
+read_file(const std::string& path)
+{
+    std::ifstream stream(path.c_str());
+    std::ostringstream os;
+    os << stream.rdbuf();
+    return os.str();
+}
+
+/* add the text of each <tag> element in contents to texts */
+static void
+add_texts(const std::string& contents, const std::string& tag)
+{
+    const std::string open("<" + tag), close("</" + tag + ">");
+    std::string::size_type pos = 0;
+
+    while ((pos = contents.find(open, pos)) != std::string::npos)
+    {
+        pos = contents.find('>', pos);
+        const std::string::size_type end = contents.find(close, pos);
+        if (pos == std::string::npos or end == std::string::npos)
+            break;
+        texts.push_back(contents.substr(pos + 1, end - pos - 1));
+        pos = end;
+    }
+}
+
+static int
+add_file(const char *path, const struct stat *st, int flag, struct FTW *ftw)
+{
+    (void)st;
+    if (flag != FTW_F)
+        return 0;
+
+    const char *name = path + ftw->base;
+    const char *ext = std::strrchr(name, '.');
+
+    if (ext and std::strcmp(ext, ".ebuild") == 0)
+    {
+        ebuilds.push_back(path);
+        packages.push_back(std::string(path, ftw->base - 1));
+
+        std::ifstream stream(path);
+        std::string line;
+        while (std::getline(stream, line))
+        {
+            if (line.compare(0, 10, "KEYWORDS=\"") == 0)
+                keyword_lines.push_back(line.substr(10, line.rfind('"') - 10));
+        }
+    }
+    else if (std::strcmp(name, "metadata.xml") == 0)
+        add_texts(read_file(path), "longdescription");
+    else if (std::strcmp(name, "arch.list") == 0)
+    {
+        /* every arch, as ~arch */
+        std::ifstream stream(path);
+        std::string line, all;
+        while (std::getline(stream, line))
+        {
+            if (not line.empty() and line[0] != '#')
+                all += (all.empty() ? "~" : " ~") + line;
+        }
+        keyword_lines.push_back(all);
+    }
+
+    return 0;
+}
+
+/* call f on one item per operation, cycling through the corpus */
+template <typename Function>
+struct Each
+{
+    Each(const std::vector<std::string>& corpus, Function f)
+        : corpus(corpus), f(f), next(0) { }
+
+    void operator()()
+    {
+        f(corpus[next]);
+        if (++next == corpus.size())
+            next = 0;
+    }
+
+    const std::vector<std::string>& corpus;
+    Function f;
+    std::size_t next;
+};
+
+template <typename Function>
+static void
+run(const std::string& name, unsigned long iterations,
+    const std::vector<std::string>& corpus, Function f)
+{
+    if (corpus.empty())
+        std::cerr << name << ": empty corpus" << std::endl;
+    else
+        benchmark(name, iterations, Each<Function>(corpus, f));
+}
+
+struct ParseComponents
+{
+    void operator()(const std::string& path) const
+    {
+        const herdstat::portage::VersionComponents v(path);
+        benchmark_sink += v.size();
+    }
+};
+
+struct ParseVersion
+{
+    void operator()(const std::string& path) const
+    {
+        const herdstat::portage::VersionString v(path);
+        benchmark_sink += v.version().size();
+    }
+};
+
+/* compares against the next version along */
+struct CompareVersions
+{
+    CompareVersions(const std::vector<herdstat::portage::VersionString>& v)
+        : versions(v), next(0) { }
+
+    void operator()()
+    {
+        const std::size_t n = next;
+        if (++next == versions.size())
+            next = 0;
+        benchmark_sink += (versions[n] < versions[next]);
+    }
+
+    const std::vector<herdstat::portage::VersionString>& versions;
+    std::size_t next;
+};
+
+struct MakeKeyword
+{
+    void operator()(const std::string& kw) const
+    {
+        bool valid;
+        const herdstat::portage::Keyword keyword(kw, valid);
+        benchmark_sink += valid;
+    }
+};
+
+struct CompareKeywords
+{
+    CompareKeywords(const std::vector<herdstat::portage::Keyword>& k)
+        : keywords(k), next(0) { }
+
+    void operator()()
+    {
+        const std::size_t n = next;
+        if (++next == keywords.size())
+            next = 0;
+        benchmark_sink += (keywords[n] < keywords[next]);
+    }
+
+    const std::vector<herdstat::portage::Keyword>& keywords;
+    std::size_t next;
+};
+
+struct Split
+{
+    void operator()(const std::string& s) const
+    {
+        std::vector<std::string> parts;
+        herdstat::util::split(s, std::back_inserter(parts));
+        benchmark_sink += parts.size();
+    }
+};
+
+struct TidyWhitespace
+{
+    void operator()(const std::string& s) const
+    {
+        benchmark_sink += herdstat::util::tidy_whitespace(s).size();
+    }
+};
+
+struct PkgFromPath
+{
+    void operator()(const std::string& path) const
+    {
+        benchmark_sink += herdstat::portage::get_pkg_from_path(path).size();
+    }
+};
+
+int
+main()
+{
+    const char *test_data = std::getenv("TEST_DATA");
+    if (not test_data)
+    {
+        std::cerr << "TEST_DATA must be set" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    /* keywords are checked against the corpus' arch.list */
+    setenv("PORTDIR", (std::string(test_data) + "/portdir").c_str(), 1);
+
+    nftw(test_data, add_file, 16, FTW_PHYS);
+    const std::string herds(read_file(std::string(test_data) +
+        "/localstatedir/herds.xml"));
+    add_texts(herds, "description");
+
+    std::vector<std::string>::const_iterator i;
+    for (i = keyword_lines.begin() ; i != keyword_lines.end() ; ++i)
+        herdstat::util::split(*i, std::back_inserter(keywords));
+
+    std::vector<herdstat::portage::VersionString> versions;
+    for (i = ebuilds.begin() ; i != ebuilds.end() ; ++i)
+        versions.push_back(herdstat::portage::VersionString(*i));
+
+    std::vector<herdstat::portage::Keyword> parsed;
+    for (i = keywords.begin() ; i != keywords.end() ; ++i)
+    {
+        bool valid;
+        const herdstat::portage::Keyword keyword(*i, valid);
+        if (valid)
+            parsed.push_back(keyword);
+    }
+
+    std::cout << "Corpus: " << ebuilds.size() << " ebuilds, "
+        << keyword_lines.size() << " KEYWORDS lines (" << keywords.size()
+        << " keywords), " << texts.size() << " descriptions" << std::endl;
+
+    run("portage::VersionComponents(path)", 100000, ebuilds,
+        ParseComponents());
+    run("portage::VersionString(path)", 100000, ebuilds, ParseVersion());
+    if (not versions.empty())
+        benchmark("portage::VersionString::operator<()", 1000000,
+            CompareVersions(versions));
+    run("portage::Keyword(kw)", 1000000, keywords, MakeKeyword());
+    if (not parsed.empty())
+        benchmark("portage::Keyword::operator<()", 1000000,
+            CompareKeywords(parsed));
+    run("util::split() (KEYWORDS)", 100000, keyword_lines, Split());
+    run("util::tidy_whitespace()", 100000, texts, TidyWhitespace());
+    run("portage::get_pkg_from_path()", 1000000, packages, PkgFromPath());
+
+    return benchmark_status();
+}
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,134 @@
+/*
+ * libherdstat -- benchmarks/read_only_file.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/*
+ * Reads a large line-oriented file with std::getline() (what util::File
+ * used to do), util::File and util::ReadOnlyFile, and compares two copies
+ * of it.
+ */
+
+#include <fstream>
+#include <cstdio>
+#include <unistd.h>
+#include <herdstat/util/file.hh>
+#include "benchmark.hh"
+
+#define READ_ONLY_FILE_BENCH_FILE   "read_only_file.bench"
+#define READ_ONLY_FILE_BENCH_LINES  200000
+
+struct Getline
+{
+    void operator()() const
+    {
+        std::ifstream stream(READ_ONLY_FILE_BENCH_FILE);
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(stream, line))
+            lines.push_back(line);
+        benchmark_sink += lines.size();
+    }
+};
+
+struct ReadFile
+{
+    void operator()() const
+    {
+        const herdstat::util::File file(READ_ONLY_FILE_BENCH_FILE);
+        benchmark_sink += file.size();
+    }
+};
+
+struct ReadReadOnlyFile
+{
+    void operator()() const
+    {
+        const herdstat::util::ReadOnlyFile file(READ_ONLY_FILE_BENCH_FILE);
+        benchmark_sink += file.size();
+    }
+};
+
+struct CompareFile
+{
+    CompareFile(const herdstat::util::File& f1,
+                 const herdstat::util::File& f2)
+        : f1(f1), f2(f2) { }
+
+    void operator()() const
+    {
+        benchmark_sink += (f1 == f2);
+    }
+
+    const herdstat::util::File& f1;
+    const herdstat::util::File& f2;
+};
+
+struct CompareReadOnlyFile
+{
+    CompareReadOnlyFile(const herdstat::util::ReadOnlyFile& f1,
+                         const herdstat::util::ReadOnlyFile& f2)
+        : f1(f1), f2(f2) { }
+
+    void operator()() const
+    {
+        benchmark_sink += (f1 == f2);
+    }
+
+    const herdstat::util::ReadOnlyFile& f1;
+    const herdstat::util::ReadOnlyFile& f2;
+};
+
+int
+main()
+{
+    {
+        std::FILE *f = std::fopen(READ_ONLY_FILE_BENCH_FILE, "w");
+        if (not f)
+            return EXIT_FAILURE;
+        for (int n = 0 ; n < READ_ONLY_FILE_BENCH_LINES ; ++n)
+            std::fprintf(f, "app-misc/package-number-%d # comment\n", n);
+        std::fclose(f);
+    }
+
+    benchmark("std::getline()", 10, Getline());
+    benchmark("util::File", 10, ReadFile());
+    benchmark("util::ReadOnlyFile", 10, ReadReadOnlyFile());
+    {
+        const herdstat::util::File f1(READ_ONLY_FILE_BENCH_FILE),
+                                   f2(READ_ONLY_FILE_BENCH_FILE);
+        benchmark("util::File::operator==()", 10, CompareFile(f1, f2));
+    }
+
+    {
+        const herdstat::util::ReadOnlyFile f1(READ_ONLY_FILE_BENCH_FILE),
+                                           f2(READ_ONLY_FILE_BENCH_FILE);
+        benchmark("util::ReadOnlyFile::operator==()", 10,
+            CompareReadOnlyFile(f1, f2));
+    }
+
+    unlink(READ_ONLY_FILE_BENCH_FILE);
+    return benchmark_status();
+}
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,150 @@
+/*
+ * libherdstat -- benchmarks/string_view.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/*
+ * Compares the allocating string helpers with their StringView
+ * counterparts, and reports what the parsers built on them cost.
+ */
+
+#include <vector>
+#include <iterator>
+#include <herdstat/util/string.hh>
+#include <herdstat/portage/util.hh>
+#include <herdstat/portage/version.hh>
+#include "benchmark.hh"
+
+static const std::string keywords(
+    "alpha amd64 arm hppa ia64 ~mips ppc ppc64 s390 sparc x86 -x86-fbsd");
+static const std::string ebuild(
+    "/usr/portage/app-misc/foo-bar/foo-bar-1.10.20050629_rc2-r1.ebuild");
+
+struct Split
+{
+    void operator()() const
+    {
+        std::vector<std::string> parts;
+        herdstat::util::split(keywords, std::back_inserter(parts));
+        benchmark_sink += parts.size();
+    }
+};
+
+struct SplitView
+{
+    void operator()() const
+    {
+        const herdstat::util::SplitView parts(keywords);
+        herdstat::util::SplitView::const_iterator i;
+        for (i = parts.begin() ; i != parts.end() ; ++i)
+            benchmark_sink += i->size();
+    }
+};
+
+struct Basename
+{
+    void operator()() const
+    {
+        benchmark_sink += herdstat::util::chop_fileext(
+            herdstat::util::basename(ebuild)).size();
+    }
+};
+
+struct BasenameView
+{
+    void operator()() const
+    {
+        benchmark_sink += herdstat::util::chop_fileext_view(
+            herdstat::util::basename_view(ebuild)).size();
+    }
+};
+
+struct Lowercase
+{
+    void operator()() const
+    {
+        benchmark_sink +=
+            (herdstat::util::lowercase("Ka0ttic") == "ka0ttic");
+    }
+};
+
+struct Iequals
+{
+    void operator()() const
+    {
+        benchmark_sink += herdstat::util::iequals("Ka0ttic", "ka0ttic");
+    }
+};
+
+struct ParseVersion
+{
+    void operator()() const
+    {
+        const herdstat::portage::VersionString v(ebuild);
+        benchmark_sink += v.version().size();
+    }
+};
+
+struct CompareVersions
+{
+    CompareVersions()
+        : v1("foo-1.10.20050629_rc2-r1.ebuild"),
+          v2("foo-1.10.20050629_rc2-r2.ebuild") { }
+
+    void operator()() const
+    {
+        benchmark_sink += (v1 < v2);
+    }
+
+    const herdstat::portage::VersionString v1, v2;
+};
+
+struct PkgFromVerstr
+{
+    void operator()() const
+    {
+        benchmark_sink += herdstat::portage::get_pkg_from_verstr(
+            "app-misc/foo-bar-1.10-r1").size();
+    }
+};
+
+int
+main()
+{
+    benchmark("util::split()", 100000, Split());
+    benchmark("util::SplitView", 100000, SplitView());
+    benchmark("util::basename() + chop_fileext()", 100000, Basename());
+    benchmark("util::basename_view() + chop_fileext_view()", 100000,
+        BasenameView());
+    benchmark("util::lowercase() ==", 100000, Lowercase());
+    benchmark("util::iequals()", 100000, Iequals());
+    benchmark("portage::VersionString(path)", 20000, ParseVersion());
+    benchmark("portage::VersionString::operator<()", 100000,
+        CompareVersions());
+    benchmark("portage::get_pkg_from_verstr()", 100000, PkgFromVerstr());
+
+    return benchmark_status();
+}
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
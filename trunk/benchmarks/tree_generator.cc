@@ -0,0 +1,318 @@
+/*
+ * libherdstat -- benchmarks/tree_generator.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ftw.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <herdstat/util/file.hh>
+#include <herdstat/util/string.hh>
+#include "generator.hh"
+#include "tree_generator.hh"
+
+namespace {
+    const char * const category_prefixes[] = {
+        "app", "dev", "games", "media", "net", "sci", "sys", "www", "x11"
+    };
+
+    const char * const category_suffixes[] = {
+        "admin", "arch", "db", "editors", "libs", "misc", "portage",
+        "shells", "text", "util", "vim", "fs", "lang", "sound", "video"
+    };
+
+    const char * const syllables[] = {
+        "ba", "cor", "dex", "el", "fu", "gan", "hy", "ix", "jo", "ka",
+        "lib", "mo", "nu", "ox", "pi", "qua", "ro", "sy", "tor", "ul",
+        "vi", "wa", "xo", "yu", "zed"
+    };
+
+    const char * const arches[] = {
+        "alpha", "amd64", "arm", "hppa", "ia64", "m68k", "mips", "ppc",
+        "ppc64", "s390", "sh", "sparc", "x86", "ppc-macos", "x86-fbsd"
+    };
+
+    const char * const suffixes[] = {
+        "", "", "", "", "_alpha", "_beta", "_pre", "_rc", "_p"
+    };
+
+    std::string
+    make_name(Random& random, unsigned n)
+    {
+        std::string name;
+        const unsigned parts = 2 + random(2);
+        for (unsigned i = 0 ; i < parts ; ++i)
+            name += syllables[random(countof(syllables))];
+        if (random(4) == 0)
+            name += "-" + std::string(syllables[random(countof(syllables))]);
+
+        /* keep names unique */
+        return name + herdstat::util::sprintf("%u", n);
+    }
+
+    std::string
+    make_version(Random& random, unsigned n)
+    {
+        std::string v(herdstat::util::sprintf("%u.%lu", n / 3,
+            random(20) + (n % 3) * 20));
+        if (random(3) == 0)
+            v += herdstat::util::sprintf(".%lu", random(10));
+
+        const char *suffix = suffixes[random(countof(suffixes))];
+        if (*suffix)
+            v += herdstat::util::sprintf("%s%lu", suffix, random(5));
+        if (random(3) == 0)
+            v += herdstat::util::sprintf("-r%lu", random(4) + 1);
+        return v;
+    }
+
+    std::string
+    make_keywords(Random& random, unsigned density)
+    {
+        std::string keywords;
+        for (std::size_t i = 0 ; i < countof(arches) ; ++i)
+        {
+            if (random(100) >= density)
+                continue;
+
+            if (not keywords.empty())
+                keywords += " ";
+            if (random(3) == 0)
+                keywords += "~";
+            keywords += arches[i];
+        }
+        return keywords;
+    }
+
+    std::string
+    make_ebuild(const std::string& pkg, const std::string& keywords)
+    {
+        return
+            "# Copyright 1999-2005 Gentoo Foundation\n"
+            "# Distributed under the terms of the GNU General Public License v2\n"
+            "# $Header: $\n\n"
+            "inherit eutils\n\n"
+            "DESCRIPTION=\"Synthetic package " + pkg + "\"\n"
+            "HOMEPAGE=\"http://www.example.org/" + pkg + "/\"\n"
+            "SRC_URI=\"mirror://sourceforge/${PN}/${P}.tar.gz\"\n"
+            "LICENSE=\"GPL-2\"\n"
+            "SLOT=\"0\"\n"
+            "KEYWORDS=\"" + keywords + "\"\n"
+            "IUSE=\"nls debug\"\n\n"
+            "DEPEND=\"virtual/libc\n"
+            "\tnls? ( sys-devel/gettext )\"\n\n"
+            "src_install() {\n"
+            "\tmake DESTDIR=\"${D}\" install || die \"make install failed\"\n"
+            "\tdodoc AUTHORS ChangeLog NEWS README\n"
+            "}\n";
+    }
+
+    std::string
+    make_metadata(Random& random)
+    {
+        const std::string dev(syllables[random(countof(syllables))] +
+            std::string(syllables[random(countof(syllables))]));
+        return
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            "<!DOCTYPE pkgmetadata SYSTEM \"http://www.gentoo.org/dtd/metadata.dtd\">\n"
+            "<pkgmetadata>\n"
+            "\t<herd>" + std::string(category_suffixes[
+                random(countof(category_suffixes))]) + "</herd>\n"
+            "\t<maintainer>\n"
+            "\t\t<email>" + dev + "@gentoo.org</email>\n"
+            "\t</maintainer>\n"
+            "\t<longdescription>A synthetic package.</longdescription>\n"
+            "</pkgmetadata>\n";
+    }
+
+    /* write ebuilds (numbered from first) and metadata.xml for a package */
+    unsigned long
+    write_package(Random& random, const std::string& dir,
+                  const std::string& name, unsigned first, unsigned n,
+                  unsigned density)
+    {
+        herdstat::util::mkdir(dir, 0755);
+        write_file(dir + "/metadata.xml", make_metadata(random));
+
+        for (unsigned i = first ; i < first + n ; ++i)
+        {
+            const std::string ebuild(dir + "/" + name + "-" +
+                make_version(random, i) + ".ebuild");
+            write_file(ebuild, make_ebuild(name,
+                make_keywords(random, density)));
+        }
+
+        return (n + 1);
+    }
+
+    int
+    evict_file(const char *path, const struct stat *st,
+               int flag, struct FTW *ftw)
+    {
+        (void)st; (void)ftw;
+
+        if (flag != FTW_F)
+            return 0;
+
+        const int fd = open(path, O_RDONLY);
+        if (fd == -1)
+            return 0;
+
+        /* dirty pages can't be dropped */
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+        return 0;
+    }
+}
+
+TreeOptions::TreeOptions()
+    : categories(20), packages(50), ebuilds(4), overlays(0), keywords(50),
+      seed(1)
+{
+    const char *opts = std::getenv("BENCHMARK_TREE");
+    if (not opts)
+        return;
+
+    struct { const char *name; unsigned *value; } options[] = {
+        { "categories", &categories },
+        { "packages", &packages },
+        { "ebuilds", &ebuilds },
+        { "overlays", &overlays },
+        { "keywords", &keywords }
+    };
+
+    for (std::size_t i = 0 ; i < countof(options) ; ++i)
+    {
+        const std::string v(generator_option(opts, options[i].name));
+        if (not v.empty())
+            *options[i].value = std::strtoul(v.c_str(), NULL, 10);
+    }
+
+    const std::string v(generator_option(opts, "seed"));
+    if (not v.empty())
+        seed = std::strtoul(v.c_str(), NULL, 10);
+}
+
+Tree
+generate_tree(const std::string& root, const TreeOptions& opts)
+{
+    Random random(opts.seed);
+    Tree tree;
+    tree.portdir = root + "/portdir";
+    tree.files = 0;
+
+    herdstat::util::mkdir(root, 0755);
+    herdstat::util::mkdir(tree.portdir, 0755);
+    herdstat::util::mkdir(tree.portdir + "/profiles", 0755);
+
+    std::string arch_list;
+    for (std::size_t i = 0 ; i < countof(arches) ; ++i)
+        arch_list += std::string(arches[i]) + "\n";
+    write_file(tree.portdir + "/profiles/arch.list", arch_list);
+
+    std::vector<std::string> categories;
+    std::string category_list;
+    for (unsigned c = 0 ; c < opts.categories ; ++c)
+    {
+        /* cycle through every combination before repeating one */
+        const std::size_t n = c % (countof(category_prefixes) *
+                                   countof(category_suffixes));
+        std::string cat(std::string(category_prefixes[
+            n % countof(category_prefixes)]) + "-" +
+            category_suffixes[n / countof(category_prefixes)]);
+        if (c >= countof(category_prefixes) * countof(category_suffixes))
+            cat += herdstat::util::sprintf("%u", c);
+
+        categories.push_back(cat);
+        category_list += cat + "\n";
+    }
+    write_file(tree.portdir + "/profiles/categories", category_list);
+    tree.files += 2;
+
+    unsigned n = 0;
+    std::vector<std::string>::const_iterator c;
+    for (c = categories.begin() ; c != categories.end() ; ++c)
+    {
+        herdstat::util::mkdir(tree.portdir + "/" + *c, 0755);
+
+        for (unsigned p = 0 ; p < opts.packages ; ++p)
+        {
+            const std::string name(make_name(random, n++));
+            tree.packages.push_back(*c + "/" + name);
+            tree.files += write_package(random,
+                tree.portdir + "/" + tree.packages.back(), name, 0,
+                opts.ebuilds, opts.keywords);
+        }
+    }
+
+    for (unsigned o = 0 ; o < opts.overlays ; ++o)
+    {
+        tree.overlays.push_back(root + herdstat::util::sprintf("/overlay%u", o));
+        const std::string& overlay(tree.overlays.back());
+        herdstat::util::mkdir(overlay, 0755);
+
+        /* newer versions of ~10% of the packages */
+        std::vector<std::string>::const_iterator i;
+        for (i = tree.packages.begin() ; i != tree.packages.end() ; ++i)
+        {
+            if (random(10) != 0)
+                continue;
+
+            const std::string cat(i->substr(0, i->find('/')));
+            if (not herdstat::util::is_dir(overlay + "/" + cat))
+                herdstat::util::mkdir(overlay + "/" + cat, 0755);
+
+            tree.files += write_package(random, overlay + "/" + *i,
+                i->substr(i->find('/') + 1), opts.ebuilds, 1 + random(2),
+                opts.keywords);
+        }
+    }
+
+    return tree;
+}
+
+void
+evict_tree(const std::string& root)
+{
+    nftw(root.c_str(), evict_file, 16, FTW_PHYS);
+
+    /* system-wide, so only if asked to (and only works for root) */
+    if (not std::getenv("BENCHMARK_DROP_CACHES"))
+        return;
+
+    std::FILE *f = std::fopen("/proc/sys/vm/drop_caches", "w");
+    if (f)
+    {
+        sync();
+        std::fputs("3\n", f);
+        std::fclose(f);
+    }
+}
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
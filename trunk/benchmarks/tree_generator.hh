@@ -0,0 +1,95 @@
+/*
+ * libherdstat -- benchmarks/tree_generator.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_BENCHMARKS_TREE_GENERATOR_HH
+#define _HAVE_BENCHMARKS_TREE_GENERATOR_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file benchmarks/tree_generator.hh
+ * @brief Generates synthetic portage trees for the benchmarks.
+ *
+ * The same options (including the seed) always produce the same tree.
+ */
+
+#include <string>
+#include <vector>
+
+/// Shape of a generated tree.
+struct TreeOptions
+{
+    /** Defaults, overridden by BENCHMARK_TREE in the environment, eg
+     * "categories=50,packages=100,ebuilds=5,overlays=2,keywords=60,seed=7".
+     */
+    TreeOptions();
+
+    /// Number of categories.
+    unsigned categories;
+    /// Packages per category.
+    unsigned packages;
+    /// Ebuilds per package.
+    unsigned ebuilds;
+    /// Number of overlays (each holds newer versions of ~10% of packages).
+    unsigned overlays;
+    /// Percentage of arches keyworded in each ebuild.
+    unsigned keywords;
+    /// Random seed.
+    unsigned long seed;
+};
+
+/// A generated tree.
+struct Tree
+{
+    /// PORTDIR.
+    std::string portdir;
+    /// Overlay directories.
+    std::vector<std::string> overlays;
+    /// Every "cat/pkg" in PORTDIR, in generation order.
+    std::vector<std::string> packages;
+    /// Number of files written.
+    unsigned long files;
+};
+
+/**
+ * Generate a tree.
+ * @param root Directory to create it in (must not exist).
+ * @param opts Shape of tree.
+ * @returns Tree.
+ */
+Tree generate_tree(const std::string& root, const TreeOptions& opts);
+
+/**
+ * Drop the tree's file contents from the page cache, so the next read
+ * has to go to disk.  Directory entries and inodes stay cached unless
+ * BENCHMARK_DROP_CACHES is set in the environment and we're allowed to
+ * write to /proc/sys/vm/drop_caches (ie we're root); that drops every
+ * cache on the system.
+ * @param root Directory to evict.
+ */
+void evict_tree(const std::string& root);
+
+#endif /* _HAVE_BENCHMARKS_TREE_GENERATOR_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,186 @@
+/*
+ * libherdstat -- benchmarks/tree_ops.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/*
+ * Times the tree operations (reading categories, filling a PackageList,
+ * finding packages, finding the newest ebuilds and loading keywords) on a
+ * generated tree, with cold and warm caches.  Set BENCHMARK_TREE to change
+ * the shape of the tree (see tree_generator.hh).
+ */
+
+#include <cstdlib>
+#include <herdstat/util/regex.hh>
+#include <herdstat/portage/config.hh>
+#include <herdstat/portage/categories.hh>
+#include <herdstat/portage/package_list.hh>
+#include <herdstat/portage/package_finder.hh>
+#include <herdstat/portage/package_which.hh>
+#include <herdstat/portage/keywords.hh>
+#include "generator.hh"
+#include "tree_generator.hh"
+#include "benchmark.hh"
+
+/* number of packages looked up by the per-package benchmarks */
+#define TREE_OPS_LOOKUPS    100
+
+static std::vector<std::string> lookups;
+
+struct ReadCategories
+{
+    void operator()() const
+    {
+        const herdstat::portage::Categories
+            categories(herdstat::portage::GlobalConfig().portdir());
+        benchmark_sink += categories.size();
+    }
+};
+
+struct FillPackageList
+{
+    void operator()() const
+    {
+        const herdstat::portage::Config& config(
+            herdstat::portage::GlobalConfig());
+        const herdstat::portage::PackageList pkgs(config.portdir(),
+            config.overlays());
+        benchmark_sink += pkgs.size();
+    }
+};
+
+struct FindByName
+{
+    FindByName(const herdstat::portage::PackageList& pkgs) : pkgs(pkgs) { }
+
+    void operator()() const
+    {
+        herdstat::portage::PackageFinder find(pkgs);
+        std::vector<std::string>::const_iterator i;
+        for (i = lookups.begin() ; i != lookups.end() ; ++i)
+            find.try_find(i->substr(i->find('/') + 1));
+        benchmark_sink += find.results().size();
+    }
+
+    const herdstat::portage::PackageList& pkgs;
+};
+
+struct FindByRegex
+{
+    FindByRegex(const herdstat::portage::PackageList& pkgs) : pkgs(pkgs) { }
+
+    void operator()() const
+    {
+        herdstat::portage::PackageFinder find(pkgs);
+        benchmark_sink += find(herdstat::util::Regex("^ba.*o")).size();
+    }
+
+    const herdstat::portage::PackageList& pkgs;
+};
+
+struct Which
+{
+    void operator()() const
+    {
+        const std::string& portdir(herdstat::portage::GlobalConfig().portdir());
+        herdstat::portage::PackageWhich which;
+        std::vector<std::string>::const_iterator i;
+        for (i = lookups.begin() ; i != lookups.end() ; ++i)
+            which(*i, portdir);
+        benchmark_sink += which.results().size();
+    }
+};
+
+struct LoadKeywords
+{
+    void operator()() const
+    {
+        const std::string& portdir(herdstat::portage::GlobalConfig().portdir());
+        std::vector<std::string>::const_iterator i;
+        for (i = lookups.begin() ; i != lookups.end() ; ++i)
+        {
+            const herdstat::portage::KeywordsMap keywords(portdir+"/"+*i);
+            benchmark_sink += keywords.size();
+        }
+    }
+};
+
+struct Evict
+{
+    Evict(const std::string& root) : root(root) { }
+    void operator()() const { evict_tree(root); }
+    const std::string root;
+};
+
+/* run f with cold caches, then warm */
+template <typename Function>
+static void
+run(const std::string& name, const std::string& root, Function f)
+{
+    benchmark_samples(name + " (cold)", 5, f, Evict(root));
+    f();
+    benchmark_samples(name + " (warm)", 10, f, benchmark_nothing());
+}
+
+int
+main()
+{
+    char tmp[] = "/tmp/herdstat-tree.XXXXXX";
+    if (not mkdtemp(tmp))
+        return EXIT_FAILURE;
+
+    const std::string root(std::string(tmp) + "/tree");
+    const TreeOptions opts;
+    const Tree tree(generate_tree(root, opts));
+
+    std::cout << "Tree: " << opts.categories << " categories, "
+        << tree.packages.size() << " packages, " << tree.overlays.size()
+        << " overlays, " << tree.files << " files" << std::endl;
+
+    /* before anything calls GlobalConfig() */
+    std::string overlays;
+    std::vector<std::string>::const_iterator i;
+    for (i = tree.overlays.begin() ; i != tree.overlays.end() ; ++i)
+        overlays += (overlays.empty() ? "" : " ") + *i;
+    setenv("PORTDIR", tree.portdir.c_str(), 1);
+    setenv("PORTDIR_OVERLAY", overlays.c_str(), 1);
+
+    const std::size_t step =
+        std::max<std::size_t>(tree.packages.size() / TREE_OPS_LOOKUPS, 1);
+    for (std::size_t n = 0 ; n < tree.packages.size() ; n += step)
+        lookups.push_back(tree.packages[n]);
+
+    const herdstat::portage::PackageList pkgs;
+
+    run("portage::Categories", root, ReadCategories());
+    run("portage::PackageList::fill()", root, FillPackageList());
+    run("portage::PackageFinder (by name)", root, FindByName(pkgs));
+    run("portage::PackageFinder (regex)", root, FindByRegex(pkgs));
+    run("portage::PackageWhich", root, Which());
+    run("portage::KeywordsMap", root, LoadKeywords());
+
+    remove_tree(tmp);
+    return benchmark_status();
+}
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,338 @@
+/*
+ * libherdstat -- benchmarks/xml_generator.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstdlib>
+#include <cctype>
+#include <herdstat/util/file.hh>
+#include <herdstat/util/string.hh>
+#include "generator.hh"
+#include "xml_generator.hh"
+
+namespace {
+    const char * const syllables[] = {
+        "ba", "cor", "dex", "el", "fu", "gan", "hy", "ix", "jo", "ka",
+        "lib", "mo", "nu", "ox", "pi", "qua", "ro", "sy", "tor", "ul",
+        "vi", "wa", "xo", "yu", "zed"
+    };
+
+    const char * const words[] = {
+        "packages", "maintained", "by", "the", "team", "for", "tools",
+        "libraries", "and", "related", "bindings", "desktop", "server",
+        "kernel", "sound", "graphics", "language", "support", "of"
+    };
+
+    const char * const months[] = {
+        "January", "February", "March", "April", "May", "June", "July",
+        "August", "September", "October", "November", "December"
+    };
+
+    std::string
+    make_word(Random& random)
+    {
+        std::string s;
+        const unsigned parts = 2 + random(2);
+        for (unsigned i = 0 ; i < parts ; ++i)
+            s += syllables[random(countof(syllables))];
+        return s;
+    }
+
+    std::string
+    make_sentence(Random& random, unsigned n)
+    {
+        std::string s;
+        for (unsigned i = 0 ; i < n ; ++i)
+        {
+            if (i > 0)
+                s += " ";
+            s += words[random(countof(words))];
+        }
+        return s;
+    }
+
+    std::string
+    capitalize(std::string s)
+    {
+        if (not s.empty())
+            s[0] = std::toupper(s[0]);
+        return s;
+    }
+
+    std::string
+    make_date(Random& random)
+    {
+        return herdstat::util::sprintf("%lu %s %lu", random(28) + 1,
+            months[random(countof(months))], 1960 + random(45));
+    }
+
+    /* count start tags */
+    unsigned long
+    count_elements(const std::string& s)
+    {
+        unsigned long n = 0;
+        std::string::size_type pos = 0;
+        while ((pos = s.find('<', pos)) != std::string::npos)
+        {
+            if (++pos < s.size() and std::isalpha(s[pos]))
+                ++n;
+        }
+        return n;
+    }
+
+    XMLDocument
+    write_document(const std::string& path, const std::string& contents)
+    {
+        write_file(path, contents);
+
+        XMLDocument doc;
+        doc.path = path;
+        doc.bytes = contents.size();
+        doc.elements = count_elements(contents);
+        return doc;
+    }
+
+    std::string
+    make_maintainer(Random& random, const std::string& dev)
+    {
+        std::string s("\t\t<maintainer>\n\t\t\t<email>" + dev +
+            "@gentoo.org</email>\n");
+        if (random(3) == 0)
+            s += "\t\t\t<name>" + capitalize(dev) + "</name>\n";
+        if (random(4) == 0)
+            s += "\t\t\t<role>" + make_sentence(random, 3) + "</role>\n";
+        return s + "\t\t</maintainer>\n";
+    }
+}
+
+XMLOptions::XMLOptions()
+    : herds(1000), developers(2000), metadata(500), projects(20), seed(1)
+{
+    const char *opts = std::getenv("BENCHMARK_XML");
+    if (not opts)
+        return;
+
+    struct { const char *name; unsigned *value; } options[] = {
+        { "herds", &herds },
+        { "developers", &developers },
+        { "metadata", &metadata },
+        { "projects", &projects }
+    };
+
+    for (std::size_t i = 0 ; i < countof(options) ; ++i)
+    {
+        const std::string v(generator_option(opts, options[i].name));
+        if (not v.empty())
+            *options[i].value = std::strtoul(v.c_str(), NULL, 10);
+    }
+
+    const std::string v(generator_option(opts, "seed"));
+    if (not v.empty())
+        seed = std::strtoul(v.c_str(), NULL, 10);
+}
+
+XMLDocuments
+generate_xml(const std::string& root, const XMLOptions& opts)
+{
+    Random random(opts.seed);
+    XMLDocuments docs;
+
+    herdstat::util::mkdir(root, 0755);
+
+    for (unsigned n = 0 ; n < opts.developers ; ++n)
+        docs.developers.push_back(make_word(random) +
+            herdstat::util::sprintf("%u", n));
+
+    const std::vector<std::string>& devs(docs.developers);
+    const unsigned long ndevs = std::max<std::size_t>(devs.size(), 1);
+
+    /* userinfo.xml */
+    {
+        std::string s(
+            "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+            "<!DOCTYPE userlist SYSTEM \"/dtd/userinfo.dtd\">\n"
+            "<userlist>\n");
+
+        std::vector<std::string>::const_iterator i;
+        for (i = devs.begin() ; i != devs.end() ; ++i)
+        {
+            const std::string first(capitalize(make_word(random)));
+            const std::string last(capitalize(*i));
+
+            s += "  <user username=\"" + *i + "\">\n"
+                 "    <realname fullname=\"" + first + " " + last + "\">\n"
+                 "      <firstname>" + first + "</firstname>\n"
+                 "      <familyname>" + last + "</familyname>\n"
+                 "    </realname>\n";
+            if (random(2) == 0)
+                s += herdstat::util::sprintf(
+                     "    <pgpkey>0x%08lX</pgpkey>\n", random(0x7fffffff));
+            s += "    <email role=\"gentoo\">" + *i + "@gentoo.org</email>\n"
+                 "    <joined>" + make_date(random) + "</joined>\n";
+            if (random(2) == 0)
+                s += "    <birthday>" + make_date(random) + "</birthday>\n";
+            if (random(10) == 0)
+                s += "    <status>retired</status>\n";
+            s += "    <roles>" + make_sentence(random, 1 + random(6)) +
+                 "</roles>\n"
+                 "    <location>" + capitalize(make_word(random)) +
+                 ", " + capitalize(make_word(random)) + "</location>\n"
+                 "  </user>\n";
+        }
+
+        s += "</userlist>\n";
+        docs.userinfo = write_document(root + "/userinfo.xml", s);
+    }
+
+    /* devaway.xml */
+    {
+        std::string s(
+            "<?xml version='1.0' encoding='UTF-8' standalone='yes'?>\n"
+            "<devaway date='Tue, 06 Sep 2005 16:00:11 +0000'>\n");
+
+        std::vector<std::string>::const_iterator i;
+        for (i = devs.begin() ; i != devs.end() ; ++i)
+        {
+            if (random(10) == 0)
+                s += "<dev nick='" + *i + "'><reason>" +
+                     capitalize(make_sentence(random, 4 + random(20))) +
+                     ".</reason></dev>\n";
+        }
+
+        s += "</devaway>\n";
+        docs.devaway = write_document(root + "/devaway.xml", s);
+    }
+
+    /* projectxml files, laid out like a CVS checkout */
+    docs.cvsdir = root + "/cvs";
+    if (opts.projects > 0)
+    {
+        std::string dir(docs.cvsdir);
+        const char * const parts[] = { "gentoo", "xml", "htdocs", "proj", "en" };
+        herdstat::util::mkdir(dir, 0755);
+        for (std::size_t i = 0 ; i < countof(parts) ; ++i)
+            herdstat::util::mkdir(dir += std::string("/") + parts[i], 0755);
+
+        for (unsigned n = 0 ; n < opts.projects ; ++n)
+        {
+            const std::string name(make_word(random) +
+                herdstat::util::sprintf("%u", n));
+            herdstat::util::mkdir(dir + "/" + name, 0755);
+
+            std::string s(
+                "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                "<!DOCTYPE project SYSTEM \"/dtd/project.dtd\">\n"
+                "<project>\n"
+                "<name>" + name + "</name>\n"
+                "<longname>" + capitalize(make_sentence(random, 4)) +
+                "</longname>\n"
+                "<description>" + capitalize(make_sentence(random, 10)) +
+                ".</description>\n");
+
+            const unsigned members = 3 + random(15);
+            for (unsigned m = 0 ; m < members ; ++m)
+                s += "<dev description=\"" + make_sentence(random, 2) +
+                     "\">" + devs[random(ndevs)] + "</dev>\n";
+
+            s += "<task id=\"" + make_word(random) + "\">\n"
+                 "<description>" + make_sentence(random, 8) +
+                 "</description>\n"
+                 "<dev>" + devs[random(ndevs)] + "</dev>\n"
+                 "</task>\n"
+                 "</project>\n";
+
+            docs.project_paths.push_back("/proj/en/" + name + "/index.xml");
+            docs.projects.push_back(write_document(
+                dir + "/" + name + "/index.xml", s));
+        }
+    }
+
+    /* herds.xml */
+    {
+        std::string s(
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            "<!DOCTYPE herds SYSTEM \"http://www.gentoo.org/dtd/herds.dtd\">\n"
+            "<herds>\n");
+
+        for (unsigned n = 0 ; n < opts.herds ; ++n)
+        {
+            const std::string name(make_word(random) +
+                herdstat::util::sprintf("%u", n));
+
+            s += "\t<herd>\n"
+                 "\t\t<name>" + name + "</name>\n"
+                 "\t\t<email>" + name + "@gentoo.org</email>\n"
+                 "\t\t<description>" + capitalize(make_sentence(random,
+                    3 + random(8))) + "</description>\n";
+
+            const unsigned members = 1 + random(8);
+            for (unsigned m = 0 ; m < members ; ++m)
+                s += make_maintainer(random, devs[random(ndevs)]);
+
+            if (not docs.project_paths.empty() and random(20) == 0)
+                s += "\t\t<maintainingproject>" +
+                     docs.project_paths[random(docs.project_paths.size())] +
+                     "</maintainingproject>\n";
+
+            s += "\t</herd>\n";
+        }
+
+        s += "</herds>\n";
+        docs.herds = write_document(root + "/herds.xml", s);
+    }
+
+    /* metadata.xml files */
+    if (opts.metadata > 0)
+    {
+        herdstat::util::mkdir(root + "/metadata", 0755);
+
+        for (unsigned n = 0 ; n < opts.metadata ; ++n)
+        {
+            std::string s(
+                "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                "<!DOCTYPE pkgmetadata SYSTEM \"http://www.gentoo.org/dtd/metadata.dtd\">\n"
+                "<pkgmetadata>\n");
+
+            const unsigned herds = 1 + random(2);
+            for (unsigned h = 0 ; h < herds ; ++h)
+                s += "\t<herd>" + make_word(random) + "</herd>\n";
+
+            const unsigned maintainers = random(3);
+            for (unsigned m = 0 ; m < maintainers ; ++m)
+                s += make_maintainer(random, devs[random(ndevs)]);
+
+            s += "\t<longdescription lang=\"en\">\n\t" +
+                 capitalize(make_sentence(random, 10 + random(40))) +
+                 ".\n\t</longdescription>\n"
+                 "</pkgmetadata>\n";
+
+            docs.metadata.push_back(write_document(root +
+                herdstat::util::sprintf("/metadata/%u.xml", n), s));
+        }
+    }
+
+    return docs;
+}
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,98 @@
+/*
+ * libherdstat -- benchmarks/xml_generator.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_BENCHMARKS_XML_GENERATOR_HH
+#define _HAVE_BENCHMARKS_XML_GENERATOR_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file benchmarks/xml_generator.hh
+ * @brief Generates synthetic herds.xml, userinfo.xml, devaway.xml,
+ * projectxml and metadata.xml files for the benchmarks.
+ *
+ * The same options (including the seed) always produce the same files.
+ */
+
+#include <string>
+#include <vector>
+
+/// Size of the generated documents.
+struct XMLOptions
+{
+    /** Defaults, overridden by BENCHMARK_XML in the environment, eg
+     * "herds=2000,developers=5000,metadata=1000,projects=50,seed=7".
+     */
+    XMLOptions();
+
+    /// Number of herds in herds.xml.
+    unsigned herds;
+    /// Number of developers in userinfo.xml (~10% are in devaway.xml).
+    unsigned developers;
+    /// Number of metadata.xml files.
+    unsigned metadata;
+    /// Number of projectxml files (referenced from herds.xml).
+    unsigned projects;
+    /// Random seed.
+    unsigned long seed;
+};
+
+/// A generated document.
+struct XMLDocument
+{
+    XMLDocument() : path(), bytes(0), elements(0) { }
+
+    std::string path;
+    unsigned long bytes;
+    unsigned long elements;
+};
+
+/// The generated documents.
+struct XMLDocuments
+{
+    XMLDocument herds;
+    XMLDocument userinfo;
+    XMLDocument devaway;
+    std::vector<XMLDocument> metadata;
+    std::vector<XMLDocument> projects;
+
+    /// CVS directory for the projectxml files (see HerdsXML::set_cvsdir()).
+    std::string cvsdir;
+    /// Project paths relative to cvsdir, as passed to ProjectXML.
+    std::vector<std::string> project_paths;
+    /// Every developer's user name.
+    std::vector<std::string> developers;
+};
+
+/**
+ * Generate the documents.
+ * @param root Directory to create them in (must not exist).
+ * @param opts Size of the documents.
+ * @returns XMLDocuments.
+ */
+XMLDocuments generate_xml(const std::string& root, const XMLOptions& opts);
+
+#endif /* _HAVE_BENCHMARKS_XML_GENERATOR_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
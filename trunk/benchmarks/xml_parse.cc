@@ -0,0 +1,233 @@
+/*
+ * libherdstat -- benchmarks/xml_parse.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/*
+ * Measures parsing throughput (MB/s, elements/s and peak heap usage) of the
+ * XML data sources on generated documents, the latency of fill_developer()
+ * on each of them and the memory footprint of the parsed data.  Set BENCHMARK_XML to change the size
+ * of the documents (see xml_generator.hh).
+ */
+
+#include <cstdlib>
+#include <herdstat/util/memory.hh>
+#include <herdstat/xml/init.hh>
+#include <herdstat/portage/developer.hh>
+#include <herdstat/portage/herds_xml.hh>
+#include <herdstat/portage/userinfo_xml.hh>
+#include <herdstat/portage/devaway_xml.hh>
+#include <herdstat/portage/metadata_xml.hh>
+#include "generator.hh"
+#include "xml_generator.hh"
+#include "benchmark.hh"
+
+/* number of developers looked up per call by the fill_developer()
+ * benchmarks */
+#define XML_PARSE_LOOKUPS   10
+
+static std::string cvsdir;
+
+struct ParseHerds
+{
+    ParseHerds(const XMLDocument& doc) : doc(doc) { }
+
+    void operator()() const
+    {
+        herdstat::portage::HerdsXML herds;
+        herds.set_cvsdir(cvsdir);
+        herds.parse(doc.path);
+        benchmark_sink += herds.size();
+    }
+
+    const XMLDocument& doc;
+};
+
+struct ParseUserinfo
+{
+    ParseUserinfo(const XMLDocument& doc, bool lazy) : doc(doc), lazy(lazy) { }
+
+    void operator()() const
+    {
+        const herdstat::portage::UserinfoXML userinfo(doc.path, lazy);
+        benchmark_sink += userinfo.devs().size();
+    }
+
+    const XMLDocument& doc;
+    const bool lazy;
+};
+
+struct ParseDevaway
+{
+    ParseDevaway(const XMLDocument& doc) : doc(doc) { }
+
+    void operator()() const
+    {
+        const herdstat::portage::DevawayXML devaway(doc.path);
+        benchmark_sink += devaway.devs().size();
+    }
+
+    const XMLDocument& doc;
+};
+
+struct ParseMetadata
+{
+    ParseMetadata(const std::vector<XMLDocument>& docs) : docs(docs) { }
+
+    void operator()() const
+    {
+        std::vector<XMLDocument>::const_iterator i;
+        for (i = docs.begin() ; i != docs.end() ; ++i)
+        {
+            const herdstat::portage::MetadataXML metadata(i->path);
+            benchmark_sink += metadata.data().herds().size();
+        }
+    }
+
+    const std::vector<XMLDocument>& docs;
+};
+
+template <typename DataSource>
+struct FillDeveloper
+{
+    FillDeveloper(const DataSource& ds, const std::vector<std::string>& devs)
+        : ds(ds), devs(devs), next(0) { }
+
+    void operator()()
+    {
+        for (std::size_t n = 0 ; n < XML_PARSE_LOOKUPS ; ++n)
+        {
+            herdstat::portage::Developer dev(devs[next++ % devs.size()]);
+            ds.fill_developer(dev);
+            benchmark_sink += dev.herds().size();
+        }
+    }
+
+    const DataSource& ds;
+    const std::vector<std::string>& devs;
+    std::size_t next;
+};
+
+/* time parsing with f and print the throughput derived from the median */
+template <typename Function>
+static void
+run(const std::string& name, unsigned long bytes, unsigned long elements,
+    Function f)
+{
+    /* peak heap usage of a single parse */
+    unsigned long peak;
+    {
+        const instrument::AllocScope scope;
+        f();
+        peak = scope.stats().peak;
+    }
+
+    const double ns = benchmark_samples(name, 10, f, benchmark_nothing());
+
+    std::cout << "    " << std::fixed << std::setprecision(2)
+        << (bytes / ns) * 1e9 / (1024 * 1024) << " MB/s, "
+        << std::setprecision(0) << (elements / ns) * 1e9 << " elements/s, "
+        << std::setprecision(2) << peak / (1024.0 * 1024) << " MB peak"
+        << std::endl;
+}
+
+/* print the heap bytes held by a parsed data source */
+template <typename DataSource>
+static void
+footprint(const std::string& name, const DataSource& ds)
+{
+    const herdstat::util::MemoryUsage mem(ds.memory_usage());
+    std::cout << name << " footprint: " << std::fixed << std::setprecision(2)
+        << mem.total() / (1024.0 * 1024) << " MB (" << mem << ")"
+        << std::endl;
+}
+
+int
+main()
+{
+    char tmp[] = "/tmp/herdstat-xml.XXXXXX";
+    if (not mkdtemp(tmp))
+        return EXIT_FAILURE;
+
+    const XMLOptions opts;
+    const XMLDocuments docs(generate_xml(std::string(tmp) + "/xml", opts));
+    cvsdir = docs.cvsdir;
+
+    unsigned long metadata_bytes = 0, metadata_elements = 0;
+    std::vector<XMLDocument>::const_iterator i;
+    for (i = docs.metadata.begin() ; i != docs.metadata.end() ; ++i)
+    {
+        metadata_bytes += i->bytes;
+        metadata_elements += i->elements;
+    }
+
+    std::cout << "Documents: " << opts.herds << " herds ("
+        << docs.herds.bytes << " bytes), " << opts.developers
+        << " developers (" << docs.userinfo.bytes << " bytes), "
+        << docs.metadata.size() << " metadata.xml (" << metadata_bytes
+        << " bytes), " << docs.projects.size() << " projectxml" << std::endl;
+
+    herdstat::xml::GlobalInit();
+
+    run("portage::HerdsXML", docs.herds.bytes, docs.herds.elements,
+        ParseHerds(docs.herds));
+    run("portage::UserinfoXML", docs.userinfo.bytes, docs.userinfo.elements,
+        ParseUserinfo(docs.userinfo, false));
+    /* the first (untimed) run builds the index; the rest load it */
+    run("portage::UserinfoXML (lazy)", docs.userinfo.bytes,
+        docs.userinfo.elements, ParseUserinfo(docs.userinfo, true));
+    run("portage::DevawayXML", docs.devaway.bytes, docs.devaway.elements,
+        ParseDevaway(docs.devaway));
+    run("portage::MetadataXML (all)", metadata_bytes, metadata_elements,
+        ParseMetadata(docs.metadata));
+
+    herdstat::portage::HerdsXML herds;
+    herds.set_cvsdir(cvsdir);
+    herds.parse(docs.herds.path);
+    const herdstat::portage::UserinfoXML userinfo(docs.userinfo.path);
+    const herdstat::portage::UserinfoXML lazy(docs.userinfo.path, true);
+    const herdstat::portage::DevawayXML devaway(docs.devaway.path);
+
+    benchmark("HerdsXML::fill_developer() x10", 100,
+        FillDeveloper<herdstat::portage::HerdsXML>(herds, docs.developers));
+    benchmark("UserinfoXML::fill_developer() x10", 1000,
+        FillDeveloper<herdstat::portage::UserinfoXML>(userinfo,
+            docs.developers));
+    benchmark("UserinfoXML::fill_developer() (lazy) x10", 1000,
+        FillDeveloper<herdstat::portage::UserinfoXML>(lazy, docs.developers));
+    benchmark("DevawayXML::fill_developer() x10", 1000,
+        FillDeveloper<herdstat::portage::DevawayXML>(devaway,
+            docs.developers));
+
+    footprint("portage::HerdsXML", herds);
+    footprint("portage::UserinfoXML", userinfo);
+    /* includes every developer loaded by the benchmark above */
+    footprint("portage::UserinfoXML (lazy)", lazy);
+    footprint("portage::DevawayXML", devaway);
+
+    remove_tree(tmp);
+    return benchmark_status();
+}
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -34,6 +34,15 @@ class MetadataList : public herdstat::Cachable,
 		const std::string _portdir;
 };
 
+/* appends each path it's given to a MetadataList */
+struct Appender
+{
+	Appender(MetadataList& list) : _list(list) { }
+	void operator()(const std::string& path) { _list.push_back(path); }
+
+	MetadataList& _list;
+};
+
 MetadataList::MetadataList(const std::string& path,
 			   const std::string& portdir)
 	: herdstat::Cachable(path), _portdir(portdir)
@@ -56,12 +65,11 @@ MetadataList::valid() const
 void
 MetadataList::fill()
 {
+	/* add matches as they're found; dump() sorts them */
 	herdstat::util::Glob glob;
-	glob(_portdir+"/*/metadata.xml");
-	glob(_portdir+"/*/*/metadata.xml");
-	this->insert(this->end(),
-		glob.results().begin(),
-		glob.results().end());
+	glob.set_threads(4);
+	glob.for_each(_portdir+"/*/metadata.xml", Appender(*this));
+	glob.for_each(_portdir+"/*/*/metadata.xml", Appender(*this));
 }
 
 void
@@ -53,6 +53,13 @@ EmailAddress::~EmailAddress() throw()
 {
 }
 /****************************************************************************/
+util::MemoryUsage
+EmailAddress::memory_usage() const
+{
+    return (util::memory_usage(_email) + util::memory_usage(_user) +
+            util::memory_usage(_domain));
+}
+/****************************************************************************/
 bool
 EmailAddress::parse(const std::string& email)
 {
@@ -33,6 +33,7 @@
  */
 
 #include <string>
+#include <herdstat/util/memory.hh>
 
 namespace herdstat {
 
@@ -102,6 +103,9 @@ namespace herdstat {
             /// Set domain.
             void set_domain(const std::string& domain);
 
+            /// Get heap bytes held by this email address.
+            util::MemoryUsage memory_usage() const;
+
         protected:
             virtual bool parse(const std::string& email);
 
@@ -27,27 +27,194 @@
 #include <string>
 #include <cerrno>
 #include <cstdarg>
+#include <cstdio>
+#include <vector>
 #include <herdstat/exceptions.hh>
 
+#if LIBHERDSTAT_BACKTRACE
+namespace {
+    /* innermost context of each thread */
+    __thread const herdstat::BacktraceContext *backtrace_head = NULL;
+}
+#endif
+
 namespace herdstat {
 /****************************************************************************/
+#if LIBHERDSTAT_BACKTRACE
+void
+BacktraceContext::push() throw()
+{
+    _prev = backtrace_head;
+    backtrace_head = this;
+}
+/****************************************************************************/
+void
+BacktraceContext::pop() throw()
+{
+    backtrace_head = _prev;
+}
+#endif
+/****************************************************************************/
+void
+BacktraceContext::change_context(const std::string& context)
+{
+    _owned.assign(context);
+    _fmt = NULL;
+    _nargs = 0;
+}
+/****************************************************************************/
+std::string
+BacktraceContext::str() const
+{
+    if (not _fmt)
+        return _owned;
+
+    std::string s;
+    int n = 0;
+    for (const char *p = _fmt ; *p ; ++p)
+    {
+        if (*p == '%' and p[1] == 's' and n < _nargs)
+        {
+            _render[n](s, _args[n]);
+            ++n; ++p;
+        }
+        else if (*p == '%' and p[1] == '%')
+        {
+            s.push_back('%');
+            ++p;
+        }
+        else
+            s.push_back(*p);
+    }
+
+    return s;
+}
+/****************************************************************************/
+std::list<std::string>
+BacktraceContext::backtrace()
+{
+    std::list<std::string> contexts;
+#if LIBHERDSTAT_BACKTRACE
+    for (const BacktraceContext *c = backtrace_head ; c ; c = c->_prev)
+        contexts.push_front(c->str());
+#endif
+    return contexts;
+}
+/****************************************************************************/
+void
+BacktraceContext::render(std::string& s, const std::string& v)
+{
+    s.append(v);
+}
+/****************************************************************************/
+void
+BacktraceContext::render(std::string& s, const char *v)
+{
+    s.append(v ? v : "(null)");
+}
+/****************************************************************************/
+void
+BacktraceContext::render(std::string& s, char v)
+{
+    s.push_back(v);
+}
+/****************************************************************************/
+void
+BacktraceContext::render(std::string& s, int v)
+{
+    render(s, static_cast<long>(v));
+}
+/****************************************************************************/
+void
+BacktraceContext::render(std::string& s, unsigned int v)
+{
+    render(s, static_cast<unsigned long>(v));
+}
+/****************************************************************************/
+void
+BacktraceContext::render(std::string& s, long v)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%ld", v);
+    s.append(buf);
+}
+/****************************************************************************/
+void
+BacktraceContext::render(std::string& s, unsigned long v)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%lu", v);
+    s.append(buf);
+}
+/****************************************************************************/
 BaseException::BaseException() throw()
     : std::exception(),
-      libebt::Backtraceable<ExceptionTag>()
+      libebt::Backtraceable<ExceptionTag>(),
+      _backtrace()
+{
+    try
+    {
+        _backtrace = BacktraceContext::backtrace();
+    }
+    catch (...)
+    {
+        /* out of memory; go without */
+    }
+}
+/****************************************************************************/
+BaseException::BaseException(const BaseException& that) throw()
+    : std::exception(that),
+      libebt::Backtraceable<ExceptionTag>(that),
+      _backtrace()
 {
+    *this = that;
 }
 /****************************************************************************/
 BaseException::~BaseException() throw()
 {
 }
 /****************************************************************************/
+BaseException&
+BaseException::operator= (const BaseException& that) throw()
+{
+    try
+    {
+        _backtrace = that._backtrace;
+    }
+    catch (...)
+    {
+        _backtrace.clear();
+    }
+
+    return *this;
+}
+/****************************************************************************/
+std::string
+BaseException::backtrace(const std::string& delim) const
+{
+    std::string s(libebt::Backtraceable<ExceptionTag>::backtrace(delim));
+
+    std::list<std::string>::const_iterator i;
+    for (i = _backtrace.begin() ; i != _backtrace.end() ; ++i)
+        s.append(*i + delim);
+
+    return s;
+}
+/****************************************************************************/
+bool
+BaseException::empty() const
+{
+    return (_backtrace.empty() and
+            libebt::Backtraceable<ExceptionTag>::empty());
+}
+/****************************************************************************/
 Exception::Exception() throw()
     : BaseException(), _buf(NULL)
 {
 }
 /****************************************************************************/
 Exception::Exception(const Exception& that) throw()
-    : BaseException(), _buf(NULL)
+    : BaseException(that), _buf(NULL)
 {
     *this = that;
 }
@@ -96,6 +263,8 @@ Exception::operator= (const Exception& that) throw()
     if (that._buf)
         _buf = strdup(that._buf);
 
+    BaseException::operator=(that);
+
     std::memcpy(&_v, &that._v, sizeof(va_list));
     return *this;
 }
@@ -107,17 +276,17 @@ Exception::what() const throw()
 }
 /****************************************************************************/
 ErrnoException::ErrnoException() throw()
-    : Exception(), _code(errno)
+    : Exception(), _code(errno), _what()
 {
 }
 /****************************************************************************/
 ErrnoException::ErrnoException(const char *msg) throw()
-    : Exception(msg), _code(errno)
+    : Exception(msg), _code(errno), _what()
 {
 }
 /****************************************************************************/
 ErrnoException::ErrnoException(const std::string& msg) throw()
-    : Exception(msg), _code(errno)
+    : Exception(msg), _code(errno), _what()
 {
 }
 /****************************************************************************/
@@ -138,11 +307,13 @@ ErrnoException::what() const throw()
         return "No error message.";
 
     if (s.empty())
-        return e.c_str();
-    if (e.empty())
-        return s.c_str();
+        _what.assign(e);
+    else if (e.empty())
+        _what.assign(s);
+    else
+        _what.assign(s + ": " + e);
 
-    return (s + ": " + e).c_str();
+    return _what.c_str();
 }
 /****************************************************************************/
 FileException::FileException() throw()
@@ -184,17 +355,23 @@ BadCast::~BadCast() throw()
 }
 /****************************************************************************/
 BadRegex::BadRegex() throw()
-    : Exception(), _err(0), _re(NULL)
+    : Exception(), _err(0), _what()
 {
 }
 /****************************************************************************/
 BadRegex::BadRegex(int e, const regex_t *re) throw()
-    : Exception(), _err(e), _re(re)
+    : Exception(), _err(e), _what()
 {
+    if (_err != 0)
+    {
+        std::vector<char> buf(regerror(_err, re, NULL, 0));
+        regerror(_err, re, &buf[0], buf.size());
+        _what.assign(&buf[0]);
+    }
 }
 /****************************************************************************/
 BadRegex::BadRegex(const std::string& msg) throw()
-    : Exception(msg), _err(0), _re(NULL)
+    : Exception(msg), _err(0), _what()
 {
 }
 /****************************************************************************/
@@ -205,20 +382,10 @@ BadRegex::~BadRegex() throw()
 const char *
 BadRegex::what() const throw()
 {
-    if (not this->message() and (not _re or (_err == 0)))
-        return "";
-
     if (this->message())
-    {
-        std::size_t len(regerror(_err, _re, NULL, 0));
-        char *buf = new char(len);
-        regerror(_err, _re, buf, len);
-        std::string s(buf);
-        delete buf;
-        return s.c_str();
-    }
-             
-    return "";
+        return this->message();
+
+    return _what.c_str();
 }
 /****************************************************************************/
 BadDate::BadDate() throw()
@@ -34,9 +34,12 @@
 
 #include <exception>
 #include <stdexcept>
+#include <string>
+#include <list>
 #include <sys/types.h>
 #include <regex.h>
 #include <libebt/libebt.hh>
+#include <herdstat/defs.hh>
 
 namespace herdstat {
 
@@ -44,26 +47,181 @@ namespace herdstat {
     class ExceptionTag { };
 
     /**
-     * @typedef BacktraceContext
-     * @brief convenience typedef for backtrace contexts provided by libebt.
+     * @class BacktraceContext exceptions.hh herdstat/exceptions.hh
+     * @brief Scoped backtrace context.
+     *
+     * Unlike libebt's contexts, the text isn't built up front.  The
+     * constructor takes a static format (where each "%s" is replaced by
+     * the next argument) plus up to three arguments, captured by
+     * reference; the text is only rendered if a BaseException is
+     * constructed while the context is in scope.  Constructing one is
+     * therefore a handful of pointer stores and no allocation.  The
+     * arguments must outlive the context, so don't pass temporaries.
+     *
+     * Contexts are kept per thread.  Configuring with --disable-backtrace
+     * compiles them out entirely.
+     *
+     * @section example Example
+     *
+@code
+void
+Foo::open(const std::string& path)
+{
+    herdstat::BacktraceContext c("Foo::open(%s)", path);
+    ...
+}
+@endcode
      */
 
-    typedef libebt::BacktraceContext<ExceptionTag> BacktraceContext;
+    class BacktraceContext
+    {
+        public:
+            /** Constructor.
+             * @param context Static context string (not copied).
+             */
+            explicit BacktraceContext(const char *context) throw()
+                : _fmt(context), _nargs(0), _owned(), _prev(NULL)
+            { this->push(); }
+
+            /** Constructor.
+             * @param context Context string (copied).
+             */
+            explicit BacktraceContext(const std::string& context)
+                : _fmt(NULL), _nargs(0), _owned(context), _prev(NULL)
+            { this->push(); }
+
+            //@{
+            /** Constructor.
+             * @param fmt Static format string.
+             * @param a1 First argument.
+             * @param a2 Second argument.
+             * @param a3 Third argument.
+             */
+            template <typename T1>
+            BacktraceContext(const char *fmt, const T1& a1) throw()
+                : _fmt(fmt), _nargs(1), _owned(), _prev(NULL)
+            {
+                this->capture(0, a1);
+                this->push();
+            }
+
+            template <typename T1, typename T2>
+            BacktraceContext(const char *fmt, const T1& a1,
+                             const T2& a2) throw()
+                : _fmt(fmt), _nargs(2), _owned(), _prev(NULL)
+            {
+                this->capture(0, a1);
+                this->capture(1, a2);
+                this->push();
+            }
+
+            template <typename T1, typename T2, typename T3>
+            BacktraceContext(const char *fmt, const T1& a1,
+                             const T2& a2, const T3& a3) throw()
+                : _fmt(fmt), _nargs(3), _owned(), _prev(NULL)
+            {
+                this->capture(0, a1);
+                this->capture(1, a2);
+                this->capture(2, a3);
+                this->push();
+            }
+            //@}
+
+            /// Destructor.
+            ~BacktraceContext() throw() { this->pop(); }
+
+            /** Replace this context's text.
+             * @param context New context string (copied).
+             */
+            void change_context(const std::string& context);
+
+            /** Render the calling thread's contexts.
+             * @returns List of contexts, outermost first.
+             */
+            static std::list<std::string> backtrace();
+
+        private:
+            typedef void (*render_type)(std::string&, const void *);
+            enum { max_args = 3 };
+
+            /* overloads used to render the captured arguments */
+            static void render(std::string& s, const std::string& v);
+            static void render(std::string& s, const char *v);
+            static void render(std::string& s, char v);
+            static void render(std::string& s, int v);
+            static void render(std::string& s, unsigned int v);
+            static void render(std::string& s, long v);
+            static void render(std::string& s, unsigned long v);
+
+            template <typename T>
+            static void render_arg(std::string& s, const void *v)
+            { render(s, *static_cast<const T *>(v)); }
+
+            template <typename T>
+            void capture(int n, const T& v) throw()
+            {
+                _args[n] = &v;
+                _render[n] = &BacktraceContext::render_arg<T>;
+            }
+
+            /// Render this context.
+            std::string str() const;
+
+#if LIBHERDSTAT_BACKTRACE
+            void push() throw();
+            void pop() throw();
+#else
+            void push() throw() { }
+            void pop() throw() { }
+#endif
+
+            /* not copyable; contexts live on the stack */
+            BacktraceContext(const BacktraceContext&);
+            BacktraceContext& operator= (const BacktraceContext&);
+
+            const char *_fmt;
+            int _nargs;
+            const void *_args[max_args];
+            render_type _render[max_args];
+            std::string _owned;
+            const BacktraceContext *_prev;
+    };
 
     /**
      * @class BaseException exceptions.hh herdstat/exceptions.hh
      * @brief Base exception class.  All exception classes defined by libherdstat
      * derive from this class.
+     *
+     * The BacktraceContext's in scope are rendered when the exception is
+     * constructed (ie. at the throw site), so they survive unwinding.
      */
 
     class BaseException : public std::exception,
                           public libebt::Backtraceable<ExceptionTag>
     {
+        public:
+            /** Get backtrace.
+             * @param delim String appended to each context.
+             * @returns libebt contexts followed by our own.
+             */
+            std::string backtrace(const std::string& delim = "\n") const;
+
+            /// Is the backtrace empty?
+            bool empty() const;
+
         protected:
             /// Default constructor.
             BaseException() throw();
+            /// Copy constructor.
+            BaseException(const BaseException& that) throw();
             /// Destructor.
             virtual ~BaseException() throw();
+
+            /// Copy assignment operator.
+            BaseException& operator= (const BaseException& that) throw();
+
+        private:
+            std::list<std::string> _backtrace;
     };
 
     /**
@@ -142,6 +300,8 @@ namespace herdstat {
 
         private:
             int _code;
+            /// storage for the string returned by what().
+            mutable std::string _what;
     };
     
     /**
@@ -220,7 +380,9 @@ namespace herdstat {
 
         private:
             int _err;
-            const regex_t *_re;
+            /// regerror() message; formatted up front since the regex_t
+            /// may be gone by the time what() is called.
+            std::string _what;
     };
 
     /**
@@ -48,7 +48,7 @@ CurlFetcher::~CurlFetcher() throw()
 bool
 CurlFetcher::fetch(const std::string& url, const std::string& path) const
 {
-    BacktraceContext c("CurlFetcher::fetch("+url+", "+path+")");
+    BacktraceContext c("CurlFetcher::fetch(%s, %s)", url, path);
 
 #ifdef HAVE_LIBCURL
     FILE *fp = NULL;
@@ -29,6 +29,8 @@
 
 #include <herdstat/util/string.hh>
 #include <herdstat/util/functional.hh>
+#include <herdstat/util/profile.hh>
+#include <herdstat/probes.hh>
 #include <herdstat/fetcher/fetcherimp.hh>
 #include <herdstat/fetcher/fetcher.hh>
 
@@ -70,7 +72,9 @@ Fetcher::~Fetcher() throw()
 void
 Fetcher::operator()(const std::string& url, const std::string& path) const
 {
-    BacktraceContext c("herdstat::Fetcher::operator()("+url+", "+path+")");
+    BacktraceContext c("herdstat::Fetcher::operator()(%s, %s)", url, path);
+    util::ProfileZone zone("Fetcher::operator()()");
+    LIBHERDSTAT_PROBE2(fetch__entry, url.c_str(), path.c_str());
     assert(not _opts.implementation().empty());
 
     const FetcherImp * const imp = _impmap[_opts.implementation()];
@@ -83,14 +87,19 @@ Fetcher::operator()(const std::string& url, const std::string& path) const
 #endif
 
     /* make sure we have write access to the directory */
-    const char * const dir = util::dirname(path).c_str();
-    if (access(dir, W_OK) != 0)
+    const std::string dir(util::dirname(path));
+    if (access(dir.c_str(), W_OK) != 0)
         throw FileException(dir);
 
     if (_opts.verbose())
         std::cerr << "Fetching " << url << std::endl;
 
-    if (not imp->fetch(url, path))
+    const bool fetched = imp->fetch(url, path);
+    if (LIBHERDSTAT_PROBE_ENABLED(fetch__return))
+        LIBHERDSTAT_PROBE3(fetch__return, url.c_str(), path.c_str(),
+            (fetched ? probes::file_size(path) : -1L));
+
+    if (not fetched)
         throw FetchException();
 }
 /****************************************************************************/
@@ -43,7 +43,7 @@ WgetFetcher::~WgetFetcher() throw()
 bool
 WgetFetcher::fetch(const std::string& url, const std::string& path) const
 {
-    BacktraceContext c("WgetFetcher::fetch("+url+", "+path+")");
+    BacktraceContext c("WgetFetcher::fetch(%s, %s)", url, path);
 
     std::string opts("-r -t3 -T15");
     opts += (options().verbose() ? " -v" : " -q");
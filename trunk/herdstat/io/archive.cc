@@ -0,0 +1,240 @@
+/*
+ * libherdstat -- herdstat/io/archive.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <herdstat/io/archive.hh>
+
+#define ARCHIVE_MAGIC       "HSAR"
+#define ARCHIVE_MAGIC_LEN   4
+#define ARCHIVE_FORMAT      1
+
+namespace {
+    unsigned long crc_table[256];
+    pthread_once_t crc_table_once = PTHREAD_ONCE_INIT;
+
+    void
+    init_crc_table()
+    {
+        for (unsigned long n = 0 ; n < 256 ; ++n)
+        {
+            unsigned long c = n;
+            for (int k = 0 ; k < 8 ; ++k)
+                c = (c & 1) ? (0xedb88320UL ^ (c >> 1)) : (c >> 1);
+            crc_table[n] = c;
+        }
+    }
+
+    /* 4 bytes, little endian */
+    void
+    write_u32(herdstat::io::BinaryOStream& s, unsigned long v)
+    {
+        const unsigned char buf[4] = {
+            static_cast<unsigned char>(v),
+            static_cast<unsigned char>(v >> 8),
+            static_cast<unsigned char>(v >> 16),
+            static_cast<unsigned char>(v >> 24)
+        };
+        s.write_raw(buf, sizeof(buf));
+    }
+
+    bool
+    read_u32(herdstat::io::BinaryIStream& s, unsigned long& v)
+    {
+        unsigned char buf[4];
+        if (not s.read_raw(buf, sizeof(buf)))
+            return false;
+
+        v = buf[0] | (buf[1] << 8) | (buf[2] << 16) |
+            (static_cast<unsigned long>(buf[3]) << 24);
+        return true;
+    }
+}
+
+namespace herdstat {
+namespace io {
+/****************************************************************************/
+unsigned long
+crc32(const void *data, std::size_t len, unsigned long crc)
+{
+    pthread_once(&crc_table_once, init_crc_table);
+
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    crc = crc ^ 0xffffffffUL;
+    while (len-- > 0)
+        crc = crc_table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    return (crc ^ 0xffffffffUL);
+}
+/****************************************************************************/
+OArchive::OArchive(const std::string& path, const std::string& tag,
+                   unsigned version)
+    : BinaryOStream(), _tag(tag), _version(version), _tmp()
+{
+    this->set_unbounded(true);
+
+    /* never truncate the archive in place; someone may have it mapped */
+    const std::string tmpl(path + ".XXXXXX");
+    std::vector<char> buf(tmpl.begin(), tmpl.end());
+    buf.push_back('\0');
+
+    const int fd = mkstemp(&buf[0]);
+    if (fd != -1)
+    {
+        /* mkstemp() creates it 0600 */
+        fchmod(fd, 0644);
+        this->open(fd);
+        if (*this)
+            _tmp.assign(&buf[0]);
+        else
+            unlink(&buf[0]);
+    }
+
+    this->set_path(path);
+}
+/****************************************************************************/
+OArchive::~OArchive() throw()
+{
+    /* write while we're still an OArchive */
+    this->close();
+}
+/****************************************************************************/
+void
+OArchive::close()
+{
+    BinaryOStream::close();
+
+    if (_tmp.empty())
+        return;
+
+    if (this->bad() or std::rename(_tmp.c_str(), this->path().c_str()) != 0)
+    {
+        unlink(_tmp.c_str());
+        this->set_bad();
+    }
+
+    _tmp.clear();
+}
+/****************************************************************************/
+void
+OArchive::do_close()
+{
+    /* swap out the payload so the header can go through the buffer */
+    std::vector<char> payload(this->buffered());
+    this->discard();
+
+    const unsigned long crc =
+        (payload.empty() ? 0 : crc32(&payload[0], payload.size()));
+
+    this->write_raw(ARCHIVE_MAGIC, ARCHIVE_MAGIC_LEN);
+    this->write_varint(ARCHIVE_FORMAT);
+    *this << _tag << _version;
+    this->write_varint(payload.size());
+    write_u32(*this, crc);
+    this->flush();
+
+    if (not payload.empty() and this->stream() and
+        std::fwrite(&payload[0], 1, payload.size(), this->stream()) !=
+            payload.size())
+        this->set_bad();
+}
+/****************************************************************************/
+IArchive::IArchive(const std::string& path, const std::string& tag,
+                   unsigned version, bool mapped)
+    : BinaryIStream(path, mapped), _error()
+{
+    if (not this->verify(tag, version))
+        this->set_bad();
+}
+/****************************************************************************/
+IArchive::~IArchive() throw()
+{
+}
+/****************************************************************************/
+bool
+IArchive::verify(const std::string& tag, unsigned version)
+{
+    if (not *this)
+    {
+        _error.assign("unable to open");
+        return false;
+    }
+
+    char magic[ARCHIVE_MAGIC_LEN];
+    varint_type format;
+    if (not this->read_raw(magic, sizeof(magic)) or
+        std::memcmp(magic, ARCHIVE_MAGIC, ARCHIVE_MAGIC_LEN) != 0 or
+        not this->read_varint(format))
+    {
+        _error.assign("not an archive");
+        return false;
+    }
+
+    if (format != ARCHIVE_FORMAT)
+    {
+        _error.assign("unsupported archive format");
+        return false;
+    }
+
+    std::string t;
+    unsigned v = 0;
+    *this >> t >> v;
+    if (not *this or t != tag or v != version)
+    {
+        _error.assign("unexpected tag or version");
+        return false;
+    }
+
+    /* don't trust the length until we've checked it against the file */
+    varint_type len;
+    unsigned long crc;
+    struct stat st;
+    if (not this->read_varint(len) or not read_u32(*this, crc) or
+        fstat(fileno(this->stream()), &st) != 0 or
+        len > static_cast<varint_type>(st.st_size) or
+        not this->load(static_cast<size_type>(len)))
+    {
+        _error.assign("truncated");
+        return false;
+    }
+
+    if (crc32(this->buffered(), this->available()) != crc)
+    {
+        _error.assign("checksum mismatch");
+        return false;
+    }
+
+    return true;
+}
+/****************************************************************************/
+} // namespace io
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,155 @@
+/*
+ * libherdstat -- herdstat/io/archive.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_IO_ARCHIVE_HH
+#define _HAVE_IO_ARCHIVE_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/io/archive.hh
+ * @brief Defines the IArchive and OArchive classes.
+ */
+
+#include <string>
+#include <herdstat/io/binary_stream.hh>
+
+namespace herdstat {
+namespace io {
+
+    /**
+     * @class OArchive archive.hh herdstat/io/archive.hh
+     * @brief BinaryOStream that writes a self-checking archive.
+     *
+     * An archive consists of a header followed by the payload (whatever
+     * was written to the stream).  The header holds:
+     *
+     * - the magic bytes "HSAR" and the archive format version,
+     * - a tag and version describing the payload (eg "userinfo.xml index"
+     *   and 2), so readers can reject anything they don't understand,
+     * - the payload's length and CRC-32.
+     *
+     * The payload is kept in memory until the archive is closed, since
+     * the header has to be written first.  It's written to a temporary
+     * file alongside the archive, which is renamed over it on a successful
+     * close (and removed otherwise), so readers (mapped ones included)
+     * only ever see a complete archive.
+     *
+     * @section example Example
+     *
+@code
+{
+    herdstat::io::OArchive ar("foo.cache", "foo cache", 1);
+    ar << foos.size() << some_string;
+}
+
+herdstat::io::IArchive ar("foo.cache", "foo cache", 1);
+if (not ar)
+    ... // missing, corrupt, or a different version; rebuild it
+ar >> size >> some_string;
+@endcode
+     */
+
+    class OArchive : public BinaryOStream
+    {
+        public:
+            /** Constructor.  Opens a temporary file next to @a path.
+             * @param path Path of file.
+             * @param tag Tag describing the payload.
+             * @param version Payload version.
+             */
+            OArchive(const std::string& path, const std::string& tag,
+                     unsigned version);
+
+            /// Destructor.  Writes the archive if not already closed.
+            virtual ~OArchive() throw();
+
+            /** Write the archive and move it into place.  If anything
+             * went wrong, the stream is bad and the file at path() is left
+             * alone.
+             */
+            void close();
+
+        protected:
+            /// Write header and payload.
+            virtual void do_close();
+
+        private:
+            const std::string _tag;
+            const unsigned _version;
+            std::string _tmp;
+    };
+
+    /**
+     * @class IArchive archive.hh herdstat/io/archive.hh
+     * @brief BinaryIStream that reads an archive written by OArchive.
+     *
+     * The header is checked and the whole payload verified on
+     * construction.  If anything's amiss (the file doesn't exist, isn't an
+     * archive, has a different tag or version, or is corrupt) the stream
+     * is bad; see error() for why.
+     */
+
+    class IArchive : public BinaryIStream
+    {
+        public:
+            /** Constructor.  Opens the file and verifies it.
+             * @param path Path of file.
+             * @param tag Expected payload tag.
+             * @param version Expected payload version.
+             * @param mapped Whether to memory map the file rather than
+             * reading the payload into memory (see BinaryIStream).
+             */
+            IArchive(const std::string& path, const std::string& tag,
+                     unsigned version, bool mapped = false);
+
+            /// Destructor.
+            virtual ~IArchive() throw();
+
+            /// Get the reason the archive was rejected (empty if it wasn't).
+            const std::string& error() const { return _error; }
+
+        private:
+            bool verify(const std::string& tag, unsigned version);
+
+            std::string _error;
+    };
+
+    /**
+     * Compute a CRC-32 (as used by zlib, PNG, etc).
+     * @param data Data.
+     * @param len Length of data.
+     * @param crc CRC of preceding data, if computing it piecewise.
+     * @returns CRC-32.
+     */
+
+    unsigned long crc32(const void *data, std::size_t len,
+                        unsigned long crc = 0);
+
+} // namespace io
+} // namespace herdstat
+
+#endif /* _HAVE_IO_ARCHIVE_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -25,18 +25,37 @@
 #endif
 
 #include <cassert>
+#include <algorithm>
+#include <unistd.h>
 #include <herdstat/io/binary_stream.hh>
 
+namespace {
+    /* floating point values are stored little endian */
+    template <typename T>
+    inline void
+    to_little_endian(T& v)
+    {
+#ifdef WORDS_BIGENDIAN
+        char *p = reinterpret_cast<char *>(&v);
+        std::reverse(p, p + sizeof(T));
+#else
+        (void)v;
+#endif
+    }
+}
+
 namespace herdstat {
 namespace io {
+/*** static members *********************************************************/
+const BinaryStream::size_type BinaryStream::default_bufsize;
 /****************************************************************************/
 BinaryStream::BinaryStream()
-    : _path(), _stream(NULL), _open(false)
+    : _path(), _stream(NULL), _open(false), _bad(false)
 {
 }
 /****************************************************************************/
 BinaryStream::BinaryStream(const std::string& path)
-    : _path(path), _stream(NULL), _open(false)
+    : _path(path), _stream(NULL), _open(false), _bad(false)
 {
 }
 /****************************************************************************/
@@ -53,6 +72,7 @@ BinaryStream::open()
 	return;
 
     _stream = std::fopen(_path.c_str(), this->mode());
+    _bad = false;
 
     _open = true;
 }
@@ -69,29 +89,66 @@ BinaryStream::open(const std::string& path)
 }
 /****************************************************************************/
 void
+BinaryStream::open(int fd)
+{
+    if (_open)
+	return;
+
+    _path.clear();
+    _stream = ::fdopen(fd, this->mode());
+    if (not _stream)
+        ::close(fd);
+    _bad = false;
+
+    _open = true;
+}
+/****************************************************************************/
+void
 BinaryStream::close()
 {
     if (not _open)
 	return;
 
-    assert(_stream != NULL);
-    std::fclose(_stream);
-    _stream = NULL;
+    if (_stream)
+    {
+        this->do_close();
+        if (std::fclose(_stream) != 0)
+            _bad = true;
+        _stream = NULL;
+    }
 
     _open = false;
 }
 /****************************************************************************/
 BinaryIStream::BinaryIStream()
-    : BinaryStream()
+    : BinaryStream(), _buf(default_bufsize), _map(), _data(&_buf[0]),
+      _pos(0), _end(0), _loaded(false)
 {
 }
 /****************************************************************************/
 BinaryIStream::BinaryIStream(const std::string& path)
-    : BinaryStream(path)
+    : BinaryStream(path), _buf(default_bufsize), _map(), _data(&_buf[0]),
+      _pos(0), _end(0), _loaded(false)
 {
     this->open();
 }
 /****************************************************************************/
+BinaryIStream::BinaryIStream(const std::string& path, bool mapped)
+    : BinaryStream(path), _buf(), _map(), _data(NULL), _pos(0), _end(0),
+      _loaded(false)
+{
+    this->open();
+
+    if (mapped)
+        this->map();
+
+    if (not this->mapped())
+    {
+        _buf.resize(default_bufsize);
+        _data = &_buf[0];
+    }
+}
+/****************************************************************************/
 BinaryIStream::~BinaryIStream() throw()
 {
 }
@@ -102,19 +159,166 @@ BinaryIStream::mode() const
     return "rb";
 }
 /****************************************************************************/
+void
+BinaryIStream::map()
+{
+    if (not this->stream() or not _map.map(fileno(this->stream())))
+        return;
+
+    _map.advise_sequential();
+    _data = _map.data();
+    _pos = 0;
+    _end = _map.size();
+    _loaded = true;
+}
+/****************************************************************************/
+void
+BinaryIStream::do_close()
+{
+    _map.close();
+    _pos = _end = 0;
+    _loaded = false;
+
+    if (_buf.empty())
+        _buf.resize(default_bufsize);
+    _data = &_buf[0];
+}
+/****************************************************************************/
+bool
+BinaryIStream::fill()
+{
+    if (_loaded or not this->stream())
+        return false;
+
+    _pos = 0;
+    _end = std::fread(&_buf[0], 1, _buf.size(), this->stream());
+    return (_end > 0);
+}
+/****************************************************************************/
+bool
+BinaryIStream::read_slow(void *buf, size_type len)
+{
+    char *p = static_cast<char *>(buf);
+
+    while (len > 0)
+    {
+        if (_pos == _end and not this->fill())
+        {
+            this->set_bad();
+            return false;
+        }
+
+        const size_type n = std::min(len, _end - _pos);
+        std::memcpy(p, _data + _pos, n);
+        _pos += n;
+        p += n;
+        len -= n;
+    }
+
+    return true;
+}
+/****************************************************************************/
+bool
+BinaryIStream::read_raw(std::string& str, size_type len)
+{
+    /* common case; straight out of the buffer */
+    if (len <= (_end - _pos))
+    {
+        str.assign(_data + _pos, len);
+        _pos += len;
+        return true;
+    }
+
+    str.clear();
+
+    while (len > 0)
+    {
+        if (_pos == _end and not this->fill())
+        {
+            this->set_bad();
+            return false;
+        }
+
+        const size_type n = std::min(len, _end - _pos);
+        str.append(_data + _pos, n);
+        _pos += n;
+        len -= n;
+    }
+
+    return true;
+}
+/****************************************************************************/
+bool
+BinaryIStream::read_varint(varint_type& v)
+{
+    v = 0;
+
+    for (unsigned shift = 0 ; shift < 64 ; shift += 7)
+    {
+        unsigned char c;
+        if (_pos < _end)
+            c = _data[_pos++];
+        else if (not this->read_raw(&c, 1))
+            return false;
+
+        v |= static_cast<varint_type>(c & 0x7f) << shift;
+        if (not (c & 0x80))
+            return true;
+    }
+
+    /* more than 10 bytes; corrupt */
+    this->set_bad();
+    return false;
+}
+/****************************************************************************/
+bool
+BinaryIStream::load(size_type len)
+{
+    /* already in memory; just stop reading after len bytes */
+    if (this->mapped())
+    {
+        if (len > (_end - _pos))
+        {
+            this->set_bad();
+            return false;
+        }
+
+        _end = _pos + len;
+        return true;
+    }
+
+    std::vector<char> buf(len);
+    if (len > 0 and not this->read_raw(&buf[0], len))
+        return false;
+
+    if (buf.empty())
+        buf.resize(1);
+
+    _buf.swap(buf);
+    _data = &_buf[0];
+    _pos = 0;
+    _end = len;
+    _loaded = true;
+    return true;
+}
+/****************************************************************************/
 BinaryOStream::BinaryOStream()
-    : BinaryStream()
+    : BinaryStream(), _buf(), _unbounded(false)
 {
+    _buf.reserve(default_bufsize);
 }
 /****************************************************************************/
 BinaryOStream::BinaryOStream(const std::string& path)
-    : BinaryStream(path)
+    : BinaryStream(path), _buf(), _unbounded(false)
 {
+    _buf.reserve(default_bufsize);
     this->open();
 }
 /****************************************************************************/
 BinaryOStream::~BinaryOStream() throw()
 {
+    /* flush while we're still a BinaryOStream */
+    this->close();
 }
 /****************************************************************************/
 const char * const
@@ -123,6 +327,71 @@ BinaryOStream::mode() const
     return "wb";
 }
 /****************************************************************************/
+void
+BinaryOStream::write_varint(varint_type v)
+{
+    char buf[10];
+    size_type n = 0;
+
+    while (v >= 0x80)
+    {
+        buf[n++] = static_cast<char>((v & 0x7f) | 0x80);
+        v >>= 7;
+    }
+
+    buf[n++] = static_cast<char>(v);
+    this->write_raw(buf, n);
+}
+/****************************************************************************/
+void
+BinaryOStream::flush()
+{
+    if (_buf.empty())
+        return;
+
+    if (not this->stream() or
+        std::fwrite(&_buf[0], 1, _buf.size(), this->stream()) != _buf.size())
+        this->set_bad();
+
+    _buf.clear();
+}
+/****************************************************************************/
+void
+BinaryOStream::do_close()
+{
+    this->flush();
+}
+/****************************************************************************/
+void
+Serializer<float>::write(BinaryOStream& s, const float& v)
+{
+    float f(v);
+    to_little_endian(f);
+    s.write_raw(&f, sizeof(f));
+}
+/****************************************************************************/
+void
+Serializer<float>::read(BinaryIStream& s, float& v)
+{
+    if (s.read_raw(&v, sizeof(v)))
+        to_little_endian(v);
+}
+/****************************************************************************/
+void
+Serializer<double>::write(BinaryOStream& s, const double& v)
+{
+    double d(v);
+    to_little_endian(d);
+    s.write_raw(&d, sizeof(d));
+}
+/****************************************************************************/
+void
+Serializer<double>::read(BinaryIStream& s, double& v)
+{
+    if (s.read_raw(&v, sizeof(v)))
+        to_little_endian(v);
+}
+/****************************************************************************/
 } // namespace io
 } // namespace herdstat
 
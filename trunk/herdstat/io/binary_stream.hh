@@ -34,20 +34,88 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <utility>
+#include <iterator>
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
+#include <climits>
+#include <stdint.h>
+#include <herdstat/util/string.hh>
+#include <herdstat/io/mapped_file.hh>
 
 namespace herdstat {
 namespace io {
 
+    /**
+     * @typedef varint_type
+     * @brief Widest integer a varint holds.  C++98 has no long long, so
+     * we use the fixed-width types rather than warn under -pedantic
+     * everywhere this header is included.
+     */
+    typedef uint64_t varint_type;
+
+    /// Signed counterpart of varint_type.
+    typedef int64_t svarint_type;
+
+    class BinaryIStream;
+    class BinaryOStream;
+
+    /**
+     * @struct Serializer binary_stream.hh herdstat/io/binary_stream.hh
+     * @brief Defines how values of type T are written to a BinaryOStream and
+     * read from a BinaryIStream.
+     *
+     * Specializations are provided for the fundamental types (integers are
+     * stored as variable-length integers, so they're independent of size
+     * and byte order), std::string, util::StringView, std::pair and
+     * std::vector.  The
+     * unspecialized template stores the raw object representation and
+     * is only suitable for plain structs that never leave the host.
+     *
+     * To make your own type serializable, specialize Serializer for it:
+     *
+@code
+namespace herdstat { namespace io {
+    template <> struct Serializer<Foo>
+    {
+        static void write(BinaryOStream& s, const Foo& v)
+        { s << v.name() << v.size(); }
+        static void read(BinaryIStream& s, Foo& v)
+        { ... }
+    };
+} }
+@endcode
+     *
+     * See herdstat/portage/serialize.hh for the libherdstat types.
+     */
+
+    template <typename T>
+    struct Serializer
+    {
+        /// Write @a v to @a s.
+        static inline void write(BinaryOStream& s, const T& v);
+        /// Read @a v from @a s.
+        static inline void read(BinaryIStream& s, T& v);
+    };
+
     /**
      * @class BinaryStream binary_stream.hh herdstat/io/binary_stream.hh
      * @brief C++-like stream interface for C's fread/fwrite.
+     *
+     * Reads and writes go through an internal buffer, so they don't cost
+     * a stdio call each.
      */
 
     class BinaryStream
     {
 	public:
+            typedef std::size_t size_type;
+
+            /// Default buffer size.
+            static const size_type default_bufsize = 64 * 1024;
+
             /// Destructor.
 	    virtual ~BinaryStream() throw();
 
@@ -56,6 +124,14 @@ namespace io {
              */
 	    void open(const std::string& path);
 
+            /** Open stream on an already open file descriptor (eg a pipe or
+             * socket).  The stream takes it over; close() closes it.  Reads
+             * block until the requested amount of data or end-of-file
+             * arrives.
+             * @param fd File descriptor.
+             */
+	    void open(int fd);
+
             /// Close stream.
 	    void close();
 
@@ -66,18 +142,21 @@ namespace io {
 
             ///@{
             /** Check if stream's status is ok.  Allows the use of BinaryStream
-             * classes in boolean expressions.
+             * classes in boolean expressions.  A stream goes bad when a read
+             * comes up short (eg at EOF) or a write fails.
              */
             inline operator void*() const
             { return (operator!() ? NULL : const_cast<BinaryStream*>(this)); }
 
 	    inline bool operator!() const
-	    {
-		return ((_stream == NULL) or (std::ferror(_stream)) or
-		        (std::feof(_stream)));
-	    }
+	    { return ((_stream == NULL) or _bad); }
             ///@}
 
+            /** Has a read come up short or a write failed?  Unlike
+             * operator!(), this still works after close().
+             */
+            inline bool bad() const { return _bad; }
+
 	protected:
 	    template <typename T> friend class BinaryIStreamIterator;
 
@@ -92,6 +171,9 @@ namespace io {
             /// Open stream (path already set).
             void open();
 
+            /// Called by close() before the file is closed.
+            virtual void do_close() { }
+
             /// For derivatives to define their open mode.
 	    virtual const char * const mode() const = 0;
 
@@ -101,15 +183,36 @@ namespace io {
             /// Get underlying FILE pointer.
 	    inline FILE * const stream() const { return _stream; }
 
+            /// Mark stream as bad.
+            inline void set_bad() { _bad = true; }
+
 	private:
 	    std::string _path;
 	    FILE *_stream;
 	    bool _open;
+            bool _bad;
     };
 
     /**
      * @class BinaryIStream binary_stream.hh herdstat/io/binary_stream.hh
      * @brief BinaryStream opened for reading.
+     *
+     * A stream opened with @a mapped set reads straight out of a memory
+     * mapping of the file rather than through fread(); reads don't copy
+     * anything beyond the value itself, and strings can be read as
+     * util::StringView's pointing into the mapping.  If the file can't be
+     * mapped (eg it's a pipe) the stream quietly falls back to buffered
+     * reads.
+     *
+     * @section example Example
+     *
+@code
+herdstat::io::BinaryIStream stream("names.bin", true);
+std::vector<herdstat::util::StringView> names(
+    (herdstat::io::BinaryIStreamIterator<herdstat::util::StringView>(stream)),
+    herdstat::io::BinaryIStreamIterator<herdstat::util::StringView>());
+// names are valid until stream is closed
+@endcode
      */
 
     class BinaryIStream : public BinaryStream
@@ -123,14 +226,29 @@ namespace io {
              */
 	    BinaryIStream(const std::string& path);
 
+            /** Constructor.  Opens stream.
+             * @param path Path of file to open.
+             * @param mapped Whether to memory map the file.
+             */
+	    BinaryIStream(const std::string& path, bool mapped);
+
             /// Destructor.
 	    virtual ~BinaryIStream() throw();
 
+            /// Is the stream reading from a memory mapping?
+            inline bool mapped() const { return _map.is_open(); }
+
+            /** Is everything left to read held in memory?  True for mapped
+             * streams and once an IArchive has verified its payload.  Only
+             * then can read_view() be used.
+             */
+            inline bool contiguous() const { return _loaded; }
+
             /** Read value from stream.
              * @param v variable to save read value.
              */
             template <typename T>
-            inline void read(T& v);
+            inline void read(T& v) { Serializer<T>::read(*this, v); }
 
             /** Read value from stream.
              * @param v variable to save read value.
@@ -139,34 +257,92 @@ namespace io {
 	    template <typename T>
 	    inline BinaryIStream& operator>>(T& v);
 
+            /** Read raw bytes.
+             * @param buf Buffer to read into.
+             * @param len Number of bytes to read.
+             * @returns False (and the stream goes bad) if there weren't
+             * @a len bytes left.
+             */
+            inline bool read_raw(void *buf, size_type len);
+
+            /** Read raw bytes, replacing the contents of @a str.
+             * @param str String to read into.
+             * @param len Number of bytes to read.
+             * @returns False (and the stream goes bad) if there weren't
+             * @a len bytes left.
+             */
+            bool read_raw(std::string& str, size_type len);
+
+            /** Read raw bytes without copying them.  The view stays valid
+             * until the stream is closed.
+             * @param view View to point at the bytes.
+             * @param len Number of bytes to read.
+             * @returns False (and the stream goes bad) if there weren't
+             * @a len bytes left or the stream isn't contiguous().
+             */
+            inline bool read_view(util::StringView& view, size_type len);
+
+            /** Read a variable-length unsigned integer.
+             * @returns False (and the stream goes bad) if it's truncated
+             * or too long.
+             */
+            bool read_varint(varint_type& v);
+
 	protected:
             /// Open mode.
 	    virtual const char * const mode() const;
+
+            /// Unmaps the file.
+            virtual void do_close();
+
+            /** Replace buffered data with the next @a len bytes of the file;
+             * afterwards the stream will only read from those.
+             * @returns False (and the stream goes bad) if there weren't
+             * @a len bytes left.
+             */
+            bool load(size_type len);
+
+            /// Get buffered data that hasn't been read yet.
+            inline const char *buffered() const { return _data + _pos; }
+            /// Get number of bytes buffered that haven't been read yet.
+            inline size_type available() const { return (_end - _pos); }
+
+	private:
+            /// Refill buffer.  Returns false if nothing more can be read.
+            bool fill();
+            bool read_slow(void *buf, size_type len);
+            void map();
+
+            std::vector<char> _buf;
+            MappedFile _map;
+            const char *_data;
+            size_type _pos, _end;
+            bool _loaded;
     };
 
-    template <typename T>
-    inline void
-    BinaryIStream::read(T& v)
+    inline bool
+    BinaryIStream::read_raw(void *buf, size_type len)
     {
-        std::fread(static_cast<void *>(&v), sizeof(T), 1, this->stream());
+        if (len > (_end - _pos))
+            return this->read_slow(buf, len);
+
+        std::memcpy(buf, _data + _pos, len);
+        _pos += len;
+        return true;
     }
 
-    /// Partial specialization for std::string.
-    template <>
-    inline void
-    BinaryIStream::read<std::string>(std::string& str)
+    inline bool
+    BinaryIStream::read_view(util::StringView& view, size_type len)
     {
-	std::string::size_type len;
-        this->read(len);
-
-        if (not *this)
-            return;
-
-        char *buf = new char[len+1];
-        buf[len] = 0;
-        std::fread(static_cast<void*>(buf), sizeof(char), len, this->stream());
-	str.assign(buf);
-        delete[] buf;
+        if (not _loaded or len > (_end - _pos))
+        {
+            this->set_bad();
+            return false;
+        }
+
+        view = util::StringView(_data + _pos, len);
+        _pos += len;
+        return true;
     }
 
     template <typename T>
@@ -193,14 +369,14 @@ namespace io {
              */
 	    BinaryOStream(const std::string& path);
 
-            /// Destructor.
+            /// Destructor.  Flushes the stream.
 	    virtual ~BinaryOStream() throw();
 
             /** Write value to stream.
              * @param v Value to write to stream.
              */
             template <typename T>
-            inline void write(const T& v);
+            inline void write(const T& v) { Serializer<T>::write(*this, v); }
 
             /// char * overload which calls the std::string specialization.
             inline void write(const char * const str);
@@ -212,38 +388,61 @@ namespace io {
 	    template <typename T>
 	    inline BinaryOStream& operator<<(const T& v);
 
+            /// char * overload.
+            inline BinaryOStream& operator<<(const char * const str)
+            { this->write(str); return *this; }
+
+            /** Write raw bytes.
+             * @param buf Data to write.
+             * @param len Number of bytes to write.
+             */
+            inline void write_raw(const void *buf, size_type len);
+
+            /// Write a variable-length unsigned integer.
+            void write_varint(varint_type v);
+
+            /// Write buffered data to the file.
+            void flush();
+
 	protected:
             /// Open mode.
 	    virtual const char * const mode() const;
-    };
 
-    template <typename T>
-    inline void
-    BinaryOStream::write(const T& v)
-    {
-        std::fwrite(static_cast<const void *>(&v),
-                sizeof(T), 1, this->stream());
-    }
+            /// Flushes the buffer.
+            virtual void do_close();
+
+            /** Buffer everything written until the next flush(), rather
+             * than writing it out whenever the buffer fills up.
+             */
+            inline void set_unbounded(bool b) { _unbounded = b; }
+
+            /// Get buffered data that hasn't been written yet.
+            inline const std::vector<char>& buffered() const { return _buf; }
+
+            /// Discard buffered data that hasn't been written yet.
+            inline void discard() { _buf.clear(); }
+
+	private:
+            std::vector<char> _buf;
+            bool _unbounded;
+    };
 
-    /// Partial specialization for std::string.
-    template <>
     inline void
-    BinaryOStream::write<std::string>(const std::string& str)
+    BinaryOStream::write_raw(const void *buf, size_type len)
     {
-	const std::string::size_type len(str.length());
-        this->write(len);
-
-        if (not *this)
-            return;
+        const char *p = static_cast<const char *>(buf);
+        _buf.insert(_buf.end(), p, p + len);
 
-        std::fwrite(static_cast<const void *>(str.c_str()),
-                sizeof(char), len, this->stream());
+        if (not _unbounded and _buf.size() >= default_bufsize)
+            this->flush();
     }
 
     inline void
     BinaryOStream::write(const char * const str)
     {
-        this->write(std::string(str));
+        const size_type len(std::strlen(str));
+        this->write_varint(len);
+        this->write_raw(str, len);
     }
 
     template <typename T>
@@ -254,6 +453,205 @@ namespace io {
 	return *this;
     }
 
+    /**
+     * Write @a n elements to a stream, preceded by their count.
+     * @param s Output stream.
+     * @param first Beginning of range.
+     * @param last End of range.
+     * @param n Number of elements in [first,last).
+     */
+
+    template <typename InputIterator>
+    void
+    write_sequence(BinaryOStream& s, InputIterator first, InputIterator last,
+                   BinaryStream::size_type n)
+    {
+        s.write_varint(n);
+        for ( ; first != last ; ++first)
+            s << *first;
+    }
+
+    /**
+     * Read elements written by write_sequence().
+     * @param s Input stream.
+     * @param out Output iterator (eg an insert iterator).
+     * @returns False if the stream went bad.
+     */
+
+    template <typename T, typename OutputIterator>
+    bool
+    read_sequence(BinaryIStream& s, OutputIterator out)
+    {
+        varint_type n;
+        if (not s.read_varint(n))
+            return false;
+
+        while (n-- > 0)
+        {
+            T v;
+            if (not (s >> v))
+                return false;
+            *out++ = v;
+        }
+
+        return true;
+    }
+
+    /* raw object representation */
+    template <typename T>
+    inline void
+    Serializer<T>::write(BinaryOStream& s, const T& v)
+    {
+        s.write_raw(&v, sizeof(T));
+    }
+
+    template <typename T>
+    inline void
+    Serializer<T>::read(BinaryIStream& s, T& v)
+    {
+        s.read_raw(&v, sizeof(T));
+    }
+
+    /// @cond
+    /* single bytes */
+#define LIBHERDSTAT_BYTE_SERIALIZER(T) \
+    template <> struct Serializer<T> \
+    { \
+        static inline void write(BinaryOStream& s, const T& v) \
+        { s.write_raw(&v, 1); } \
+        static inline void read(BinaryIStream& s, T& v) \
+        { s.read_raw(&v, 1); } \
+    };
+
+    LIBHERDSTAT_BYTE_SERIALIZER(char)
+    LIBHERDSTAT_BYTE_SERIALIZER(signed char)
+    LIBHERDSTAT_BYTE_SERIALIZER(unsigned char)
+#undef LIBHERDSTAT_BYTE_SERIALIZER
+
+    template <> struct Serializer<bool>
+    {
+        static inline void write(BinaryOStream& s, const bool& v)
+        { const char c = (v ? 1 : 0); s.write_raw(&c, 1); }
+        static inline void read(BinaryIStream& s, bool& v)
+        { char c = 0; s.read_raw(&c, 1); v = (c != 0); }
+    };
+
+    /* unsigned integers; LEB128 */
+#define LIBHERDSTAT_UNSIGNED_SERIALIZER(T) \
+    template <> struct Serializer<T> \
+    { \
+        static inline void write(BinaryOStream& s, const T& v) \
+        { s.write_varint(v); } \
+        static inline void read(BinaryIStream& s, T& v) \
+        { \
+            varint_type n; \
+            if (s.read_varint(n)) v = static_cast<T>(n); \
+        } \
+    };
+
+    LIBHERDSTAT_UNSIGNED_SERIALIZER(unsigned short)
+    LIBHERDSTAT_UNSIGNED_SERIALIZER(unsigned int)
+    LIBHERDSTAT_UNSIGNED_SERIALIZER(unsigned long)
+#if ULONG_MAX == 0xffffffffUL
+    /* otherwise it's unsigned long */
+    LIBHERDSTAT_UNSIGNED_SERIALIZER(varint_type)
+#endif
+#undef LIBHERDSTAT_UNSIGNED_SERIALIZER
+
+    /* signed integers; zigzag encoded so small negatives stay short */
+#define LIBHERDSTAT_SIGNED_SERIALIZER(T) \
+    template <> struct Serializer<T> \
+    { \
+        static inline void write(BinaryOStream& s, const T& v) \
+        { \
+            const svarint_type n(v); \
+            s.write_varint((static_cast<varint_type>(n) << 1) ^ \
+                           static_cast<varint_type>(n >> 63)); \
+        } \
+        static inline void read(BinaryIStream& s, T& v) \
+        { \
+            varint_type n; \
+            if (s.read_varint(n)) \
+                v = static_cast<T>(static_cast<svarint_type>(n >> 1) ^ \
+                                   -static_cast<svarint_type>(n & 1)); \
+        } \
+    };
+
+    LIBHERDSTAT_SIGNED_SERIALIZER(short)
+    LIBHERDSTAT_SIGNED_SERIALIZER(int)
+    LIBHERDSTAT_SIGNED_SERIALIZER(long)
+#if ULONG_MAX == 0xffffffffUL
+    LIBHERDSTAT_SIGNED_SERIALIZER(svarint_type)
+#endif
+#undef LIBHERDSTAT_SIGNED_SERIALIZER
+
+    /* IEEE 754, little endian */
+    template <> struct Serializer<float>
+    {
+        static void write(BinaryOStream& s, const float& v);
+        static void read(BinaryIStream& s, float& v);
+    };
+
+    template <> struct Serializer<double>
+    {
+        static void write(BinaryOStream& s, const double& v);
+        static void read(BinaryIStream& s, double& v);
+    };
+
+    /* length-prefixed */
+    template <> struct Serializer<std::string>
+    {
+        static inline void write(BinaryOStream& s, const std::string& v)
+        {
+            s.write_varint(v.size());
+            s.write_raw(v.data(), v.size());
+        }
+
+        static inline void read(BinaryIStream& s, std::string& v)
+        {
+            varint_type len;
+            if (s.read_varint(len))
+                s.read_raw(v, static_cast<BinaryStream::size_type>(len));
+        }
+    };
+
+    /* same encoding as std::string; reading requires a contiguous()
+     * stream */
+    template <> struct Serializer<util::StringView>
+    {
+        static inline void write(BinaryOStream& s, const util::StringView& v)
+        {
+            s.write_varint(v.size());
+            s.write_raw(v.data(), v.size());
+        }
+
+        static inline void read(BinaryIStream& s, util::StringView& v)
+        {
+            varint_type len;
+            if (s.read_varint(len))
+                s.read_view(v, static_cast<BinaryStream::size_type>(len));
+        }
+    };
+
+    template <typename T1, typename T2>
+    struct Serializer<std::pair<T1, T2> >
+    {
+        static inline void write(BinaryOStream& s, const std::pair<T1, T2>& v)
+        { s << v.first << v.second; }
+        static inline void read(BinaryIStream& s, std::pair<T1, T2>& v)
+        { s >> v.first >> v.second; }
+    };
+
+    template <typename T>
+    struct Serializer<std::vector<T> >
+    {
+        static inline void write(BinaryOStream& s, const std::vector<T>& v)
+        { write_sequence(s, v.begin(), v.end(), v.size()); }
+        static inline void read(BinaryIStream& s, std::vector<T>& v)
+        { v.clear(); read_sequence<T>(s, std::back_inserter(v)); }
+    };
+    /// @endcond
+
 } // namespace io
 } // namespace herdstat
 
@@ -0,0 +1,706 @@
+/*
+ * libherdstat -- herdstat/io/compress.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <unistd.h>
+
+#ifdef HAVE_LIBZ
+# include <zlib.h>
+#endif
+#ifdef HAVE_LIBLZMA
+# include <lzma.h>
+#endif
+#ifdef HAVE_LIBZSTD
+# include <zstd.h>
+#endif
+
+#include <herdstat/defs.hh>
+#include <herdstat/util/string.hh>
+#include <herdstat/io/compress.hh>
+
+/* size of intermediate (compressed side) buffers */
+#define BUFFER_SIZE 65536
+
+namespace herdstat {
+namespace io {
+/****************************************************************************/
+CompressionType
+detect_compression(const char *buf, std::size_t len)
+{
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(buf);
+
+    if (len >= 2 and p[0] == 0x1f and p[1] == 0x8b)
+        return COMPRESSION_GZIP;
+    if (len >= 6 and std::memcmp(p, "\xfd" "7zXZ\0", 6) == 0)
+        return COMPRESSION_XZ;
+    if (len >= 4 and p[0] == 0x28 and p[1] == 0xb5 and
+                     p[2] == 0x2f and p[3] == 0xfd)
+        return COMPRESSION_ZSTD;
+
+    return COMPRESSION_NONE;
+}
+/****************************************************************************/
+CompressionType
+detect_compression(const std::string& path)
+{
+    BacktraceContext c("herdstat::io::detect_compression(%s)", path);
+
+    std::FILE *fp = std::fopen(path.c_str(), "rb");
+    if (not fp)
+        throw FileException(path);
+
+    char buf[6];
+    const std::size_t len = std::fread(buf, 1, sizeof(buf), fp);
+    std::fclose(fp);
+
+    return detect_compression(buf, len);
+}
+/****************************************************************************/
+CompressionType
+compression_from_suffix(const std::string& path)
+{
+    const std::string::size_type pos = path.rfind('.');
+    if (pos == std::string::npos)
+        return COMPRESSION_NONE;
+
+    const std::string ext(path.substr(pos));
+    if (ext == ".gz")   return COMPRESSION_GZIP;
+    if (ext == ".xz")   return COMPRESSION_XZ;
+    if (ext == ".zst")  return COMPRESSION_ZSTD;
+    return COMPRESSION_NONE;
+}
+/****************************************************************************/
+const char *
+compression_suffix(CompressionType type)
+{
+    switch (type)
+    {
+        case COMPRESSION_GZIP:  return ".gz";
+        case COMPRESSION_XZ:    return ".xz";
+        case COMPRESSION_ZSTD:  return ".zst";
+        default:                return "";
+    }
+}
+/****************************************************************************/
+bool
+compression_supported(CompressionType type)
+{
+    switch (type)
+    {
+        case COMPRESSION_NONE:
+            return true;
+#ifdef HAVE_LIBZ
+        case COMPRESSION_GZIP:
+            return true;
+#endif
+#ifdef HAVE_LIBLZMA
+        case COMPRESSION_XZ:
+            return true;
+#endif
+#ifdef HAVE_LIBZSTD
+        case COMPRESSION_ZSTD:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+/*** DecompressorImp ********************************************************/
+class DecompressorImp
+{
+    public:
+        virtual ~DecompressorImp() throw() { }
+        virtual std::size_t read(char *buf, std::size_t len) = 0;
+
+    protected:
+        DecompressorImp(const std::string& path) : _path(path) { }
+        const std::string& path() const { return _path; }
+
+    private:
+        const std::string& _path;
+};
+/*** CompressorImp **********************************************************/
+class CompressorImp
+{
+    public:
+        virtual ~CompressorImp() throw() { }
+        virtual void write(const char *buf, std::size_t len) = 0;
+        virtual void close() = 0;
+
+    protected:
+        CompressorImp(const std::string& path) : _path(path) { }
+        const std::string& path() const { return _path; }
+
+    private:
+        const std::string& _path;
+};
+/****************************************************************************/
+namespace {
+/****************************************************************************/
+std::FILE *
+open_or_throw(const std::string& path, const char *mode)
+{
+    std::FILE *fp = std::fopen(path.c_str(), mode);
+    if (not fp)
+        throw FileException(path);
+    return fp;
+}
+/****************************************************************************/
+class PlainDecompressor : public DecompressorImp
+{
+    public:
+        PlainDecompressor(const std::string& path)
+            : DecompressorImp(path), _fp(open_or_throw(path, "rb")) { }
+        virtual ~PlainDecompressor() throw() { std::fclose(_fp); }
+
+        virtual std::size_t read(char *buf, std::size_t len)
+        {
+            const std::size_t n = std::fread(buf, 1, len, _fp);
+            if (n < len and std::ferror(_fp))
+                throw FileException(path());
+            return n;
+        }
+
+    private:
+        std::FILE *_fp;
+};
+/****************************************************************************/
+class PlainCompressor : public CompressorImp
+{
+    public:
+        PlainCompressor(const std::string& path)
+            : CompressorImp(path), _fp(open_or_throw(path, "wb")) { }
+        virtual ~PlainCompressor() throw() { if (_fp) std::fclose(_fp); }
+
+        virtual void write(const char *buf, std::size_t len)
+        {
+            if (std::fwrite(buf, 1, len, _fp) != len)
+                throw FileException(path());
+        }
+
+        virtual void close()
+        {
+            const int rv = std::fclose(_fp);
+            _fp = NULL;
+            if (rv != 0)
+                throw FileException(path());
+        }
+
+    private:
+        std::FILE *_fp;
+};
+/****************************************************************************/
+#ifdef HAVE_LIBZ
+class GzipDecompressor : public DecompressorImp
+{
+    public:
+        GzipDecompressor(const std::string& path)
+            : DecompressorImp(path), _gz(gzopen(path.c_str(), "rb"))
+        {
+            if (not _gz)
+                throw FileException(path);
+            gzbuffer(_gz, BUFFER_SIZE);
+        }
+
+        virtual ~GzipDecompressor() throw() { gzclose(_gz); }
+
+        virtual std::size_t read(char *buf, std::size_t len)
+        {
+            const int n = gzread(_gz, buf, static_cast<unsigned>(len));
+            if (n < 0)
+            {
+                int err;
+                throw CompressionException(path(), gzerror(_gz, &err));
+            }
+            return static_cast<std::size_t>(n);
+        }
+
+    private:
+        gzFile _gz;
+};
+/****************************************************************************/
+class GzipCompressor : public CompressorImp
+{
+    public:
+        GzipCompressor(const std::string& path, int level)
+            : CompressorImp(path), _gz(NULL)
+        {
+            const std::string mode(level < 0 ? std::string("wb") :
+                util::sprintf("wb%d", level > 9 ? 9 : level));
+            if (not (_gz = gzopen(path.c_str(), mode.c_str())))
+                throw FileException(path);
+            gzbuffer(_gz, BUFFER_SIZE);
+        }
+
+        virtual ~GzipCompressor() throw() { if (_gz) gzclose(_gz); }
+
+        virtual void write(const char *buf, std::size_t len)
+        {
+            if (len > 0 and
+                gzwrite(_gz, buf, static_cast<unsigned>(len)) == 0)
+            {
+                int err;
+                throw CompressionException(path(), gzerror(_gz, &err));
+            }
+        }
+
+        virtual void close()
+        {
+            const int rv = gzclose(_gz);
+            _gz = NULL;
+            if (rv != Z_OK)
+                throw CompressionException(path(), "gzclose() failed");
+        }
+
+    private:
+        gzFile _gz;
+};
+#endif /* HAVE_LIBZ */
+/****************************************************************************/
+#ifdef HAVE_LIBLZMA
+class XzDecompressor : public DecompressorImp
+{
+    public:
+        XzDecompressor(const std::string& path)
+            : DecompressorImp(path), _fp(open_or_throw(path, "rb")),
+              _eof(false), _done(false)
+        {
+            std::memset(&_strm, 0, sizeof(_strm));
+            if (lzma_stream_decoder(&_strm, UINT64_MAX,
+                    LZMA_CONCATENATED) != LZMA_OK)
+            {
+                std::fclose(_fp);
+                throw CompressionException(path,
+                    "failed to initialize lzma decoder");
+            }
+        }
+
+        virtual ~XzDecompressor() throw()
+        {
+            lzma_end(&_strm);
+            std::fclose(_fp);
+        }
+
+        virtual std::size_t read(char *buf, std::size_t len)
+        {
+            if (_done)
+                return 0;
+
+            _strm.next_out = reinterpret_cast<uint8_t *>(buf);
+            _strm.avail_out = len;
+
+            while (_strm.avail_out > 0)
+            {
+                if (_strm.avail_in == 0 and not _eof)
+                {
+                    _strm.next_in = _in;
+                    _strm.avail_in = std::fread(_in, 1, sizeof(_in), _fp);
+                    if (std::ferror(_fp))
+                        throw FileException(path());
+                    _eof = std::feof(_fp);
+                }
+
+                const lzma_ret rv =
+                    lzma_code(&_strm, _eof ? LZMA_FINISH : LZMA_RUN);
+                if (rv == LZMA_STREAM_END)
+                {
+                    _done = true;
+                    break;
+                }
+                if (rv != LZMA_OK)
+                    throw CompressionException(path(),
+                        util::sprintf("lzma_code() failed (%d)", rv));
+            }
+
+            return (len - _strm.avail_out);
+        }
+
+    private:
+        std::FILE *_fp;
+        lzma_stream _strm;
+        bool _eof, _done;
+        uint8_t _in[BUFFER_SIZE];
+};
+/****************************************************************************/
+class XzCompressor : public CompressorImp
+{
+    public:
+        XzCompressor(const std::string& path, int level)
+            : CompressorImp(path), _fp(open_or_throw(path, "wb"))
+        {
+            std::memset(&_strm, 0, sizeof(_strm));
+            const uint32_t preset = (level < 0 ? LZMA_PRESET_DEFAULT :
+                static_cast<uint32_t>(level > 9 ? 9 : level));
+            if (lzma_easy_encoder(&_strm, preset, LZMA_CHECK_CRC64) != LZMA_OK)
+            {
+                std::fclose(_fp);
+                throw CompressionException(path,
+                    "failed to initialize lzma encoder");
+            }
+        }
+
+        virtual ~XzCompressor() throw()
+        {
+            lzma_end(&_strm);
+            if (_fp) std::fclose(_fp);
+        }
+
+        virtual void write(const char *buf, std::size_t len)
+        {
+            _strm.next_in = reinterpret_cast<const uint8_t *>(buf);
+            _strm.avail_in = len;
+            while (_strm.avail_in > 0)
+                this->code(LZMA_RUN);
+        }
+
+        virtual void close()
+        {
+            while (this->code(LZMA_FINISH) != LZMA_STREAM_END)
+                ;
+
+            const int rv = std::fclose(_fp);
+            _fp = NULL;
+            if (rv != 0)
+                throw FileException(path());
+        }
+
+    private:
+        lzma_ret code(lzma_action action)
+        {
+            _strm.next_out = _out;
+            _strm.avail_out = sizeof(_out);
+
+            const lzma_ret rv = lzma_code(&_strm, action);
+            if (rv != LZMA_OK and rv != LZMA_STREAM_END)
+                throw CompressionException(path(),
+                    util::sprintf("lzma_code() failed (%d)", rv));
+
+            const std::size_t n = sizeof(_out) - _strm.avail_out;
+            if (std::fwrite(_out, 1, n, _fp) != n)
+                throw FileException(path());
+
+            return rv;
+        }
+
+        std::FILE *_fp;
+        lzma_stream _strm;
+        uint8_t _out[BUFFER_SIZE];
+};
+#endif /* HAVE_LIBLZMA */
+/****************************************************************************/
+#ifdef HAVE_LIBZSTD
+class ZstdDecompressor : public DecompressorImp
+{
+    public:
+        ZstdDecompressor(const std::string& path)
+            : DecompressorImp(path), _fp(open_or_throw(path, "rb")),
+              _dstream(ZSTD_createDStream()), _eof(false)
+        {
+            if (not _dstream or ZSTD_isError(ZSTD_initDStream(_dstream)))
+            {
+                if (_dstream) ZSTD_freeDStream(_dstream);
+                std::fclose(_fp);
+                throw CompressionException(path,
+                    "failed to initialize zstd decoder");
+            }
+            _in.src = _buf;
+            _in.size = _in.pos = 0;
+        }
+
+        virtual ~ZstdDecompressor() throw()
+        {
+            ZSTD_freeDStream(_dstream);
+            std::fclose(_fp);
+        }
+
+        virtual std::size_t read(char *buf, std::size_t len)
+        {
+            ZSTD_outBuffer out = { buf, len, 0 };
+
+            while (out.pos < out.size)
+            {
+                if (_in.pos == _in.size and not _eof)
+                {
+                    _in.size = std::fread(_buf, 1, sizeof(_buf), _fp);
+                    _in.pos = 0;
+                    if (std::ferror(_fp))
+                        throw FileException(path());
+                    _eof = std::feof(_fp);
+                }
+
+                const std::size_t pos = out.pos;
+                const std::size_t rv =
+                    ZSTD_decompressStream(_dstream, &out, &_in);
+                if (ZSTD_isError(rv))
+                    throw CompressionException(path(),
+                        ZSTD_getErrorName(rv));
+
+                /* out of input and nothing left to flush; unless the
+                 * last frame was completed, the file was truncated */
+                if (_in.pos == _in.size and _eof and out.pos == pos)
+                {
+                    if (rv != 0)
+                        throw CompressionException(path(),
+                            "unexpected end of file");
+                    break;
+                }
+            }
+
+            return out.pos;
+        }
+
+    private:
+        std::FILE *_fp;
+        ZSTD_DStream *_dstream;
+        ZSTD_inBuffer _in;
+        bool _eof;
+        char _buf[BUFFER_SIZE];
+};
+/****************************************************************************/
+class ZstdCompressor : public CompressorImp
+{
+    public:
+        ZstdCompressor(const std::string& path, int level)
+            : CompressorImp(path), _fp(open_or_throw(path, "wb")),
+              _cstream(ZSTD_createCStream())
+        {
+            if (not _cstream or ZSTD_isError(ZSTD_initCStream(_cstream,
+                    level < 0 ? 3 : level)))
+            {
+                if (_cstream) ZSTD_freeCStream(_cstream);
+                std::fclose(_fp);
+                throw CompressionException(path,
+                    "failed to initialize zstd encoder");
+            }
+        }
+
+        virtual ~ZstdCompressor() throw()
+        {
+            ZSTD_freeCStream(_cstream);
+            if (_fp) std::fclose(_fp);
+        }
+
+        virtual void write(const char *buf, std::size_t len)
+        {
+            ZSTD_inBuffer in = { buf, len, 0 };
+            while (in.pos < in.size)
+            {
+                ZSTD_outBuffer out = { _buf, sizeof(_buf), 0 };
+                const std::size_t rv =
+                    ZSTD_compressStream(_cstream, &out, &in);
+                if (ZSTD_isError(rv))
+                    throw CompressionException(path(),
+                        ZSTD_getErrorName(rv));
+                this->flush(out);
+            }
+        }
+
+        virtual void close()
+        {
+            std::size_t remaining;
+            do
+            {
+                ZSTD_outBuffer out = { _buf, sizeof(_buf), 0 };
+                remaining = ZSTD_endStream(_cstream, &out);
+                if (ZSTD_isError(remaining))
+                    throw CompressionException(path(),
+                        ZSTD_getErrorName(remaining));
+                this->flush(out);
+            } while (remaining > 0);
+
+            const int rv = std::fclose(_fp);
+            _fp = NULL;
+            if (rv != 0)
+                throw FileException(path());
+        }
+
+    private:
+        void flush(const ZSTD_outBuffer& out)
+        {
+            if (std::fwrite(_buf, 1, out.pos, _fp) != out.pos)
+                throw FileException(path());
+        }
+
+        std::FILE *_fp;
+        ZSTD_CStream *_cstream;
+        char _buf[BUFFER_SIZE];
+};
+#endif /* HAVE_LIBZSTD */
+/****************************************************************************/
+} // anonymous namespace
+/****************************************************************************/
+Decompressor::Decompressor(const std::string& path)
+    : _path(path), _type(detect_compression(path)), _imp(NULL)
+{
+    BacktraceContext c("herdstat::io::Decompressor::Decompressor(%s)", path);
+
+    switch (_type)
+    {
+        case COMPRESSION_NONE:
+            _imp = new PlainDecompressor(_path);
+            break;
+#ifdef HAVE_LIBZ
+        case COMPRESSION_GZIP:
+            _imp = new GzipDecompressor(_path);
+            break;
+#endif
+#ifdef HAVE_LIBLZMA
+        case COMPRESSION_XZ:
+            _imp = new XzDecompressor(_path);
+            break;
+#endif
+#ifdef HAVE_LIBZSTD
+        case COMPRESSION_ZSTD:
+            _imp = new ZstdDecompressor(_path);
+            break;
+#endif
+        default:
+            throw CompressionException(_path,
+                util::sprintf("no support for '%s' compression compiled in",
+                    compression_suffix(_type)));
+    }
+}
+/****************************************************************************/
+Decompressor::~Decompressor() throw()
+{
+    delete _imp;
+}
+/****************************************************************************/
+std::size_t
+Decompressor::read(char *buf, std::size_t len)
+{
+    return _imp->read(buf, len);
+}
+/****************************************************************************/
+void
+Decompressor::read_all(std::string& s)
+{
+    BacktraceContext c("herdstat::io::Decompressor::read_all(%s)", _path);
+
+    char buf[BUFFER_SIZE];
+    std::size_t len;
+    while ((len = _imp->read(buf, sizeof(buf))) > 0)
+        s.append(buf, len);
+}
+/****************************************************************************/
+Compressor::Compressor(const std::string& path, CompressionType type,
+                       int level LIBHERDSTAT_UNUSED)
+    : _path(path), _type(type), _imp(NULL)
+{
+    BacktraceContext c("herdstat::io::Compressor::Compressor(%s)", path);
+
+    switch (_type)
+    {
+        case COMPRESSION_NONE:
+            _imp = new PlainCompressor(_path);
+            break;
+#ifdef HAVE_LIBZ
+        case COMPRESSION_GZIP:
+            _imp = new GzipCompressor(_path, level);
+            break;
+#endif
+#ifdef HAVE_LIBLZMA
+        case COMPRESSION_XZ:
+            _imp = new XzCompressor(_path, level);
+            break;
+#endif
+#ifdef HAVE_LIBZSTD
+        case COMPRESSION_ZSTD:
+            _imp = new ZstdCompressor(_path, level);
+            break;
+#endif
+        default:
+            throw CompressionException(_path,
+                util::sprintf("no support for '%s' compression compiled in",
+                    compression_suffix(_type)));
+    }
+}
+/****************************************************************************/
+Compressor::~Compressor() throw()
+{
+    if (_imp)
+    {
+        try { _imp->close(); }
+        catch (...) { }
+        delete _imp;
+    }
+}
+/****************************************************************************/
+void
+Compressor::write(const char *buf, std::size_t len)
+{
+    assert(_imp);
+    _imp->write(buf, len);
+}
+/****************************************************************************/
+void
+Compressor::close()
+{
+    BacktraceContext c("herdstat::io::Compressor::close(%s)", _path);
+
+    if (not _imp)
+        return;
+
+    /* ensure _imp is freed even if closing fails */
+    CompressorImp *imp = _imp;
+    _imp = NULL;
+
+    try
+    {
+        imp->close();
+    }
+    catch (...)
+    {
+        delete imp;
+        throw;
+    }
+
+    delete imp;
+}
+/****************************************************************************/
+void
+compress_file(const std::string& from, const std::string& to,
+              CompressionType type)
+{
+    BacktraceContext c("herdstat::io::compress_file(%s, %s)", from, to);
+
+    Decompressor in(from);
+    Compressor out(to, type);
+
+    char buf[BUFFER_SIZE];
+    std::size_t len;
+    while ((len = in.read(buf, sizeof(buf))) > 0)
+        out.write(buf, len);
+
+    out.close();
+}
+/****************************************************************************/
+} // namespace io
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,206 @@
+/*
+ * libherdstat -- herdstat/io/compress.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_IO_COMPRESS_HH
+#define _HAVE_IO_COMPRESS_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/io/compress.hh
+ * @brief Defines the Decompressor and Compressor classes.
+ */
+
+#include <string>
+#include <cstddef>
+#include <herdstat/noncopyable.hh>
+#include <herdstat/io/exceptions.hh>
+
+namespace herdstat {
+namespace io {
+
+    /**
+     * @enum CompressionType
+     * @brief Supported compression formats.
+     */
+
+    enum CompressionType
+    {
+        COMPRESSION_NONE,
+        COMPRESSION_GZIP,
+        COMPRESSION_XZ,
+        COMPRESSION_ZSTD
+    };
+
+    /**
+     * Determine compression format from leading (magic) bytes.
+     * @param buf Buffer holding the start of a file.
+     * @param len Length of buf.
+     * @returns CompressionType (COMPRESSION_NONE if unrecognized).
+     */
+    CompressionType detect_compression(const char *buf, std::size_t len);
+
+    /**
+     * Determine compression format of the given file by reading its magic
+     * bytes.
+     * @param path Path.
+     * @returns CompressionType (COMPRESSION_NONE if unrecognized).
+     * @exception FileException
+     */
+    CompressionType detect_compression(const std::string& path);
+
+    /**
+     * Determine compression format from the given path's file extension
+     * (.gz, .xz, .zst).
+     * @param path Path.
+     * @returns CompressionType (COMPRESSION_NONE if unrecognized).
+     */
+    CompressionType compression_from_suffix(const std::string& path);
+
+    /**
+     * Get file extension (including the dot) conventionally used for the
+     * given compression format.
+     */
+    const char *compression_suffix(CompressionType type);
+
+    /**
+     * Was support for the given compression format compiled in?
+     */
+    bool compression_supported(CompressionType type);
+
+    class DecompressorImp;
+    class CompressorImp;
+
+    /**
+     * @class Decompressor compress.hh herdstat/io/compress.hh
+     * @brief Reads a file, transparently decompressing gzip, xz or zstd
+     * content.  Uncompressed files are passed through as-is.
+     *
+     * @section example Example
+     *
+@code
+herdstat::io::Decompressor in("/var/lib/herdstat/herds.xml.gz");
+char buf[BUFSIZ];
+std::size_t len;
+while ((len = in.read(buf, sizeof(buf))) > 0)
+    ...
+@endcode
+     */
+
+    class Decompressor : private Noncopyable
+    {
+        public:
+            /** Constructor.  Opens path and determines its format.
+             * @param path Path.
+             * @exception FileException, CompressionException
+             */
+            explicit Decompressor(const std::string& path);
+
+            /// Destructor.
+            ~Decompressor() throw();
+
+            /// Get path.
+            inline const std::string& path() const { return _path; }
+            /// Get detected compression format.
+            inline CompressionType type() const { return _type; }
+
+            /** Read (up to) len decompressed bytes into buf.
+             * @returns Number of bytes read (0 on EOF).
+             * @exception CompressionException
+             */
+            std::size_t read(char *buf, std::size_t len);
+
+            /** Read all remaining decompressed content.
+             * @param s String to append to.
+             * @exception CompressionException
+             */
+            void read_all(std::string& s);
+
+        private:
+            const std::string _path;
+            CompressionType _type;
+            DecompressorImp *_imp;
+    };
+
+    /**
+     * @class Compressor compress.hh herdstat/io/compress.hh
+     * @brief Writes a file compressed with the given format.
+     */
+
+    class Compressor : private Noncopyable
+    {
+        public:
+            /** Constructor.  Opens (truncates) path for writing.
+             * @param path Path.
+             * @param type Compression format.
+             * @param level Compression level (-1 for the format's default).
+             * @exception FileException, CompressionException
+             */
+            Compressor(const std::string& path, CompressionType type,
+                       int level = -1);
+
+            /// Destructor.  Calls close() if not already closed.
+            ~Compressor() throw();
+
+            /// Get path.
+            inline const std::string& path() const { return _path; }
+            /// Get compression format.
+            inline CompressionType type() const { return _type; }
+
+            ///@{
+            /** Compress and write data.
+             * @exception CompressionException
+             */
+            void write(const char *buf, std::size_t len);
+            inline void write(const std::string& s)
+            { this->write(s.data(), s.size()); }
+            ///@}
+
+            /** Flush any pending output and close file.
+             * @exception CompressionException
+             */
+            void close();
+
+        private:
+            const std::string _path;
+            const CompressionType _type;
+            CompressorImp *_imp;
+    };
+
+    /**
+     * Compress a file.
+     * @param from Path of source file (may itself be compressed).
+     * @param to Path of destination file.
+     * @param type Compression format to use for destination.
+     * @exception FileException, CompressionException
+     */
+    void compress_file(const std::string& from, const std::string& to,
+                       CompressionType type);
+
+} // namespace io
+} // namespace herdstat
+
+#endif /* _HAVE_IO_COMPRESS_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
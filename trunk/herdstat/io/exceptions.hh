@@ -0,0 +1,68 @@
+/*
+ * libherdstat -- herdstat/io/exceptions.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_IO_EXCEPTIONS_HH
+#define _HAVE_IO_EXCEPTIONS_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/io/exceptions.hh
+ * @brief io-related exception classes.
+ */
+
+#include <herdstat/exceptions.hh>
+
+namespace herdstat {
+namespace io {
+
+    /**
+     * @class CompressionException exceptions.hh herdstat/io/exceptions.hh
+     * @brief Exception for (de)compression errors.
+     */
+
+    class CompressionException : public Exception
+    {
+        public:
+            /// Default constructor.
+            CompressionException() throw() : Exception() { }
+
+            /** Constructor.
+             * @param path Path of the file being (de)compressed.
+             * @param msg Error message.
+             */
+            CompressionException(const std::string& path,
+                                 const std::string& msg) throw()
+                : Exception("%s: %s", path.c_str(), msg.c_str()) { }
+
+            /// Destructor.
+            virtual ~CompressionException() throw() { }
+    };
+
+} // namespace io
+} // namespace herdstat
+
+#endif /* _HAVE_IO_EXCEPTIONS_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,126 @@
+/*
+ * libherdstat -- herdstat/io/mapped_file.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <herdstat/exceptions.hh>
+#include <herdstat/io/mapped_file.hh>
+
+namespace herdstat {
+namespace io {
+/****************************************************************************/
+MappedFile::MappedFile()
+    : _data(""), _size(0), _open(false)
+{
+}
+/****************************************************************************/
+MappedFile::MappedFile(const std::string& path)
+    : _data(""), _size(0), _open(false)
+{
+    this->open(path);
+}
+/****************************************************************************/
+MappedFile::~MappedFile() throw()
+{
+    this->close();
+}
+/****************************************************************************/
+void
+MappedFile::open(const std::string& path)
+{
+    BacktraceContext c("io::MappedFile::open(%s)", path);
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        throw FileException(path);
+
+    const bool mapped = this->map(fd);
+    const int error = errno;
+    ::close(fd);
+
+    if (not mapped)
+    {
+        errno = error;
+        throw FileException(path);
+    }
+}
+/****************************************************************************/
+bool
+MappedFile::map(int fd)
+{
+    this->close();
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+        return false;
+
+    if (not S_ISREG(st.st_mode))
+    {
+        errno = ENODEV;
+        return false;
+    }
+
+    /* mmap() refuses zero-length mappings */
+    if (st.st_size > 0)
+    {
+        void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED)
+            return false;
+
+        _data = static_cast<const char *>(p);
+        _size = st.st_size;
+    }
+
+    _open = true;
+    return true;
+}
+/****************************************************************************/
+void
+MappedFile::close()
+{
+    if (_size > 0)
+        munmap(const_cast<char *>(_data), _size);
+
+    _data = "";
+    _size = 0;
+    _open = false;
+}
+/****************************************************************************/
+void
+MappedFile::advise_sequential() const
+{
+    if (_size > 0)
+        madvise(const_cast<char *>(_data), _size, MADV_SEQUENTIAL);
+}
+/****************************************************************************/
+} // namespace io
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,117 @@
+/*
+ * libherdstat -- herdstat/io/mapped_file.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_IO_MAPPED_FILE_HH
+#define _HAVE_IO_MAPPED_FILE_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/io/mapped_file.hh
+ * @brief Defines the MappedFile class.
+ */
+
+#include <string>
+#include <cstddef>
+#include <herdstat/noncopyable.hh>
+
+namespace herdstat {
+namespace io {
+
+    /**
+     * @class MappedFile mapped_file.hh herdstat/io/mapped_file.hh
+     * @brief Read-only memory mapping of a whole file.
+     *
+     * The mapping is private, so the contents don't change underneath you
+     * if the file is rewritten (as long as it's replaced rather than
+     * truncated).  Empty files are fine; data() is then an empty string.
+     */
+
+    class MappedFile : private Noncopyable
+    {
+        public:
+            typedef std::size_t size_type;
+            typedef const char * const_iterator;
+
+            /// Default constructor.
+            MappedFile();
+
+            /** Constructor.  Maps the given file.
+             * @param path Path of file.
+             * @exception FileException
+             */
+            explicit MappedFile(const std::string& path);
+
+            /// Destructor.  Unmaps the file.
+            ~MappedFile() throw();
+
+            /** Map the given file, unmapping any previous one.
+             * @param path Path of file.
+             * @exception FileException
+             */
+            void open(const std::string& path);
+
+            /** Map the file open on the given descriptor, unmapping any
+             * previous one.  The descriptor may be closed afterwards.
+             * @param fd File descriptor.
+             * @returns False (with errno set) if the file couldn't be
+             * mapped (eg it's a pipe).
+             */
+            bool map(int fd);
+
+            /// Unmap the file.
+            void close();
+
+            /// Is a file mapped?
+            bool is_open() const { return _open; }
+
+            /** Tell the kernel the mapping will be read front to back, so
+             * it reads ahead aggressively.
+             */
+            void advise_sequential() const;
+
+            ///@{
+            /// Get mapped data.
+            const char *data() const { return _data; }
+            const_iterator begin() const { return _data; }
+            const_iterator end() const { return _data + _size; }
+            ///@}
+
+            /// Get size of mapped data.
+            size_type size() const { return _size; }
+            /// Is the mapping empty?
+            bool empty() const { return (_size == 0); }
+
+        private:
+            const char *_data;
+            size_type _size;
+            bool _open;
+    };
+
+} // namespace io
+} // namespace herdstat
+
+#endif /* _HAVE_IO_MAPPED_FILE_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
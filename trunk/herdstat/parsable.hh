@@ -71,13 +71,13 @@ namespace herdstat {
             typedef util::Timer timer_type;
 
             /// Default constructor.
-            Parsable() : _parsed(false), _path(), _timer() { }
+            Parsable() : _parsed(false), _partial(false), _path(), _timer() { }
 
             /** Constructor.
              * @param path Path of parsable file.
              */
             Parsable(const std::string& path)
-                : _parsed(false), _path(path), _timer() { }
+                : _parsed(false), _partial(false), _path(path), _timer() { }
             
             /// Destructor.
             virtual ~Parsable() { }
@@ -90,6 +90,10 @@ namespace herdstat {
 
             /// Have we already parsed?
             bool parsed() const { return _parsed; }
+            /** Did we only parse part of the file (a selective parse)?  If
+             * so, the parsed data is incomplete.
+             */
+            bool partial() const { return _partial; }
             /// Get path of parsable file.
             const std::string &path() const { return _path; }
             /// Get elapsed time it took to parse.
@@ -109,8 +113,12 @@ namespace herdstat {
             /// Get reference to timer object.
             timer_type& timer() { return _timer; }
 
+            /// Mark parsed data as (in)complete.
+            void set_partial(bool partial) { _partial = partial; }
+
         private:
             bool _parsed;
+            bool _partial;
             mutable std::string _path;
             timer_type  _timer;
     };
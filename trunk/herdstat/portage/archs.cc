@@ -45,7 +45,7 @@ Archs::~Archs() throw()
 void
 Archs::do_read()
 {
-    this->insert(std::istream_iterator<std::string>(this->stream()),
+    this->insert(std::istream_iterator<std::string>(this->input()),
                  std::istream_iterator<std::string>());
 
     /* so keywords like '-*' are recognized. */
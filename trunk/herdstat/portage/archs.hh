@@ -33,6 +33,7 @@
  */
 
 #include <herdstat/util/file.hh>
+#include <herdstat/util/string.hh>
 
 namespace herdstat {
 namespace portage {
@@ -45,9 +46,10 @@ namespace portage {
      * @section usage Usage
      *
      * Use the Archs class like you would any std::set<std::string>.
+     * Lookups also accept a util::StringView or C string.
      */
 
-    class Archs : public util::SetBase<std::string>,
+    class Archs : public util::FlatSetBase<std::string, util::StringLess>,
                   protected util::BaseFile
     {
         public:
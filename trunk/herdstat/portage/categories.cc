@@ -67,9 +67,10 @@ struct BailIfInvalid : std::binary_function<std::string, std::string, void>
 void
 Categories::do_read()
 {
-    BacktraceContext c("herdstat::portage::Categories::do_read("+this->path()+")");
+    BacktraceContext c("herdstat::portage::Categories::do_read(%s)",
+        this->path());
 
-    this->insert(std::istream_iterator<std::string>(this->stream()),
+    this->insert(std::istream_iterator<std::string>(this->input()),
                  std::istream_iterator<std::string>());
 
     /* validate if requested */
@@ -29,6 +29,7 @@
 
 #include <string>
 #include <herdstat/util/file.hh>
+#include <herdstat/util/string.hh>
 #include <herdstat/util/container_base.hh>
 
 /**
@@ -59,10 +60,12 @@ namespace portage {
      * @section usage Usage
      *
      * Use the Categories class as you would any std::set<std::string>.
+     * Lookups also accept a util::StringView or C string.
      */
 
-    class Categories : public util::SetBase<std::string>,
-                       protected util::BaseFile
+    class Categories
+        : public util::FlatSetBase<std::string, util::StringLess>,
+          protected util::BaseFile
     {
         public:
             /** Constructor.
@@ -28,11 +28,37 @@
 #include <herdstat/util/string.hh>
 #include <herdstat/portage/config.hh>
 
+namespace {
+    /* guards construction of the GlobalConfig() instance */
+    pthread_mutex_t global_config_mutex = PTHREAD_MUTEX_INITIALIZER;
+}
+
 namespace herdstat {
 namespace portage {
 /****************************************************************************/
+const Config&
+GlobalConfig()
+{
+    /* constant-initialized, so it's safe to test before static
+     * constructors have run. */
+    static const Config * volatile config = NULL;
+
+    const Config *c = util::atomic_load(config);
+    if (not c)
+    {
+        util::Lock lock(global_config_mutex);
+        if (not (c = util::atomic_load(config)))
+        {
+            static const Config instance;
+            util::atomic_store(config, c = &instance);
+        }
+    }
+
+    return *c;
+}
+/****************************************************************************/
 Config::Config()
-    : _vars(), _portdir(), _overlays(), _cats(NULL), _archs(NULL)
+    : _vars(), _portdir(), _overlays(), _cats(NULL), _archs(NULL), _mutex()
 {
     /* read default config */
     _vars.read("/etc/make.globals");
@@ -66,13 +92,41 @@ Config::Config()
             util::split(x->second, std::back_inserter(_overlays));
     }
 }
-
+/****************************************************************************/
 Config::~Config() throw()
 {
     if (_cats) delete _cats;
     if (_archs) delete _archs;
 }
 /****************************************************************************/
+const Categories&
+Config::categories() const
+{
+    Categories *cats = util::atomic_load(_cats);
+    if (not cats)
+    {
+        util::Lock lock(_mutex);
+        if (not (cats = util::atomic_load(_cats)))
+            util::atomic_store(_cats, cats = new Categories(_portdir));
+    }
+
+    return *cats;
+}
+/****************************************************************************/
+const Archs&
+Config::archs() const
+{
+    Archs *archs = util::atomic_load(_archs);
+    if (not archs)
+    {
+        util::Lock lock(_mutex);
+        if (not (archs = util::atomic_load(_archs)))
+            util::atomic_store(_archs, archs = new Archs(_portdir));
+    }
+
+    return *archs;
+}
+/****************************************************************************/
 } // namespace portage
 } // namespace herdstat
 
@@ -38,6 +38,7 @@
 #include <herdstat/noncopyable.hh>
 #include <herdstat/exceptions.hh>
 #include <herdstat/util/vars.hh>
+#include <herdstat/util/thread.hh>
 #include <herdstat/portage/archs.hh>
 #include <herdstat/portage/categories.hh>
 
@@ -67,6 +68,10 @@ namespace portage {
      * make.conf/make.globals (and other files that it reads) more than
      * necessary.
      *
+     * GlobalConfig(), categories() and archs() may safely be called from
+     * multiple threads; the one-time initialisation each performs is
+     * guarded.
+     *
      * As stated in the previous section, the Config class stores variables and
      * their values as found in make.conf/make.globals.  The values to these
      * variables can be retrieved via the operator[]() member.
@@ -100,12 +105,12 @@ const std::string distdir(config["DISTDIR"]);
             /** Get categories.
              * @exception FileException
              */
-            inline const Categories& categories() const;
+            const Categories& categories() const;
             
             /** Get arch keywords.
              * @exception FileException
              */
-            inline const Archs& archs() const;
+            const Archs& archs() const;
 
         private:
             /// Only GlobalConfig() can instantiate this class.
@@ -119,28 +124,15 @@ const std::string distdir(config["DISTDIR"]);
             util::Vars _vars;
             std::string _portdir;
             std::vector<std::string> _overlays;
-            mutable Categories *_cats;
-            mutable Archs *_archs;
+            mutable Categories * volatile _cats;
+            mutable Archs * volatile _archs;
+            mutable util::Mutex _mutex;
     };
 
     inline const std::string& Config::portdir() const { return _portdir; }
     inline const std::vector<std::string>& Config::overlays() const
     { return _overlays; }
 
-    inline const Categories&
-    Config::categories() const
-    {
-        if (not _cats) _cats = new Categories(_portdir);
-        return *_cats;
-    }
-
-    inline const Archs&
-    Config::archs() const
-    {
-        if (not _archs) _archs = new Archs(_portdir);
-        return *_archs;
-    }
-
     inline std::string
     Config::operator[] (const std::string& var) const
     {
@@ -155,12 +147,7 @@ const std::string distdir(config["DISTDIR"]);
      * @see Config for an example of using the returned Config instance.
      */
 
-    inline const Config&
-    GlobalConfig()
-    {
-        static Config c;
-        return c;
-    }
+    const Config& GlobalConfig();
 
 } // namespace portage
 } // namespace herdstat
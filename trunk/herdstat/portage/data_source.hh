@@ -64,6 +64,18 @@ namespace portage {
              */
             virtual void fill_developer(Developer& dev) const = 0;
 
+            /** Parse only the records selected by @a sel, skipping the rest
+             * and stopping as soon as @a sel is complete.  The result is
+             * marked partial() and subsequent calls to parse() are no-ops;
+             * use a new object for a full parse.  Has no effect if we've
+             * already parsed.
+             * @param sel Selector (found() is updated).
+             * @param path Path of XML file (defaults to empty).
+             * @exception FileException, xml::ParserException
+             */
+            inline void parse_selected(xml::Selector& sel,
+                                       const std::string& path = "");
+
         protected:
             /// Default constructor.
             DataSource() { }
@@ -77,6 +89,28 @@ namespace portage {
             virtual ~DataSource() throw() { }
     };
 
+    inline void
+    DataSource::parse_selected(xml::Selector& sel, const std::string& path)
+    {
+        if (this->parsed())
+            return;
+
+        this->set_selector(&sel);
+        this->set_partial(true);
+
+        try
+        {
+            this->parse(path);
+        }
+        catch (...)
+        {
+            this->set_selector(NULL);
+            throw;
+        }
+
+        this->set_selector(NULL);
+    }
+
 } // namespace portage
 } // namespace herdstat
 
@@ -0,0 +1,258 @@
+/*
+ * libherdstat -- herdstat/portage/data_source_loader.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cerrno>
+#include <exception>
+#include <herdstat/exceptions.hh>
+#include <herdstat/util/functional.hh>
+#include <herdstat/portage/data_source_loader.hh>
+
+namespace {
+    /* lets a PackageList be loaded (and timed) like any other Parsable */
+    class PackageListLoader : public herdstat::Parsable
+    {
+        public:
+            PackageListLoader(herdstat::portage::PackageList& pkgs)
+                : herdstat::Parsable(pkgs.portdir()), _pkgs(pkgs) { }
+
+        protected:
+            virtual void do_parse(const std::string& path LIBHERDSTAT_UNUSED)
+            {
+                this->timer().start();
+                _pkgs.fill();
+                this->timer().stop();
+            }
+
+        private:
+            herdstat::portage::PackageList& _pkgs;
+    };
+}
+
+namespace herdstat {
+namespace portage {
+/****************************************************************************/
+DataSourceLoader::Job::Job(DataSourceLoader *l, Parsable *p,
+                           const std::string& s)
+    : loader(l), parsable(p), path(s), thread(), started(false),
+      done(false), error()
+{
+}
+/****************************************************************************/
+DataSourceLoader::DataSourceLoader()
+    : _jobs(), _owned(), _finished(), _running(0), _timer(), _mutex()
+{
+    if ((errno = pthread_cond_init(&_cond, NULL)) != 0)
+        throw ErrnoException("pthread_cond_init");
+}
+/****************************************************************************/
+DataSourceLoader::~DataSourceLoader() throw()
+{
+    std::vector<Job *>::iterator i;
+    for (i = _jobs.begin() ; i != _jobs.end() ; ++i)
+    {
+        if ((*i)->started)
+            pthread_join((*i)->thread, NULL);
+    }
+
+    std::for_each(_jobs.begin(), _jobs.end(),
+        util::DeleteAndNullify<Job>());
+    std::for_each(_owned.begin(), _owned.end(),
+        util::DeleteAndNullify<Parsable>());
+
+    pthread_cond_destroy(&_cond);
+}
+/****************************************************************************/
+const Parsable&
+DataSourceLoader::add(DataSource& ds, const std::string& path)
+{
+    util::Lock lock(_mutex);
+    _jobs.push_back(new Job(this, &ds, path));
+    return ds;
+}
+/****************************************************************************/
+const Parsable&
+DataSourceLoader::add(PackageList& pkgs)
+{
+    util::Lock lock(_mutex);
+    _owned.push_back(new PackageListLoader(pkgs));
+    _jobs.push_back(new Job(this, _owned.back(), ""));
+    return *_owned.back();
+}
+/****************************************************************************/
+void
+DataSourceLoader::start()
+{
+    BacktraceContext c("portage::DataSourceLoader::start()");
+
+    util::Lock lock(_mutex);
+
+    std::vector<Job *>::iterator i;
+    for (i = _jobs.begin() ; i != _jobs.end() ; ++i)
+    {
+        Job *job = *i;
+        if (job->started)
+            continue;
+
+        if ((errno = pthread_create(&job->thread, NULL, run, job)) != 0)
+            throw ErrnoException("pthread_create");
+
+        job->started = true;
+        if (_running++ == 0)
+            _timer.start();
+    }
+}
+/****************************************************************************/
+void *
+DataSourceLoader::run(void *arg)
+{
+    Job *job = static_cast<Job *>(arg);
+    std::string error;
+
+    try
+    {
+        job->parsable->parse(job->path);
+    }
+    catch (const BaseException& e)
+    {
+        error.assign(e.what());
+    }
+    catch (const std::exception& e)
+    {
+        error.assign(e.what());
+    }
+    catch (...)
+    {
+        error.assign("unknown error");
+    }
+
+    DataSourceLoader *loader = job->loader;
+    util::Lock lock(loader->_mutex);
+
+    job->error.swap(error);
+    job->done = true;
+    loader->_finished.push_back(job);
+
+    if (--loader->_running == 0)
+        loader->_timer.stop();
+
+    pthread_cond_broadcast(&loader->_cond);
+    return NULL;
+}
+/****************************************************************************/
+DataSourceLoader::Job *
+DataSourceLoader::find(const Parsable& p) const
+{
+    std::vector<Job *>::const_iterator i;
+    for (i = _jobs.begin() ; i != _jobs.end() ; ++i)
+    {
+        if ((*i)->parsable == &p)
+            return *i;
+    }
+
+    throw Exception("DataSourceLoader: unknown object");
+}
+/****************************************************************************/
+void
+DataSourceLoader::check(const Job *job) const
+{
+    if (not job->error.empty())
+        throw Exception("%s: %s", job->parsable->path().c_str(),
+            job->error.c_str());
+}
+/****************************************************************************/
+bool
+DataSourceLoader::ready(const Parsable& p) const
+{
+    util::Lock lock(_mutex);
+    return this->find(p)->done;
+}
+/****************************************************************************/
+void
+DataSourceLoader::wait(const Parsable& p)
+{
+    BacktraceContext c("portage::DataSourceLoader::wait()");
+
+    util::Lock lock(_mutex);
+
+    Job *job = this->find(p);
+    if (not job->started)
+        throw Exception("DataSourceLoader::wait() called before start()");
+
+    while (not job->done)
+        pthread_cond_wait(&_cond, &_mutex.native());
+
+    this->check(job);
+}
+/****************************************************************************/
+const Parsable *
+DataSourceLoader::wait_next()
+{
+    BacktraceContext c("portage::DataSourceLoader::wait_next()");
+
+    util::Lock lock(_mutex);
+
+    while (_finished.empty() and _running > 0)
+        pthread_cond_wait(&_cond, &_mutex.native());
+
+    if (_finished.empty())
+        return NULL;
+
+    const Job *job = _finished.front();
+    _finished.pop_front();
+
+    this->check(job);
+    return job->parsable;
+}
+/****************************************************************************/
+void
+DataSourceLoader::wait()
+{
+    BacktraceContext c("portage::DataSourceLoader::wait()");
+
+    util::Lock lock(_mutex);
+
+    while (_running > 0)
+        pthread_cond_wait(&_cond, &_mutex.native());
+
+    std::vector<Job *>::const_iterator i;
+    for (i = _jobs.begin() ; i != _jobs.end() ; ++i)
+    {
+        if ((*i)->done)
+            this->check(*i);
+    }
+}
+/****************************************************************************/
+DataSourceLoader::timer_type::size_type
+DataSourceLoader::elapsed() const
+{
+    util::Lock lock(_mutex);
+    return _timer.elapsed();
+}
+/****************************************************************************/
+} // namespace portage
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
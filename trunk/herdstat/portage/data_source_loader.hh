@@ -0,0 +1,183 @@
+/*
+ * libherdstat -- herdstat/portage/data_source_loader.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_PORTAGE_DATA_SOURCE_LOADER_HH
+#define _HAVE_PORTAGE_DATA_SOURCE_LOADER_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/portage/data_source_loader.hh
+ * @brief Defines the DataSourceLoader class.
+ */
+
+#include <deque>
+#include <vector>
+#include <string>
+#include <pthread.h>
+
+#include <herdstat/noncopyable.hh>
+#include <herdstat/parsable.hh>
+#include <herdstat/util/timer.hh>
+#include <herdstat/util/thread.hh>
+#include <herdstat/portage/data_source.hh>
+#include <herdstat/portage/package_list.hh>
+
+namespace herdstat {
+namespace portage {
+
+    /**
+     * @class DataSourceLoader data_source_loader.hh herdstat/portage/data_source_loader.hh
+     * @brief Parses several data sources (and optionally fills a
+     * PackageList) in parallel, one thread each.
+     *
+     * The loader does not own the objects added to it; they must outlive
+     * it.  Don't touch an object until the loader says it's ready (via
+     * wait() or wait_next()).  They may share a progress meter.
+     * xml::GlobalInit() must have been called beforehand.
+     *
+     * Per-source timings are available through each object's
+     * Parsable::elapsed(); elapsed() returns the wall-clock time of the
+     * whole load.
+     *
+     * @section example Example
+     *
+@code
+herdstat::xml::GlobalInit();
+
+herdstat::portage::HerdsXML herds;
+herdstat::portage::UserinfoXML userinfo;
+herdstat::portage::DevawayXML devaway;
+herdstat::portage::PackageList pkgs(false);
+
+herdstat::portage::DataSourceLoader loader;
+loader.add(herds);
+loader.add(userinfo);
+loader.add(devaway);
+loader.add(pkgs);
+loader.start();
+
+// either handle each one as soon as it's ready...
+while (const herdstat::Parsable *p = loader.wait_next())
+    std::cout << p->path() << " took " << p->elapsed() << "ms" << std::endl;
+
+// ...or simply wait for all of them.
+loader.wait();
+std::cout << "Loading took " << loader.elapsed() << "ms" << std::endl;
+@endcode
+     */
+
+    class DataSourceLoader : private Noncopyable
+    {
+        public:
+            typedef util::Timer timer_type;
+            typedef std::size_t size_type;
+
+            /// Default constructor.
+            DataSourceLoader();
+
+            /// Destructor.  Waits for any outstanding threads.
+            virtual ~DataSourceLoader() throw();
+
+            /** Queue a data source for parsing.
+             * @param ds DataSource object.
+             * @param path Path to pass to DataSource::parse() (defaults to
+             * empty).
+             * @returns @a ds
+             */
+            const Parsable& add(DataSource& ds, const std::string& path = "");
+
+            /** Queue a package list for filling.
+             * @param pkgs PackageList object.
+             * @returns Parsable whose elapsed() is the time fill() took.
+             */
+            const Parsable& add(PackageList& pkgs);
+
+            /** Start a thread for each object queued since the last call.
+             * @exception ErrnoException
+             */
+            void start();
+
+            /// Number of objects queued.
+            size_type size() const { return _jobs.size(); }
+
+            /// Has the given object finished loading (successfully or not)?
+            bool ready(const Parsable& p) const;
+
+            /** Wait for the given object to finish loading.
+             * @exception Exception if it failed.
+             */
+            void wait(const Parsable& p);
+
+            /** Wait for the next object to finish loading.  Each object is
+             * returned exactly once, in the order they finish.
+             * @returns Pointer to the Parsable (as returned by add()) or NULL
+             * if every started object has been returned.
+             * @exception Exception if that object failed.
+             */
+            const Parsable *wait_next();
+
+            /** Wait for all started objects to finish loading.
+             * @exception Exception for the first one that failed.
+             */
+            void wait();
+
+            /// Wall-clock time from start() until the last object finished.
+            timer_type::size_type elapsed() const;
+
+        private:
+            struct Job
+            {
+                Job(DataSourceLoader *loader, Parsable *parsable,
+                    const std::string& path);
+
+                DataSourceLoader * const loader;
+                Parsable * const parsable;
+                const std::string path;
+                pthread_t thread;
+                bool started;
+                bool done;
+                std::string error;
+            };
+
+            static void *run(void *job);
+
+            Job *find(const Parsable& p) const;
+            void check(const Job *job) const;
+
+            std::vector<Job *> _jobs;
+            std::vector<Parsable *> _owned;
+            std::deque<Job *> _finished;
+            size_type _running;
+            timer_type _timer;
+            mutable util::Mutex _mutex;
+            pthread_cond_t _cond;
+    };
+
+} // namespace portage
+} // namespace herdstat
+
+#endif /* _HAVE_PORTAGE_DATA_SOURCE_LOADER_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -28,6 +28,7 @@
 #include <herdstat/exceptions.hh>
 #include <herdstat/util/string.hh>
 #include <herdstat/util/file.hh>
+#include <herdstat/util/profile.hh>
 #include <herdstat/portage/devaway_xml.hh>
 
 namespace herdstat {
@@ -52,9 +53,16 @@ DevawayXML::~DevawayXML() throw()
 {
 }
 /****************************************************************************/
+util::MemoryUsage
+DevawayXML::memory_usage() const
+{
+    return (_devs.memory_usage() + util::memory_usage(this->path()));
+}
+/****************************************************************************/
 void
 DevawayXML::do_parse(const std::string& path)
 {
+    util::ProfileZone zone("portage::DevawayXML::parse()");
     this->timer().start();
 
     if (not path.empty())
@@ -62,12 +70,12 @@ DevawayXML::do_parse(const std::string& path)
     else if (this->path().empty())
         this->set_path(_local_default);
 
-    BacktraceContext c("portage::DevawayXML::parse("+this->path()+")");
+    BacktraceContext c("portage::DevawayXML::parse(%s)", this->path());
 
     if (not util::is_file(this->path()))
         throw FileException(this->path());
 
-    this->parse_file(this->path().c_str());
+    this->parse_path(this->path());
 
     this->timer().stop();
 }
@@ -106,6 +114,9 @@ DevawayXML::start_element(const std::string& name, const attrs_type& attrs)
     if (meter())
         ++*meter();
 
+    if (this->skipping())
+        return true;
+
     if (name == "devaway")
         in_devaway = true;
     else if (name == "dev" and in_devaway)
@@ -117,6 +128,12 @@ DevawayXML::start_element(const std::string& name, const attrs_type& attrs)
             return false;
         }
 
+        if (this->selector() and not (*this->selector())(pos->second))
+        {
+            this->skip_to_end_of("dev");
+            return true;
+        }
+
         _cur_dev = _devs.insert(pos->second).first;
         in_dev = true;
     }
@@ -132,8 +149,16 @@ DevawayXML::end_element(const std::string& name)
     if (meter())
         ++*meter();
 
+    if (this->skipping(name))
+        return true;
+
     if (name == "devaway")      in_devaway = false;
-    else if (name == "dev")     in_dev = false;
+    else if (name == "dev")
+    {
+        in_dev = false;
+        if (this->selector() and this->selector()->complete())
+            return this->stop();
+    }
     else if (name == "reason")  in_reason = false;
 
     return true;
@@ -83,6 +83,9 @@ namespace portage {
             /// Get vector of all usernames as well as all email addy's.
             const std::vector<std::string> keys() const;
 
+            /// Get heap bytes held by the parsed developers.
+            util::MemoryUsage memory_usage() const;
+
         protected:
             /** Parse devaway.xml.
              * @param path Path to devaway.xml (defaults to empty).
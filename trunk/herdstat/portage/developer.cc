@@ -81,6 +81,23 @@ Developer::~Developer() throw()
     if (_herds) delete _herds;
 }
 /****************************************************************************/
+util::MemoryUsage
+Developer::memory_usage() const
+{
+    util::MemoryUsage m(_email.memory_usage());
+    m += util::memory_usage(_user);
+    m += util::memory_usage(_name);
+    m += util::memory_usage(_pgpkey);
+    m += util::memory_usage(_joined);
+    m += util::memory_usage(_birth);
+    m += util::memory_usage(_status);
+    m += util::memory_usage(_role);
+    m += util::memory_usage(_location);
+    m += util::memory_usage(_awaymsg);
+    m += util::cache_usage(_herds);
+    return m;
+}
+/****************************************************************************/
 Developers::Developers()
 {
 }
@@ -186,6 +186,11 @@ namespace portage {
             /// Set as away.
             inline void set_away(const bool away);
 
+            /** Get heap bytes held by this developer.  The herds vector is
+             * allocated on first use and is counted as a cache.
+             */
+            util::MemoryUsage memory_usage() const;
+
         private:
             std::string _user;
             GentooEmailAddress _email;
@@ -443,8 +448,23 @@ herdstat::util::transform_if(devs.begin(), devs.end(),
              */
             inline iterator find(const util::Regex &regex);
             inline const_iterator find(const util::Regex& regex) const;
+
+        private:
+            /* the Developer find() searches for: only the user name (minus
+             * anything after '@'), without the email address parsing
+             * Developer(user) does */
+            static inline Developer key(const std::string& user);
     };
 
+    inline Developer
+    Developers::key(const std::string& user)
+    {
+        Developer dev;
+        const std::string::size_type pos = user.find('@');
+        dev.set_user(pos == std::string::npos ? user : user.substr(0, pos));
+        return dev;
+    }
+
     inline Developers::operator
     const Developers::container_type&() const
     {
@@ -452,11 +472,11 @@ herdstat::util::transform_if(devs.begin(), devs.end(),
     }
 
     inline Developers::iterator Developers::find(const std::string& dev)
-    { return util::SetBase<Developer>::find(Developer(dev)); }
+    { return util::SetBase<Developer>::find(key(dev)); }
 
     inline Developers::const_iterator
     Developers::find(const std::string& dev) const
-    { return util::SetBase<Developer>::find(Developer(dev)); }
+    { return util::SetBase<Developer>::find(key(dev)); }
 
     inline Developers::iterator
     Developers::find(const util::Regex& regex)
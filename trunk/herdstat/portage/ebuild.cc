@@ -60,6 +60,12 @@ Ebuild::assign(const std::string& path)
     this->read(path);
 }
 /****************************************************************************/
+util::MemoryUsage
+Ebuild::memory_usage() const
+{
+    return (util::Vars::memory_usage() + _vmap.memory_usage());
+}
+/****************************************************************************/
 void
 Ebuild::do_set_defaults()
 {
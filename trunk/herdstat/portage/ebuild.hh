@@ -71,6 +71,9 @@ namespace portage {
             /// Assign a new path.
             void assign(const std::string& path);
 
+            /// Get heap bytes held by our variables and version components.
+            util::MemoryUsage memory_usage() const;
+
         protected:
             /// Set default variables.
             virtual void do_set_defaults();
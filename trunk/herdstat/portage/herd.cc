@@ -61,6 +61,24 @@ Herd::~Herd() throw()
 {
 }
 /****************************************************************************/
+Herd&
+Herd::operator= (const Herd& that)
+{
+    Developers::operator=(that);
+    _name  = that._name;
+    _email = that._email;
+    _desc  = that._desc;
+    return *this;
+}
+/****************************************************************************/
+util::MemoryUsage
+Herd::memory_usage() const
+{
+    return (util::SetBase<Developer>::memory_usage() +
+            util::memory_usage(_name) + _email.memory_usage() +
+            util::memory_usage(_desc));
+}
+/****************************************************************************/
 Herds::Herds()
 {
 }
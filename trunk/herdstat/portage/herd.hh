@@ -139,6 +139,9 @@ namespace portage {
             /// Set herd description.
             inline void set_desc(const std::string &desc);
 
+            /// Get heap bytes held by this herd and its developers.
+            util::MemoryUsage memory_usage() const;
+
         private:
             std::string _name;
             GentooEmailAddress _email;
@@ -343,8 +346,22 @@ std::transform(herds.begin(), herds.end(),
             inline iterator find(const util::Regex& regex);
             inline const_iterator find(const util::Regex& regex) const;
             ///@}
+
+        private:
+            /* the Herd find() searches for: only the name (minus anything
+             * after '@'), without the email address parsing Herd(name) does */
+            static inline Herd key(const std::string& name);
     };
 
+    inline Herd
+    Herds::key(const std::string& name)
+    {
+        Herd herd;
+        const std::string::size_type pos = name.find('@');
+        herd.set_name(pos == std::string::npos ? name : name.substr(0, pos));
+        return herd;
+    }
+
     inline Herds::operator
     const Herds::container_type&() const
     {
@@ -354,13 +371,13 @@ std::transform(herds.begin(), herds.end(),
     inline Herds::iterator
     Herds::find(const std::string& h)
     {
-        return util::SetBase<Herd>::find(Herd(h));
+        return util::SetBase<Herd>::find(key(h));
     }
 
     inline Herds::const_iterator
     Herds::find(const std::string& h) const
     {
-        return util::SetBase<Herd>::find(Herd(h));
+        return util::SetBase<Herd>::find(key(h));
     }
     
     inline Herds::iterator
@@ -29,6 +29,7 @@
 #include <herdstat/exceptions.hh>
 #include <herdstat/util/string.hh>
 #include <herdstat/util/file.hh>
+#include <herdstat/util/profile.hh>
 #include <herdstat/xml/document.hh>
 #include <herdstat/portage/project_xml.hh>
 #include <herdstat/portage/herds_xml.hh>
@@ -64,20 +65,28 @@ HerdsXML::~HerdsXML() throw()
 {
 }
 /****************************************************************************/
+util::MemoryUsage
+HerdsXML::memory_usage() const
+{
+    return (_herds.memory_usage() + util::memory_usage(this->path()) +
+            util::memory_usage(_cvsdir));
+}
+/****************************************************************************/
 void
 HerdsXML::do_parse(const std::string& path)
 {
+    util::ProfileZone zone("portage::HerdsXML::parse()");
     this->timer().start();
 
     if      (not path.empty())      this->set_path(path);
     else if (this->path().empty())  this->set_path(_local_default);
 
-    BacktraceContext c("portage::HerdsXML::parse("+this->path()+")");
+    BacktraceContext c("portage::HerdsXML::parse(%s)", this->path());
 
     if (not util::is_file(this->path()))
         throw FileException(this->path());
 
-    this->parse_file(this->path().c_str());
+    this->parse_path(this->path());
 
     this->timer().stop();
 }
@@ -113,6 +122,9 @@ HerdsXML::start_element(const std::string& name,
     if (meter())
         ++*meter();
 
+    if (this->skipping())
+        return true;
+
     if (name == "herd")
         in_herd = true;
     else if (name == "name" and not in_maintainer)
@@ -141,8 +153,19 @@ HerdsXML::end_element(const std::string& name)
     if (meter())
         ++*meter();
 
+    if (this->skipping(name))
+        return true;
+
     if (name == "herd")
-        in_herd = false;
+    {
+        /* we may have skipped the end of any element inside <herd> */
+        in_herd = in_herd_name = in_herd_email = in_herd_desc = false;
+        in_maintainer = in_maintainer_name = in_maintainer_email = false;
+        in_maintainer_role = in_maintaining_prj = false;
+
+        if (this->selector() and this->selector()->complete())
+            return this->stop();
+    }
     else if (name == "name" and not in_maintainer)
         in_herd_name = false;
     else if (name == "email" and not in_maintainer)
@@ -170,7 +193,15 @@ HerdsXML::do_text(const std::string& text)
         ++*meter();
 
     if (in_herd_name)
+    {
+        if (this->selector() and not (*this->selector())(text))
+        {
+            this->skip_to_end_of("herd");
+            return true;
+        }
+
         _cur_herd = _herds.insert(Herd(text)).first;
+    }
     else if (in_herd_desc)
         const_cast<Herd&>(*_cur_herd).set_desc(text);
     else if (in_herd_email)
@@ -104,6 +104,9 @@ namespace portage {
             /// Were no herds found in herds.xml?
             inline bool empty() const;
 
+            /// Get heap bytes held by the parsed herds.
+            util::MemoryUsage memory_usage() const;
+
         protected:
             /** Parse herds.xml.
              * @param path Path to herds.xml (defaults to empty).
@@ -30,6 +30,8 @@
 #include <herdstat/util/misc.hh>
 #include <herdstat/util/string.hh>
 #include <herdstat/util/algorithm.hh>
+#include <herdstat/util/profile.hh>
+#include <herdstat/probes.hh>
 #include <herdstat/portage/functional.hh>
 #include <herdstat/portage/util.hh>
 #include <herdstat/portage/config.hh>
@@ -48,7 +50,7 @@ Keyword::maskc::maskc()
 Keyword::maskc&
 Keyword::maskc::operator=(const char mc)
 {
-    BacktraceContext c("portage::Keyword::maskc::operator=(" + std::string(1, mc) + ")");
+    BacktraceContext c("portage::Keyword::maskc::operator=(%s)", mc);
 
     if (std::strchr(_valid_masks, mc) == NULL)
         throw InvalidKeywordMask(mc);
@@ -74,23 +76,28 @@ Keyword::maskc::operator< (const maskc& that) const
 }
 /****************************************************************************/
 Keyword::Keyword(const std::string& kw)
-    : _arch(), _mask(), _valid_archs(GlobalConfig().archs())
+    : _arch(), _mask(), _valid_archs(&GlobalConfig().archs())
 {
-    BacktraceContext c("portage::Keyword::Keyword("+kw+")");
+    BacktraceContext c("portage::Keyword::Keyword(%s)", kw);
 
-    this->parse(kw);
-
-    if (not _valid_archs.count(_arch))
+    if (not this->parse(kw))
         throw InvalidArch(_arch);
 }
 /****************************************************************************/
-void
+Keyword::Keyword(const std::string& kw, bool& valid)
+    : _arch(), _mask(), _valid_archs(&GlobalConfig().archs())
+{
+    valid = this->parse(kw);
+}
+/****************************************************************************/
+bool
 Keyword::parse(const std::string& kw)
 {
     if (std::strchr(_valid_masks, kw[0]))
         _mask = kw[0];
 
-    _arch = (_mask.empty() ? kw : kw.substr(1));
+    _arch.assign(kw, (_mask.empty() ? 0 : 1), std::string::npos);
+    return (_valid_archs->count(_arch) != 0);
 }
 /****************************************************************************/
 Keywords::Keywords()
@@ -116,6 +123,13 @@ Keywords::~Keywords() throw()
 {
 }
 /****************************************************************************/
+util::MemoryUsage
+Keywords::memory_usage() const
+{
+    return (util::FlatSetBase<Keyword>::memory_usage() +
+            _ebuild.memory_usage() + util::memory_usage(_str));
+}
+/****************************************************************************/
 void
 Keywords::assign(const std::string& path)
 {
@@ -132,25 +146,68 @@ Keywords::assign(const Ebuild& e)
     this->format();
 }
 /****************************************************************************/
+bool
+Keywords::try_assign(const std::string& path)
+{
+    _ebuild.read(path);
+    if (not this->try_fill())
+        return false;
+    this->format();
+    return true;
+}
+/****************************************************************************/
+bool
+Keywords::try_assign(const Ebuild& e)
+{
+    _ebuild = e;
+    if (not this->try_fill())
+        return false;
+    this->format();
+    return true;
+}
+/****************************************************************************/
 void
 Keywords::fill()
 {
     BacktraceContext c("portage::Keywords::fill()");
 
-    if (_ebuild["KEYWORDS"].empty())
+    const std::string& keywords(_ebuild["KEYWORDS"]);
+    if (keywords.empty())
         throw Exception(_ebuild.path()+": no KEYWORDS variable defined");
 
     this->clear();
 
     /* split the keywords string, inserting each into our container */
-    util::split(_ebuild["KEYWORDS"],
-        std::inserter(this->container(), this->end()));
+    const util::SplitView parts(keywords);
+    util::SplitView::const_iterator i;
+    for (i = parts.begin() ; i != parts.end() ; ++i)
+        this->insert(this->end(), Keyword(i->str()));
+}
+/****************************************************************************/
+bool
+Keywords::try_fill()
+{
+    this->clear();
+
+    const util::SplitView parts(_ebuild["KEYWORDS"]);
+    util::SplitView::const_iterator i;
+    for (i = parts.begin() ; i != parts.end() ; ++i)
+    {
+        /* an arch we don't know about (eg one newer than our arch.list)
+         * shouldn't cost us the rest of the ebuild's keywords */
+        bool valid;
+        const Keyword kw(i->str(), valid);
+        if (valid)
+            this->insert(this->end(), kw);
+    }
+
+    return (not this->empty());
 }
 /****************************************************************************/
 void
 Keywords::format()
 {
-    static util::ColorMap cmap;
+    const util::ColorMap cmap;
 
     iterator i = this->begin();
     while (i != this->end())
@@ -186,21 +243,30 @@ struct NewPair
 
         p.first.assign(ebuild);
 
+        /* ebuilds without KEYWORDS are common; they just map to an empty
+         * set.  only an unreadable ebuild unwinds, and that's no reason to
+         * lose the rest of the package. */
+        bool keyworded = false;
         try
         {
-            p.second.assign(ebuild);
+            keyworded = p.second.try_assign(ebuild);
         }
-        catch (const Exception&)
+        catch (const FileException&)
         {
         }
 
+        if (not keyworded)
+            p.second.clear();
+
         return p;
     }
 };
 
 KeywordsMap::KeywordsMap(const std::string& pkgdir)
 {
-    BacktraceContext c("portage::KeywordsMap::KeywordsMap("+pkgdir+")");
+    BacktraceContext c("portage::KeywordsMap::KeywordsMap(%s)", pkgdir);
+    util::ProfileZone zone("portage::KeywordsMap::KeywordsMap()");
+    LIBHERDSTAT_PROBE1(keywords__entry, pkgdir.c_str());
 
     if (not util::is_dir(pkgdir))
         throw FileException(pkgdir);
@@ -208,7 +274,10 @@ KeywordsMap::KeywordsMap(const std::string& pkgdir)
     const util::Directory dir(pkgdir);
     util::transform_if(dir.begin(), dir.end(),
         std::inserter(this->container(), this->end()),
-        IsEbuild(), NewPair());;
+        IsEbuild(), NewPair());
+
+    LIBHERDSTAT_PROBE2(keywords__return, pkgdir.c_str(),
+        static_cast<long>(this->size()));
 }
 /****************************************************************************/
 KeywordsMap::~KeywordsMap() throw()
@@ -69,6 +69,13 @@ namespace portage {
              */
             Keyword(const std::string& kw);
 
+            /** Non-throwing constructor.
+             * @param kw keyword string.
+             * @param valid Set to whether @a kw is a valid keyword.  If not,
+             * the Keyword shouldn't be used.
+             */
+            Keyword(const std::string& kw, bool& valid);
+
             /// Get mask character (or nul byte if empty).
             char mask() const { return _mask; }
             /// Get architecture.
@@ -111,6 +118,10 @@ namespace portage {
             /// Is this a stable keyword?
             bool is_stable() const { return _mask.empty(); }
 
+            /// Get heap bytes held by this keyword.
+            util::MemoryUsage memory_usage() const
+            { return util::memory_usage(_arch); }
+
         private:
             // {{{ Keyword::maskc
             /**
@@ -180,13 +191,15 @@ namespace portage {
             // }}}
 
             /** Parse keyword.
-             * @exception InvalidKeywordMask
+             * @returns Whether the architecture is valid.
              */
-            void parse(const std::string& kw);
+            bool parse(const std::string& kw);
 
             std::string _arch;
             maskc _mask;
-            const Archs& _valid_archs;
+            /* a pointer, so keywords can be assigned (and kept in a
+             * vector) */
+            const Archs *_valid_archs;
             static const char * const _valid_masks;
     };
 
@@ -230,7 +243,7 @@ namespace portage {
      * string.
      */
 
-    class Keywords : public util::SetBase<Keyword>
+    class Keywords : public util::FlatSetBase<Keyword>
     {
         public:
             /// Default constructor.
@@ -263,6 +276,28 @@ namespace portage {
              */
             void assign(const Ebuild& e);
 
+            //@{
+            /** Non-throwing assign(), for bulk scans where ebuilds without
+             * (valid) keywords are normal.  Keywords with an unknown arch are
+             * skipped; the rest are kept.  Errors reading the ebuild are
+             * still thrown.
+             * @returns False if the ebuild has no valid keywords, in which
+             * case we're left empty.
+             * @exception FileException
+             */
+            bool try_assign(const std::string& path);
+            bool try_assign(const Ebuild& e);
+            //@}
+
+            /** Assign keywords from a range of keyword strings (eg when
+             * reading them back from a cache).  path() will be empty.
+             * @param first Beginning of range.
+             * @param last End of range.
+             * @exception InvalidArch
+             */
+            template <typename InputIterator>
+            void assign(InputIterator first, InputIterator last);
+
             /// Get formatted keywords string.
             inline const std::string& str() const;
 
@@ -276,8 +311,12 @@ namespace portage {
             /// Are all keywords stable?
             inline bool all_stable() const;
 
+            /// Get heap bytes held by the keywords and their ebuild.
+            util::MemoryUsage memory_usage() const;
+
         private:
             void fill();
+            bool try_fill();
             /// prepare keywords string
             void format();
 
@@ -285,6 +324,20 @@ namespace portage {
             std::string _str;
     };
 
+    template <typename InputIterator>
+    void
+    Keywords::assign(InputIterator first, InputIterator last)
+    {
+        _ebuild = Ebuild();
+        _str.clear();
+        this->clear();
+
+        for ( ; first != last ; ++first)
+            this->insert(Keyword(*first));
+
+        this->format();
+    }
+
     inline const std::string& Keywords::str() const { return _str; }
     inline const std::string& Keywords::path() const { return _ebuild.path(); }
 
@@ -52,7 +52,7 @@ License::~License() throw()
 void
 License::parse()
 {
-    BacktraceContext c("portage::License::parse("+_license+")");
+    BacktraceContext c("portage::License::parse(%s)", _license);
 
     _license.erase(std::remove(_license.begin(),
                 _license.end(), '|'), _license.end());
@@ -78,14 +78,16 @@ License::parse()
 
     if (_validate)
     {
-        std::vector<std::string> parts;
-        std::vector<std::string>::iterator i;
-        util::split(_license, std::back_inserter(parts));
+        std::string path(GlobalConfig().portdir()+"/licenses/");
+        const std::string::size_type len = path.size();
+
+        const util::SplitView parts(_license);
+        util::SplitView::const_iterator i;
         for (i = parts.begin() ; i != parts.end() ; ++i)
         {
-            if (not util::file_exists(GlobalConfig().portdir()+
-                    "/licenses/"+(*i)))
-                throw QAException(*i);
+            path.replace(len, std::string::npos, i->data(), i->size());
+            if (not util::file_exists(path))
+                throw QAException(i->str());
         }
     }
 }
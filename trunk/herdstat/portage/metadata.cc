@@ -66,6 +66,13 @@ Metadata::~Metadata() throw()
     if (_devs) delete _devs;
 }
 /****************************************************************************/
+util::MemoryUsage
+Metadata::memory_usage() const
+{
+    return (util::memory_usage(_pkg) + util::memory_usage(_longdesc) +
+            util::cache_usage(_herds) + util::cache_usage(_devs));
+}
+/****************************************************************************/
 } // namespace portage
 } // namespace herdstat
 
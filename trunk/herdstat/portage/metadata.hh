@@ -103,6 +103,12 @@ namespace portage {
             inline bool operator!=(const Metadata& that) const;
             ///@}
 
+            /** Get heap bytes held by this metadata.  The herds and
+             * developers are allocated on first use and are counted as
+             * caches.
+             */
+            util::MemoryUsage memory_usage() const;
+
         private:
             std::string _pkg;
             std::string _longdesc;
@@ -29,6 +29,7 @@
 #include <herdstat/exceptions.hh>
 #include <herdstat/util/string.hh>
 #include <herdstat/util/file.hh>
+#include <herdstat/util/profile.hh>
 #include <herdstat/portage/metadata_xml.hh>
 
 namespace herdstat {
@@ -56,12 +57,14 @@ MetadataXML::~MetadataXML() throw()
 void
 MetadataXML::do_parse(const std::string& path)
 {
+    util::ProfileZone zone("portage::MetadataXML::parse()");
+
     if (not path.empty()) this->set_path(path);
 
-    BacktraceContext c("portage::MetadataXML::parse("+this->path()+")");
+    BacktraceContext c("portage::MetadataXML::parse(%s)", this->path());
 
     if (not util::file_exists(this->path())) throw FileException(this->path());
-    this->parse_file(this->path().c_str());
+    this->parse_path(this->path());
 
     if (_data.longdesc().empty() and not _longdesc.empty())
         _data.set_longdesc(_longdesc);
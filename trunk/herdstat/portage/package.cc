@@ -57,6 +57,20 @@ Package::~Package() throw()
     if (_pkgdir) delete _pkgdir;
 }
 /****************************************************************************/
+util::MemoryUsage
+Package::memory_usage() const
+{
+    util::MemoryUsage m;
+    m += util::memory_usage(_name);
+    m += util::memory_usage(_cat);
+    m += util::memory_usage(_dir);
+    m += util::memory_usage(_full);
+    m += util::memory_usage(_path);
+    m += util::cache_usage(_kwmap);
+    m += util::cache_usage(_pkgdir);
+    return m;
+}
+/****************************************************************************/
 Package&
 Package::operator=(const Package& that)
 {
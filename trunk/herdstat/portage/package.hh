@@ -137,6 +137,11 @@ namespace portage {
             inline bool operator!=(const util::Regex& re) const;
             ///@}
 
+            /** Get heap bytes held by this package.  The KeywordsMap and
+             * PackageDirectory objects, if loaded, are counted as caches.
+             */
+            util::MemoryUsage memory_usage() const;
+
         private:
             std::string _name;
             std::string _cat;
@@ -159,10 +164,7 @@ namespace portage {
     { assert(not _path.empty()); return _path; }
 
     inline bool Package::in_overlay() const
-    {
-        static const std::string& portdir(GlobalConfig().portdir());
-        return (_dir != portdir);
-    }
+    { return (_dir != GlobalConfig().portdir()); }
 
     inline bool
     Package::operator< (const Package& that) const
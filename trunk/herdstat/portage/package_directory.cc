@@ -61,6 +61,12 @@ PackageDirectory::~PackageDirectory() throw()
     if (_ebuilds) delete _ebuilds;
 }
 /****************************************************************************/
+util::MemoryUsage
+PackageDirectory::memory_usage() const
+{
+    return (util::Directory::memory_usage() + util::cache_usage(_ebuilds));
+}
+/****************************************************************************/
 } // namespace portage
 } // namespace herdstat
 
@@ -80,6 +80,11 @@ namespace portage {
             /// Get a vector of portage::Ebuild's representing each ebuild.
             inline const std::vector<Ebuild>& ebuilds() const;
 
+            /** Get heap bytes held by this package directory.  The ebuilds,
+             * if loaded, are counted as a cache.
+             */
+            util::MemoryUsage memory_usage() const;
+
         private:
             mutable std::vector<Ebuild> * _ebuilds;
     };
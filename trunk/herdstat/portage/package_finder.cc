@@ -42,6 +42,18 @@ const std::vector<Package>&
 PackageFinder::operator()(const std::string& criteria,
                           util::ProgressMeter *progress)
 {
+    if (not this->try_find(criteria, progress))
+        throw NonExistentPkg(criteria);
+
+    return _results;
+}
+/****************************************************************************/
+bool
+PackageFinder::try_find(const std::string& criteria,
+                        util::ProgressMeter *progress)
+{
+    util::ProfileZone zone("portage::PackageFinder::find(std::string)");
+
     /* literal searches allow us to use a little optimization hack - we can
      * simply check if the criteria exists in portdir or any of the overlays */
 
@@ -62,9 +74,9 @@ PackageFinder::operator()(const std::string& criteria,
     }
 
     if (_results.empty())
-        return find(criteria, progress);
+        return this->try_find<std::string>(criteria, progress);
 
-    return _results;
+    return true;
 }
 /****************************************************************************/
 } // namespace portage
@@ -33,6 +33,7 @@
  */
 
 #include <herdstat/util/timer.hh>
+#include <herdstat/util/profile.hh>
 #include <herdstat/util/algorithm.hh>
 #include <herdstat/portage/util.hh>
 #include <herdstat/portage/package_list.hh>
@@ -81,6 +82,16 @@ namespace portage {
             const std::vector<Package>&
             find(const T& v, util::ProgressMeter *progress = NULL);
 
+            /** Non-throwing find(), for bulk lookups where a miss is
+             * normal.  Matches are appended to results().
+             * @param v const reference to either a std::string or a
+             * util::Regex.
+             * @param progress Progress meter to use (defaults to NULL).
+             * @returns True if there are any results.
+             */
+            template <typename T>
+            bool try_find(const T& v, util::ProgressMeter *progress = NULL);
+
             /** Perform search for literal string.  Does some possible
              * optimizations, otherwise just calls find().
              * @param v literal string.
@@ -104,6 +115,19 @@ namespace portage {
             operator()(const util::Regex& v, util::ProgressMeter *progress = NULL)
             { return find(v, progress); }
 
+            /** Non-throwing operator()(const std::string&).
+             * @param v literal string.
+             * @param progress Progress meter to use (defaults to NULL).
+             * @returns True if there are any results.
+             */
+            bool try_find(const std::string& v,
+                          util::ProgressMeter *progress = NULL);
+
+            /// char * overload that calls try_find(const std::string&).
+            inline bool
+            try_find(const char * const v, util::ProgressMeter *progress = NULL)
+            { return try_find(std::string(v), progress); }
+
         private:
             struct IsValid
                 : std::binary_function<Package, util::ProgressMeter *, bool>
@@ -131,6 +155,17 @@ namespace portage {
     const std::vector<Package>&
     PackageFinder::find(const T& v, util::ProgressMeter *progress)
     {
+        if (not this->try_find<T>(v, progress))
+            throw NonExistentPkg(v);
+
+        return _results;
+    }
+
+    template <typename T>
+    bool
+    PackageFinder::try_find(const T& v, util::ProgressMeter *progress)
+    {
+        util::ProfileZone zone("portage::PackageFinder::find()");
         _timer.start();
 
         util::copy_if(_pkglist.begin(), _pkglist.end(),
@@ -141,10 +176,7 @@ namespace portage {
 
         _timer.stop();
 
-        if (_results.empty())
-            throw NonExistentPkg(v);
-
-        return _results;
+        return (not _results.empty());
     }
 
 } // namespace portage
@@ -24,6 +24,7 @@
 # include "config.h"
 #endif
 
+#include <herdstat/util/profile.hh>
 #include <herdstat/portage/package_list.hh>
 
 namespace herdstat {
@@ -55,6 +56,7 @@ void
 PackageList::fill(util::ProgressMeter *progress)
 {
     BacktraceContext c("herdstat::portage::PackageList::fill()");
+    util::ProfileZone zone("portage::PackageList::fill()");
 
     if (_filled)
         return;
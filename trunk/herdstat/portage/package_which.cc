@@ -43,6 +43,7 @@ PackageWhich::operator()(const std::vector<Package>& finder_results,
                          util::ProgressMeter *progress)
 {
     BacktraceContext c("herdstat::portage::PackageWhich::operator()(std::vector<Package>)");
+    util::ProfileZone zone("portage::PackageWhich::operator()()");
 
     /* Loop through the results only keeping the newest of packages */
     std::vector<Package> pkgs;
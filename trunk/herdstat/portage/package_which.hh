@@ -101,7 +101,9 @@ namespace portage {
                              const std::string& portdir,
                              util::ProgressMeter *progress)
     {
-        BacktraceContext c("herdstat::portage::PackageWhich::operator()("+pkg+", "+portdir+")");
+        BacktraceContext c("herdstat::portage::PackageWhich::operator()(%s, %s)",
+            pkg, portdir);
+        util::ProfileZone zone("portage::PackageWhich::operator()()");
 
         if (progress)
             ++*progress;
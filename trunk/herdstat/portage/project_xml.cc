@@ -25,6 +25,7 @@
 #endif
 
 #include <iostream>
+#include <herdstat/util/profile.hh>
 #include <herdstat/util/string.hh>
 #include <herdstat/util/file.hh>
 #include <herdstat/portage/project_xml.hh>
@@ -36,12 +37,31 @@ namespace portage {
 /*** static members *********************************************************/
 const char * const ProjectXML::_baseURL = "http://www.gentoo.org/cgi-bin/viewcvs.cgi/*checkout*/xml/htdocs%s?rev=HEAD&root=gentoo&content-type=text/plain";
 const char * const ProjectXML::_baseLocal = "%s/gentoo/xml/htdocs/%s";
-std::set<std::string> ProjectXML::_parsed;
 /****************************************************************************/
 ProjectXML::ProjectXML(const std::string& path, const std::string& cvsdir,
                          bool force_fetch)
     : _devs(), _cvsdir(cvsdir), _force_fetch(force_fetch),
-      in_sub(false), in_dev(false), in_task(false), _cur_role()
+      in_sub(false), in_dev(false), in_task(false), _cur_role(),
+      _parsed_local(), _parsed(_parsed_local)
+{
+    this->init(path);
+}
+/****************************************************************************/
+ProjectXML::ProjectXML(const std::string& path, const std::string& cvsdir,
+                       bool force_fetch, std::set<std::string>& parsed)
+    : _devs(), _cvsdir(cvsdir), _force_fetch(force_fetch),
+      in_sub(false), in_dev(false), in_task(false), _cur_role(),
+      _parsed_local(), _parsed(parsed)
+{
+    this->init(path);
+}
+/****************************************************************************/
+ProjectXML::~ProjectXML() throw()
+{
+}
+/****************************************************************************/
+void
+ProjectXML::init(const std::string& path)
 {
     if (_cvsdir.empty())
     {
@@ -61,14 +81,10 @@ ProjectXML::ProjectXML(const std::string& path, const std::string& cvsdir,
     this->parse();
 }
 /****************************************************************************/
-ProjectXML::~ProjectXML() throw()
-{
-}
-/****************************************************************************/
 void
 ProjectXML::do_fetch(const std::string& p) const
 {
-    BacktraceContext c("portage::ProjectXML::do_fetch("+p+")");
+    BacktraceContext c("portage::ProjectXML::do_fetch(%s)", p);
 
     if (not _cvsdir.empty())
         return;
@@ -115,9 +131,11 @@ ProjectXML::do_fetch(const std::string& p) const
 void
 ProjectXML::do_parse(const std::string& path)
 {
+    util::ProfileZone zone("portage::ProjectXML::parse()");
+
     if (not path.empty()) this->set_path(path);
 
-    BacktraceContext c("portage::ProjectXML::parse("+this->path()+")");
+    BacktraceContext c("portage::ProjectXML::parse(%s)", this->path());
 
     if (not util::is_file(this->path()))
         throw FileException(this->path());
@@ -127,7 +145,7 @@ ProjectXML::do_parse(const std::string& path)
     if (not _parsed.insert(this->path()).second)
         return;
 
-    this->parse_file(this->path().c_str());
+    this->parse_path(this->path());
 }
 /****************************************************************************/
 bool
@@ -152,7 +170,7 @@ ProjectXML::start_element(const std::string& name, const attrs_type& attrs)
             {
                 in_sub = true;
 
-                ProjectXML mp(pos->second, _cvsdir, _force_fetch);
+                ProjectXML mp(pos->second, _cvsdir, _force_fetch, _parsed);
                 mp.set_meter(this->meter());
                 Herd::const_iterator i;
                 for (i = mp.devs().begin() ; i != mp.devs().end() ; ++i)
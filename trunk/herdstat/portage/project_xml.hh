@@ -103,6 +103,14 @@ namespace portage {
             ///@}
 
         private:
+            /** Constructor for subprojects; shares the set of already
+             * parsed files with the ProjectXML that references it.
+             */
+            ProjectXML(const std::string& path, const std::string& cvsdir,
+                       bool force_fetch, std::set<std::string>& parsed);
+
+            void init(const std::string& path);
+
             Herd _devs;
             const std::string& _cvsdir;
             const bool _force_fetch;
@@ -111,8 +119,11 @@ namespace portage {
             static const char * const _baseURL;
             static const char * const _baseLocal;
             /* for keeping track of what we've parsed already
-             * to prevent infinite recursion. */
-            static std::set<std::string> _parsed;
+             * to prevent infinite recursion.  owned by the top-level
+             * instance so that concurrent and subsequent instances
+             * don't interfere with each other. */
+            std::set<std::string> _parsed_local;
+            std::set<std::string>& _parsed;
     };
 
     inline const Herd& ProjectXML::devs() const { return _devs; }
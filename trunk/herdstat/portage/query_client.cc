@@ -0,0 +1,224 @@
+/*
+ * libherdstat -- herdstat/portage/query_client.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <herdstat/exceptions.hh>
+#include <herdstat/io/binary_stream.hh>
+#include <herdstat/portage/serialize.hh>
+#include <herdstat/portage/query_protocol.hh>
+#include <herdstat/portage/query_server.hh>
+#include <herdstat/portage/query_client.hh>
+
+/* seconds to wait for an answer before giving up on the server */
+#define QUERY_CLIENT_TIMEOUT    30
+
+namespace herdstat {
+namespace portage {
+/****************************************************************************/
+QueryClient::QueryClient(const std::string& path)
+    : _path(path.empty() ? QueryServer::default_socket() : path),
+      _local(NULL), _remote(false)
+{
+}
+/****************************************************************************/
+QueryClient::~QueryClient() throw()
+{
+    delete _local;
+}
+/****************************************************************************/
+QueryEngine&
+QueryClient::local()
+{
+    if (not _local)
+        _local = new QueryEngine();
+    return *_local;
+}
+/****************************************************************************/
+int
+QueryClient::send(char op, const std::string& arg, bool regex,
+                  io::BinaryIStream& in)
+{
+    struct sockaddr_un addr;
+    if (_path.size() >= sizeof(addr.sun_path))
+        return -1;
+
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, _path.c_str());
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    if (::connect(fd, reinterpret_cast<struct sockaddr *>(&addr),
+                  sizeof(addr)) != 0 or not query::peer_is_us(fd))
+    {
+        /* no server, or not one of ours */
+        ::close(fd);
+        return -1;
+    }
+
+    struct timeval timeout = { QUERY_CLIENT_TIMEOUT, 0 };
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    query::MessageOStream out;
+    out.write_raw(query::magic, sizeof(query::magic));
+    out << query::version << this->local().config() << op << regex << arg;
+
+    /* the end of our request is the end of the stream */
+    if (not out.send(fd) or ::shutdown(fd, SHUT_WR) != 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+
+    /* the stream owns the connection from here on */
+    in.open(fd);
+
+    char status = 0;
+    if (not (in >> status))
+        return -1;
+
+    return status;
+}
+/****************************************************************************/
+template <typename T>
+int
+QueryClient::ask(char op, const std::string& arg, bool regex, T& result)
+{
+    io::BinaryIStream in;
+    const int status = this->send(op, arg, regex, in);
+
+    switch (status)
+    {
+        case query::status_ok:
+            if (not (in >> result))
+                break;
+            _remote = true;
+            return status;
+
+        case query::status_none:
+            _remote = true;
+            return status;
+
+        case query::status_error:
+        {
+            std::string msg;
+            if (not (in >> msg))
+                break;
+            _remote = true;
+            throw Exception("%s", msg.c_str());
+        }
+    }
+
+    /* answer it ourselves */
+    _remote = false;
+    return -1;
+}
+/****************************************************************************/
+bool
+QueryClient::find(const std::string& criteria, bool regex,
+                  std::vector<Package>& results)
+{
+    std::vector<Package> v;
+    switch (this->ask(query::op_find, criteria, regex, v))
+    {
+        case query::status_ok:
+            results.insert(results.end(), v.begin(), v.end());
+            return true;
+        case query::status_none:
+            return false;
+    }
+
+    return this->local().find(criteria, regex, results);
+}
+/****************************************************************************/
+bool
+QueryClient::which(const std::string& criteria, bool regex,
+                   std::vector<std::string>& results)
+{
+    std::vector<std::string> v;
+    switch (this->ask(query::op_which, criteria, regex, v))
+    {
+        case query::status_ok:
+            results.insert(results.end(), v.begin(), v.end());
+            return true;
+        case query::status_none:
+            return false;
+    }
+
+    return this->local().which(criteria, regex, results);
+}
+/****************************************************************************/
+bool
+QueryClient::herd(const std::string& name, Herd& herd)
+{
+    switch (this->ask(query::op_herd, name, false, herd))
+    {
+        case query::status_ok:
+            return true;
+        case query::status_none:
+            return false;
+    }
+
+    return this->local().herd(name, herd);
+}
+/****************************************************************************/
+bool
+QueryClient::developer(const std::string& user, Developer& dev)
+{
+    switch (this->ask(query::op_developer, user, false, dev))
+    {
+        case query::status_ok:
+            return true;
+        case query::status_none:
+            return false;
+    }
+
+    return this->local().developer(user, dev);
+}
+/****************************************************************************/
+bool
+QueryClient::reload()
+{
+    this->local().reset();
+
+    io::BinaryIStream in;
+    return (this->send(query::op_reload, "", false, in) == query::status_ok);
+}
+/****************************************************************************/
+} // namespace portage
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,143 @@
+/*
+ * libherdstat -- herdstat/portage/query_client.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_PORTAGE_QUERY_CLIENT_HH
+#define _HAVE_PORTAGE_QUERY_CLIENT_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/portage/query_client.hh
+ * @brief Defines the QueryClient class.
+ */
+
+#include <string>
+#include <vector>
+#include <herdstat/noncopyable.hh>
+#include <herdstat/portage/query_engine.hh>
+
+namespace herdstat {
+
+namespace io { class BinaryIStream; }
+
+namespace portage {
+
+    /**
+     * @class QueryClient query_client.hh herdstat/portage/query_client.hh
+     * @brief Sends queries to a QueryServer, answering them in-process if
+     * there isn't one.
+     *
+     * The interface is that of QueryEngine.  Each query tries the server
+     * first; if nothing is listening on the socket, the server is running
+     * as another user, speaks a different protocol version or is
+     * configured differently, or the connection breaks, the query is
+     * answered by a local QueryEngine instead (created on first use, and
+     * its data loaded when first needed).  Errors the server reports (eg a
+     * bad regular expression) are thrown as with a local query.
+     *
+     * The server answers according to its own configuration, so each
+     * query carries the local engine's (see local() and
+     * QueryEngine::config()).  Set up the local engine the same way as
+     * the server's, or the server won't answer.
+     *
+     * @section example Example
+     *
+@code
+herdstat::xml::GlobalInit();
+
+herdstat::portage::QueryClient client;
+std::vector<std::string> ebuilds;
+if (client.which("vim", false, ebuilds))
+    std::copy(ebuilds.begin(), ebuilds.end(),
+        std::ostream_iterator<std::string>(std::cout, "\n"));
+std::cout << (client.remote() ? "answered by server" : "answered locally")
+    << std::endl;
+@endcode
+     */
+
+    class QueryClient : private Noncopyable
+    {
+        public:
+            /** Constructor.
+             * @param path Path of server socket (defaults to
+             * QueryServer::default_socket()).
+             */
+            QueryClient(const std::string& path = "");
+
+            /// Destructor.
+            ~QueryClient() throw();
+
+            /// Get path of server socket.
+            const std::string& path() const { return _path; }
+
+            /** Was the last query answered by the server (as opposed to
+             * locally)?
+             */
+            bool remote() const { return _remote; }
+
+            /** Get the engine used when there's no server (creating it if
+             * needed).
+             */
+            QueryEngine& local();
+
+            ///@{
+            /** See QueryEngine.
+             * @exception Exception
+             */
+            bool find(const std::string& criteria, bool regex,
+                      std::vector<Package>& results);
+            bool which(const std::string& criteria, bool regex,
+                       std::vector<std::string>& results);
+            bool herd(const std::string& name, Herd& herd);
+            bool developer(const std::string& user, Developer& dev);
+            ///@}
+
+            /** Ask the server to forget what it has loaded (see
+             * QueryEngine::reset()); the local engine is reset too.
+             * @returns True if the server did.
+             */
+            bool reload();
+
+        private:
+            /* send a query; returns the server's status with any result
+             * left in the stream, or -1 if there's no usable server */
+            int send(char op, const std::string& arg, bool regex,
+                     io::BinaryIStream& in);
+
+            /* send a query and read its result; returns status_ok,
+             * status_none or -1 */
+            template <typename T>
+            int ask(char op, const std::string& arg, bool regex, T& result);
+
+            const std::string _path;
+            QueryEngine *_local;
+            bool _remote;
+    };
+
+} // namespace portage
+} // namespace herdstat
+
+#endif /* _HAVE_PORTAGE_QUERY_CLIENT_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,305 @@
+/*
+ * libherdstat -- herdstat/portage/query_engine.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <herdstat/exceptions.hh>
+#include <herdstat/util/regex.hh>
+#include <herdstat/util/profile.hh>
+#include <herdstat/portage/config.hh>
+#include <herdstat/portage/package_finder.hh>
+#include <herdstat/portage/package_which.hh>
+#include <herdstat/portage/data_source_loader.hh>
+#include <herdstat/portage/query_engine.hh>
+
+namespace herdstat {
+namespace portage {
+/****************************************************************************/
+QueryEngine::QueryEngine()
+    : _herds_path(), _userinfo_path(), _devaway_path(), _pkgs(NULL),
+      _herds(NULL), _userinfo(NULL), _devaway(NULL),
+      _userinfo_checked(false), _devaway_checked(false)
+{
+}
+/****************************************************************************/
+QueryEngine::~QueryEngine() throw()
+{
+    this->reset();
+}
+/****************************************************************************/
+void
+QueryEngine::reset()
+{
+    delete _pkgs;
+    delete _herds;
+    delete _userinfo;
+    delete _devaway;
+
+    _pkgs = NULL;
+    _herds = NULL;
+    _userinfo = NULL;
+    _devaway = NULL;
+    _userinfo_checked = _devaway_checked = false;
+}
+/****************************************************************************/
+std::vector<std::string>
+QueryEngine::config() const
+{
+    const Config& config(GlobalConfig());
+
+    std::vector<std::string> result;
+    result.push_back(config.portdir());
+    result.push_back(_herds_path);
+    result.push_back(_userinfo_path);
+    result.push_back(_devaway_path);
+    result.insert(result.end(), config.overlays().begin(),
+                  config.overlays().end());
+    return result;
+}
+/****************************************************************************/
+void
+QueryEngine::load()
+{
+    util::ProfileZone zone("portage::QueryEngine::load()");
+
+    /* anything that fails to load is dropped, so it's loaded again (and
+     * the error reported) on first use */
+    DataSourceLoader loader;
+
+    if (not _pkgs)
+        loader.add(*(_pkgs = new PackageList(false)));
+    if (not _herds)
+        loader.add(*(_herds = new HerdsXML()), _herds_path);
+    if (not _userinfo_checked)
+        loader.add(*(_userinfo = new UserinfoXML()), _userinfo_path);
+    if (not _devaway_checked)
+        loader.add(*(_devaway = new DevawayXML()), _devaway_path);
+
+    loader.start();
+    while (true)
+    {
+        try
+        {
+            if (not loader.wait_next())
+                break;
+        }
+        catch (const Exception&)
+        {
+            /* keep waiting for the rest */
+        }
+    }
+
+    if (_pkgs and not _pkgs->filled())
+    {
+        delete _pkgs;
+        _pkgs = NULL;
+    }
+    if (_herds and not _herds->parsed())
+    {
+        delete _herds;
+        _herds = NULL;
+    }
+    if (_userinfo and not _userinfo->parsed())
+    {
+        delete _userinfo;
+        _userinfo = NULL;
+    }
+    if (_devaway and not _devaway->parsed())
+    {
+        delete _devaway;
+        _devaway = NULL;
+    }
+
+    _userinfo_checked = (_userinfo != NULL);
+    _devaway_checked = (_devaway != NULL);
+}
+/****************************************************************************/
+const PackageList&
+QueryEngine::packages()
+{
+    if (not _pkgs)
+    {
+        PackageList *pkgs = new PackageList(false);
+        try
+        {
+            pkgs->fill();
+        }
+        catch (...)
+        {
+            delete pkgs;
+            throw;
+        }
+        _pkgs = pkgs;
+    }
+
+    return *_pkgs;
+}
+/****************************************************************************/
+const HerdsXML&
+QueryEngine::herds_xml()
+{
+    if (not _herds)
+    {
+        HerdsXML *herds = new HerdsXML();
+        try
+        {
+            herds->parse(_herds_path);
+        }
+        catch (...)
+        {
+            delete herds;
+            throw;
+        }
+        _herds = herds;
+    }
+
+    return *_herds;
+}
+/****************************************************************************/
+const UserinfoXML *
+QueryEngine::userinfo_xml()
+{
+    if (not _userinfo_checked)
+    {
+        _userinfo_checked = true;
+
+        if (util::is_file(_userinfo_path))
+        {
+            UserinfoXML *userinfo = new UserinfoXML();
+            try
+            {
+                userinfo->parse(_userinfo_path);
+            }
+            catch (...)
+            {
+                delete userinfo;
+                throw;
+            }
+            _userinfo = userinfo;
+        }
+    }
+
+    return _userinfo;
+}
+/****************************************************************************/
+const DevawayXML *
+QueryEngine::devaway_xml()
+{
+    if (not _devaway_checked)
+    {
+        _devaway_checked = true;
+
+        DevawayXML *devaway = new DevawayXML();
+        try
+        {
+            devaway->parse(_devaway_path);
+            _devaway = devaway;
+        }
+        catch (const FileException&)
+        {
+            /* doesn't exist */
+            delete devaway;
+        }
+        catch (...)
+        {
+            delete devaway;
+            throw;
+        }
+    }
+
+    return _devaway;
+}
+/****************************************************************************/
+bool
+QueryEngine::find(const std::string& criteria, bool regex,
+                  std::vector<Package>& results)
+{
+    BacktraceContext c("portage::QueryEngine::find(%s)", criteria);
+    util::ProfileZone zone("portage::QueryEngine::find()");
+
+    PackageFinder finder(this->packages());
+    const bool found = (regex ?
+        finder.try_find(util::Regex(criteria)) : finder.try_find(criteria));
+
+    results.insert(results.end(), finder.results().begin(),
+                   finder.results().end());
+    return found;
+}
+/****************************************************************************/
+bool
+QueryEngine::which(const std::string& criteria, bool regex,
+                   std::vector<std::string>& results)
+{
+    BacktraceContext c("portage::QueryEngine::which(%s)", criteria);
+    util::ProfileZone zone("portage::QueryEngine::which()");
+
+    std::vector<Package> pkgs;
+    if (not this->find(criteria, regex, pkgs))
+        return false;
+
+    PackageWhich which;
+    which(pkgs);
+
+    results.insert(results.end(), which.results().begin(),
+                   which.results().end());
+    return (not which.results().empty());
+}
+/****************************************************************************/
+bool
+QueryEngine::herd(const std::string& name, Herd& herd)
+{
+    BacktraceContext c("portage::QueryEngine::herd(%s)", name);
+
+    const Herds& herds(this->herds_xml().herds());
+    const Herds::const_iterator i = herds.find(name);
+    if (i == herds.end())
+        return false;
+
+    herd = *i;
+    return true;
+}
+/****************************************************************************/
+bool
+QueryEngine::developer(const std::string& user, Developer& dev)
+{
+    BacktraceContext c("portage::QueryEngine::developer(%s)", user);
+
+    /* only the user name; Developer(user) would make up an email address */
+    dev = Developer();
+    dev.set_user(user.substr(0, user.find('@')));
+
+    this->herds_xml().fill_developer(dev);
+    if (const UserinfoXML *userinfo = this->userinfo_xml())
+        userinfo->fill_developer(dev);
+    if (const DevawayXML *devaway = this->devaway_xml())
+        devaway->fill_developer(dev);
+
+    return (not dev.herds().empty() or not dev.name().empty() or
+            not dev.email().empty() or dev.is_away());
+}
+/****************************************************************************/
+} // namespace portage
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,182 @@
+/*
+ * libherdstat -- herdstat/portage/query_engine.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_PORTAGE_QUERY_ENGINE_HH
+#define _HAVE_PORTAGE_QUERY_ENGINE_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/portage/query_engine.hh
+ * @brief Defines the QueryEngine class.
+ */
+
+#include <string>
+#include <vector>
+#include <herdstat/noncopyable.hh>
+#include <herdstat/portage/package_list.hh>
+#include <herdstat/portage/herds_xml.hh>
+#include <herdstat/portage/userinfo_xml.hh>
+#include <herdstat/portage/devaway_xml.hh>
+
+namespace herdstat {
+namespace portage {
+
+    /**
+     * @class QueryEngine query_engine.hh herdstat/portage/query_engine.hh
+     * @brief Answers package, herd and developer queries, keeping the
+     * package list and parsed data sources around between queries.
+     *
+     * Everything is loaded on first use, so a query only pays for what it
+     * needs (a package search never parses herds.xml).  load() loads it
+     * all up front, in parallel.  userinfo.xml and devaway.xml are optional;
+     * developer lookups skip them if they don't exist.
+     *
+     * A QueryEngine is what a QueryServer answers queries with and what a
+     * QueryClient falls back to when there's no server.  It is not
+     * thread-safe.
+     *
+     * @section example Example
+     *
+@code
+herdstat::xml::GlobalInit();
+
+herdstat::portage::QueryEngine engine;
+std::vector<herdstat::portage::Package> pkgs;
+if (engine.find("vim", false, pkgs))
+    ...
+herdstat::portage::Herd herd;
+if (engine.herd("netmon", herd))
+    ...
+@endcode
+     */
+
+    class QueryEngine : private Noncopyable
+    {
+        public:
+            /// Default constructor.
+            QueryEngine();
+
+            /// Destructor.
+            ~QueryEngine() throw();
+
+            ///@{
+            /** Set path of a data source (defaults to empty, ie the
+             * default location).  Takes effect the next time it's loaded.
+             * @param path Path.
+             */
+            void set_herds_xml(const std::string& path)
+            { _herds_path.assign(path); }
+            void set_userinfo_xml(const std::string& path)
+            { _userinfo_path.assign(path); }
+            void set_devaway_xml(const std::string& path)
+            { _devaway_path.assign(path); }
+            ///@}
+
+            /** Load everything now (in parallel) rather than on first use.
+             * Anything that fails to load is tried again, and the error
+             * reported, on first use.  xml::GlobalInit() must have been
+             * called beforehand.
+             * @exception ErrnoException if a thread can't be started.
+             */
+            void load();
+
+            /** Forget everything loaded; it's loaded again on next use (eg
+             * after the tree has been synced).
+             */
+            void reset();
+
+            /** Get what answers depend on besides the query itself:
+             * PORTDIR, the data source paths and the overlays, in that
+             * order.  Two engines with the same configuration give the
+             * same answers.
+             */
+            std::vector<std::string> config() const;
+
+            /** Find packages matching the given criteria (see
+             * PackageFinder).
+             * @param criteria Package name, category/package or regular
+             * expression.
+             * @param regex Is @a criteria a regular expression?
+             * @param results Matches are appended to it.
+             * @returns True if anything matched.
+             * @exception Exception
+             */
+            bool find(const std::string& criteria, bool regex,
+                      std::vector<Package>& results);
+
+            /** Find the latest ebuild of each package matching the given
+             * criteria (see PackageWhich).
+             * @param criteria Package name, category/package or regular
+             * expression.
+             * @param regex Is @a criteria a regular expression?
+             * @param results Ebuild paths are appended to it.
+             * @returns True if anything matched.
+             * @exception Exception
+             */
+            bool which(const std::string& criteria, bool regex,
+                       std::vector<std::string>& results);
+
+            /** Look up a herd in herds.xml.
+             * @param name %Herd name.
+             * @param herd Set to the herd if found.
+             * @returns True if found.
+             * @exception Exception
+             */
+            bool herd(const std::string& name, Herd& herd);
+
+            /** Look up a developer in herds.xml, userinfo.xml and
+             * devaway.xml.
+             * @param user User name.
+             * @param dev Filled with whatever the data sources know.
+             * @returns True if any of them knows the developer.
+             * @exception Exception
+             */
+            bool developer(const std::string& user, Developer& dev);
+
+            /// Get the package list (filling it if needed).
+            const PackageList& packages();
+
+            /// Get herds.xml (parsing it if needed).
+            const HerdsXML& herds_xml();
+
+        private:
+            /* get userinfo.xml/devaway.xml, or NULL if they don't exist */
+            const UserinfoXML *userinfo_xml();
+            const DevawayXML *devaway_xml();
+
+            std::string _herds_path, _userinfo_path, _devaway_path;
+            PackageList *_pkgs;
+            HerdsXML *_herds;
+            UserinfoXML *_userinfo;
+            DevawayXML *_devaway;
+            bool _userinfo_checked, _devaway_checked;
+    };
+
+} // namespace portage
+} // namespace herdstat
+
+#endif /* _HAVE_PORTAGE_QUERY_ENGINE_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,80 @@
+/*
+ * libherdstat -- herdstat/portage/query_protocol.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cerrno>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <herdstat/portage/query_protocol.hh>
+
+namespace herdstat {
+namespace portage {
+namespace query {
+/****************************************************************************/
+bool
+MessageOStream::send(int fd)
+{
+    const std::vector<char>& buf(this->buffered());
+    std::vector<char>::size_type sent = 0;
+
+    while (sent < buf.size())
+    {
+        const ssize_t n = ::send(fd, &buf[sent], buf.size() - sent,
+                                 MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            this->discard();
+            return false;
+        }
+        sent += n;
+    }
+
+    this->discard();
+    return true;
+}
+/****************************************************************************/
+bool
+peer_is_us(int fd)
+{
+#ifdef SO_PEERCRED
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    return (::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0 and
+            cred.uid == ::getuid());
+#else
+    uid_t uid;
+    gid_t gid;
+    return (::getpeereid(fd, &uid, &gid) == 0 and uid == ::getuid());
+#endif
+}
+/****************************************************************************/
+} // namespace query
+} // namespace portage
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
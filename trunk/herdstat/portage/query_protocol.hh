@@ -0,0 +1,114 @@
+/*
+ * libherdstat -- herdstat/portage/query_protocol.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_PORTAGE_QUERY_PROTOCOL_HH
+#define _HAVE_PORTAGE_QUERY_PROTOCOL_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/portage/query_protocol.hh
+ * @brief Defines the wire format spoken by QueryServer and QueryClient.
+ *
+ * Internal header; not installed.
+ *
+ * Each connection carries exactly one query.  The client writes its
+ * request and shuts down its end for writing; the server reads the
+ * request up to end-of-file, writes the response and closes the
+ * connection.  Both are encoded with io::BinaryOStream (so integers are
+ * varints and strings are length-prefixed):
+ *
+ * - request: "HSQ", version (unsigned), the client's configuration (a
+ *   vector of strings, see QueryEngine::config()), op (char), regex
+ *   (bool), argument (string)
+ * - response: status (char), then for status_ok the result (a vector of
+ *   Package for op_find, a vector of ebuild paths for op_which, a Herd for
+ *   op_herd or a Developer for op_developer) and for status_error the
+ *   error message.
+ *
+ * Both ends hang up on a peer that isn't running as the same user.
+ */
+
+#include <string>
+#include <herdstat/io/binary_stream.hh>
+
+namespace herdstat {
+namespace portage {
+namespace query {
+
+    /// Protocol version; bump on any incompatible change.
+    const unsigned version = 2;
+
+    /// Request magic.
+    const char magic[] = { 'H', 'S', 'Q' };
+
+    /// Operations.
+    enum op_type
+    {
+        op_find      = 'f',
+        op_which     = 'w',
+        op_herd      = 'h',
+        op_developer = 'd',
+        op_reload    = 'r'
+    };
+
+    /// Response status.
+    enum status_type
+    {
+        status_ok       = 0,    ///< result follows
+        status_none     = 1,    ///< nothing matched
+        status_error    = 2,    ///< error message follows
+        status_version  = 3,    ///< server doesn't speak our version
+        status_config   = 4     ///< server is configured differently
+    };
+
+    /**
+     * BinaryOStream that holds a whole message in memory until send()'d.
+     */
+    class MessageOStream : public io::BinaryOStream
+    {
+        public:
+            MessageOStream() { this->set_unbounded(true); }
+
+            /** Send the message (without raising SIGPIPE if the peer has
+             * gone away) and empty the buffer.
+             * @param fd Socket.
+             * @returns False on error (see errno).
+             */
+            bool send(int fd);
+    };
+
+    /** Is the process at the other end of a connected socket running as
+     * our (real) user?
+     * @param fd Socket.
+     */
+    bool peer_is_us(int fd);
+
+} // namespace query
+} // namespace portage
+} // namespace herdstat
+
+#endif /* _HAVE_PORTAGE_QUERY_PROTOCOL_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,324 @@
+/*
+ * libherdstat -- herdstat/portage/query_server.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <herdstat/exceptions.hh>
+#include <herdstat/util/string.hh>
+#include <herdstat/portage/serialize.hh>
+#include <herdstat/portage/query_protocol.hh>
+#include <herdstat/portage/query_server.hh>
+
+/* seconds a client gets to send its query (and take the answer) */
+#define QUERY_SERVER_TIMEOUT    5
+
+/* is dir a real directory owned by us that nobody else can get into? */
+static bool
+private_dir(const std::string& dir)
+{
+    struct stat s;
+    return (::lstat(dir.c_str(), &s) == 0 and S_ISDIR(s.st_mode) and
+            s.st_uid == ::getuid() and (s.st_mode & (S_IRWXG|S_IRWXO)) == 0);
+}
+
+/* bind() with a umask that leaves the socket accessible only to us */
+static int
+bind_private(int fd, struct sockaddr_un& addr)
+{
+    const mode_t mask = ::umask(S_IRWXG|S_IRWXO);
+    const int rv = ::bind(fd, reinterpret_cast<struct sockaddr *>(&addr),
+                          sizeof(addr));
+    const int error = errno;
+    ::umask(mask);
+    errno = error;
+    return rv;
+}
+
+namespace herdstat {
+namespace portage {
+/****************************************************************************/
+QueryServer::QueryServer(QueryEngine& engine, const std::string& path)
+    : _engine(engine), _path(path.empty() ? default_socket() : path),
+      _fd(-1), _stop(0)
+{
+}
+/****************************************************************************/
+QueryServer::~QueryServer() throw()
+{
+    if (_fd >= 0)
+    {
+        ::close(_fd);
+        ::unlink(_path.c_str());
+    }
+}
+/****************************************************************************/
+std::string
+QueryServer::default_socket()
+{
+    const char *result;
+
+    if ((result = std::getenv("HERDSTAT_QUERY_SOCKET")) and *result)
+        return result;
+    if ((result = std::getenv("XDG_RUNTIME_DIR")) and *result)
+        return std::string(result) + "/libherdstat-query";
+
+    return util::sprintf("/tmp/libherdstat-%lu/query",
+        static_cast<unsigned long>(::getuid()));
+}
+/****************************************************************************/
+void
+QueryServer::listen()
+{
+    BacktraceContext c("portage::QueryServer::listen(%s)", _path);
+
+    if (_fd >= 0)
+        return;
+
+    struct sockaddr_un addr;
+    if (_path.size() >= sizeof(addr.sun_path))
+        throw Exception("%s: socket path too long", _path.c_str());
+
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, _path.c_str());
+
+    /* nobody else may get at the socket, or swap it for one of their own,
+     * so it goes in a directory only we can get into */
+    const std::string dir(util::dirname(_path));
+    if (::mkdir(dir.c_str(), S_IRWXU) != 0 and errno != EEXIST)
+        throw ErrnoException(dir);
+    if (not private_dir(dir))
+        throw Exception("%s: not a directory owned by you with mode 0700",
+            dir.c_str());
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        throw ErrnoException("socket");
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    int rv = bind_private(fd, addr);
+    if (rv != 0 and errno == EADDRINUSE)
+    {
+        /* somebody listening, or left over from a server that's gone? */
+        const int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        const bool alive = (probe >= 0 and ::connect(probe,
+            reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) == 0);
+        if (probe >= 0)
+            ::close(probe);
+
+        if (alive)
+        {
+            ::close(fd);
+            throw Exception("%s: a query server is already running",
+                _path.c_str());
+        }
+
+        ::unlink(_path.c_str());
+        rv = bind_private(fd, addr);
+    }
+
+    if (rv != 0 or ::listen(fd, SOMAXCONN) != 0)
+    {
+        const int error = errno;
+        ::close(fd);
+        errno = error;
+        throw ErrnoException(_path);
+    }
+
+    _fd = fd;
+    _stop = 0;
+}
+/****************************************************************************/
+bool
+QueryServer::serve_one()
+{
+    if (_stop)
+        return false;
+
+    const int fd = ::accept(_fd, NULL, NULL);
+    if (fd < 0)
+    {
+        if (_stop)
+            return false;
+        if (errno == EINTR or errno == ECONNABORTED)
+            return true;
+        throw ErrnoException("accept");
+    }
+
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    /* only answer our own user */
+    if (not query::peer_is_us(fd))
+    {
+        ::close(fd);
+        return (not _stop);
+    }
+
+    struct timeval timeout = { QUERY_SERVER_TIMEOUT, 0 };
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    this->answer(fd);
+    return (not _stop);
+}
+/****************************************************************************/
+void
+QueryServer::run()
+{
+    this->listen();
+    while (this->serve_one())
+        ;
+}
+/****************************************************************************/
+void
+QueryServer::stop()
+{
+    _stop = 1;
+
+    /* wakes up accept() */
+    if (_fd >= 0)
+        ::shutdown(_fd, SHUT_RDWR);
+}
+/****************************************************************************/
+void
+QueryServer::answer(int fd)
+{
+    /* the stream owns the connection from here on */
+    io::BinaryIStream in;
+    in.open(fd);
+
+    char magic[sizeof(query::magic)];
+    unsigned version = 0;
+    char op = 0;
+    bool regex = false;
+    std::string arg;
+
+    /* not a client of ours, or it gave up; just hang up */
+    if (not in.read_raw(magic, sizeof(magic)) or
+        std::memcmp(magic, query::magic, sizeof(magic)) != 0 or
+        not (in >> version))
+        return;
+
+    query::MessageOStream out;
+
+    if (version != query::version)
+    {
+        out << static_cast<char>(query::status_version);
+        out.send(fd);
+        return;
+    }
+
+    std::vector<std::string> config;
+    if (not (in >> config >> op >> regex >> arg))
+        return;
+
+    /* our answer wouldn't be the one the client would've come up with */
+    if (config != _engine.config())
+    {
+        out << static_cast<char>(query::status_config);
+        out.send(fd);
+        return;
+    }
+
+    try
+    {
+        switch (op)
+        {
+            case query::op_find:
+            {
+                std::vector<Package> results;
+                if (_engine.find(arg, regex, results))
+                    out << static_cast<char>(query::status_ok) << results;
+                else
+                    out << static_cast<char>(query::status_none);
+                break;
+            }
+
+            case query::op_which:
+            {
+                std::vector<std::string> results;
+                if (_engine.which(arg, regex, results))
+                    out << static_cast<char>(query::status_ok) << results;
+                else
+                    out << static_cast<char>(query::status_none);
+                break;
+            }
+
+            case query::op_herd:
+            {
+                Herd herd;
+                if (_engine.herd(arg, herd))
+                    out << static_cast<char>(query::status_ok) << herd;
+                else
+                    out << static_cast<char>(query::status_none);
+                break;
+            }
+
+            case query::op_developer:
+            {
+                Developer dev;
+                if (_engine.developer(arg, dev))
+                    out << static_cast<char>(query::status_ok) << dev;
+                else
+                    out << static_cast<char>(query::status_none);
+                break;
+            }
+
+            case query::op_reload:
+                _engine.reset();
+                out << static_cast<char>(query::status_ok);
+                break;
+
+            default:
+                throw Exception("unknown query type '%c'", op);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        query::MessageOStream error;
+        error << static_cast<char>(query::status_error)
+              << std::string(e.what());
+        error.send(fd);
+        return;
+    }
+
+    out.send(fd);
+}
+/****************************************************************************/
+} // namespace portage
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
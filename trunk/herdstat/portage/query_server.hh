@@ -0,0 +1,144 @@
+/*
+ * libherdstat -- herdstat/portage/query_server.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_PORTAGE_QUERY_SERVER_HH
+#define _HAVE_PORTAGE_QUERY_SERVER_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/portage/query_server.hh
+ * @brief Defines the QueryServer class.
+ */
+
+#include <string>
+#include <csignal>
+#include <herdstat/noncopyable.hh>
+#include <herdstat/portage/query_engine.hh>
+
+namespace herdstat {
+namespace portage {
+
+    /**
+     * @class QueryServer query_server.hh herdstat/portage/query_server.hh
+     * @brief Answers QueryClient queries over a local (Unix domain) socket
+     * using a QueryEngine that stays loaded between them.
+     *
+     * Connections are handled one at a time, in the calling thread; each
+     * carries a single query.  A client that doesn't finish sending its
+     * query within a few seconds is dropped.
+     *
+     * The server answers according to its own configuration (PORTDIR,
+     * overlays) and data source paths, not the client's.  Each query
+     * carries the client's (see QueryEngine::config()), and a query from a
+     * client configured differently is refused, so the client answers it
+     * itself.
+     *
+     * The socket lives in a directory that only the user running the
+     * server can get into, and is only accessible to that user itself.
+     * Connections from any other user are dropped.  The socket is removed
+     * when the server is destroyed.
+     *
+     * @section example Example
+     *
+@code
+herdstat::xml::GlobalInit();
+
+herdstat::portage::QueryEngine engine;
+engine.load();
+
+herdstat::portage::QueryServer server(engine);
+server.listen();
+server.run();
+@endcode
+     */
+
+    class QueryServer : private Noncopyable
+    {
+        public:
+            /** Constructor.
+             * @param engine QueryEngine to answer queries with (must outlive
+             * the server).
+             * @param path Path of socket (defaults to default_socket()).
+             */
+            QueryServer(QueryEngine& engine, const std::string& path = "");
+
+            /// Destructor.  Closes and removes the socket.
+            ~QueryServer() throw();
+
+            /** Get the default socket path: $HERDSTAT_QUERY_SOCKET if set,
+             * otherwise libherdstat-query in $XDG_RUNTIME_DIR or, failing
+             * that, /tmp/libherdstat-<uid>/query.
+             */
+            static std::string default_socket();
+
+            /// Get path of socket.
+            const std::string& path() const { return _path; }
+
+            /** Create the socket and start listening on it.  Its directory
+             * is created (mode 0700) if it doesn't exist; it must be a
+             * directory (not a symlink to one) owned by the current user
+             * and inaccessible to anyone else.  A stale socket left behind
+             * by a server that's gone is replaced.  The process umask is
+             * changed while the socket is created.
+             * @exception Exception if the directory isn't private or
+             * another server is listening on the socket, ErrnoException on
+             * any other error.
+             */
+            void listen();
+
+            /** Wait for one connection and answer its query.
+             * @returns False if stop() was called.
+             * @exception ErrnoException
+             */
+            bool serve_one();
+
+            /** Answer queries until stop() is called.  Calls listen() first
+             * if needed.  SIGPIPE is never raised for a client that hangs
+             * up early.
+             * @exception Exception, ErrnoException
+             */
+            void run();
+
+            /** Make run() return once it's done with the current query.
+             * Safe to call from a signal handler or another thread.
+             */
+            void stop();
+
+        private:
+            /* read and answer the query on the given connection */
+            void answer(int fd);
+
+            QueryEngine& _engine;
+            const std::string _path;
+            int _fd;
+            volatile std::sig_atomic_t _stop;
+    };
+
+} // namespace portage
+} // namespace herdstat
+
+#endif /* _HAVE_PORTAGE_QUERY_SERVER_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,199 @@
+/*
+ * libherdstat -- herdstat/portage/serialize.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <iterator>
+#include <herdstat/portage/serialize.hh>
+
+namespace herdstat {
+namespace io {
+/****************************************************************************/
+void
+Serializer<portage::Package>::write(BinaryOStream& s,
+                                    const portage::Package& v)
+{
+    s << v.full() << v.portdir() << v.path();
+}
+/****************************************************************************/
+void
+Serializer<portage::Package>::read(BinaryIStream& s, portage::Package& v)
+{
+    std::string full, portdir, path;
+    if (not (s >> full >> portdir >> path))
+        return;
+
+    portage::Package pkg(full, portdir);
+    pkg.set_path(path);
+    v = pkg;
+}
+/****************************************************************************/
+void
+Serializer<portage::VersionString>::write(BinaryOStream& s,
+                                          const portage::VersionString& v)
+{
+    s << v.ebuild();
+}
+/****************************************************************************/
+void
+Serializer<portage::VersionString>::read(BinaryIStream& s,
+                                         portage::VersionString& v)
+{
+    std::string ebuild;
+    if (s >> ebuild)
+        v.assign(ebuild);
+}
+/****************************************************************************/
+void
+Serializer<portage::Keywords>::write(BinaryOStream& s,
+                                     const portage::Keywords& v)
+{
+    s.write_varint(v.size());
+
+    portage::Keywords::const_iterator i;
+    for (i = v.begin() ; i != v.end() ; ++i)
+    {
+        if (i->mask())
+            s << (std::string(1, i->mask()) + i->arch());
+        else
+            s << i->arch();
+    }
+}
+/****************************************************************************/
+void
+Serializer<portage::Keywords>::read(BinaryIStream& s, portage::Keywords& v)
+{
+    std::vector<std::string> keywords;
+    if (read_sequence<std::string>(s, std::back_inserter(keywords)))
+        v.assign(keywords.begin(), keywords.end());
+}
+/****************************************************************************/
+void
+Serializer<portage::Developer>::write(BinaryOStream& s,
+                                      const portage::Developer& v)
+{
+    s << v.user() << v.email() << v.name() << v.pgpkey() << v.joined()
+      << v.birthday() << v.status() << v.role() << v.location()
+      << v.awaymsg() << v.is_away() << v.herds();
+}
+/****************************************************************************/
+void
+Serializer<portage::Developer>::read(BinaryIStream& s, portage::Developer& v)
+{
+    std::string user, email, name, pgpkey, joined, birthday, status, role,
+                location, awaymsg;
+    bool away = false;
+    std::vector<std::string> herds;
+
+    if (not (s >> user >> email >> name >> pgpkey >> joined >> birthday
+               >> status >> role >> location >> awaymsg >> away >> herds))
+        return;
+
+    v.set_user(user);
+    v.set_email(email);
+    v.set_name(name);
+    v.set_pgpkey(pgpkey);
+    v.set_joined(joined);
+    v.set_birthday(birthday);
+    v.set_status(status);
+    v.set_role(role);
+    v.set_location(location);
+    v.set_awaymsg(awaymsg);
+    v.set_away(away);
+    v.set_herds(herds);
+}
+/****************************************************************************/
+void
+Serializer<portage::Developers>::write(BinaryOStream& s,
+                                       const portage::Developers& v)
+{
+    write_sequence(s, v.begin(), v.end(), v.size());
+}
+/****************************************************************************/
+void
+Serializer<portage::Developers>::read(BinaryIStream& s,
+                                      portage::Developers& v)
+{
+    v.clear();
+    read_sequence<portage::Developer>(s, std::inserter(v, v.end()));
+}
+/****************************************************************************/
+void
+Serializer<portage::Herd>::write(BinaryOStream& s, const portage::Herd& v)
+{
+    s << v.name() << v.email() << v.desc();
+    write_sequence(s, v.begin(), v.end(), v.size());
+}
+/****************************************************************************/
+void
+Serializer<portage::Herd>::read(BinaryIStream& s, portage::Herd& v)
+{
+    std::string name, email, desc;
+    if (not (s >> name >> email >> desc))
+        return;
+
+    v.set_name(name);
+    v.set_email(email);
+    v.set_desc(desc);
+    v.clear();
+    read_sequence<portage::Developer>(s, std::inserter(v, v.end()));
+}
+/****************************************************************************/
+void
+Serializer<portage::Herds>::write(BinaryOStream& s, const portage::Herds& v)
+{
+    write_sequence(s, v.begin(), v.end(), v.size());
+}
+/****************************************************************************/
+void
+Serializer<portage::Herds>::read(BinaryIStream& s, portage::Herds& v)
+{
+    v.clear();
+    read_sequence<portage::Herd>(s, std::inserter(v, v.end()));
+}
+/****************************************************************************/
+void
+Serializer<portage::Metadata>::write(BinaryOStream& s,
+                                     const portage::Metadata& v)
+{
+    s << v.pkg() << v.longdesc() << v.is_category() << v.herds() << v.devs();
+}
+/****************************************************************************/
+void
+Serializer<portage::Metadata>::read(BinaryIStream& s, portage::Metadata& v)
+{
+    std::string pkg, longdesc;
+    bool cat = false;
+    if (not (s >> pkg >> longdesc >> cat >> v.herds() >> v.devs()))
+        return;
+
+    v.set_pkg(pkg);
+    v.set_longdesc(longdesc);
+    v.set_category(cat);
+}
+/****************************************************************************/
+} // namespace io
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
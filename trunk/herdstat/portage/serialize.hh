@@ -0,0 +1,83 @@
+/*
+ * libherdstat -- herdstat/portage/serialize.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_PORTAGE_SERIALIZE_HH
+#define _HAVE_PORTAGE_SERIALIZE_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/portage/serialize.hh
+ * @brief io::Serializer specializations for the portage classes, so they
+ * can be written to (and read from) binary streams and archives.
+ *
+ * @section example Example
+ *
+@code
+herdstat::io::OArchive ar("herds.cache", "herds", 1);
+ar << herds_xml.herds();
+...
+herdstat::io::IArchive ar("herds.cache", "herds", 1);
+herdstat::portage::Herds herds;
+if (ar >> herds)
+    ...
+@endcode
+ */
+
+#include <herdstat/io/binary_stream.hh>
+#include <herdstat/portage/package.hh>
+#include <herdstat/portage/version.hh>
+#include <herdstat/portage/keywords.hh>
+#include <herdstat/portage/developer.hh>
+#include <herdstat/portage/herd.hh>
+#include <herdstat/portage/metadata.hh>
+
+namespace herdstat {
+namespace io {
+
+    /// @cond
+#define LIBHERDSTAT_DECLARE_SERIALIZER(T) \
+    template <> struct Serializer<T> \
+    { \
+        static void write(BinaryOStream& s, const T& v); \
+        static void read(BinaryIStream& s, T& v); \
+    };
+
+    LIBHERDSTAT_DECLARE_SERIALIZER(portage::Package)
+    LIBHERDSTAT_DECLARE_SERIALIZER(portage::VersionString)
+    LIBHERDSTAT_DECLARE_SERIALIZER(portage::Keywords)
+    LIBHERDSTAT_DECLARE_SERIALIZER(portage::Developer)
+    LIBHERDSTAT_DECLARE_SERIALIZER(portage::Developers)
+    LIBHERDSTAT_DECLARE_SERIALIZER(portage::Herd)
+    LIBHERDSTAT_DECLARE_SERIALIZER(portage::Herds)
+    LIBHERDSTAT_DECLARE_SERIALIZER(portage::Metadata)
+#undef LIBHERDSTAT_DECLARE_SERIALIZER
+    /// @endcond
+
+} // namespace io
+} // namespace herdstat
+
+#endif /* _HAVE_PORTAGE_SERIALIZE_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,253 @@
+/*
+ * libherdstat -- herdstat/portage/userinfo_index.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstdio>
+#include <cctype>
+
+#include <herdstat/exceptions.hh>
+#include <herdstat/util/file.hh>
+#include <herdstat/io/compress.hh>
+#include <herdstat/io/archive.hh>
+#include <herdstat/portage/userinfo_index.hh>
+
+#define INDEX_MAGIC     "userinfo.xml index"
+#define INDEX_VERSION   2
+
+namespace herdstat {
+namespace portage {
+/****************************************************************************/
+UserinfoIndex::UserinfoIndex(const std::string& xml, const std::string& cache)
+    : Cachable(cache.empty() ? xml+".idx" : cache), _xml(xml), _contents(),
+      _mutex()
+{
+}
+/****************************************************************************/
+UserinfoIndex::~UserinfoIndex() throw()
+{
+}
+/****************************************************************************/
+util::MemoryUsage
+UserinfoIndex::memory_usage() const
+{
+    util::MemoryUsage m(util::MapBase<std::string, range_type>::memory_usage());
+    m += util::memory_usage(this->path());
+    m += util::memory_usage(_xml);
+    m.caches += util::memory_usage(_contents).total();
+    return m;
+}
+/****************************************************************************/
+bool
+UserinfoIndex::valid() const
+{
+    BacktraceContext c("portage::UserinfoIndex::valid()");
+
+    if (not util::is_file(this->path()))
+        return false;
+
+    const util::Stat xml(_xml);
+    io::IArchive stream(this->path(), INDEX_MAGIC, INDEX_VERSION, true);
+
+    util::Stat::size_type size = 0;
+    util::Stat::time_type mtime = 0;
+
+    stream >> size >> mtime;
+
+    return (stream and size == xml.size() and mtime == xml.mtime());
+}
+/****************************************************************************/
+void
+UserinfoIndex::fill()
+{
+    BacktraceContext c("portage::UserinfoIndex::fill(%s)", _xml);
+
+    this->clear();
+    _contents.clear();
+    io::Decompressor(_xml).read_all(_contents);
+
+    const std::string& s(_contents);
+    std::string::size_type pos = 0;
+
+    while ((pos = s.find('<', pos)) != std::string::npos)
+    {
+        /* skip comments; they may very well contain "<user" */
+        if (s.compare(pos, 4, "<!--") == 0)
+        {
+            if ((pos = s.find("-->", pos + 4)) == std::string::npos)
+                break;
+            pos += 3;
+            continue;
+        }
+
+        if (s.compare(pos, 5, "<user") != 0 or (pos + 5) >= s.size() or
+            not (std::isspace(static_cast<unsigned char>(s[pos+5])) or
+                 s[pos+5] == '>' or s[pos+5] == '/'))
+        {
+            ++pos;
+            continue;
+        }
+
+        const std::string::size_type tag_end = s.find('>', pos);
+        if (tag_end == std::string::npos)
+            break;
+
+        /* username="foo" or username='foo' */
+        std::string::size_type attr = s.find("username", pos);
+        if (attr == std::string::npos or attr > tag_end)
+            throw Exception("%s: <user> tag with no username attribute!",
+                _xml.c_str());
+
+        attr = s.find_first_not_of(" \t\r\n", attr + 8);
+        if (attr < tag_end and s[attr] == '=')
+            attr = s.find_first_not_of(" \t\r\n", attr + 1);
+        if (attr >= tag_end or (s[attr] != '"' and s[attr] != '\''))
+            throw Exception("%s: malformed username attribute at offset %lu",
+                _xml.c_str(), static_cast<unsigned long>(attr));
+
+        const std::string::size_type user_end = s.find(s[attr], attr + 1);
+        if (user_end == std::string::npos or user_end > tag_end)
+            throw Exception("%s: malformed username attribute at offset %lu",
+                _xml.c_str(), static_cast<unsigned long>(attr));
+
+        std::string::size_type end;
+        if (s[tag_end - 1] == '/')
+        {
+            /* <user username="foo"/> */
+            end = tag_end + 1;
+        }
+        else
+        {
+            end = s.find("</user>", tag_end);
+            if (end == std::string::npos)
+                throw Exception("%s: unterminated <user> element at offset %lu",
+                    _xml.c_str(), static_cast<unsigned long>(pos));
+            end += 7;
+        }
+
+        this->insert(value_type(s.substr(attr + 1, user_end - attr - 1),
+            range_type(pos, end - pos)));
+
+        pos = end;
+    }
+}
+/****************************************************************************/
+void
+UserinfoIndex::load()
+{
+    BacktraceContext c("portage::UserinfoIndex::load(%s)", this->path());
+
+    io::IArchive stream(this->path(), INDEX_MAGIC, INDEX_VERSION, true);
+    if (not stream)
+        throw Exception("%s: %s", this->path().c_str(),
+            stream.error().c_str());
+
+    util::Stat::size_type size = 0;
+    util::Stat::time_type mtime = 0;
+    size_type n = 0;
+
+    stream >> size >> mtime >> n;
+    if (not stream)
+        throw Exception("%s: truncated index", this->path().c_str());
+
+    this->clear();
+    while (n-- > 0 and stream)
+    {
+        std::string user;
+        range_type range;
+        stream >> user >> range;
+        this->insert(value_type(user, range));
+    }
+
+    if (not stream)
+        throw Exception("%s: truncated index", this->path().c_str());
+}
+/****************************************************************************/
+void
+UserinfoIndex::dump()
+{
+    BacktraceContext c("portage::UserinfoIndex::dump(%s)", this->path());
+
+    const util::Stat xml(_xml);
+
+    /* caching is an optimization; don't fail if we can't write it */
+    io::OArchive stream(this->path(), INDEX_MAGIC, INDEX_VERSION);
+    if (not stream)
+        return;
+
+    stream << xml.size() << xml.mtime() << this->size();
+
+    for (const_iterator i = this->begin() ; i != this->end() ; ++i)
+        stream << i->first << i->second;
+}
+/****************************************************************************/
+bool
+UserinfoIndex::element(const std::string& user, std::string& element) const
+{
+    BacktraceContext c("portage::UserinfoIndex::element(%s)", user);
+
+    const_iterator i = this->find(user);
+    if (i == this->end())
+        return false;
+
+    const range_type& range(i->second);
+
+    /* compressed document; we have to decompress all of it anyway.  once
+     * read, _contents doesn't change until the index is rebuilt. */
+    {
+        util::Lock lock(_mutex);
+        if (_contents.empty() and
+            io::detect_compression(_xml) != io::COMPRESSION_NONE)
+            io::Decompressor(_xml).read_all(_contents);
+    }
+
+    if (not _contents.empty())
+    {
+        if ((range.first + range.second) > _contents.size())
+            throw Exception("%s: stale index", this->path().c_str());
+        element.assign(_contents, range.first, range.second);
+        return true;
+    }
+
+    /* plain document; read only the bytes we need */
+    std::FILE *fp = std::fopen(_xml.c_str(), "rb");
+    if (not fp)
+        throw FileException(_xml);
+
+    element.resize(range.second);
+    const bool ok =
+        (std::fseek(fp, static_cast<long>(range.first), SEEK_SET) == 0) and
+        (std::fread(&element[0], 1, range.second, fp) == range.second);
+    std::fclose(fp);
+
+    if (not ok)
+        throw Exception("%s: stale index", this->path().c_str());
+
+    return true;
+}
+/****************************************************************************/
+} // namespace portage
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
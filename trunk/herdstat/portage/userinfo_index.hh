@@ -0,0 +1,118 @@
+/*
+ * libherdstat -- herdstat/portage/userinfo_index.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_USERINFO_INDEX_HH
+#define _HAVE_USERINFO_INDEX_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/portage/userinfo_index.hh
+ * @brief Defines the UserinfoIndex class.
+ */
+
+#include <string>
+#include <utility>
+#include <herdstat/cachable.hh>
+#include <herdstat/util/container_base.hh>
+#include <herdstat/util/thread.hh>
+
+namespace herdstat {
+namespace portage {
+
+    /**
+     * @class UserinfoIndex userinfo_index.hh herdstat/portage/userinfo_index.hh
+     * @brief Maps each username in userinfo.xml to the byte range of its
+     * &lt;user&gt; element.
+     *
+     * The index is built by a plain text scan of the document (no XML
+     * parsing) and is cached on disk so that subsequent runs only need to
+     * stat userinfo.xml.  The cache is considered valid as long as the size
+     * and mtime of userinfo.xml match the ones recorded in it.  Failure to
+     * write the cache (eg. a read-only directory) is not an error.
+     *
+     * Offsets refer to the decompressed document if userinfo.xml is
+     * compressed.
+     */
+
+    class UserinfoIndex : public Cachable,
+                          public util::MapBase<std::string,
+                                    std::pair<std::size_t, std::size_t> >
+    {
+        public:
+            /// (offset, length) of a <user> element.
+            typedef std::pair<std::size_t, std::size_t> range_type;
+
+            /** Constructor.
+             * @param xml Path to userinfo.xml.
+             * @param cache Path to index cache (defaults to xml + ".idx").
+             */
+            UserinfoIndex(const std::string& xml,
+                          const std::string& cache = "");
+
+            /// Destructor.
+            virtual ~UserinfoIndex() throw();
+
+            /// Get path to userinfo.xml.
+            inline const std::string& xml() const { return _xml; }
+
+            /** Load the cache if valid, otherwise build the index and try
+             * to cache it.
+             * @exception FileException, Exception
+             */
+            void init() { this->logic(); }
+
+            /** Get the &lt;user&gt; element for the given user.
+             * @param user User name.
+             * @param element String to store element in.
+             * @returns False if user is not in the index.
+             * @exception FileException
+             */
+            bool element(const std::string& user, std::string& element) const;
+
+            virtual bool valid() const;
+            virtual void fill();
+            virtual void load();
+            virtual void dump();
+
+            /** Get heap bytes held by the index.  The document contents,
+             * kept after building the index or reading a compressed
+             * document, are counted as a cache.
+             */
+            util::MemoryUsage memory_usage() const;
+
+        private:
+            const std::string _xml;
+            /// document contents, if we had to read all of it.
+            mutable std::string _contents;
+            /// guards reading a compressed document into _contents.
+            mutable util::Mutex _mutex;
+    };
+
+} // namespace portage
+} // namespace herdstat
+
+#endif /* _HAVE_USERINFO_INDEX_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -24,8 +24,10 @@
 # include "config.h"
 #endif
 
+#include <cassert>
 #include <herdstat/exceptions.hh>
 #include <herdstat/util/file.hh>
+#include <herdstat/util/profile.hh>
 #include <herdstat/portage/userinfo_xml.hh>
 
 namespace herdstat {
@@ -34,18 +36,28 @@ namespace portage {
 const char * const UserinfoXML::_local_default = LOCALSTATEDIR"/userinfo.xml";
 /****************************************************************************/
 UserinfoXML::UserinfoXML()
-    : DataSource(), _devs(), in_user(false), in_firstname(false),
-      in_familyname(false), in_pgpkey(false), in_email(false), in_joined(false),
-      in_birth(false), in_roles(false), in_status(false), in_location(false),
-      _cur_dev()
+    : DataSource(), _devs(), _lazy(false), _index_path(), _index(),
+      _mutex(), in_user(false), in_firstname(false), in_familyname(false),
+      in_pgpkey(false), in_email(false), in_joined(false), in_birth(false),
+      in_roles(false), in_status(false), in_location(false), _cur_dev()
 {
 }
 /****************************************************************************/
 UserinfoXML::UserinfoXML(const std::string& path)
-    : DataSource(path), _devs(), in_user(false),
-      in_firstname(false), in_familyname(false), in_pgpkey(false),
-      in_email(false), in_joined(false), in_birth(false), in_roles(false),
-      in_status(false), in_location(false), _cur_dev()
+    : DataSource(path), _devs(), _lazy(false), _index_path(), _index(),
+      _mutex(), in_user(false), in_firstname(false), in_familyname(false),
+      in_pgpkey(false), in_email(false), in_joined(false), in_birth(false),
+      in_roles(false), in_status(false), in_location(false), _cur_dev()
+{
+    this->parse();
+}
+/****************************************************************************/
+UserinfoXML::UserinfoXML(const std::string& path, bool lazy,
+                         const std::string& index)
+    : DataSource(path), _devs(), _lazy(lazy), _index_path(index), _index(),
+      _mutex(), in_user(false), in_firstname(false), in_familyname(false),
+      in_pgpkey(false), in_email(false), in_joined(false), in_birth(false),
+      in_roles(false), in_status(false), in_location(false), _cur_dev()
 {
     this->parse();
 }
@@ -54,15 +66,95 @@ UserinfoXML::~UserinfoXML() throw()
 {
 }
 /****************************************************************************/
+util::MemoryUsage
+UserinfoXML::memory_usage() const
+{
+    util::MemoryUsage m;
+    m += util::memory_usage(this->path());
+    m += util::memory_usage(_index_path);
+
+    if (_lazy)
+        m.caches += _devs.memory_usage().total();
+    else
+        m += _devs.memory_usage();
+
+    if (_index.get())
+    {
+        m.nodes += sizeof(UserinfoIndex);
+        m += _index->memory_usage();
+    }
+
+    return m;
+}
+/****************************************************************************/
 void
 UserinfoXML::do_parse(const std::string& path)
 {
+    util::ProfileZone zone("portage::UserinfoXML::parse()");
+
     if (not path.empty()) this->set_path(path);
 
-    BacktraceContext c("portage::UserinfoXML::parse("+this->path()+")");
+    BacktraceContext c("portage::UserinfoXML::parse(%s)", this->path());
 
     if (not util::is_file(this->path())) throw FileException(this->path());
-    this->parse_file(this->path().c_str());
+
+    if (_lazy)
+    {
+        _devs.clear();
+        _index.reset(new UserinfoIndex(this->path(), _index_path));
+        _index->init();
+
+        /* selective parse; load the selected developers now */
+        if (this->selector())
+        {
+            UserinfoIndex::const_iterator i;
+            for (i = _index->begin() ; i != _index->end() ; ++i)
+            {
+                if ((*this->selector())(i->first))
+                    this->load(i->first);
+            }
+        }
+
+        return;
+    }
+
+    this->parse_path(this->path());
+}
+/****************************************************************************/
+Developers::const_iterator
+UserinfoXML::find(const std::string& user) const
+{
+    if (not _index.get())
+        return _devs.find(user);
+
+    /* lazy; other threads may be loading developers too */
+    util::Lock lock(_mutex);
+    Developers::const_iterator i = _devs.find(user);
+    if (i == _devs.end())
+        i = this->load(user);
+    return i;
+}
+/****************************************************************************/
+Developers::const_iterator
+UserinfoXML::load(const std::string& user) const
+{
+    BacktraceContext c("portage::UserinfoXML::load(%s)", user);
+
+    assert(_index.get());
+
+    std::string element;
+    if (not _index->element(user, element))
+        return _devs.end();
+
+    /* parse just this <user> element */
+    UserinfoXML fragment;
+    if (not fragment.parse_chunk(element.data(), element.size()) or
+        not fragment.parse_finish())
+        throw xml::ParserException(this->path(),
+                fragment.get_error_message());
+
+    _devs.insert(fragment._devs.begin(), fragment._devs.end());
+    return _devs.find(user);
 }
 /****************************************************************************/
 void
@@ -73,7 +165,7 @@ UserinfoXML::fill_developer(Developer& dev) const
     if (dev.user().empty())
         throw Exception("UserinfoXML::fill_developer() requires you pass a Developer object with at least the user name filled in");
 
-    Herd::const_iterator d = _devs.find(dev);
+    Herd::const_iterator d = this->find(dev.user());
     if (d != _devs.end())
     {
         if (dev.name().empty() and not d->name().empty())
@@ -94,12 +186,21 @@ UserinfoXML::start_element(const std::string& name, const attrs_type& attrs)
     if (meter())
         ++*meter();
 
+    if (this->skipping())
+        return true;
+
     if (name == "user")
     {
         attrs_type::const_iterator pos = attrs.find("username");
         if (pos == attrs.end())
             throw Exception("<user> tag with no username attribute!");
 
+        if (this->selector() and not (*this->selector())(pos->second))
+        {
+            this->skip_to_end_of("user");
+            return true;
+        }
+
         Developer dev(pos->second);
         dev.set_status("Active");
         _cur_dev = _devs.insert(dev).first;
@@ -137,7 +238,15 @@ UserinfoXML::end_element(const std::string& name)
     if (meter())
         ++*meter();
 
-    if      (name == "user")        in_user = false;
+    if (this->skipping(name))
+        return true;
+
+    if (name == "user")
+    {
+        in_user = false;
+        if (this->selector() and this->selector()->complete())
+            return this->stop();
+    }
     else if (name == "firstname")   in_firstname = false;
     else if (name == "familyname")  in_familyname = false;
     else if (name == "pgpkey")      in_pgpkey = false;
@@ -32,8 +32,11 @@
  * @brief Defines the interface to Gentoo's userinfo.xml.
  */
 
+#include <memory>
+#include <herdstat/util/thread.hh>
 #include <herdstat/portage/data_source.hh>
 #include <herdstat/portage/herd.hh>
+#include <herdstat/portage/userinfo_index.hh>
 
 namespace herdstat {
 namespace portage {
@@ -50,6 +53,17 @@ namespace portage {
      * member).
      *
      * @see portage::HerdsXML documentation.
+     *
+     * @section lazy Lazy mode
+     *
+     * When constructed in lazy mode, parsing only builds (or loads the
+     * cached) portage::UserinfoIndex.  A developer's &lt;user&gt; element is
+     * parsed the first time it's looked up via find() or fill_developer().
+     * In this mode devs() only contains the developers looked up so far.
+     * find() and fill_developer() may be called from several threads at
+     * once, but devs() must not be iterated while they are.
+     *
+     * Like all DataSource's, UserinfoXML objects are noncopyable.
      */
 
     class UserinfoXML : public DataSource
@@ -64,6 +78,16 @@ namespace portage {
              */
             UserinfoXML(const std::string& path);
 
+            /** Constructor.
+             * @param path Path to userinfo.xml.
+             * @param lazy Only index userinfo.xml, parsing developers on
+             * demand.
+             * @param index Path to index cache (defaults to path + ".idx").
+             * @exception FileException, xml::ParserException
+             */
+            UserinfoXML(const std::string& path, bool lazy,
+                        const std::string& index = "");
+
             /// Destructor.
             virtual ~UserinfoXML() throw();
 
@@ -78,12 +102,28 @@ namespace portage {
             /// Get developers.
             inline const Developers& devs() const;
 
+            /** Find developer by user name, parsing it first if in lazy mode.
+             * @param user User name.
+             * @returns iterator to developer or devs().end().
+             * @exception xml::ParserException
+             */
+            Developers::const_iterator find(const std::string& user) const;
+
+            /// Are we in lazy mode?
+            inline bool lazy() const { return _lazy; }
+
             /* convenience */
             /// Get number of developers in userinfo.xml.
             inline Developers::size_type size() const;
             /// Were no developers in userinfo.xml?
             inline bool empty() const;
 
+            /** Get heap bytes held by the parsed developers and the index.
+             * In lazy mode, the developers loaded so far are counted as a
+             * cache.
+             */
+            util::MemoryUsage memory_usage() const;
+
         protected:
             /** Parse userinfo.xml.
              * @param path Path to userinfo.xml (defaults to empty).
@@ -100,9 +140,18 @@ namespace portage {
             ///@}
 
         private:
-            Developers _devs;
+            /// Parse the given user's <user> element into _devs.
+            Developers::const_iterator load(const std::string& user) const;
+
+            mutable Developers _devs;
             static const char * const _local_default;
 
+            const bool _lazy;
+            const std::string _index_path;
+            std::auto_ptr<UserinfoIndex> _index;
+            /// guards loading developers into _devs in lazy mode.
+            mutable util::Mutex _mutex;
+
             bool in_user,
                  in_firstname,
                  in_familyname,
@@ -118,8 +167,10 @@ namespace portage {
     };
 
     inline const Developers& UserinfoXML::devs() const { return _devs; }
-    inline Developers::size_type UserinfoXML::size() const { return _devs.size(); }
-    inline bool UserinfoXML::empty() const { return _devs.empty(); }
+    inline Developers::size_type UserinfoXML::size() const
+    { return (_index.get() ? _index->size() : _devs.size()); }
+    inline bool UserinfoXML::empty() const
+    { return (_index.get() ? _index->empty() : _devs.empty()); }
 
 } // namespace portage
 } // namespace herdstat
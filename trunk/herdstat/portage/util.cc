@@ -33,25 +33,33 @@ namespace portage {
 std::string
 get_pkg_from_verstr(const std::string& ver)
 {
-    std::string cat, pkg;
-    std::string::size_type pos = ver.find('/');
-    if (pos != std::string::npos)
-        cat.assign(0, pos++);
-
-    std::vector<std::string> parts;
-    util::split(ver.substr(pos), std::back_inserter(parts), "-");
-
-    /* if parts > 3, $PN contains a '-' */
-    if (parts.size() > 3)
+    util::StringView cat, pkg(ver);
+    util::StringView::size_type pos = pkg.find('/');
+    if (pos != util::StringView::npos)
     {
-        while (parts.size() > 2)
-        {
-            pkg += "-" + parts.front();
-            parts.erase(parts.begin());
-        }
+        cat = pkg.substr(0, pos);
+        pkg.remove_prefix(pos + 1);
     }
 
-    return (cat+"/"+pkg);
+    /* chop -r${PR} */
+    pos = pkg.rfind('-');
+    if (pos != util::StringView::npos and pos + 2 < pkg.size() and
+        pkg[pos + 1] == 'r' and pkg.find_first_not_of("0123456789",
+            pos + 2) == util::StringView::npos)
+        pkg = pkg.substr(0, pos);
+
+    /* chop -${PV}; $PN may contain a '-', but $PV starts with a digit */
+    pos = pkg.rfind('-');
+    if (pos != util::StringView::npos and pos + 1 < pkg.size() and
+        std::isdigit(static_cast<unsigned char>(pkg[pos + 1])))
+        pkg = pkg.substr(0, pos);
+
+    std::string result;
+    result.reserve(cat.size() + pkg.size() + 1);
+    result.append(cat.data(), cat.size());
+    result.append(1, '/');
+    result.append(pkg.data(), pkg.size());
+    return result;
 }
 
 } // namespace portage
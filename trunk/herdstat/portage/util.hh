@@ -64,7 +64,7 @@ namespace portage {
     is_category(const std::string& path)
     {
         return (util::is_dir(path) and
-                GlobalConfig().categories().count(util::basename(path)));
+                GlobalConfig().categories().count(util::basename_view(path)));
     }
 
     /**
@@ -31,6 +31,7 @@
 #include <cstdlib>
 #include <climits>
 #include <cassert>
+#include <pthread.h>
 
 #include <herdstat/util/misc.hh>
 #include <herdstat/util/string.hh>
@@ -41,10 +42,12 @@
 #include <herdstat/portage/version.hh>
 
 // {{{ ValidSuffixes
-struct SuffixLess : std::binary_function<std::string, std::string, bool>
+struct SuffixLess : std::binary_function<herdstat::util::StringView,
+                                          herdstat::util::StringView, bool>
 {
     /* s1 < s2? */
-    bool operator()(const std::string& s1, const std::string& s2) const
+    bool operator()(const herdstat::util::StringView& s1,
+                    const herdstat::util::StringView& s2) const
     {
         if (s1 == s2)  return false;
         if (s1 == "p") return false;
@@ -67,21 +70,28 @@ class ValidSuffixes
         inline const_iterator end() const { return _s.end(); }
 
         /* get location of v or end() if it doesn't exist */
-        inline const_iterator find(const value_type& v) const
+        inline const_iterator find(const herdstat::util::StringView& v) const
         {
             std::pair<const_iterator, const_iterator> p =
                 std::equal_range(_s.begin(), _s.end(), v, SuffixLess());
             return (p.first == p.second ? _s.end() : p.first);
         }
         
-        /* does v exist? */
-        inline bool count(const value_type& v) const
+        /* position of v in version order.  no (or an invalid) suffix
+         * sorts after all but "p", so gets the position "p" would have,
+         * and "p" moves up one. */
+        inline unsigned rank(const herdstat::util::StringView& v) const
         {
-            return std::binary_search(_s.begin(), _s.end(), v, SuffixLess());
+            const const_iterator i(this->find(v));
+            return (i == _s.end() ? this->none() :
+                    i - _s.begin() + (*i == "p"));
         }
 
+        /* rank() of no suffix */
+        inline unsigned none() const { return _s.size() - 1; }
+
     private:
-        friend const ValidSuffixes& GlobalValidSuffixes();
+        friend void init_valid_suffixes();
 
         ValidSuffixes() : _s()
         {
@@ -92,14 +102,184 @@ class ValidSuffixes
         container_type _s;
 };
 
+static pthread_once_t valid_suffixes_once = PTHREAD_ONCE_INIT;
+static const ValidSuffixes *valid_suffixes = NULL;
+
+void
+init_valid_suffixes()
+{
+    static const ValidSuffixes s;
+    valid_suffixes = &s;
+}
+
 const ValidSuffixes&
 GlobalValidSuffixes()
 {
-    static ValidSuffixes s;
-    return s;
+    pthread_once(&valid_suffixes_once, init_valid_suffixes);
+    return *valid_suffixes;
 }
 // }}}
 
+/* destringify<unsigned long>() for a version component, without the copy */
+static unsigned long
+version_component(const herdstat::util::StringView& s)
+{
+    unsigned long result = 0;
+
+    herdstat::util::StringView::const_iterator i;
+    for (i = s.begin() ; i != s.end() ; ++i)
+    {
+        const unsigned long digit = *i - '0';
+        if (not std::isdigit(static_cast<unsigned char>(*i)) or
+            result > (ULONG_MAX - digit) / 10)
+            throw herdstat::BadCast("Failed to cast '"+s.str()+
+                "' to unsigned long.");
+        result = (result * 10) + digit;
+    }
+
+    return result;
+}
+
+/* split ${PVR} into the suffix (alpha, beta, etc) and its version; the
+ * suffix is left empty if it isn't a valid one.  returns its rank(). */
+static unsigned
+split_suffix(const herdstat::util::StringView& pvr,
+             herdstat::util::StringView& suffix,
+             herdstat::util::StringView& suffix_ver)
+{
+    suffix = pvr;
+    suffix_ver = herdstat::util::StringView();
+
+    /* chop revision */
+    herdstat::util::StringView::size_type pos = suffix.rfind('-');
+    if (pos != herdstat::util::StringView::npos and
+        suffix.substr(pos + 1, 1) == herdstat::util::StringView("r", 1))
+        suffix = suffix.substr(0, pos);
+
+    /* get suffix */
+    pos = suffix.rfind('_');
+    if (pos != herdstat::util::StringView::npos)
+    {
+        suffix.remove_prefix(pos+1);
+
+        /* get suffix version */
+        pos = suffix.find_first_of("0123456789");
+        if (pos != herdstat::util::StringView::npos)
+        {
+            suffix_ver = suffix.substr(pos);
+            suffix = suffix.substr(0, pos);
+        }
+
+        /* ignore invalid suffixes */
+        const unsigned rank = GlobalValidSuffixes().rank(suffix);
+        if (rank == GlobalValidSuffixes().none())
+            suffix = herdstat::util::StringView();
+        return rank;
+    }
+
+    suffix = herdstat::util::StringView();
+    return GlobalValidSuffixes().none();
+}
+
+/* split ${PV} minus suffix into the version and any extra non-digit
+ * characters */
+static void
+split_version(const herdstat::util::StringView& pv,
+              herdstat::util::StringView& version,
+              herdstat::util::StringView& extra)
+{
+    version = pv;
+    extra = herdstat::util::StringView();
+
+    /* strip suffix */
+    herdstat::util::StringView::size_type pos = version.find('_');
+    if (pos != herdstat::util::StringView::npos)
+        version = version.substr(0, pos);
+
+    /* find first non-digit */
+    pos = version.find_first_not_of("0123456789.");
+    if (pos != herdstat::util::StringView::npos)
+    {
+        extra = version.substr(pos);
+        version = version.substr(0, pos);
+    }
+}
+
+/* v1/x1 < v2/x2, where v is ${PV} minus suffix and x any extra non-digit
+ * characters (see split_version()) */
+static bool
+version_less(const herdstat::util::StringView& v1,
+             const herdstat::util::StringView& x1,
+             const herdstat::util::StringView& v2,
+             const herdstat::util::StringView& x2)
+{
+    bool differ = false;
+    bool result = false;
+
+    /* std::string comparison should be sufficient for == */
+    if (v1 == v2)
+        return x1 < x2;
+
+    const herdstat::util::StringView dot(".", 1);
+    const herdstat::util::SplitView thisparts(v1, dot);
+    const herdstat::util::SplitView thatparts(v2, dot);
+
+    /* TODO: if thisparts.size() and thatpart.size() == 1, convert to long
+     * and compare */
+
+    herdstat::util::SplitView::const_iterator thisiter, thatiter;
+    for (thisiter = thisparts.begin(), thatiter = thatparts.begin() ;
+         thisiter != thisparts.end() and thatiter != thatparts.end() ;
+         ++thisiter, ++thatiter)
+    {
+        /* loop until the version components differ */
+
+        /* TODO: use std::mismatch() ?? */
+        unsigned long thisver = version_component(*thisiter);
+        unsigned long thatver = version_component(*thatiter);
+
+        bool same = false;
+        if (thisver == thatver)
+        {
+            /* 1 == 01 ? they're the same in comparison speak but 
+             * absolutely not the same in version std::string speak */
+            if (thisiter->size() == thatiter->size() + 1 and
+                (*thisiter)[0] == '0' and thisiter->substr(1) == *thatiter)
+                same = true;
+            else
+                continue;
+        }
+        
+        result = ( same ? true : thisver < thatver );
+        differ = true;
+        break;
+    }
+
+    /* the one with fewer components (if any) is less */
+    if (not differ)
+        return (thisiter == thisparts.end());
+
+    return result;
+}
+
+/* r1/n1 < r2/n2, where r is a suffix's rank() and n its version (see
+ * split_suffix()) */
+static bool
+suffix_less(unsigned r1, const herdstat::util::StringView& n1,
+            unsigned r2, const herdstat::util::StringView& n2)
+{
+    if (r1 != r2)
+        return (r1 < r2);
+
+    /* no suffix, or the same suffix, so compare suffix version */
+    if (r1 == GlobalValidSuffixes().none())
+        return false;
+    else if (not n1.empty() and not n2.empty())
+        return (version_component(n1) < version_component(n2));
+
+    return (n1.empty() and not n2.empty());
+}
+
 namespace herdstat {
 namespace portage {
 /****************************************************************************/
@@ -111,7 +291,8 @@ VersionComponents::VersionComponents()
 }
 /****************************************************************************/
 VersionComponents::VersionComponents(const std::string &path)
-    : _verstr(util::chop_fileext(util::basename(path))), _vmap()
+    : _verstr(util::chop_fileext_view(util::basename_view(path)).str()),
+      _vmap()
 {
     this->parse();
 }
@@ -123,11 +304,19 @@ VersionComponents::~VersionComponents() throw()
 void
 VersionComponents::assign(const std::string& path)
 {
-    _verstr.assign(util::chop_fileext(util::basename(path)));
+    const util::StringView verstr(
+        util::chop_fileext_view(util::basename_view(path)));
+    _verstr.assign(verstr.data(), verstr.size());
     _vmap.clear();
     this->parse();
 }
 /****************************************************************************/
+util::MemoryUsage
+VersionComponents::memory_usage() const
+{
+    return (util::memory_usage(_verstr) + util::memory_usage(_vmap));
+}
+/****************************************************************************/
 void
 VersionComponents::parse()
 {
@@ -143,158 +332,71 @@ VersionComponents::parse()
         }
     }
 
-    std::vector<std::string> parts;
-    util::split(_verstr, std::back_inserter(parts), "-");
-
-    /* If parts > 3, ${PN} contains a '-' */
-    if (parts.size() > 3)
-    {
-        std::string PN;
-        while (parts.size() > 2)
-        {
-            PN += "-" + parts.front();
-            parts.erase(parts.begin());
-        }
-
-        parts.insert(parts.begin(), PN);
-    }
-
-    /* this should NEVER != 3. */
-    assert(parts.size() == 3);
-
-    /* fill our map with the components */
-    std::pair<iterator, bool> pn = _vmap.insert(value_type("PN", parts[0]));
-    std::pair<iterator, bool> pv = _vmap.insert(value_type("PV", parts[1]));
-    std::pair<iterator, bool> pr = _vmap.insert(value_type("PR", parts[2]));
-    assert(pn.second and pv.second and pr.second);
-    _vmap.insert(value_type("P", pn.first->second+"-"+pv.first->second));
-    std::pair<iterator, bool> pvr = _vmap.insert(value_type("PVR",
-        pv.first->second+"-"+pr.first->second));
-    _vmap.insert(value_type("PF", pn.first->second+"-"+pvr.first->second));
+    /* ${PN}-${PV}-${PR}, where ${PN} may contain a '-' */
+    const util::StringView verstr(_verstr);
+    const util::StringView::size_type pr_pos = verstr.rfind('-');
+    const util::StringView::size_type pv_pos = (pr_pos == 0 ?
+        util::StringView::npos : verstr.rfind('-', pr_pos - 1));
+
+    /* this should NEVER happen. */
+    assert(pv_pos != util::StringView::npos and pv_pos != 0);
+
+    const std::string PN(verstr.substr(0, pv_pos).str());
+    const std::string PV(verstr.substr(pv_pos + 1, pr_pos - pv_pos - 1).str());
+    const std::string PR(verstr.substr(pr_pos + 1).str());
+
+    /* fill our map with the components, in order so each one is
+     * simply appended */
+    _vmap.reserve(6);
+    _vmap.insert(_vmap.end(), value_type("P", PN+"-"+PV));
+    _vmap.insert(_vmap.end(), value_type("PF", PN+"-"+PV+"-"+PR));
+    _vmap.insert(_vmap.end(), value_type("PN", PN));
+    _vmap.insert(_vmap.end(), value_type("PR", PR));
+    _vmap.insert(_vmap.end(), value_type("PV", PV));
+    _vmap.insert(_vmap.end(), value_type("PVR", PV+"-"+PR));
+    assert(_vmap.size() == 6);
 
     /* remove $PN from _verstr */
-    std::string::size_type len(_vmap["PN"].length());
-    if (_vmap["PN"].find('-') == std::string::npos)
-        ++len;
-    _verstr.erase(0, len);
+    _verstr.erase(0, pv_pos + 1);
 }
 // }}}
 /****************************************************************************/
 // {{{ VersionString::suffix
 /****************************************************************************/
 VersionString::suffix::suffix()
-    : _suffix(), _suffix_ver()
+    : _suffix(), _suffix_ver(), _rank(GlobalValidSuffixes().none())
 {
 }
 /****************************************************************************/
-VersionString::suffix::suffix(const std::string& pvr)
-    : _suffix(), _suffix_ver()
+VersionString::suffix::suffix(const util::StringView& pvr)
+    : _suffix(), _suffix_ver(), _rank()
 {
     this->parse(pvr);
 }
 /****************************************************************************/
 void
-VersionString::suffix::parse(const std::string &pvr) const
-{
-    _suffix_ver.clear();
-    _suffix.assign(pvr);
-
-    /* chop revision */
-    std::string::size_type pos = _suffix.rfind("-r");
-    if (pos != std::string::npos)
-        _suffix.erase(pos);
-
-    /* get suffix */
-    pos = _suffix.rfind('_');
-    if (pos != std::string::npos)
-    {
-        _suffix.erase(0, pos+1);
-
-        /* get suffix version */
-        pos = _suffix.find_first_of("0123456789");
-        if (pos != std::string::npos)
-        {
-            _suffix_ver = _suffix.substr(pos);
-            _suffix.erase(pos);
-        }
-
-        /* ignore invalid suffixes */
-        if (not GlobalValidSuffixes().count(_suffix))
-            _suffix.clear();
-    }
-    else
-        _suffix.clear();
-}
-/****************************************************************************/
-bool
-VersionString::suffix::operator< (const suffix& that) const
+VersionString::suffix::parse(const util::StringView& pvr) const
 {
-    const ValidSuffixes& suffixes(GlobalValidSuffixes());
-    ValidSuffixes::const_iterator ti, si;
-
-    ti = suffixes.find(_suffix);
-    si = suffixes.find(that._suffix);
-
-    /* both have a suffix */
-    if ((ti != suffixes.end()) and (si != suffixes.end()))
-    {
-        /* same suffix, so compare suffix version */
-        if (ti == si)
-        {
-            if (not _suffix_ver.empty() and not that._suffix_ver.empty())
-                return ( util::destringify<unsigned long>(_suffix_ver) <
-                         util::destringify<unsigned long>(that._suffix_ver) );
-            else if (_suffix_ver.empty() and that._suffix_ver.empty())
-                return true;
-            else
-                return not that._suffix_ver.empty();
-        }
-
-        return ti < si;
-    }
-
-    /* that has no suffix */
-    else if (ti != suffixes.end())
-        /* only the 'p' suffix is > than no suffix */
-        return not (*ti == "p");
-    /* this has no suffix */
-    else if (si != suffixes.end())
-        /* only the 'p' suffix is > than no suffix */
-        return (*si == "p");
-
-    return false;
+    util::StringView suffix, suffix_ver;
+    _rank = split_suffix(pvr, suffix, suffix_ver);
+    _suffix.assign(suffix.data(), suffix.size());
+    _suffix_ver.assign(suffix_ver.data(), suffix_ver.size());
 }
 /****************************************************************************/
 bool
 VersionString::suffix::operator== (const suffix& that) const
 {
-    const ValidSuffixes& suffixes(GlobalValidSuffixes());
-    ValidSuffixes::const_iterator ti, si;
-
-    ti = suffixes.find(_suffix);
-    si = suffixes.find(that._suffix);
-
-    /* both have a suffix */
-    if ((ti != suffixes.end()) and (si != suffixes.end()))
-    {
-        /* same suffix, so compare suffix version */
-        if (ti == si)
-        {
-            if (not _suffix_ver.empty() and not that._suffix_ver.empty())
-                return ( util::destringify<unsigned long>(_suffix_ver) ==
-                         util::destringify<unsigned long>(that._suffix_ver) );
-            else if (_suffix_ver.empty() and that._suffix_ver.empty())
-                return true;
-            else
-                return not that._suffix_ver.empty();
-        }
-
-        return ti == si;
-    }
-    else if ((ti != suffixes.end()) or (si != suffixes.end()))
+    if (_rank != that._rank)
         return false;
 
-    return true;
+    /* no suffix, or the same suffix, so compare suffix version */
+    if (_rank == GlobalValidSuffixes().none())
+        return true;
+    else if (not _suffix_ver.empty() and not that._suffix_ver.empty())
+        return ( version_component(_suffix_ver) ==
+                 version_component(that._suffix_ver) );
+
+    return (_suffix_ver.empty() == that._suffix_ver.empty());
 }
 // }}}
 /****************************************************************************/
@@ -305,87 +407,19 @@ VersionString::nosuffix::nosuffix()
 {
 }
 /****************************************************************************/
-VersionString::nosuffix::nosuffix(const std::string& pv)
+VersionString::nosuffix::nosuffix(const util::StringView& pv)
     : _version(), _extra()
 {
     this->parse(pv);
 }
 /****************************************************************************/
 void
-VersionString::nosuffix::parse(const std::string& pv) const
+VersionString::nosuffix::parse(const util::StringView& pv) const
 {
-    _extra.clear();
-    _version.assign(pv);
-
-    /* strip suffix */
-    std::string::size_type pos = _version.find('_');
-    if (pos != std::string::npos)
-        _version.erase(pos);
-
-    /* find first non-digit */
-    pos = _version.find_first_not_of("0123456789.");
-    if (pos != std::string::npos)
-    {
-        _extra = _version.substr(pos);
-        _version.erase(pos);
-    }
-}
-/****************************************************************************/
-bool
-VersionString::nosuffix::operator< (const nosuffix& that) const
-{
-    bool differ = false;
-    bool result = false;
-
-    /* std::string comparison should be sufficient for == */
-    if (*this == that)
-        return false;
-    else if (_version == that._version)
-        return _extra < that._extra;
-
-    std::vector<std::string> thisparts, thatparts;
-    util::split(_version, std::back_inserter(thisparts), ".");
-    util::split(that._version, std::back_inserter(thatparts), ".");
-
-    std::vector<std::string>::size_type stoppos =
-        std::min<std::vector<std::string>::size_type>(thisparts.size(),
-                                                       thatparts.size());
-
-    /* TODO: if thisparts.size() and thatpart.size() == 1, convert to long
-     * and compare */
-
-    std::vector<std::string>::iterator thisiter, thatiter;
-    for (thisiter = thisparts.begin(), thatiter = thatparts.begin() ;
-         stoppos != 0 ; ++thisiter, ++thatiter, --stoppos)
-    {
-        /* loop until the version components differ */
-
-        /* TODO: use std::mismatch() ?? */
-        unsigned long thisver =
-            util::destringify<unsigned long>(*thisiter);
-        unsigned long thatver =
-            util::destringify<unsigned long>(*thatiter);
-
-        bool same = false;
-        if (thisver == thatver)
-        {
-            /* 1 == 01 ? they're the same in comparison speak but 
-             * absolutely not the same in version std::string speak */
-            if (*thisiter == (std::string("0") + *thatiter))
-                same = true;
-            else
-                continue;
-        }
-        
-        result = ( same ? true : thisver < thatver );
-        differ = true;
-        break;
-    }
-
-    if (not differ)
-        return (thisparts.size() <= thatparts.size());
-
-    return result;
+    util::StringView version, extra;
+    split_version(pv, version, extra);
+    _version.assign(version.data(), version.size());
+    _extra.assign(extra.data(), extra.size());
 }
 /****************************************************************************/
 bool
@@ -448,44 +482,103 @@ VersionString::str() const
     return _verstr;
 }
 /****************************************************************************/
+util::MemoryUsage
+VersionString::memory_usage() const
+{
+    return (util::memory_usage(_ebuild) + _v.memory_usage() +
+            util::memory_usage(_verstr) + _suffix.memory_usage() +
+            _version.memory_usage());
+}
+/****************************************************************************/
+VersionString::key
+VersionString::parts() const
+{
+    key k;
+    k._version = _version();
+    k._extra = _version.extra();
+    k._suffix = _suffix.rank();
+    k._suffix_ver = _suffix.version();
+
+    /* _verstr is ${PV}-${PR} */
+    const util::StringView verstr(_verstr);
+    k._rev = verstr.substr(verstr.rfind('-') + 2);
+    return k;
+}
+/****************************************************************************/
 bool
 VersionString::operator< (const VersionString& that) const
 {
-    if (_version < that._version)
+    return (this->parts() < that.parts());
+}
+// }}}
+/****************************************************************************/
+// {{{ VersionString::key
+/****************************************************************************/
+VersionString::key::key()
+    : _version(), _extra(), _suffix(GlobalValidSuffixes().none()),
+      _suffix_ver(), _rev()
+{
+}
+/****************************************************************************/
+VersionString::key::key(const util::StringView& path)
+    : _version(), _extra(), _suffix(GlobalValidSuffixes().none()),
+      _suffix_ver(), _rev()
+{
+    /* ${PN}-${PV}[-r${PR}], split the way VersionComponents::parse() does
+     * it but without copying anything */
+    const util::StringView verstr(
+        util::chop_fileext_view(util::basename_view(path)));
+
+    util::StringView::size_type pr_pos = verstr.rfind('-');
+    if (pr_pos != util::StringView::npos and
+        (pr_pos + 2) < verstr.size() and verstr[pr_pos + 1] == 'r' and
+        std::isdigit(static_cast<unsigned char>(verstr[pr_pos + 2])))
+        _rev = verstr.substr(pr_pos + 2);
+    else
+        pr_pos = verstr.size();
+
+    const util::StringView::size_type pv_pos = (pr_pos == 0 ?
+        util::StringView::npos : verstr.rfind('-', pr_pos - 1));
+
+    /* not an ebuild name; it won't match anything */
+    if (pv_pos == util::StringView::npos)
+        return;
+
+    const util::StringView pv(verstr.substr(pv_pos + 1, pr_pos - pv_pos - 1));
+    split_version(pv, _version, _extra);
+    util::StringView suffix;
+    _suffix = split_suffix(pv, suffix, _suffix_ver);
+}
+/****************************************************************************/
+bool
+VersionString::key::operator< (const key& that) const
+{
+    if (_version != that._version or _extra != that._extra)
+        return version_less(_version, _extra, that._version, that._extra);
+    else if (suffix_less(_suffix, _suffix_ver, that._suffix, that._suffix_ver))
         return true;
-    else if (_version == that._version)
-    {
-        if (_suffix < that._suffix)
-            return true;
-        else if (_suffix == that._suffix)
-        {
-            unsigned long thisrev =
-                util::destringify<unsigned long>(_v["PR"].substr(1));
-            unsigned long thatrev =
-                util::destringify<unsigned long>(that._v["PR"].substr(1));
-            return (thisrev <= thatrev);
-        }
-    }
+    else if (suffix_less(that._suffix, that._suffix_ver, _suffix, _suffix_ver))
+        return false;
 
-    return false;
+    return (version_component(_rev) < version_component(that._rev));
 }
 // }}}
 /****************************************************************************/
 // {{{ Versions
 /****************************************************************************/
 Versions::Versions()
-    : util::SetBase<VersionString>()
+    : util::FlatSetBase<VersionString, VersionString::less>()
 {
 }
 /****************************************************************************/
 Versions::Versions(const std::string& path)
-    : util::SetBase<VersionString>()
+    : util::FlatSetBase<VersionString, VersionString::less>()
 {
     this->assign(path);
 }
 /****************************************************************************/
 Versions::Versions(const std::vector<std::string>& paths)
-    : util::SetBase<VersionString>()
+    : util::FlatSetBase<VersionString, VersionString::less>()
 {
     std::for_each(paths.begin(), paths.end(),
         std::bind2nd(util::Appender<Versions, std::string>(), this));
@@ -504,16 +597,20 @@ Versions::assign(const std::string& path)
         return;
 
     const util::Directory pkgdir(path);
+    std::vector<std::string> ebuilds;
     util::copy_if(pkgdir.begin(), pkgdir.end(),
-        std::inserter(this->container(), this->end()), IsEbuild());
+        std::back_inserter(ebuilds), IsEbuild());
+    util::FlatSetBase<VersionString, VersionString::less>::insert(ebuilds.begin(), ebuilds.end());
 }
 /****************************************************************************/
 void
 Versions::append(const std::string& path)
 {
     const util::Directory pkgdir(path);
+    std::vector<std::string> ebuilds;
     util::copy_if(pkgdir.begin(), pkgdir.end(),
-        std::inserter(this->container(), this->end()), IsEbuild());
+        std::back_inserter(ebuilds), IsEbuild());
+    util::FlatSetBase<VersionString, VersionString::less>::insert(ebuilds.begin(), ebuilds.end());
 }
 /****************************************************************************/
 // }}}
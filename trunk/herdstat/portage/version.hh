@@ -43,6 +43,7 @@
 #include <cassert>
 
 #include <herdstat/util/container_base.hh>
+#include <herdstat/util/string.hh>
 #include <herdstat/util/functional.hh>
 #include <herdstat/util/file.hh>
 
@@ -76,14 +77,19 @@ namespace portage {
 
     class VersionComponents
     {
+        private:
+            /// Components, sorted by name.
+            class map_type
+                : public util::FlatMapBase<std::string, std::string> { };
+
         public:
-            typedef std::map<std::string, std::string> container_type;
-            typedef container_type::iterator iterator;
-            typedef container_type::const_iterator const_iterator;
-            typedef container_type::size_type size_type;
-            typedef container_type::value_type value_type;
-            typedef container_type::key_type key_type;
-            typedef container_type::mapped_type mapped_type;
+            typedef map_type::container_type container_type;
+            typedef map_type::iterator iterator;
+            typedef map_type::const_iterator const_iterator;
+            typedef map_type::size_type size_type;
+            typedef map_type::value_type value_type;
+            typedef map_type::key_type key_type;
+            typedef map_type::mapped_type mapped_type;
 
             /// Default constructor.
             VersionComponents();
@@ -103,7 +109,8 @@ namespace portage {
 
             /** Get value mapped to given version component.
              * @param key version component (P, PN, etc).
-             * @returns const reference to value mapped to @a key.
+             * @returns const reference to value mapped to @a key (empty if
+             * there's no such component).
              */
             inline const mapped_type& operator[](const key_type& key) const;
 
@@ -120,18 +127,23 @@ namespace portage {
             /// Get version string.
             inline const std::string& version() const;
 
+            /// Get heap bytes held by the version string and components.
+            util::MemoryUsage memory_usage() const;
+
         private:
             /// Parse version string and insert components into map.
             void parse();
 
             std::string _verstr;
-            mutable container_type _vmap;
+            map_type _vmap;
     };
 
     inline const VersionComponents::mapped_type&
     VersionComponents::operator[](const key_type& key) const
     {
-        return _vmap[key];
+        static const mapped_type empty;
+        const const_iterator i(_vmap.find(key));
+        return (i == _vmap.end() ? empty : i->second);
     }
 
     inline const std::string&
@@ -229,6 +241,32 @@ std::cout << v1.str() << std::endl;
             { return not (*this == that); }
             ///@}
 
+            /// Get heap bytes held by this version string.
+            util::MemoryUsage memory_usage() const;
+
+            class key;
+
+            /**
+             * @struct less
+             * @brief Transparent version ordering.
+             *
+             * Besides two VersionString objects, it compares a
+             * VersionString against a key parsed from an ebuild path, so a
+             * container ordered by it can be searched without constructing
+             * a VersionString.
+             */
+
+            struct less
+            {
+                typedef void is_transparent;
+
+                bool operator()(const VersionString& a,
+                                const VersionString& b) const
+                { return (a < b); }
+                bool operator()(const VersionString& a, const key& b) const;
+                bool operator()(const key& a, const VersionString& b) const;
+            };
+
         private:
             /**
              * @class suffix
@@ -244,12 +282,12 @@ std::cout << v1.str() << std::endl;
                     /** Constructor.
                      * @param pvr PVR string object (version+revision).
                      */
-                    suffix(const std::string& pvr);
+                    suffix(const util::StringView& pvr);
 
                     /** Assign a new suffix.
                      * @param pvr PVR string object (version+revision).
                      */
-                    void assign(const std::string& pvr)
+                    void assign(const util::StringView& pvr)
                     { this->parse(pvr); }
 
                     /** Get suffix string.
@@ -263,15 +301,19 @@ std::cout << v1.str() << std::endl;
                     const std::string& version() const
                     { return _suffix_ver; }
 
+                    /** Get position of the suffix in version order.
+                     * @returns Position (the same for every string that
+                     * isn't a valid suffix).
+                     */
+                    unsigned rank() const { return _rank; }
+
+                    /// Get heap bytes held by the suffix strings.
+                    util::MemoryUsage memory_usage() const
+                    { return (util::memory_usage(_suffix) +
+                              util::memory_usage(_suffix_ver)); }
+
                     ///@{
                     /// Compare this suffix against that suffix.
-                    bool operator< (const suffix& that) const;
-                    bool operator<=(const suffix& that) const
-                    { return not (*this > that); }
-                    bool operator> (const suffix& that) const
-                    { return (that < *this); }
-                    bool operator>=(const suffix& that) const
-                    { return not (*this < that); }
                     bool operator== (const suffix& that) const;
                     bool operator!= (const suffix& that) const
                     { return not (*this == that); }
@@ -279,12 +321,14 @@ std::cout << v1.str() << std::endl;
 
                 private:
                     /// Parse ${PVR}
-                    void parse(const std::string &pvr) const;
+                    void parse(const util::StringView& pvr) const;
 
                     /// Suffix std::string.
                     mutable std::string _suffix;
                     /// Suffix version std::string.
                     mutable std::string _suffix_ver;
+                    /// Position in version order.
+                    mutable unsigned _rank;
             };
 
             /**
@@ -300,12 +344,12 @@ std::cout << v1.str() << std::endl;
                     /** Constructor.
                      * @param pv PV string object.
                      */
-                    nosuffix(const std::string& pv);
+                    nosuffix(const util::StringView& pv);
 
                     /** Assign a new $PV.
                      * @param pv PV string object.
                      */
-                    void assign(const std::string& pv)
+                    void assign(const util::StringView& pv)
                     { this->parse(pv); }
 
                     /** Get version string minus suffix.
@@ -314,11 +358,18 @@ std::cout << v1.str() << std::endl;
                     const std::string& operator() () const
                     { return _version; }
 
+                    /** Get any extra non-digit characters.
+                     * @returns String object.
+                     */
+                    const std::string& extra() const { return _extra; }
+
+                    /// Get heap bytes held by the version strings.
+                    util::MemoryUsage memory_usage() const
+                    { return (util::memory_usage(_version) +
+                              util::memory_usage(_extra)); }
+
                     ///@{
                     /// Compare this nosuffix against that nosuffix.
-                    bool operator< (const nosuffix& that) const;
-                    bool operator> (const nosuffix& that) const
-                    { return (that < *this); }
                     bool operator== (const nosuffix& that) const;
                     bool operator!= (const nosuffix& that) const
                     { return not (*this == that); }
@@ -326,7 +377,7 @@ std::cout << v1.str() << std::endl;
 
                 private:
                     /// Parse ${PV}.
-                    void parse(const std::string& pv) const;
+                    void parse(const util::StringView& pv) const;
 
                     /// Version string (minus suffix).
                     mutable std::string _version;
@@ -334,6 +385,9 @@ std::cout << v1.str() << std::endl;
                     mutable std::string _extra;
             };
 
+            /// Get the parts we're ordered by, as views into our members.
+            key parts() const;
+
             /// Absolute path to ebuild.
             mutable std::string _ebuild;
             /// Version components map.
@@ -353,6 +407,57 @@ std::cout << v1.str() << std::endl;
                  (_suffix  == that._suffix)  and
                  (_v["PR"] == that._v["PR"]) );
     }
+
+    /**
+     * @class VersionString::key version.hh herdstat/portage/version.hh
+     * @brief The parts of an ebuild's version that VersionString is ordered
+     * by, as views into its path.
+     */
+
+    class VersionString::key
+    {
+        public:
+            /** Constructor.  The path must outlive the key.
+             * @param path Path to ebuild.
+             */
+            explicit key(const util::StringView& path);
+
+            /** Compare this key against that key.
+             * @exception BadCast if a revision or suffix version isn't a
+             * number.
+             */
+            bool operator< (const key& that) const;
+
+        private:
+            friend class VersionString;
+
+            key();
+
+            /// ${PV} minus suffix and any extra non-digit characters.
+            util::StringView _version;
+            /// Any extra non-digit characters.
+            util::StringView _extra;
+            /// Position of the suffix (alpha, beta, etc) in version order.
+            unsigned _suffix;
+            /// Suffix version.
+            util::StringView _suffix_ver;
+            /// ${PR} minus the 'r'.
+            util::StringView _rev;
+    };
+
+    inline bool
+    VersionString::less::operator()(const VersionString& a,
+                                    const key& b) const
+    {
+        return (a.parts() < b);
+    }
+
+    inline bool
+    VersionString::less::operator()(const key& a,
+                                    const VersionString& b) const
+    {
+        return (a < b.parts());
+    }
     // }}}
 
     // {{{ Versions
@@ -372,7 +477,8 @@ std::cout << v1.str() << std::endl;
      * @include versions/main.cc
      */
 
-    class Versions : public util::SetBase<VersionString>
+    class Versions
+        : public util::FlatSetBase<VersionString, VersionString::less>
     {
         public:
             /// Default constructor.
@@ -412,9 +518,12 @@ std::cout << v1.str() << std::endl;
             inline const VersionString& back() const;
 
             //@{
-            /** Find version string using ebuild matching path.
+            /** Find version string using ebuild matching path.  Only the
+             * file name of the ebuild is compared.
              * @param path Ebuild path.
              * @returns iterator to first match or end() if no match.
+             * @exception BadCast if a revision or suffix version isn't a
+             * number.
              */
             inline iterator find(const std::string& path);
             inline const_iterator find(const std::string& path) const;
@@ -448,25 +557,34 @@ std::cout << v1.str() << std::endl;
     inline Versions::iterator
     Versions::find(const std::string& p)
     {
-        return this->find(VersionString(p));
+        return static_cast<const Versions&>(*this).find(p);
     }
 
     inline Versions::const_iterator
     Versions::find(const std::string& p) const
     {
-        return this->find(VersionString(p));
+        /* search by version without building a VersionString, then make
+         * sure it's the same ebuild file name (${PF}.ebuild) */
+        const VersionString::key k(p);
+        const const_iterator i(this->lower_bound(k));
+        if (i == this->end() or this->value_comp()(k, *i) or
+            util::basename_view(i->ebuild()) != util::basename_view(p))
+            return this->end();
+        return i;
     }
 
     inline bool
     Versions::insert(const std::string& path)
     {
-        return util::SetBase<VersionString>::insert(VersionString(path)).second;
+        return util::FlatSetBase<VersionString, VersionString::less>::insert(
+            VersionString(path)).second;
     }
 
     inline bool
     Versions::insert(const VersionString& v)
     {
-        return util::SetBase<VersionString>::insert(v).second;
+        return util::FlatSetBase<VersionString,
+                                 VersionString::less>::insert(v).second;
     }
 
     inline const VersionString&
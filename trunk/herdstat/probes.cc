@@ -0,0 +1,43 @@
+/*
+ * libherdstat -- herdstat/probes.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <herdstat/probes.hh>
+
+#ifdef HAVE_USDT
+
+/* the tracer finds each probe's semaphore through its note, and bumps it
+ * while attached; they live in .probes as <sys/sdt.h> expects. */
+# define LIBHERDSTAT_PROBE_SEMAPHORE(name) \
+    extern "C" { \
+        unsigned short libherdstat_##name##_semaphore \
+            __attribute__ ((section (".probes"))) = 0; \
+    }
+LIBHERDSTAT_PROBES(LIBHERDSTAT_PROBE_SEMAPHORE)
+# undef LIBHERDSTAT_PROBE_SEMAPHORE
+
+#endif /* HAVE_USDT */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,122 @@
+/*
+ * libherdstat -- herdstat/probes.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_PROBES_HH
+#define _HAVE_PROBES_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/probes.hh
+ * @brief Defines the LIBHERDSTAT_PROBE* static tracepoint macros.
+ *
+ * Internal header; not installed.
+ *
+ * When configured with --enable-usdt, each probe compiles to a single nop
+ * plus an ELF note (see <sys/sdt.h>) that dtrace, systemtap, perf and
+ * bpftrace can attach to, eg:
+ *
+ * @code
+ * bpftrace -e 'usdt:/usr/lib/libherdstat.so:libherdstat:fetch__return
+ *     { printf("%s %d\n", str(arg0), arg2); }'
+ * @endcode
+ *
+ * Otherwise the macros expand to nothing and their arguments are never
+ * evaluated.  Even with --enable-usdt, arguments are evaluated every time
+ * the probe is passed, traced or not; anything costly to compute (a
+ * stat(), say) goes behind LIBHERDSTAT_PROBE_ENABLED(name), which reads
+ * the probe's semaphore and is only true while a tracer is attached.
+ * Each probe's semaphore is defined in probes.cc, so a new probe must be
+ * added to LIBHERDSTAT_PROBES too.
+ *
+ * Probes come in entry/return pairs named <op>__entry and
+ * <op>__return; a return probe does not fire if the operation throws
+ * before reaching it.  Strings are passed as const char *, sizes as long.
+ *
+ * - directory__read__entry(path), directory__read__return(path, entries)
+ * - fetch__entry(url, path), fetch__return(url, path, bytes)
+ *   (bytes is -1 if the fetch failed)
+ * - sax__parse__entry(path), sax__parse__return(path, bytes)
+ * - keywords__entry(pkgdir), keywords__return(pkgdir, versions)
+ */
+
+/* every probe, to declare (and define, in probes.cc) their semaphores */
+#define LIBHERDSTAT_PROBES(P) \
+    P(directory__read__entry) P(directory__read__return) \
+    P(fetch__entry) P(fetch__return) \
+    P(sax__parse__entry) P(sax__parse__return) \
+    P(keywords__entry) P(keywords__return)
+
+#ifdef HAVE_USDT
+
+# include <sys/types.h>
+# include <sys/stat.h>
+# define _SDT_HAS_SEMAPHORES 1
+# include <sys/sdt.h>
+# include <string>
+
+# define LIBHERDSTAT_PROBE_SEMAPHORE(name) \
+    extern "C" unsigned short libherdstat_##name##_semaphore;
+LIBHERDSTAT_PROBES(LIBHERDSTAT_PROBE_SEMAPHORE)
+# undef LIBHERDSTAT_PROBE_SEMAPHORE
+
+# define LIBHERDSTAT_PROBE_ENABLED(name) \
+    __builtin_expect(libherdstat_##name##_semaphore != 0, 0)
+
+# define LIBHERDSTAT_PROBE1(name, a) \
+    STAP_PROBE1(libherdstat, name, a)
+# define LIBHERDSTAT_PROBE2(name, a, b) \
+    STAP_PROBE2(libherdstat, name, a, b)
+# define LIBHERDSTAT_PROBE3(name, a, b, c) \
+    STAP_PROBE3(libherdstat, name, a, b, c)
+
+namespace herdstat {
+namespace probes {
+
+    /** Size of the given file in bytes, or -1 if it can't be stat'd.
+     * Guard with LIBHERDSTAT_PROBE_ENABLED().
+     */
+    inline long
+    file_size(const std::string& path)
+    {
+        struct stat s;
+        return (::stat(path.c_str(), &s) == 0 ?
+                static_cast<long>(s.st_size) : -1L);
+    }
+
+} // namespace probes
+} // namespace herdstat
+
+#else /* HAVE_USDT */
+
+# define LIBHERDSTAT_PROBE_ENABLED(name) false
+# define LIBHERDSTAT_PROBE1(name, a) do { } while (0)
+# define LIBHERDSTAT_PROBE2(name, a, b) do { } while (0)
+# define LIBHERDSTAT_PROBE3(name, a, b, c) do { } while (0)
+
+#endif /* HAVE_USDT */
+
+#endif /* _HAVE_PROBES_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
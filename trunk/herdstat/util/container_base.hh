@@ -30,11 +30,13 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <algorithm>
 #include <functional>
+#include <herdstat/util/memory.hh>
 
 /**
  * @file herdstat/util/container_base.hh
- * @brief Defines the ContainerBase base class template.
+ * @brief Defines the ContainerBase family of base class templates.
  */
 
 namespace herdstat {
@@ -153,6 +155,13 @@ v.insert(v.end(),
             inline void clear() { _c.clear(); }
             inline void swap(const container_type& c) { _c.swap(c); }
             //@}
+
+            /** Get heap bytes held by the container and its elements.
+             * Derived classes with members of their own should hide this
+             * with a version that adds them.
+             */
+            inline MemoryUsage memory_usage() const
+            { return util::memory_usage(_c); }
     
         protected:
             /// Default constructor.
@@ -481,6 +490,524 @@ v.insert(v.end(),
     {
     }
 
+    /**
+     * @struct TransparentLookup container_base.hh herdstat/util/container_base.hh
+     * @brief Return type R of the heterogeneous lookups of FlatSetBase and
+     * FlatMapBase for key type Key, which only exist if the comparison
+     * function object is "transparent".
+     *
+     * A transparent Compare declares
+     * @code typedef void is_transparent; @endcode
+     * and can compare elements against other key types directly, so eg a
+     * container of std::string can be searched with a StringView or a
+     * C string without constructing a std::string each time.
+     */
+
+    template <typename Compare, typename Key, typename R, typename Void = void>
+    struct TransparentLookup { };
+
+    template <typename Compare, typename Key, typename R>
+    struct TransparentLookup<Compare, Key, R, typename Compare::is_transparent>
+    {
+        typedef R type;
+    };
+
+    /**
+     * Merge the unsorted elements appended to a sorted vector (from
+     * position @a n on) into it, dropping any that are equivalent to an
+     * element before them (so existing elements win over new ones, and
+     * earlier new ones over later ones).  Used by FlatSetBase and
+     * FlatMapBase for bulk insertion.
+     * @param c Vector whose first @a n elements are sorted and unique.
+     * @param n Number of elements that were already there.
+     * @param comp Comparison function object.
+     */
+    template <typename C, typename Compare>
+    void
+    flat_merge(C& c, typename C::size_type n, Compare comp)
+    {
+        typedef typename C::iterator iterator;
+
+        const iterator middle(c.begin() + n);
+
+        /* new elements are often in order already (eg from a sorted file),
+         * in which case sorting them would only cost a temporary buffer */
+        iterator i(middle);
+        while (i != c.end() and (i + 1) != c.end() and not comp(*(i + 1), *i))
+            ++i;
+        if (i != c.end() and (i + 1) != c.end())
+            std::stable_sort(middle, c.end(), comp);
+
+        if (middle != c.begin() and middle != c.end() and
+            comp(*middle, *(middle - 1)))
+            std::inplace_merge(c.begin(), middle, c.end(), comp);
+
+        /* equivalent elements are now adjacent, first one first */
+        iterator last(c.begin());
+        if ((i = c.begin()) != c.end())
+        {
+            while (++i != c.end())
+            {
+                if (comp(*last, *i) and ++last != i)
+                    *last = *i;
+            }
+            c.erase(++last, c.end());
+        }
+    }
+
+    /**
+     * @class FlatSetBase container_base.hh herdstat/util/container_base.hh
+     * @brief Base class template for classes that act like a set<T>, but
+     * keep their elements in a sorted vector.
+     *
+     * Lookups are binary searches and iteration walks contiguous memory, so
+     * both touch far fewer cache lines than with SetBase; a full container
+     * is a single allocation instead of one per element.  In exchange,
+     * inserting or erasing a single element is linear and, like any vector
+     * operation that changes the size, invalidates iterators and references.
+     * Use it for containers that are filled once and then searched, and
+     * fill them with insert(begin, end), which sorts once.
+     *
+     * Elements can't be modified through iterators (same as a set).
+     *
+     * @see ContainerBase documentation.
+     */
+
+    template <typename T, typename Compare = std::less<T> >
+    class FlatSetBase : public ContainerBase<std::vector<T> >
+    {
+        public:
+            typedef ContainerBase<std::vector<T> > base_type;
+            typedef typename base_type::container_type container_type;
+            typedef typename container_type::size_type size_type;
+            typedef typename container_type::difference_type difference_type;
+            typedef typename container_type::value_type value_type;
+            typedef typename container_type::const_iterator iterator;
+            typedef typename container_type::const_iterator const_iterator;
+            typedef typename container_type::const_reverse_iterator
+                reverse_iterator;
+            typedef typename container_type::const_reverse_iterator
+                const_reverse_iterator;
+            typedef value_type key_type;
+            typedef Compare key_compare;
+            typedef Compare value_compare;
+
+            virtual ~FlatSetBase();
+
+            inline const_iterator begin() const
+            { return this->container().begin(); }
+            inline const_iterator end() const
+            { return this->container().end(); }
+            inline const_reverse_iterator rbegin() const
+            { return this->container().rbegin(); }
+            inline const_reverse_iterator rend() const
+            { return this->container().rend(); }
+
+            std::pair<iterator, bool> insert(const value_type& v);
+            iterator insert(iterator hintpos, const value_type& v);
+            template <typename In>
+            void insert(In begin, In end);
+
+            inline void erase(iterator pos)
+            { this->container().erase(this->mutable_iterator(pos)); }
+            size_type erase(const key_type& k);
+            inline void erase(iterator begin, iterator end)
+            {
+                this->container().erase(this->mutable_iterator(begin),
+                                        this->mutable_iterator(end));
+            }
+
+            inline key_compare key_comp() const { return key_compare(); }
+            inline value_compare value_comp() const { return value_compare(); }
+
+            const_iterator find(const key_type& k) const;
+            inline size_type count(const key_type& k) const
+            { return (this->find(k) == this->end() ? 0 : 1); }
+
+            inline const_iterator lower_bound(const key_type& k) const
+            { return std::lower_bound(this->begin(), this->end(), k,
+                                      Compare()); }
+            inline const_iterator upper_bound(const key_type& k) const
+            { return std::upper_bound(this->begin(), this->end(), k,
+                                      Compare()); }
+            inline std::pair<const_iterator, const_iterator>
+            equal_range(const key_type& k) const
+            { return std::equal_range(this->begin(), this->end(), k,
+                                      Compare()); }
+
+            ///@{
+            /** Heterogeneous lookups; only available if Compare is
+             * transparent (see TransparentLookup).
+             */
+            template <typename Key>
+            typename TransparentLookup<Compare, Key, const_iterator>::type
+            find(const Key& k) const
+            {
+                const const_iterator pos(this->lower_bound(k));
+                return ((pos == this->end() or Compare()(k, *pos)) ?
+                        this->end() : pos);
+            }
+
+            template <typename Key>
+            typename TransparentLookup<Compare, Key, size_type>::type
+            count(const Key& k) const
+            { return (this->find(k) == this->end() ? 0 : 1); }
+
+            template <typename Key>
+            typename TransparentLookup<Compare, Key, const_iterator>::type
+            lower_bound(const Key& k) const
+            { return std::lower_bound(this->begin(), this->end(), k,
+                                      Compare()); }
+
+            template <typename Key>
+            typename TransparentLookup<Compare, Key, const_iterator>::type
+            upper_bound(const Key& k) const
+            { return std::upper_bound(this->begin(), this->end(), k,
+                                      Compare()); }
+
+            template <typename Key>
+            typename TransparentLookup<Compare, Key,
+                std::pair<const_iterator, const_iterator> >::type
+            equal_range(const Key& k) const
+            { return std::equal_range(this->begin(), this->end(), k,
+                                      Compare()); }
+            ///@}
+
+            /// Make room for @a n elements (before a series of inserts).
+            inline void reserve(size_type n) { this->container().reserve(n); }
+
+        protected:
+            FlatSetBase();
+            FlatSetBase(const container_type& c);
+            template <class In>
+            FlatSetBase(In begin, In end);
+
+        private:
+            typename container_type::iterator mutable_iterator(const_iterator i)
+            { return this->container().begin() + (i - this->begin()); }
+    };
+
+    template <typename T, typename Compare>
+    FlatSetBase<T, Compare>::FlatSetBase()
+    {
+    }
+
+    template <typename T, typename Compare>
+    FlatSetBase<T, Compare>::FlatSetBase(const container_type& c)
+    {
+        this->insert(c.begin(), c.end());
+    }
+    
+    template <typename T, typename Compare>
+    template <class In>
+    FlatSetBase<T, Compare>::FlatSetBase(In begin, In end)
+    {
+        this->insert(begin, end);
+    }
+
+    template <typename T, typename Compare>
+    FlatSetBase<T, Compare>::~FlatSetBase()
+    {
+    }
+
+    template <typename T, typename Compare>
+    std::pair<typename FlatSetBase<T, Compare>::iterator, bool>
+    FlatSetBase<T, Compare>::insert(const value_type& v)
+    {
+        const iterator pos(this->lower_bound(v));
+        if (pos != this->end() and not Compare()(v, *pos))
+            return std::make_pair(pos, false);
+        return std::make_pair(iterator(this->container().insert(
+            this->mutable_iterator(pos), v)), true);
+    }
+
+    template <typename T, typename Compare>
+    typename FlatSetBase<T, Compare>::iterator
+    FlatSetBase<T, Compare>::insert(iterator hintpos, const value_type& v)
+    {
+        /* right before hintpos? */
+        const Compare comp;
+        if ((hintpos == this->end() or comp(v, *hintpos)) and
+            (hintpos == this->begin() or comp(*(hintpos - 1), v)))
+            return this->container().insert(this->mutable_iterator(hintpos), v);
+        return this->insert(v).first;
+    }
+
+    template <typename T, typename Compare>
+    template <typename In>
+    void
+    FlatSetBase<T, Compare>::insert(In begin, In end)
+    {
+        const size_type n = this->size();
+        this->container().insert(this->container().end(), begin, end);
+        flat_merge(this->container(), n, Compare());
+    }
+
+    template <typename T, typename Compare>
+    typename FlatSetBase<T, Compare>::size_type
+    FlatSetBase<T, Compare>::erase(const key_type& k)
+    {
+        const iterator pos(this->find(k));
+        if (pos == this->end())
+            return 0;
+        this->erase(pos);
+        return 1;
+    }
+
+    template <typename T, typename Compare>
+    typename FlatSetBase<T, Compare>::const_iterator
+    FlatSetBase<T, Compare>::find(const key_type& k) const
+    {
+        const const_iterator pos(this->lower_bound(k));
+        return ((pos == this->end() or Compare()(k, *pos)) ? this->end() : pos);
+    }
+
+    /**
+     * @class FlatMapBase container_base.hh herdstat/util/container_base.hh
+     * @brief Base class template for classes that act like a map<K,V>, but
+     * keep their elements in a vector sorted by key.
+     *
+     * Same trade-offs as FlatSetBase.  Elements are std::pair<K,V> (not
+     * std::pair<const K,V>); values may be modified through iterators but
+     * keys must not be.
+     *
+     * @see ContainerBase documentation.
+     */
+
+    template <typename K, typename V, typename Compare = std::less<K> >
+    class FlatMapBase : public ContainerBase<std::vector<std::pair<K, V> > >
+    {
+        public:
+            typedef ContainerBase<std::vector<std::pair<K, V> > > base_type;
+            typedef typename base_type::container_type container_type;
+            typedef typename container_type::size_type size_type;
+            typedef typename container_type::difference_type difference_type;
+            typedef typename container_type::value_type value_type;
+            typedef typename container_type::iterator iterator;
+            typedef typename container_type::const_iterator const_iterator;
+            typedef K key_type;
+            typedef V mapped_type;
+            typedef Compare key_compare;
+
+            /// Compares elements by key (with each other or with a key).
+            class value_compare
+            {
+                public:
+                    bool operator()(const value_type& lhs,
+                                    const value_type& rhs) const
+                    { return _comp(lhs.first, rhs.first); }
+                    template <typename Key>
+                    bool operator()(const value_type& lhs,
+                                    const Key& rhs) const
+                    { return _comp(lhs.first, rhs); }
+                    template <typename Key>
+                    bool operator()(const Key& lhs,
+                                    const value_type& rhs) const
+                    { return _comp(lhs, rhs.first); }
+
+                private:
+                    Compare _comp;
+            };
+
+            virtual ~FlatMapBase();
+
+            mapped_type& operator[](const key_type& k);
+
+            std::pair<iterator, bool> insert(const value_type& v);
+            iterator insert(iterator hintpos, const value_type& v);
+            template <typename In>
+            void insert(In begin, In end);
+
+            inline void erase(iterator pos) { this->container().erase(pos); }
+            size_type erase(const key_type& k);
+            inline void erase(iterator begin, iterator end)
+            { this->container().erase(begin, end); }
+
+            inline key_compare key_comp() const { return key_compare(); }
+            inline value_compare value_comp() const { return value_compare(); }
+
+            iterator find(const key_type& k);
+            const_iterator find(const key_type& k) const;
+
+            inline size_type count(const key_type& k) const
+            { return (this->find(k) == this->end() ? 0 : 1); }
+
+            inline iterator lower_bound(const key_type& k)
+            { return std::lower_bound(this->begin(), this->end(), k,
+                                      value_compare()); }
+            inline const_iterator lower_bound(const key_type& k) const
+            { return std::lower_bound(this->begin(), this->end(), k,
+                                      value_compare()); }
+            inline iterator upper_bound(const key_type& k)
+            { return std::upper_bound(this->begin(), this->end(), k,
+                                      value_compare()); }
+            inline const_iterator upper_bound(const key_type& k) const
+            { return std::upper_bound(this->begin(), this->end(), k,
+                                      value_compare()); }
+            inline std::pair<iterator, iterator> equal_range(const key_type& k)
+            { return std::equal_range(this->begin(), this->end(), k,
+                                      value_compare()); }
+            inline std::pair<const_iterator, const_iterator>
+            equal_range(const key_type& k) const
+            { return std::equal_range(this->begin(), this->end(), k,
+                                      value_compare()); }
+
+            ///@{
+            /** Heterogeneous lookups; only available if Compare is
+             * transparent (see TransparentLookup).
+             */
+            template <typename Key>
+            typename TransparentLookup<Compare, Key, iterator>::type
+            find(const Key& k)
+            {
+                const iterator pos(this->lower_bound(k));
+                return ((pos == this->end() or Compare()(k, pos->first)) ?
+                        this->end() : pos);
+            }
+
+            template <typename Key>
+            typename TransparentLookup<Compare, Key, const_iterator>::type
+            find(const Key& k) const
+            {
+                const const_iterator pos(this->lower_bound(k));
+                return ((pos == this->end() or Compare()(k, pos->first)) ?
+                        this->end() : pos);
+            }
+
+            template <typename Key>
+            typename TransparentLookup<Compare, Key, size_type>::type
+            count(const Key& k) const
+            { return (this->find(k) == this->end() ? 0 : 1); }
+
+            template <typename Key>
+            typename TransparentLookup<Compare, Key, iterator>::type
+            lower_bound(const Key& k)
+            { return std::lower_bound(this->begin(), this->end(), k,
+                                      value_compare()); }
+
+            template <typename Key>
+            typename TransparentLookup<Compare, Key, const_iterator>::type
+            lower_bound(const Key& k) const
+            { return std::lower_bound(this->begin(), this->end(), k,
+                                      value_compare()); }
+
+            template <typename Key>
+            typename TransparentLookup<Compare, Key, iterator>::type
+            upper_bound(const Key& k)
+            { return std::upper_bound(this->begin(), this->end(), k,
+                                      value_compare()); }
+
+            template <typename Key>
+            typename TransparentLookup<Compare, Key, const_iterator>::type
+            upper_bound(const Key& k) const
+            { return std::upper_bound(this->begin(), this->end(), k,
+                                      value_compare()); }
+            ///@}
+
+            /// Make room for @a n elements (before a series of inserts).
+            inline void reserve(size_type n) { this->container().reserve(n); }
+
+        protected:
+            FlatMapBase();
+            FlatMapBase(const container_type& c);
+            template <typename In>
+            FlatMapBase(In begin, In end);
+    };
+
+    template <typename K, typename V, typename Compare>
+    FlatMapBase<K,V,Compare>::FlatMapBase()
+    {
+    }
+    
+    template <typename K, typename V, typename Compare>
+    FlatMapBase<K,V,Compare>::FlatMapBase(const container_type& c) 
+    {
+        this->insert(c.begin(), c.end());
+    }
+    
+    template <typename K, typename V, typename Compare>
+    template <typename In>
+    FlatMapBase<K,V,Compare>::FlatMapBase(In begin, In end)
+    {
+        this->insert(begin, end);
+    }
+
+    template <typename K, typename V, typename Compare>
+    FlatMapBase<K,V,Compare>::~FlatMapBase()
+    {
+    }
+
+    template <typename K, typename V, typename Compare>
+    typename FlatMapBase<K,V,Compare>::mapped_type&
+    FlatMapBase<K,V,Compare>::operator[](const key_type& k)
+    {
+        iterator pos(this->lower_bound(k));
+        if (pos == this->end() or Compare()(k, pos->first))
+            pos = this->container().insert(pos, value_type(k, mapped_type()));
+        return pos->second;
+    }
+
+    template <typename K, typename V, typename Compare>
+    std::pair<typename FlatMapBase<K,V,Compare>::iterator, bool>
+    FlatMapBase<K,V,Compare>::insert(const value_type& v)
+    {
+        const iterator pos(this->lower_bound(v.first));
+        if (pos != this->end() and not Compare()(v.first, pos->first))
+            return std::make_pair(pos, false);
+        return std::make_pair(this->container().insert(pos, v), true);
+    }
+
+    template <typename K, typename V, typename Compare>
+    typename FlatMapBase<K,V,Compare>::iterator
+    FlatMapBase<K,V,Compare>::insert(iterator hintpos, const value_type& v)
+    {
+        /* right before hintpos? */
+        const Compare comp;
+        if ((hintpos == this->end() or comp(v.first, hintpos->first)) and
+            (hintpos == this->begin() or comp((hintpos - 1)->first, v.first)))
+            return this->container().insert(hintpos, v);
+        return this->insert(v).first;
+    }
+
+    template <typename K, typename V, typename Compare>
+    template <typename In>
+    void
+    FlatMapBase<K,V,Compare>::insert(In begin, In end)
+    {
+        const size_type n = this->size();
+        this->container().insert(this->container().end(), begin, end);
+        flat_merge(this->container(), n, value_compare());
+    }
+
+    template <typename K, typename V, typename Compare>
+    typename FlatMapBase<K,V,Compare>::size_type
+    FlatMapBase<K,V,Compare>::erase(const key_type& k)
+    {
+        const iterator pos(this->find(k));
+        if (pos == this->end())
+            return 0;
+        this->erase(pos);
+        return 1;
+    }
+
+    template <typename K, typename V, typename Compare>
+    typename FlatMapBase<K,V,Compare>::iterator
+    FlatMapBase<K,V,Compare>::find(const key_type& k)
+    {
+        const iterator pos(this->lower_bound(k));
+        return ((pos == this->end() or Compare()(k, pos->first)) ?
+                this->end() : pos);
+    }
+
+    template <typename K, typename V, typename Compare>
+    typename FlatMapBase<K,V,Compare>::const_iterator
+    FlatMapBase<K,V,Compare>::find(const key_type& k) const
+    {
+        const const_iterator pos(this->lower_bound(k));
+        return ((pos == this->end() or Compare()(k, pos->first)) ?
+                this->end() : pos);
+    }
+
 } // namespace util
 } // namespace herdstat
 
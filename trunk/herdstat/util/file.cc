@@ -26,12 +26,17 @@
 
 #include <algorithm>
 #include <functional>
+#include <memory>
 #include <iterator>
 #include <utility>
+#include <cstdio>
 #include <cstring>
 #include <cassert>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include <herdstat/exceptions.hh>
+#include <herdstat/probes.hh>
 #include <herdstat/util/functional.hh>
 #include <herdstat/util/file.hh>
 
@@ -60,7 +65,7 @@ Stat::assign(const std::string &p, bool opened)
 bool
 Stat::operator()(void)
 {
-    BacktraceContext s("herdstat::util::Stat::operator()("+_path+")");
+    BacktraceContext s("herdstat::util::Stat::operator()(%s)", _path);
 
     if (this->_opened)
     {
@@ -106,7 +111,8 @@ BaseFileObject::~BaseFileObject() throw()
 void
 BaseFileObject::close()
 {
-    BacktraceContext c("herdstat::util::BaseFileObject::close("+this->path()+")");
+    BacktraceContext c("herdstat::util::BaseFileObject::close(%s)",
+        this->path());
 
     if (not this->is_open())
         return;
@@ -128,7 +134,7 @@ BaseFileObject::read()
 void
 BaseFileObject::read(const std::string& path)
 {
-    BacktraceContext c("herdstat::util::BaseFileObject::read("+path+")");
+    BacktraceContext c("herdstat::util::BaseFileObject::read(%s)", path);
 
     if (this->is_open())
         this->close();
@@ -141,18 +147,21 @@ BaseFileObject::read(const std::string& path)
 }
 /*****************************************************************************/
 BaseFile::BaseFile()
-    : BaseFileObject(), _stream(NULL), _mode(DEFAULT_MODE)
+    : BaseFileObject(), _stream(NULL), _buffer(NULL), _mode(DEFAULT_MODE),
+      _compression(io::COMPRESSION_NONE)
 {
 }
 /*****************************************************************************/
 BaseFile::BaseFile(const BaseFile& that)
-    : BaseFileObject(), _stream(NULL), _mode(DEFAULT_MODE)
+    : BaseFileObject(), _stream(NULL), _buffer(NULL), _mode(DEFAULT_MODE),
+      _compression(io::COMPRESSION_NONE)
 {
     *this = that;
 }
 /*****************************************************************************/
 BaseFile::BaseFile(const std::string &path, std::ios_base::openmode mode)
-    : BaseFileObject(path), _stream(NULL), _mode(mode)
+    : BaseFileObject(path), _stream(NULL), _buffer(NULL), _mode(mode),
+      _compression(io::COMPRESSION_NONE)
 {
     this->open(this->path().c_str(), mode);
 }
@@ -166,7 +175,7 @@ BaseFile::operator=(const BaseFile& that)
 
     set_mode(that.mode());
 
-    if (that._stream and that._stream->is_open())
+    if (that._buffer or (that._stream and that._stream->is_open()))
         this->open(that.path().c_str(), mode());
 
     return *this;
@@ -184,10 +193,16 @@ BaseFile::open(const char *n, std::ios_base::openmode mode)
     if (this->path() != n)
         this->stat().assign(n);
 
-    BacktraceContext c("herdstat::util::BaseFile::open("+this->path()+")");
+    BacktraceContext c("herdstat::util::BaseFile::open(%s)", this->path());
 
     set_mode(mode);
 
+    if (_buffer)
+    {
+        this->set_open(true);
+        return;
+    }
+
     if (_stream)
     {
         if (_stream->is_open())
@@ -204,6 +219,32 @@ BaseFile::open(const char *n, std::ios_base::openmode mode)
     if (not _stream->is_open())
         throw FileException(n);
 
+    /* if opened read-only, sniff the magic bytes and, if compressed,
+     * replace the file stream with its decompressed contents.  only
+     * regular files can be rewound afterwards; sniffing a pipe would eat
+     * the start of it. */
+    _compression = io::COMPRESSION_NONE;
+    if (not (mode & std::ios::out) and this->stat().type() == REGULAR)
+    {
+        char magic[6];
+        const std::streamsize len = _stream->rdbuf()->sgetn(magic,
+                                        sizeof(magic));
+        _stream->rdbuf()->pubseekpos(0, std::ios::in);
+
+        if (len > 0)
+            _compression = io::detect_compression(magic, len);
+
+        if (_compression != io::COMPRESSION_NONE)
+        {
+            std::string contents;
+            io::Decompressor(n).read_all(contents);
+
+            delete _stream;
+            _stream = NULL;
+            _buffer = new std::stringstream(contents, mode);
+        }
+    }
+
     this->set_open(true);
 }
 /*****************************************************************************/
@@ -228,6 +269,25 @@ BaseFile::do_close()
         delete _stream;
         _stream = NULL;
     }
+
+    if (_buffer)
+    {
+        delete _buffer;
+        _buffer = NULL;
+    }
+}
+/*****************************************************************************/
+MemoryUsage
+BaseFile::memory_usage() const
+{
+    MemoryUsage m(util::memory_usage(this->path()));
+
+    if (_stream)
+        m.nodes += sizeof(std::fstream) + (_stream->is_open() ? BUFSIZ : 0);
+    if (_buffer)
+        m.nodes += sizeof(std::stringstream) + _buffer->str().size() + 1;
+
+    return m;
 }
 /*****************************************************************************/
 File::File(const std::string &path, std::ios_base::openmode mode)
@@ -243,15 +303,60 @@ File::~File() throw()
 void
 File::do_read()
 {
-    BacktraceContext c("herdstat::util::File::do_read("+this->path()+")");
+    BacktraceContext c("herdstat::util::File::do_read(%s)", this->path());
+
+    /* read-only and not compressed; splitting the mapped file is much
+     * cheaper than getline().  only for regular, non-empty files though:
+     * pipes can't be mapped and /proc files claim to be empty.  fstat()
+     * the descriptor we map, so the answer can't change under us (our
+     * stream won't hand over its own descriptor).  O_NONBLOCK so opening
+     * a FIFO whose writer has gone doesn't hang. */
+    if (not (this->mode() & std::ios::out) and
+        this->compression() == io::COMPRESSION_NONE)
+    {
+        const int fd = ::open(this->path().c_str(), O_RDONLY|O_NONBLOCK);
+        std::auto_ptr<const ReadOnlyFile> file;
+        struct stat st;
+
+        if (fd != -1 and fstat(fd, &st) == 0 and
+            S_ISREG(st.st_mode) and st.st_size > 0)
+        {
+            try
+            {
+                file.reset(new ReadOnlyFile(this->path(), fd));
+            }
+            catch (const FileException&)
+            {
+                /* can't map it; fall back to the stream */
+            }
+            catch (...)
+            {
+                ::close(fd);
+                throw;
+            }
+        }
+
+        if (fd != -1)
+            ::close(fd);
+
+        if (file.get())
+        {
+            this->reserve(this->size() + file->size());
+
+            ReadOnlyFile::const_iterator i;
+            for (i = file->begin() ; i != file->end() ; ++i)
+                this->push_back(i->str());
+            return;
+        }
+    }
 
     std::string line;
-    while (std::getline(this->stream(), line))
+    while (std::getline(this->input(), line))
         this->push_back(line);
 
     /*
      * this->insert(this->end(),
-     *      std::istream_iterator<std::string>(this->stream()),
+     *      std::istream_iterator<std::string>(this->input()),
      *      std::istream_iterator<std::string>());
      */
 }
@@ -270,7 +375,7 @@ File::operator== (const File &that) const
 void
 File::dump(std::ostream &os) const
 {
-    BacktraceContext c("herdstat::util::File::dump("+this->path()+")");
+    BacktraceContext c("herdstat::util::File::dump(%s)", this->path());
     std::copy(this->begin(), this->end(),
         std::ostream_iterator<value_type>(os, "\n"));
 }
@@ -278,11 +383,146 @@ File::dump(std::ostream &os) const
 void
 File::write()
 {
-    BacktraceContext c("herdstat::util::File::write("+this->path()+")");
+    BacktraceContext c("herdstat::util::File::write(%s)", this->path());
+
+    if (this->compression() != io::COMPRESSION_NONE)
+    {
+        this->write(this->compression());
+        return;
+    }
+
     this->dump(this->stream());
     this->clear();
 }
 /*****************************************************************************/
+void
+File::write(io::CompressionType type)
+{
+    BacktraceContext c("herdstat::util::File::write(%s)", this->path());
+
+    std::ostringstream os;
+    this->dump(os);
+
+    io::Compressor out(this->path(), type);
+    out.write(os.str());
+    out.close();
+
+    this->clear();
+}
+/*****************************************************************************/
+ReadOnlyFile::ReadOnlyFile()
+    : BaseFileObject(), _map(), _buffer(), _data(""), _length(0), _lines(),
+      _compression(io::COMPRESSION_NONE)
+{
+}
+/*****************************************************************************/
+ReadOnlyFile::ReadOnlyFile(const std::string& path)
+    : BaseFileObject(path), _map(), _buffer(), _data(""), _length(0),
+      _lines(), _compression(io::COMPRESSION_NONE)
+{
+    this->open();
+    this->read();
+}
+/*****************************************************************************/
+ReadOnlyFile::ReadOnlyFile(const std::string& path, int fd)
+    : BaseFileObject(path), _map(), _buffer(), _data(""), _length(0),
+      _lines(), _compression(io::COMPRESSION_NONE)
+{
+    this->open_fd(fd);
+    this->read();
+}
+/*****************************************************************************/
+ReadOnlyFile::~ReadOnlyFile() throw()
+{
+    if (this->is_open())
+        this->close();
+}
+/*****************************************************************************/
+void
+ReadOnlyFile::open()
+{
+    this->open_fd(-1);
+}
+/*****************************************************************************/
+void
+ReadOnlyFile::open_fd(int fd)
+{
+    BacktraceContext c("herdstat::util::ReadOnlyFile::open(%s)", this->path());
+
+    if (this->is_open())
+        return;
+
+    if (fd == -1)
+        _map.open(this->path());
+    else if (not _map.map(fd))
+        throw FileException(this->path());
+    _compression = io::detect_compression(_map.data(), _map.size());
+
+    if (_compression == io::COMPRESSION_NONE)
+    {
+        _data = _map.data();
+        _length = _map.size();
+    }
+    else
+    {
+        _map.close();
+        io::Decompressor(this->path()).read_all(_buffer);
+        _data = _buffer.data();
+        _length = _buffer.size();
+    }
+
+    this->set_open(true);
+}
+/*****************************************************************************/
+void
+ReadOnlyFile::do_read()
+{
+    BacktraceContext c("herdstat::util::ReadOnlyFile::do_read(%s)",
+        this->path());
+
+    _lines.clear();
+
+    /* memchr() is about as fast a newline scan as we'll get; libc
+     * vectorizes it */
+    size_type pos = 0;
+    while (pos < _length)
+    {
+        _lines.push_back(pos);
+
+        const char *nl = static_cast<const char *>(
+            std::memchr(_data + pos, '\n', _length - pos));
+
+        /* pretend an unterminated last line ends with a newline */
+        pos = (nl ? (nl - _data) : _length) + 1;
+    }
+
+    _lines.push_back(pos);
+}
+/*****************************************************************************/
+void
+ReadOnlyFile::do_close()
+{
+    _map.close();
+    std::string().swap(_buffer);
+    _data = "";
+    _length = 0;
+    _lines.clear();
+}
+/*****************************************************************************/
+bool
+ReadOnlyFile::operator== (const ReadOnlyFile& that) const
+{
+    return (_length == that._length and
+            std::memcmp(_data, that._data, _length) == 0);
+}
+/*****************************************************************************/
+void
+ReadOnlyFile::dump(std::ostream& os) const
+{
+    BacktraceContext c("herdstat::util::ReadOnlyFile::dump(%s)", this->path());
+    os.write(_data, _length);
+}
+/*****************************************************************************/
 Directory::Directory(bool recurse, util::ProgressMeter *meter)
     : Progressable(meter), BaseFileObject(), util::VectorBase<std::string>(),
       _dirp(NULL), _recurse(recurse)
@@ -328,7 +568,7 @@ Directory::operator= (const Directory& that)
 void
 Directory::do_close()
 {
-    BacktraceContext c("herdstat::util::Directory::do_close("+this->path()+")");
+    BacktraceContext c("herdstat::util::Directory::do_close(%s)", this->path());
     closedir(_dirp);
     _dirp = NULL;
 }
@@ -336,7 +576,7 @@ Directory::do_close()
 void
 Directory::open()
 {
-    BacktraceContext c("herdstat::util::Directory::open("+this->path()+")");
+    BacktraceContext c("herdstat::util::Directory::open(%s)", this->path());
 
     if (this->is_open())
         return;
@@ -353,7 +593,8 @@ Directory::open()
 void
 Directory::do_read()
 {
-    BacktraceContext c("herdstat::util::Directory::do_read("+this->path()+")");
+    BacktraceContext c("herdstat::util::Directory::do_read(%s)", this->path());
+    LIBHERDSTAT_PROBE1(directory__read__entry, this->path().c_str());
 
     struct dirent *d = NULL;
     while ((d = readdir(_dirp)))
@@ -375,6 +616,9 @@ Directory::do_read()
             this->insert(this->end(), dir.begin(), dir.end());
         }
     }
+
+    LIBHERDSTAT_PROBE2(directory__read__return, this->path().c_str(),
+        static_cast<long>(this->size()));
 }
 /*****************************************************************************/
 Directory::iterator
@@ -405,13 +649,20 @@ Directory::find(const Regex& regex) const
     return std::find_if(this->begin(), this->end(),
         std::bind1st(regexMatch(), regex));
 }
+/*****************************************************************************/
+MemoryUsage
+Directory::memory_usage() const
+{
+    return (VectorBase<std::string>::memory_usage() +
+            util::memory_usage(this->path()));
+}
 /*****************************************************************************
  * general purpose file-related functions                                    *
  *****************************************************************************/
 void
 copy_file(const std::string& from, const std::string& to)
 {
-    BacktraceContext c("herdstat::util::copy_file("+from+", "+to+")");
+    BacktraceContext c("herdstat::util::copy_file(%s, %s)", from, to);
 
     /* remove to if it exists */
     if (is_file(to) and (unlink(to.c_str()) != 0))
@@ -439,7 +690,7 @@ copy_file(const std::string& from, const std::string& to)
 void
 move_file(const std::string& from, const std::string& to)
 {
-    BacktraceContext c("herdstat::util::move_file("+from+", "+to+")");
+    BacktraceContext c("herdstat::util::move_file(%s, %s)", from, to);
     copy_file(from, to);
     if (unlink(from.c_str()) != 0)
 	throw FileException(from);
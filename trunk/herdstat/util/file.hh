@@ -35,6 +35,7 @@
 #include <ios>
 #include <ostream>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <vector>
 #include <cstdlib>
@@ -47,6 +48,9 @@
 
 #include <herdstat/defs.hh>
 #include <herdstat/progressable.hh>
+#include <herdstat/io/compress.hh>
+#include <herdstat/io/mapped_file.hh>
+#include <herdstat/util/string.hh>
 #include <herdstat/util/regex.hh>
 #include <herdstat/util/container_base.hh>
 
@@ -340,7 +344,9 @@ namespace util {
 
     /**
      * @class BaseFile file.hh herdstat/util/file.hh
-     * @brief Base type for representing regular files.
+     * @brief Base type for representing regular files.  Files opened
+     * read-only that are gzip, xz or zstd compressed are transparently
+     * decompressed.
      */
 
     class BaseFile : public BaseFileObject
@@ -375,6 +381,10 @@ namespace util {
             /// Get open mode.
             inline const std::ios_base::openmode& mode() const { return _mode; }
 
+            /// Get compression format detected when the file was opened.
+            inline io::CompressionType compression() const
+            { return _compression; }
+
             /** Open file with default open mode.
              * @exception FileException
              */
@@ -394,26 +404,51 @@ namespace util {
              */
             virtual void open(std::ios_base::openmode mode);
 
+            /** Get heap bytes held by our path and, while open, our stream
+             * (whose buffer is assumed to be BUFSIZ bytes) or decompressed
+             * contents.
+             */
+            MemoryUsage memory_usage() const;
+
         protected:
             inline void set_mode(std::ios_base::openmode mode) { _mode = mode; }
 
             /// close file
             virtual void do_close();
 
-            /// Get stream associated with this.
+            /** Get stream associated with this.  Not available if the
+             * file is compressed; read it using input() instead.
+             */
             inline stream_type& stream() { assert(_stream); return *_stream; }
 
+            /** Get stream to read file contents from (the decompressed
+             * contents if the file is compressed).
+             */
+            inline std::iostream& input()
+            {
+                assert(_stream or _buffer);
+                if (_buffer) return *_buffer;
+                return *_stream;
+            }
+
         private:
             /// stream associated with this.
-            stream_type *_stream;
+            std::fstream *_stream;
+            /// decompressed contents, if the file is compressed.
+            std::stringstream *_buffer;
             /// open mode
             std::ios_base::openmode _mode;
+            /// compression format
+            io::CompressionType _compression;
     };
 
     /**
      * @class File file.hh herdstat/util/file.hh
      * @brief Represents a regular file using a vector of std::string's for
      * storing file contents.
+     *
+     * If you only need to read the file, ReadOnlyFile is cheaper; it
+     * doesn't copy each line into its own string.
      */
 
     class File : public BaseFile,
@@ -459,14 +494,210 @@ namespace util {
              */
             virtual void dump(std::ostream &s) const;
 
-            /// Dump internal container to disk.
+            /** Dump internal container to disk.  If the file was read
+             * compressed, it is written back using the same format.
+             */
             virtual void write();
 
+            /** Dump internal container to disk, compressed.
+             * @param type Compression format.
+             * @exception FileException, io::CompressionException
+             */
+            void write(io::CompressionType type);
+
         protected:
             /// read contents into container
             virtual void do_read();
     };
 
+    /**
+     * @class ReadOnlyFile file.hh herdstat/util/file.hh
+     * @brief Represents a regular file opened read-only, exposing its lines
+     * as StringView's.
+     *
+     * The file is memory mapped (or, if compressed, decompressed into
+     * memory) and indexed by line when read; nothing is copied.  Lines are
+     * split exactly as std::getline() would split them, so a ReadOnlyFile
+     * has the same lines as a File of the same path.  The views are valid
+     * until the file is closed or re-read.
+     *
+     * @section example Example
+     *
+@code
+const herdstat::util::ReadOnlyFile file("/usr/portage/profiles/arch.list");
+herdstat::util::ReadOnlyFile::const_iterator i;
+for (i = file.begin() ; i != file.end() ; ++i)
+{
+    if (not i->empty() and (*i)[0] != '#')
+        archs.insert(i->str());
+}
+@endcode
+     */
+
+    class ReadOnlyFile : public BaseFileObject
+    {
+        public:
+            typedef StringView value_type;
+            typedef std::size_t size_type;
+
+            /**
+             * @class const_iterator file.hh herdstat/util/file.hh
+             * @brief Random access iterator over the lines of a
+             * ReadOnlyFile.
+             */
+
+            class const_iterator
+            {
+                public:
+                    typedef std::random_access_iterator_tag iterator_category;
+                    typedef StringView value_type;
+                    typedef std::ptrdiff_t difference_type;
+                    typedef const StringView *pointer;
+                    typedef const StringView& reference;
+
+                    const_iterator() : _file(NULL), _n(0), _line() { }
+
+                    reference operator*() const { return _line; }
+                    pointer operator->() const { return &_line; }
+                    value_type operator[](difference_type n) const
+                    { return (*_file)[_n + n]; }
+
+                    const_iterator& operator++() { return *this += 1; }
+                    const_iterator& operator--() { return *this -= 1; }
+                    const_iterator operator++(int)
+                    { const_iterator tmp(*this); *this += 1; return tmp; }
+                    const_iterator operator--(int)
+                    { const_iterator tmp(*this); *this -= 1; return tmp; }
+
+                    const_iterator& operator+=(difference_type n)
+                    { _n += n; this->load(); return *this; }
+                    const_iterator& operator-=(difference_type n)
+                    { return *this += -n; }
+                    const_iterator operator+(difference_type n) const
+                    { const_iterator tmp(*this); return tmp += n; }
+                    const_iterator operator-(difference_type n) const
+                    { const_iterator tmp(*this); return tmp -= n; }
+                    difference_type operator-(const const_iterator& that) const
+                    { return (static_cast<difference_type>(_n) - that._n); }
+
+                    bool operator== (const const_iterator& that) const
+                    { return (_n == that._n); }
+                    bool operator!= (const const_iterator& that) const
+                    { return (_n != that._n); }
+                    bool operator< (const const_iterator& that) const
+                    { return (_n < that._n); }
+
+                private:
+                    friend class ReadOnlyFile;
+
+                    const_iterator(const ReadOnlyFile *file, size_type n)
+                        : _file(file), _n(n), _line() { this->load(); }
+
+                    void load()
+                    { if (_n < _file->size()) _line = (*_file)[_n]; }
+
+                    const ReadOnlyFile *_file;
+                    size_type _n;
+                    StringView _line;
+            };
+
+            /// Default constructor.
+            ReadOnlyFile();
+
+            /** Constructor.  Opens and reads file.
+             * @param path Path to file.
+             * @exception FileException
+             */
+            explicit ReadOnlyFile(const std::string& path);
+
+            /** Constructor.  Maps and reads a descriptor that's already open
+             * on path.  The descriptor stays the caller's to close; the
+             * mapping doesn't need it.
+             * @param path Path to file.
+             * @param fd File descriptor open for reading.
+             * @exception FileException
+             */
+            ReadOnlyFile(const std::string& path, int fd);
+
+            /// Destructor.
+            virtual ~ReadOnlyFile() throw();
+
+            /** Open file.
+             * @exception FileException
+             */
+            virtual void open();
+
+            /// Get compression format detected when the file was opened.
+            inline io::CompressionType compression() const
+            { return _compression; }
+
+            /// Get the whole (decompressed) contents.
+            inline StringView contents() const
+            { return StringView(_data, _length); }
+
+            /// Get number of lines.
+            inline size_type size() const
+            { return (_lines.empty() ? 0 : _lines.size() - 1); }
+            /// Is the file empty?
+            inline bool empty() const { return (this->size() == 0); }
+
+            /** Get a line (without its trailing newline).
+             * @param n Line number, starting from 0.
+             * @returns StringView of the line.
+             */
+            inline StringView operator[](size_type n) const
+            { return StringView(_data + _lines[n],
+                                _lines[n+1] - _lines[n] - 1); }
+
+            ///@{
+            /// Iterate over the lines.
+            const_iterator begin() const { return const_iterator(this, 0); }
+            const_iterator end() const
+            { return const_iterator(this, this->size()); }
+            ///@}
+
+            /** Determine if two files have identical contents.
+             * @param that ReadOnlyFile object.
+             * @returns A boolean value.
+             */
+            bool operator== (const ReadOnlyFile& that) const;
+
+            /** Determine if two files differ.
+             * @param that ReadOnlyFile object.
+             * @returns A boolean value.
+             */
+            inline bool operator!= (const ReadOnlyFile& that) const
+            { return not (*this == that); }
+
+            /** Dump contents to specified stream.
+             * @param s Output stream.
+             */
+            virtual void dump(std::ostream& s) const;
+
+        protected:
+            /// Index lines.
+            virtual void do_read();
+
+            /// Unmap file.
+            virtual void do_close();
+
+        private:
+            ReadOnlyFile(const ReadOnlyFile&);
+            ReadOnlyFile& operator= (const ReadOnlyFile&);
+
+            /// Map fd, or path() if fd is -1.
+            void open_fd(int fd);
+
+            io::MappedFile _map;
+            /// decompressed contents, if the file is compressed.
+            std::string _buffer;
+            const char *_data;
+            size_type _length;
+            /// offset of the start of each line, plus one past the end.
+            std::vector<size_type> _lines;
+            io::CompressionType _compression;
+    };
+
     /**
      * @class Directory file.hh herdstat/util/file.hh
      * @brief Represents a directory, using a std::vector<std::string> to store
@@ -573,6 +804,9 @@ if (i != dir.end())
              */
             const_iterator find(const Regex& r) const;
 
+            /// Get heap bytes held by our path and entries.
+            MemoryUsage memory_usage() const;
+
         protected:
             /// Read directory.
             virtual void do_read();
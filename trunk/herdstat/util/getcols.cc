@@ -28,8 +28,14 @@
 #include <term.h>
 
 #include <herdstat/exceptions.hh>
+#include <herdstat/util/thread.hh>
 #include <herdstat/util/getcols.hh>
 
+namespace {
+    /* termcap isn't reentrant */
+    pthread_mutex_t term_mutex = PTHREAD_MUTEX_INITIALIZER;
+}
+
 namespace herdstat {
 namespace util {
 
@@ -39,6 +45,8 @@ getcols()
     static bool term_init = false;
     static char term_info[2048];
 
+    Lock lock(term_mutex);
+
     if (not term_init)
     {
         const char * const type = std::getenv("TERM");
@@ -24,22 +24,345 @@
 # include "config.h"
 #endif
 
-#include <iostream>
-#include <glob.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fnmatch.h>
+#include <pthread.h>
+
 #include <herdstat/exceptions.hh>
+#include <herdstat/noncopyable.hh>
+#include <herdstat/util/file.hh>
+#include <herdstat/util/thread.hh>
 #include <herdstat/util/glob.hh>
 
+namespace {
+    using herdstat::util::Glob;
+
+    /* appends matches to Glob's results */
+    class ResultsHandler : public Glob::Handler
+    {
+        public:
+            ResultsHandler(std::vector<std::string>& v) : _v(v) { }
+            virtual void operator()(const std::string& path)
+            { _v.push_back(path); }
+
+        private:
+            std::vector<std::string>& _v;
+    };
+
+    /*
+     * Walks the tree one pattern component at a time.  When threaded, the
+     * first wildcard component only collects the paths it would descend
+     * into; the worker threads then take it from there.
+     */
+    class GlobWalker : private herdstat::Noncopyable
+    {
+        public:
+            GlobWalker(const std::vector<std::string>& parts, bool dir_only,
+                       Glob::Handler& handler, Glob::size_type threads);
+
+            void run(const std::string& base);
+
+        private:
+            enum EntryType { unknown, directory, symlink, other };
+
+            struct Entry
+            {
+                std::string name;
+                EntryType type;
+            };
+
+            struct Work
+            {
+                std::string path;
+                std::vector<std::string>::size_type part;
+            };
+
+            void match(const std::string& path,
+                       std::vector<std::string>::size_type part);
+            void descend(const std::string& path,
+                         std::vector<std::string>::size_type part);
+            void emit(const std::string& path);
+            bool read(const std::string& path, std::vector<Entry>& entries);
+            bool is_dir(const std::string& path, const Entry& e,
+                        bool follow) const;
+
+            static void *worker(void *walker);
+
+            const std::vector<std::string>& _parts;
+            const bool _dir_only;
+            Glob::Handler& _handler;
+            const Glob::size_type _threads;
+
+            bool _collect;
+            std::vector<Work> _work;
+            std::vector<Work>::size_type _next;
+            std::string _error;
+            herdstat::util::Mutex _mutex;
+    };
+
+    inline bool
+    has_magic(const std::string& s)
+    {
+        return (s.find_first_of("*?[\\") != std::string::npos);
+    }
+
+    inline std::string
+    join(const std::string& dir, const std::string& name)
+    {
+        if (dir.empty())
+            return name;
+        if (dir[dir.size() - 1] == '/')
+            return dir + name;
+        return dir + "/" + name;
+    }
+
+    GlobWalker::GlobWalker(const std::vector<std::string>& parts,
+                           bool dir_only, Glob::Handler& handler,
+                           Glob::size_type threads)
+        : _parts(parts), _dir_only(dir_only), _handler(handler),
+          _threads(threads), _collect(false), _work(), _next(0),
+          _error(), _mutex()
+    {
+    }
+
+    void
+    GlobWalker::run(const std::string& base)
+    {
+        if (_threads < 2)
+        {
+            this->match(base, 0);
+            return;
+        }
+
+        _collect = true;
+        this->match(base, 0);
+        _collect = false;
+
+        std::vector<pthread_t> threads;
+        const Glob::size_type nthreads = std::min(_threads,
+            static_cast<Glob::size_type>(_work.size()));
+
+        for (Glob::size_type n = 0 ; n < nthreads ; ++n)
+        {
+            pthread_t t;
+            if ((errno = pthread_create(&t, NULL, worker, this)) != 0)
+            {
+                /* let the ones we've got finish the job */
+                if (threads.empty())
+                    throw herdstat::ErrnoException("pthread_create");
+                break;
+            }
+            threads.push_back(t);
+        }
+
+        for (std::vector<pthread_t>::iterator i = threads.begin() ;
+             i != threads.end() ; ++i)
+            pthread_join(*i, NULL);
+
+        if (not _error.empty())
+            throw herdstat::Exception(_error);
+    }
+
+    void *
+    GlobWalker::worker(void *arg)
+    {
+        GlobWalker *walker = static_cast<GlobWalker *>(arg);
+
+        while (true)
+        {
+            const Work *work = NULL;
+            {
+                herdstat::util::Lock lock(walker->_mutex);
+                if (not walker->_error.empty() or
+                    walker->_next == walker->_work.size())
+                    break;
+                work = &walker->_work[walker->_next++];
+            }
+
+            std::string error;
+            try
+            {
+                walker->match(work->path, work->part);
+            }
+            catch (const herdstat::BaseException& e)
+            {
+                error.assign(e.what());
+            }
+            catch (const std::exception& e)
+            {
+                error.assign(e.what());
+            }
+            catch (...)
+            {
+                error.assign("unknown error");
+            }
+
+            if (not error.empty())
+            {
+                herdstat::util::Lock lock(walker->_mutex);
+                if (walker->_error.empty())
+                    walker->_error.swap(error);
+            }
+        }
+
+        return NULL;
+    }
+
+    void
+    GlobWalker::emit(const std::string& path)
+    {
+        if (_threads < 2)
+            _handler(path);
+        else
+        {
+            herdstat::util::Lock lock(_mutex);
+            _handler(path);
+        }
+    }
+
+    void
+    GlobWalker::descend(const std::string& path,
+                        std::vector<std::string>::size_type part)
+    {
+        if (_collect)
+        {
+            Work work;
+            work.path = path;
+            work.part = part;
+            _work.push_back(work);
+        }
+        else
+            this->match(path, part);
+    }
+
+    bool
+    GlobWalker::read(const std::string& path, std::vector<Entry>& entries)
+    {
+        DIR *dir = opendir(path.empty() ? "." : path.c_str());
+        if (not dir)
+        {
+            /* not there (anymore) is just no match */
+            if (errno == ENOENT or errno == ENOTDIR)
+                return false;
+            throw herdstat::FileException(path);
+        }
+
+        struct dirent *d;
+        while ((d = readdir(dir)))
+        {
+            if ((std::strcmp(d->d_name, ".") == 0) or
+                (std::strcmp(d->d_name, "..") == 0))
+                continue;
+
+            Entry e;
+            e.name.assign(d->d_name);
+            e.type = unknown;
+#ifdef _DIRENT_HAVE_D_TYPE
+            if (d->d_type == DT_DIR)        e.type = directory;
+            else if (d->d_type == DT_LNK)   e.type = symlink;
+            else if (d->d_type != DT_UNKNOWN) e.type = other;
+#endif
+            entries.push_back(e);
+        }
+
+        closedir(dir);
+        return true;
+    }
+
+    bool
+    GlobWalker::is_dir(const std::string& path, const Entry& e,
+                       bool follow) const
+    {
+        if (e.type == directory)
+            return true;
+        if (e.type == other or (e.type == symlink and not follow))
+            return false;
+
+        struct stat s;
+        const int ret = (follow ? stat(path.c_str(), &s) :
+                                  lstat(path.c_str(), &s));
+        return (ret == 0 and S_ISDIR(s.st_mode));
+    }
+
+    void
+    GlobWalker::match(const std::string& path,
+                      std::vector<std::string>::size_type part)
+    {
+        if (part == _parts.size())
+        {
+            if (not _dir_only)
+                this->emit(path);
+            else if (herdstat::util::is_dir(path))
+                this->emit(join(path, ""));
+            return;
+        }
+
+        const std::string& pattern(_parts[part]);
+        const bool last = (part + 1 == _parts.size());
+
+        /* no need to read the directory */
+        if (not has_magic(pattern))
+        {
+            const std::string child(join(path, pattern));
+            struct stat s;
+            if (last ? lstat(child.c_str(), &s) == 0 :
+                       herdstat::util::is_dir(child))
+                this->match(child, part + 1);
+            return;
+        }
+
+        /* zero directories */
+        if (pattern == "**" and not last)
+            this->match(path, part + 1);
+
+        std::vector<Entry> entries;
+        if (not this->read(path, entries))
+            return;
+
+        std::vector<Entry>::const_iterator i;
+        for (i = entries.begin() ; i != entries.end() ; ++i)
+        {
+            const std::string child(join(path, i->name));
+
+            if (pattern == "**")
+            {
+                if (i->name[0] == '.')
+                    continue;
+
+                const bool dir = this->is_dir(child, *i, false);
+                if (last and (dir or not _dir_only))
+                    this->emit(_dir_only ? join(child, "") : child);
+                if (dir)
+                    this->descend(child, part);
+            }
+            else if (fnmatch(pattern.c_str(), i->name.c_str(),
+                             FNM_PERIOD) == 0)
+            {
+                if (last)
+                    this->match(child, part + 1);
+                else if (this->is_dir(child, *i, true))
+                    this->descend(child, part + 1);
+            }
+        }
+    }
+}
+
 namespace herdstat {
 namespace util {
 /****************************************************************************/
 Glob::Glob()
-    : _results()
+    : _results(), _threads(1)
 {
 
 }
 /****************************************************************************/
 Glob::Glob(const std::string& pattern)
-    : _results()
+    : _results(), _threads(1)
 {
     this->operator()(pattern);
 }
@@ -51,25 +374,20 @@ Glob::~Glob() throw()
 const std::vector<std::string>&
 Glob::operator()(const std::string& pattern)
 {
-    BacktraceContext c("herdstat::util::Glob::operator()("+pattern+")");
-
-    glob_t globbuf;
-
-    int ret = glob(pattern.c_str(), GLOB_ERR, NULL, &globbuf);
-    if (ret != 0 and ret != GLOB_NOMATCH)
-        throw ErrnoException("glob");
+    BacktraceContext c("herdstat::util::Glob::operator()(%s)", pattern);
 
-    /* fill _results */
-    if (ret != GLOB_NOMATCH)
-        _results.insert(_results.end(),
-                        globbuf.gl_pathv, globbuf.gl_pathv + globbuf.gl_pathc);
+    const std::vector<std::string>::size_type n = _results.size();
 
-    globfree(&globbuf);
+    ResultsHandler handler(_results);
+    this->operator()(pattern, handler);
 
-    /* there may be duplicates due to previous calls to operator(). */
-    if ((ret != GLOB_NOMATCH) and (_results.size() > 1))
+    /* only the new matches need sorting; there may be duplicates due
+     * to previous calls to operator(). */
+    if (_results.size() > n)
     {
-        std::sort(_results.begin(), _results.end());
+        std::sort(_results.begin() + n, _results.end());
+        std::inplace_merge(_results.begin(), _results.begin() + n,
+            _results.end());
         _results.erase(std::unique(_results.begin(), _results.end()),
             _results.end());
     }
@@ -77,6 +395,38 @@ Glob::operator()(const std::string& pattern)
     return _results;
 }
 /****************************************************************************/
+void
+Glob::operator()(const std::string& pattern, Handler& handler) const
+{
+    BacktraceContext c("herdstat::util::Glob::operator()(%s)", pattern);
+
+    if (pattern.empty())
+        return;
+
+    /* split into path components, collapsing repeated "**"s */
+    std::vector<std::string> parts;
+    std::string::size_type pos = 0;
+    while (pos < pattern.size())
+    {
+        std::string::size_type end = pattern.find('/', pos);
+        if (end == std::string::npos)
+            end = pattern.size();
+
+        const std::string part(pattern.substr(pos, end - pos));
+        if (not part.empty() and
+            not (part == "**" and not parts.empty() and parts.back() == "**"))
+            parts.push_back(part);
+
+        pos = end + 1;
+    }
+
+    const bool dir_only = (pattern[pattern.size() - 1] == '/');
+    const std::string base(pattern[0] == '/' ? "/" : "");
+
+    GlobWalker walker(parts, dir_only, handler, _threads);
+    walker.run(base);
+}
+/****************************************************************************/
 } // namespace util
 } // namespace herdstat
 
@@ -40,7 +40,22 @@ namespace util {
 
     /**
      * @class Glob glob.hh herdstat/util/glob.hh
-     * @brief Interface to POSIX glob().
+     * @brief POSIX-style pathname pattern matching.
+     *
+     * Patterns are matched one path component at a time with fnmatch(),
+     * walking the directory tree as we go, so matches are available as
+     * soon as they're found.  On top of what glob() supports, a component
+     * consisting of just "**" matches zero or more directories (without
+     * following symlinks or descending into hidden directories); if it's
+     * the last component, it matches everything below.  A trailing slash
+     * restricts matches to directories.
+     *
+     * Use results() for the accumulated, sorted matches of all previous
+     * operator()() calls, or one of the callback forms to handle matches
+     * as they're found (in directory order, with no sorting).  The
+     * directories enumerated by the first wildcard component can be
+     * walked in parallel via set_threads(); the callback is never called
+     * concurrently, though.
      *
      * @section example Example
      *
@@ -64,18 +79,51 @@ glob.clear_results();
 glob("*.ebuild");
 std::copy(glob.results().begin(), glob.results().end(),
     std::ostream_iterator<std::string>(std::cout, "\n"));
+@endcode
+     *
+     * And one that handles each match as it's found:
+     *
+@code
+struct Print
+{
+    void operator()(const std::string& path) const
+    { std::cout << path << std::endl; }
+};
+
+herdstat::util::Glob glob;
+glob.set_threads(4);
+glob.for_each("/usr/portage/" "**" "/metadata.xml", Print());
 @endcode
      */
 
     class Glob
     {
         public:
+            typedef std::vector<std::string> container_type;
+            typedef container_type::size_type size_type;
+
+            /**
+             * @class Handler glob.hh herdstat/util/glob.hh
+             * @brief Interface for receiving matches as they're found.
+             */
+
+            class Handler
+            {
+                public:
+                    virtual ~Handler() { }
+
+                    /** Called for each match.
+                     * @param path Matching path.
+                     */
+                    virtual void operator()(const std::string& path) = 0;
+            };
+
             /// Default constructor.
             Glob();
 
             /** Constructor.
              * @param pattern glob pattern string.
-             * @exception ErrnoException
+             * @exception FileException
              */
             Glob(const std::string& pattern);
 
@@ -90,16 +138,58 @@ std::copy(glob.results().begin(), glob.results().end(),
              */
             inline const std::vector<std::string>& results() const;
 
-            /** Perform glob search.
+            /** Perform glob search, adding matches to results().
              * @param pattern glob pattern string.
-             * @exception ErrnoException
+             * @exception FileException
              * @returns const reference to results.
              */
             const std::vector<std::string>&
             operator()(const std::string& pattern);
 
+            /** Perform glob search, passing each match to the given
+             * handler instead of storing it.  If a pattern contains more
+             * than one "**", the same path may be passed more than once.
+             * @param pattern glob pattern string.
+             * @param handler Handler object.
+             * @exception FileException, Exception
+             */
+            void operator()(const std::string& pattern,
+                            Handler& handler) const;
+
+            /** Perform glob search, calling the given function object for
+             * each match.
+             * @param pattern glob pattern string.
+             * @param f Unary function object taking a const std::string&.
+             * @returns f.
+             * @exception FileException, Exception
+             */
+            template <typename UnaryFunction>
+            UnaryFunction for_each(const std::string& pattern,
+                                   UnaryFunction f) const;
+
+            /// Get number of threads used to walk the tree.
+            inline size_type threads() const;
+
+            /** Set number of threads used to walk the tree (defaults to 1).
+             * @param n Number of threads.
+             */
+            inline void set_threads(size_type n);
+
         private:
+            template <typename UnaryFunction>
+            class FunctionHandler : public Handler
+            {
+                public:
+                    FunctionHandler(UnaryFunction& f) : _f(f) { }
+                    virtual void operator()(const std::string& path)
+                    { _f(path); }
+
+                private:
+                    UnaryFunction& _f;
+            };
+
             std::vector<std::string> _results;
+            size_type _threads;
     };
 
     inline void
@@ -114,6 +204,27 @@ std::copy(glob.results().begin(), glob.results().end(),
         return _results;
     }
 
+    inline Glob::size_type
+    Glob::threads() const
+    {
+        return _threads;
+    }
+
+    inline void
+    Glob::set_threads(size_type n)
+    {
+        _threads = (n > 0 ? n : 1);
+    }
+
+    template <typename UnaryFunction>
+    UnaryFunction
+    Glob::for_each(const std::string& pattern, UnaryFunction f) const
+    {
+        FunctionHandler<UnaryFunction> handler(f);
+        this->operator()(pattern, handler);
+        return f;
+    }
+
 } // namespace util
 } // namespace herdstat
 
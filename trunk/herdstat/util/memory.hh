@@ -0,0 +1,247 @@
+/*
+ * libherdstat -- herdstat/util/memory.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_UTIL_MEMORY_HH
+#define _HAVE_UTIL_MEMORY_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/util/memory.hh
+ * @brief Defines the MemoryUsage class and the memory_usage() functions.
+ */
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <utility>
+#include <ostream>
+
+namespace herdstat {
+namespace util {
+
+    /**
+     * @class MemoryUsage memory.hh herdstat/util/memory.hh
+     * @brief Heap bytes held by an object, broken out by component.
+     *
+     * Only heap memory is counted; the size of the object itself is not
+     * (but the size of every element a container allocates is).  Figures
+     * are the bytes requested from operator new, so malloc's own overhead
+     * is not included.  Strings that share a buffer (copy-on-write
+     * implementations) are each charged an equal part of it.
+     *
+     * Objects that can report their footprint have a memory_usage() member
+     * returning one of these; util::memory_usage() does the same for
+     * strings and standard containers.
+     *
+     * @section example Example
+     *
+@code
+herdstat::portage::HerdsXML herds_xml;
+herdstat::util::MemoryUsage mem(herds_xml.memory_usage());
+std::cout << "herds.xml takes " << mem.total() << " bytes ("
+    << mem << ")" << std::endl;
+@endcode
+     */
+
+    struct MemoryUsage
+    {
+        typedef std::size_t size_type;
+
+        MemoryUsage() : strings(0), nodes(0), caches(0) { }
+
+        /// Total number of heap bytes.
+        size_type total() const { return strings + nodes + caches; }
+
+        MemoryUsage& operator+= (const MemoryUsage& that)
+        {
+            strings += that.strings;
+            nodes   += that.nodes;
+            caches  += that.caches;
+            return *this;
+        }
+
+        MemoryUsage operator+ (const MemoryUsage& that) const
+        { return (MemoryUsage(*this) += that); }
+
+        /// Bytes of std::string buffers.
+        size_type strings;
+        /// Bytes of container nodes/arrays and other owned objects.
+        size_type nodes;
+        /// Bytes reachable from lazily-filled caches (whatever they hold).
+        size_type caches;
+    };
+
+    inline std::ostream&
+    operator<< (std::ostream& stream, const MemoryUsage& m)
+    {
+        return (stream << "strings: " << m.strings
+                       << ", nodes: " << m.nodes
+                       << ", caches: " << m.caches);
+    }
+
+    /**
+     * @name memory_usage
+     * Get heap bytes held by the given object.  Class types must have a
+     * memory_usage() member; built-in types hold nothing.
+     */
+    ///@{
+    inline MemoryUsage memory_usage(bool) { return MemoryUsage(); }
+    inline MemoryUsage memory_usage(char) { return MemoryUsage(); }
+    inline MemoryUsage memory_usage(int) { return MemoryUsage(); }
+    inline MemoryUsage memory_usage(unsigned int) { return MemoryUsage(); }
+    inline MemoryUsage memory_usage(long) { return MemoryUsage(); }
+    inline MemoryUsage memory_usage(unsigned long) { return MemoryUsage(); }
+    inline MemoryUsage memory_usage(const std::string& s);
+    template <typename T>
+    MemoryUsage memory_usage(const T& v);
+    template <typename T, typename U>
+    MemoryUsage memory_usage(const std::pair<T, U>& p);
+    template <typename T, typename A>
+    MemoryUsage memory_usage(const std::vector<T, A>& v);
+    template <typename T, typename C, typename A>
+    MemoryUsage memory_usage(const std::set<T, C, A>& s);
+    template <typename K, typename V, typename C, typename A>
+    MemoryUsage memory_usage(const std::map<K, V, C, A>& m);
+    ///@}
+
+    /**
+     * Get heap bytes held by a lazily-allocated cache.  Everything,
+     * including the object pointed to, is counted as MemoryUsage::caches.
+     * @param p Pointer to cache (may be NULL).
+     * @returns MemoryUsage object.
+     */
+    template <typename T>
+    MemoryUsage cache_usage(const T *p);
+
+    /* layout of a red-black tree node, minus the value */
+    struct TreeNodeHeader
+    {
+        int color;
+        void *parent, *left, *right;
+    };
+
+    template <typename T>
+    struct TreeNode
+    {
+        TreeNodeHeader header;
+        T value;
+    };
+
+    inline MemoryUsage
+    memory_usage(const std::string& s)
+    {
+        MemoryUsage m;
+#if defined(__GLIBCXX__) && !_GLIBCXX_USE_CXX11_ABI
+        /* reference-counted; the buffer is preceded by its length,
+         * capacity and reference count (the number of other owners), and
+         * empty strings share a static one.  A shared buffer is split
+         * evenly between its owners. */
+        struct header { std::string::size_type length, capacity; int refs; };
+        if (s.capacity() > 0)
+        {
+            const header *h = reinterpret_cast<const header *>(s.data()) - 1;
+            m.strings = (s.capacity() + 1 + sizeof(header)) /
+                (h->refs > 0 ? h->refs + 1 : 1);
+        }
+#else
+        /* short strings may be stored inside the object itself */
+        const char * const self = reinterpret_cast<const char *>(&s);
+        if (s.capacity() > 0 and
+            (s.data() < self or s.data() >= self + sizeof(s)))
+            m.strings = s.capacity() + 1;
+#endif
+        return m;
+    }
+
+    template <typename T>
+    MemoryUsage
+    memory_usage(const T& v)
+    {
+        return v.memory_usage();
+    }
+
+    template <typename T, typename U>
+    MemoryUsage
+    memory_usage(const std::pair<T, U>& p)
+    {
+        return (memory_usage(p.first) + memory_usage(p.second));
+    }
+
+    template <typename T, typename A>
+    MemoryUsage
+    memory_usage(const std::vector<T, A>& v)
+    {
+        MemoryUsage m;
+        m.nodes = v.capacity() * sizeof(T);
+        typename std::vector<T, A>::const_iterator i;
+        for (i = v.begin() ; i != v.end() ; ++i)
+            m += memory_usage(*i);
+        return m;
+    }
+
+    template <typename T, typename C, typename A>
+    MemoryUsage
+    memory_usage(const std::set<T, C, A>& s)
+    {
+        MemoryUsage m;
+        m.nodes = s.size() * sizeof(TreeNode<T>);
+        typename std::set<T, C, A>::const_iterator i;
+        for (i = s.begin() ; i != s.end() ; ++i)
+            m += memory_usage(*i);
+        return m;
+    }
+
+    template <typename K, typename V, typename C, typename A>
+    MemoryUsage
+    memory_usage(const std::map<K, V, C, A>& m)
+    {
+        typedef typename std::map<K, V, C, A>::value_type value_type;
+
+        MemoryUsage u;
+        u.nodes = m.size() * sizeof(TreeNode<value_type>);
+        typename std::map<K, V, C, A>::const_iterator i;
+        for (i = m.begin() ; i != m.end() ; ++i)
+            u += memory_usage(*i);
+        return u;
+    }
+
+    template <typename T>
+    MemoryUsage
+    cache_usage(const T *p)
+    {
+        MemoryUsage m;
+        if (p)
+            m.caches = sizeof(T) + memory_usage(*p).total();
+        return m;
+    }
+
+} // namespace util
+} // namespace herdstat
+
+#endif /* _HAVE_UTIL_MEMORY_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -30,6 +30,7 @@
 #include <cstdarg>
 #include <ctime>
 #include <unistd.h>
+#include <pthread.h>
 
 #include <herdstat/exceptions.hh>
 #include <herdstat/util/file.hh>
@@ -39,30 +40,39 @@
 namespace herdstat {
 namespace util {
 /****************************************************************************/
-std::map<ASCIIColor, std::string>&
-MakeColorMap()
+static pthread_once_t color_map_once = PTHREAD_ONCE_INIT;
+static std::map<ASCIIColor, std::string> *color_map = NULL;
+
+static void
+init_color_map()
 {
     static std::map<ASCIIColor, std::string> m;
-    if (m.empty())
-    {
+
 #define INSERT_COLOR(x,y) m.insert(std::make_pair(x, y))
 
-        INSERT_COLOR(red,     "\033[0;31m");
-        INSERT_COLOR(green,   "\033[0;32m");
-        INSERT_COLOR(blue,    "\033[1;34m");
-        INSERT_COLOR(yellow,  "\033[1;33m");
-        INSERT_COLOR(orange,  "\033[0;33m");
-        INSERT_COLOR(magenta, "\033[1;35m");
-        INSERT_COLOR(cyan,    "\033[1;36m");
-        INSERT_COLOR(black,   "\033[0;30m");
-        INSERT_COLOR(white,   "\033[0;1m");
-        INSERT_COLOR(none,    "\033[00m");
+    INSERT_COLOR(red,     "\033[0;31m");
+    INSERT_COLOR(green,   "\033[0;32m");
+    INSERT_COLOR(blue,    "\033[1;34m");
+    INSERT_COLOR(yellow,  "\033[1;33m");
+    INSERT_COLOR(orange,  "\033[0;33m");
+    INSERT_COLOR(magenta, "\033[1;35m");
+    INSERT_COLOR(cyan,    "\033[1;36m");
+    INSERT_COLOR(black,   "\033[0;30m");
+    INSERT_COLOR(white,   "\033[0;1m");
+    INSERT_COLOR(none,    "\033[00m");
 
 #undef INSERT_COLOR
 
-    }
+    color_map = &m;
+}
 
-    return m;
+std::map<ASCIIColor, std::string>&
+MakeColorMap()
+{
+    /* every color is inserted up front, so concurrent lookups never
+     * modify the map. */
+    pthread_once(&color_map_once, init_color_map);
+    return *color_map;
 }
 
 ColorMap::ColorMap()
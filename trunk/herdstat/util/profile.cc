@@ -0,0 +1,458 @@
+/*
+ * libherdstat -- herdstat/util/profile.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <map>
+#include <string>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <algorithm>
+#include <unistd.h>
+
+#include <herdstat/exceptions.hh>
+#include <herdstat/util/timer.hh>
+#include <herdstat/util/string.hh>
+#include <herdstat/util/profile.hh>
+
+namespace {
+    /* guards construction of the GlobalProfiler() instance */
+    pthread_mutex_t global_profiler_mutex = PTHREAD_MUTEX_INITIALIZER;
+}
+
+namespace herdstat {
+namespace util {
+
+    /* a zone, as entered from a particular parent zone */
+    struct ProfileNode : private Noncopyable
+    {
+        ProfileNode(const char *n, ProfileNode *p)
+            : name(n), parent(p), children(), calls(0), total(0) { }
+
+        ~ProfileNode()
+        {
+            std::vector<ProfileNode *>::iterator i;
+            for (i = children.begin() ; i != children.end() ; ++i)
+                delete *i;
+        }
+
+        ProfileNode *child(const char *n)
+        {
+            /* names are nearly always the same literal, so try comparing
+             * pointers first */
+            std::vector<ProfileNode *>::iterator i;
+            for (i = children.begin() ; i != children.end() ; ++i)
+                if ((*i)->name == n)
+                    return *i;
+            for (i = children.begin() ; i != children.end() ; ++i)
+                if (std::strcmp((*i)->name, n) == 0)
+                    return *i;
+
+            children.push_back(new ProfileNode(n, this));
+            return children.back();
+        }
+
+        /* add the calls and times of that (and its children) to this */
+        void merge(const ProfileNode& that)
+        {
+            calls += that.calls;
+            total += that.total;
+
+            std::vector<ProfileNode *>::const_iterator i;
+            for (i = that.children.begin() ; i != that.children.end() ; ++i)
+                this->child((*i)->name)->merge(**i);
+        }
+
+        /* time not spent in child zones */
+        nsec_type self() const
+        {
+            nsec_type t = 0;
+            std::vector<ProfileNode *>::const_iterator i;
+            for (i = children.begin() ; i != children.end() ; ++i)
+                t += (*i)->total;
+            return (total > t ? total - t : 0);
+        }
+
+        const char * const name;
+        ProfileNode * const parent;
+        std::vector<ProfileNode *> children;
+        unsigned long calls;
+        nsec_type total;
+    };
+
+    /* a traced zone */
+    struct ProfileEvent
+    {
+        const char *name;
+        nsec_type begin;
+        nsec_type duration;
+    };
+
+    /* per-thread profile */
+    struct ProfileThread : private Noncopyable
+    {
+        ProfileThread(unsigned long n)
+            : id(n), root("", NULL), current(&root), events(), dropped(0),
+              mutex() { }
+
+        const unsigned long id;
+        ProfileNode root;
+        ProfileNode *current;
+        std::vector<ProfileEvent> events;
+        /* events not recorded because we were at the trace limit */
+        unsigned long dropped;
+        Mutex mutex;
+    };
+
+} // namespace util
+} // namespace herdstat
+
+namespace {
+    using herdstat::util::ProfileNode;
+    using herdstat::util::nsec_type;
+
+    struct FlatEntry
+    {
+        FlatEntry() : name(NULL), calls(0), total(0), self(0) { }
+
+        const char *name;
+        unsigned long calls;
+        nsec_type total;
+        nsec_type self;
+    };
+
+    bool
+    slower(const FlatEntry& a, const FlatEntry& b)
+    {
+        return (a.self > b.self);
+    }
+
+    /* sum up each zone name, only counting the total time of the outermost
+     * of any recursive calls */
+    void
+    flatten(const ProfileNode& node, std::vector<const char *>& stack,
+            std::map<std::string, FlatEntry>& entries)
+    {
+        std::vector<ProfileNode *>::const_iterator i;
+        for (i = node.children.begin() ; i != node.children.end() ; ++i)
+        {
+            const ProfileNode& n(**i);
+            FlatEntry& e(entries[n.name]);
+            e.name = n.name;
+            e.calls += n.calls;
+            e.self += n.self();
+
+            bool recursive = false;
+            std::vector<const char *>::const_iterator s;
+            for (s = stack.begin() ; s != stack.end() ; ++s)
+                if (std::strcmp(*s, n.name) == 0)
+                    recursive = true;
+            if (not recursive)
+                e.total += n.total;
+
+            stack.push_back(n.name);
+            flatten(n, stack, entries);
+            stack.pop_back();
+        }
+    }
+
+    void
+    write_row(std::ostream& stream, const std::string& name,
+              unsigned long calls, nsec_type total,
+              nsec_type self)
+    {
+        stream << std::left << std::setw(48) << name << std::right
+            << std::setw(10) << calls << std::fixed << std::setprecision(3)
+            << std::setw(14) << total / 1e6 << std::setw(14) << self / 1e6
+            << std::endl;
+    }
+
+    void
+    write_tree(std::ostream& stream, const ProfileNode& node, int depth)
+    {
+        std::vector<ProfileNode *>::const_iterator i;
+        for (i = node.children.begin() ; i != node.children.end() ; ++i)
+        {
+            write_row(stream, std::string(depth * 2, ' ') + (*i)->name,
+                (*i)->calls, (*i)->total, (*i)->self());
+            write_tree(stream, **i, depth + 1);
+        }
+    }
+
+    std::string
+    json_escape(const char *s)
+    {
+        std::string result;
+        for ( ; *s ; ++s)
+        {
+            if (*s == '"' or *s == '\\')
+                result += '\\';
+            if (static_cast<unsigned char>(*s) < 0x20)
+                result += herdstat::util::sprintf("\\u%04x", *s);
+            else
+                result += *s;
+        }
+        return result;
+    }
+}
+
+namespace herdstat {
+namespace util {
+/*** static members *********************************************************/
+const std::size_t Profiler::default_trace_limit;
+/****************************************************************************/
+Profiler&
+GlobalProfiler()
+{
+    /* constant-initialized, so it's safe to test before static
+     * constructors have run. */
+    static Profiler * volatile profiler = NULL;
+
+    Profiler *p = atomic_load(profiler);
+    if (not p)
+    {
+        Lock lock(global_profiler_mutex);
+        if (not (p = atomic_load(profiler)))
+        {
+            static Profiler instance;
+            atomic_store(profiler, p = &instance);
+        }
+    }
+
+    return *p;
+}
+/****************************************************************************/
+Profiler::Profiler()
+    : _enabled(false), _tracing(false), _trace_limit(default_trace_limit),
+      _key(), _threads(), _mutex()
+{
+    if ((errno = pthread_key_create(&_key, NULL)) != 0)
+        throw ErrnoException("pthread_key_create");
+
+    const char *env = std::getenv("HERDSTAT_PROFILE");
+    if (env and *env and std::strcmp(env, "0") != 0)
+        this->enable(std::strcmp(env, "trace") == 0);
+}
+/****************************************************************************/
+Profiler::~Profiler()
+{
+    std::vector<ProfileThread *>::iterator i;
+    for (i = _threads.begin() ; i != _threads.end() ; ++i)
+        delete *i;
+
+    pthread_key_delete(_key);
+}
+/****************************************************************************/
+void
+Profiler::enable(bool trace)
+{
+    _tracing = trace;
+    _enabled = true;
+}
+/****************************************************************************/
+void
+Profiler::disable()
+{
+    _enabled = false;
+}
+/****************************************************************************/
+void
+Profiler::reset()
+{
+    Lock lock(_mutex);
+
+    std::vector<ProfileThread *>::iterator i;
+    for (i = _threads.begin() ; i != _threads.end() ; ++i)
+    {
+        ProfileThread *t = *i;
+        Lock thread_lock(t->mutex);
+
+        std::vector<ProfileNode *>::iterator n;
+        for (n = t->root.children.begin() ; n != t->root.children.end() ; ++n)
+            delete *n;
+        t->root.children.clear();
+        t->current = &t->root;
+        t->events.clear();
+        t->dropped = 0;
+    }
+}
+/****************************************************************************/
+unsigned long
+Profiler::dropped_events() const
+{
+    Lock lock(_mutex);
+
+    unsigned long n = 0;
+    std::vector<ProfileThread *>::const_iterator i;
+    for (i = _threads.begin() ; i != _threads.end() ; ++i)
+    {
+        Lock thread_lock((*i)->mutex);
+        n += (*i)->dropped;
+    }
+    return n;
+}
+/****************************************************************************/
+ProfileThread *
+Profiler::thread()
+{
+    ProfileThread *t = static_cast<ProfileThread *>(pthread_getspecific(_key));
+    if (t)
+        return t;
+
+    Lock lock(_mutex);
+    t = new ProfileThread(_threads.size() + 1);
+    _threads.push_back(t);
+    pthread_setspecific(_key, t);
+    return t;
+}
+/****************************************************************************/
+void
+Profiler::report(std::ostream& stream, format_type format) const
+{
+    ProfileNode merged("", NULL);
+    {
+        Lock lock(_mutex);
+        std::vector<ProfileThread *>::const_iterator i;
+        for (i = _threads.begin() ; i != _threads.end() ; ++i)
+        {
+            Lock thread_lock((*i)->mutex);
+            merged.merge((*i)->root);
+        }
+    }
+
+    stream << std::left << std::setw(48) << "zone" << std::right
+        << std::setw(10) << "calls" << std::setw(14) << "total ms"
+        << std::setw(14) << "self ms" << std::endl;
+
+    if (format == tree)
+    {
+        write_tree(stream, merged, 0);
+        return;
+    }
+
+    std::map<std::string, FlatEntry> entries;
+    std::vector<const char *> stack;
+    flatten(merged, stack, entries);
+
+    std::vector<FlatEntry> sorted;
+    std::map<std::string, FlatEntry>::const_iterator e;
+    for (e = entries.begin() ; e != entries.end() ; ++e)
+        sorted.push_back(e->second);
+    std::stable_sort(sorted.begin(), sorted.end(), slower);
+
+    std::vector<FlatEntry>::const_iterator i;
+    for (i = sorted.begin() ; i != sorted.end() ; ++i)
+        write_row(stream, i->name, i->calls, i->total, i->self);
+}
+/****************************************************************************/
+void
+Profiler::write_trace(std::ostream& stream) const
+{
+    Lock lock(_mutex);
+
+    /* timestamps are relative to the first event */
+    nsec_type epoch = 0;
+    std::vector<ProfileThread *>::const_iterator i;
+    for (i = _threads.begin() ; i != _threads.end() ; ++i)
+    {
+        Lock thread_lock((*i)->mutex);
+        if (not (*i)->events.empty() and
+            (epoch == 0 or (*i)->events.front().begin < epoch))
+            epoch = (*i)->events.front().begin;
+    }
+
+    const long pid = getpid();
+    unsigned long dropped = 0;
+    bool first = true;
+
+    stream << "{\"traceEvents\":[";
+    for (i = _threads.begin() ; i != _threads.end() ; ++i)
+    {
+        Lock thread_lock((*i)->mutex);
+        dropped += (*i)->dropped;
+
+        std::vector<ProfileEvent>::const_iterator e;
+        for (e = (*i)->events.begin() ; e != (*i)->events.end() ; ++e)
+        {
+            stream << (first ? "\n" : ",\n") << sprintf(
+                "{\"name\":\"%s\",\"cat\":\"herdstat\",\"ph\":\"X\","
+                "\"pid\":%ld,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f}",
+                json_escape(e->name).c_str(), pid, (*i)->id,
+                (e->begin - epoch) / 1e3, e->duration / 1e3);
+            first = false;
+        }
+    }
+    stream << "\n],\"displayTimeUnit\":\"ns\"";
+    if (dropped > 0)
+        stream << ",\"otherData\":{\"droppedEvents\":\"" << dropped << "\"}";
+    stream << "}" << std::endl;
+}
+/****************************************************************************/
+ProfileZone::ProfileZone(const char *name)
+    : _thread(NULL), _node(NULL), _begin(0)
+{
+    Profiler& profiler(GlobalProfiler());
+    if (not profiler.enabled())
+        return;
+
+    _thread = profiler.thread();
+    {
+        Lock lock(_thread->mutex);
+        _node = _thread->current = _thread->current->child(name);
+    }
+
+    _begin = monotonic_ns();
+}
+/****************************************************************************/
+ProfileZone::~ProfileZone()
+{
+    if (not _thread)
+        return;
+
+    const nsec_type end = monotonic_ns();
+    Lock lock(_thread->mutex);
+
+    ++_node->calls;
+    _node->total += (end - _begin);
+    _thread->current = _node->parent;
+
+    const Profiler& profiler(GlobalProfiler());
+    if (profiler.tracing())
+    {
+        if (_thread->events.size() < profiler.trace_limit())
+        {
+            const ProfileEvent event = { _node->name, _begin, end - _begin };
+            _thread->events.push_back(event);
+        }
+        else
+            ++_thread->dropped;
+    }
+}
+/****************************************************************************/
+} // namespace util
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
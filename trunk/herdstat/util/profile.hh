@@ -0,0 +1,195 @@
+/*
+ * libherdstat -- herdstat/util/profile.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_UTIL_PROFILE_HH
+#define _HAVE_UTIL_PROFILE_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/util/profile.hh
+ * @brief Defines the Profiler and ProfileZone classes.
+ */
+
+#include <vector>
+#include <ostream>
+#include <pthread.h>
+#include <herdstat/noncopyable.hh>
+#include <herdstat/util/thread.hh>
+#include <herdstat/util/timer.hh>
+
+namespace herdstat {
+namespace util {
+
+    struct ProfileNode;
+    struct ProfileThread;
+
+    /**
+     * @class Profiler profile.hh herdstat/util/profile.hh
+     * @brief Collects the time spent in each ProfileZone.
+     *
+     * Zones nest, so the profile is a tree: the same zone entered from
+     * two different places shows up twice.  Each thread records into its
+     * own tree, so zones cost no more than an uncontended lock; the trees
+     * are merged when reporting.  When tracing, every zone entered is also
+     * recorded individually, so it can be viewed on a timeline with
+     * write_trace().
+     *
+     * Profiling is off by default.  Either call enable(), or set
+     * HERDSTAT_PROFILE in the environment (to "trace" to trace as well).
+     * Use the GlobalProfiler() instance.
+     *
+     * @section example Example
+     *
+@code
+herdstat::util::GlobalProfiler().enable();
+herdstat::portage::PackageList pkgs;
+...
+herdstat::util::GlobalProfiler().report(std::cerr);
+@endcode
+     */
+
+    class Profiler : private Noncopyable
+    {
+        public:
+            /// Report formats.
+            enum format_type
+            {
+                /// One line per zone name, slowest (by self time) first.
+                flat,
+                /// The zones as they nest, indented.
+                tree
+            };
+
+            /// Destructor.
+            ~Profiler();
+
+            /** Start profiling.
+             * @param trace Also record each zone entered (for
+             * write_trace()).
+             */
+            void enable(bool trace = false);
+
+            /// Stop profiling.  Collected data is kept.
+            void disable();
+
+            /// Is profiling enabled?
+            bool enabled() const { return _enabled; }
+            /// Is tracing enabled?
+            bool tracing() const { return _tracing; }
+
+            /// Default for set_trace_limit().
+            static const std::size_t default_trace_limit = 1000000;
+
+            /** Set the most zones traced per thread.  Once a thread has
+             * recorded that many, further zones are still profiled but are
+             * left off the trace, and counted by dropped_events().  Keeps a
+             * long traced run from growing without bound.
+             * @param n Number of events (defaults to default_trace_limit).
+             */
+            void set_trace_limit(std::size_t n) { _trace_limit = n; }
+            /// Get the most zones traced per thread.
+            std::size_t trace_limit() const { return _trace_limit; }
+
+            /// Get the number of zones left off the trace (in all threads).
+            unsigned long dropped_events() const;
+
+            /** Discard collected data, including the dropped_events()
+             * count.  No zone may be active in any thread.
+             */
+            void reset();
+
+            /** Write a report of the time spent in each zone (merged across
+             * threads).  Times include time spent in nested zones; the self
+             * time doesn't.
+             * @param stream Output stream.
+             * @param format Report format (defaults to tree).
+             */
+            void report(std::ostream& stream, format_type format = tree) const;
+
+            /** Write the traced zones in the Chrome trace event format
+             * (loadable by chrome://tracing and Perfetto).  If any were
+             * dropped, the count is written as otherData.droppedEvents.
+             * @param stream Output stream.
+             */
+            void write_trace(std::ostream& stream) const;
+
+        private:
+            friend Profiler& GlobalProfiler();
+            friend class ProfileZone;
+
+            Profiler();
+
+            /// Get the calling thread's data, creating it if necessary.
+            ProfileThread *thread();
+
+            volatile bool _enabled;
+            volatile bool _tracing;
+            volatile std::size_t _trace_limit;
+            pthread_key_t _key;
+            std::vector<ProfileThread *> _threads;
+            mutable Mutex _mutex;
+    };
+
+    /// Get the global Profiler instance.
+    Profiler& GlobalProfiler();
+
+    /**
+     * @class ProfileZone profile.hh herdstat/util/profile.hh
+     * @brief Times the scope it's declared in (if profiling is enabled).
+     *
+@code
+void
+Foo::bar()
+{
+    herdstat::util::ProfileZone zone("Foo::bar()");
+    ...
+}
+@endcode
+     */
+
+    class ProfileZone : private Noncopyable
+    {
+        public:
+            /** Constructor.
+             * @param name Zone name.  Must be a string literal (or
+             * otherwise outlive the Profiler).
+             */
+            explicit ProfileZone(const char *name);
+
+            /// Destructor.
+            ~ProfileZone();
+
+        private:
+            ProfileThread *_thread;
+            ProfileNode *_node;
+            nsec_type _begin;
+    };
+
+} // namespace util
+} // namespace herdstat
+
+#endif /* _HAVE_UTIL_PROFILE_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -31,12 +31,13 @@ namespace herdstat {
 namespace util {
 
 ProgressBar::ProgressBar(const std::string& color)
-    : ProgressMeter(color), _cols(0), _total(0), _cur(0), _step(0)
+    : ProgressMeter(color), _cols(0), _total(0)
 {
 }
 
 ProgressBar::~ProgressBar() throw()
 {
+    this->stop();
 }
 
 void
@@ -44,7 +45,6 @@ ProgressBar::do_start()
 {
     _cols = util::getcols();
     _total = (_cols - 2);
-    _step = (100.0 / _total);
 
     std::printf("\n[");
     for (std::size_t i = 0 ; i < _total ; ++i)
@@ -61,17 +61,22 @@ ProgressBar::do_stop()
 void
 ProgressBar::do_increment(int cur)
 {
-    std::size_t inc = static_cast<std::size_t>(_cur += _step);
-    if (inc >= 100)
-        return;
+    /* frames may skip any number of increments, so draw the whole bar from
+     * where we are now rather than from where the last frame left off */
+    std::size_t inc = (cur <= 0 ? 0 : cur * _total / 100);
+    if (inc > _total)
+        inc = _total;
 
     for (std::size_t i = 0 ; i < _cols ; ++i)
         std::printf("\b \b");
 
     std::printf("[");
-    for (std::size_t i = 0 ; i < ( inc - 1 ) ; ++i)
-        std::printf("=");
-    std::printf(">");
+    if (inc > 0)
+    {
+        for (std::size_t i = 0 ; i < (inc - 1) ; ++i)
+            std::printf("=");
+        std::printf(">");
+    }
     for (std::size_t i = 0 ; i < (_total - inc) ; ++i)
         std::printf(" ");
     std::printf("]");
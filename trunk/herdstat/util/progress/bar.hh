@@ -47,8 +47,7 @@ namespace util {
             virtual void do_increment(int cur);
 
         private:
-            std::size_t _cols;
-            float _total, _cur, _step;
+            std::size_t _cols, _total;
     };
 
 } // namespace util
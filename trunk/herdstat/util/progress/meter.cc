@@ -24,27 +24,37 @@
 # include "config.h"
 #endif
 
+#include <cerrno>
+#include <sys/time.h>
+#include <herdstat/exceptions.hh>
 #include <herdstat/util/progress/meter.hh>
 
 namespace herdstat {
 namespace util {
+/*** static members *********************************************************/
+const unsigned ProgressMeter::default_frame_rate;
 /****************************************************************************/
 ProgressMeter::ProgressMeter(const std::string& color)
-    : _cur(0), _step(0), _started(false), _outlen(0), _color(color)
+    : _count(0), _drawn(0), _step(0), _started(false), _outlen(0),
+      _color(color), _fps(default_frame_rate), _rendering(false),
+      _thread(), _mutex()
 {
+    pthread_cond_init(&_cond, NULL);
 }
 /****************************************************************************/
 ProgressMeter::~ProgressMeter() throw()
 {
+    this->stop_renderer();
+    pthread_cond_destroy(&_cond);
 }
 /****************************************************************************/
 void
 ProgressMeter::start(unsigned total, const std::string& title)
 {
     if (_started) return;
-    _started = true;
 
     _step = 100.0 / total;
+    _count = _drawn = 0;
 
     if (not title.empty())
     {
@@ -56,6 +66,18 @@ ProgressMeter::start(unsigned total, const std::string& title)
     this->do_start();
     std::printf("\033[00m");
     std::fflush(stdout);
+
+    if (_fps != 0)
+    {
+        _rendering = true;
+        if ((errno = pthread_create(&_thread, NULL, renderer, this)) != 0)
+        {
+            _rendering = false;
+            throw ErrnoException("pthread_create");
+        }
+    }
+
+    _started = true;
 }
 /****************************************************************************/
 void
@@ -64,13 +86,84 @@ ProgressMeter::stop()
     if (not _started)
         return;
 
+    _started = false;
+    this->stop_renderer();
+
+    {
+        Lock lock(_mutex);
+        this->render();
+    }
+
+    std::printf("%s", _color.c_str());
     this->do_stop();
+    std::printf("\033[00m");
 
     for (unsigned i = 0 ; i < _outlen ; ++i)
         std::printf("\b \b");
     std::fflush(stdout);
 
-    _cur = _step = _outlen = _started = 0;
+    _count = _drawn = _outlen = 0;
+    _step = 0;
+}
+/****************************************************************************/
+void
+ProgressMeter::render()
+{
+    const unsigned count = __sync_fetch_and_add(&_count, 0);
+    if (count == _drawn)
+        return;
+
+    _drawn = count;
+
+    std::printf("%s", _color.c_str());
+    this->do_increment(static_cast<int>(count * _step));
+    std::printf("\033[00m");
+    std::fflush(stdout);
+}
+/****************************************************************************/
+void
+ProgressMeter::stop_renderer()
+{
+    {
+        Lock lock(_mutex);
+        if (not _rendering)
+            return;
+
+        _rendering = false;
+        pthread_cond_signal(&_cond);
+    }
+
+    pthread_join(_thread, NULL);
+}
+/****************************************************************************/
+void *
+ProgressMeter::renderer(void *arg)
+{
+    ProgressMeter *meter = static_cast<ProgressMeter *>(arg);
+    const long frame = 1000000 / meter->_fps;   /* usec */
+
+    Lock lock(meter->_mutex);
+
+    while (meter->_rendering)
+    {
+        struct timeval now;
+        gettimeofday(&now, NULL);
+
+        const long usec = now.tv_usec + frame;
+        struct timespec next;
+        next.tv_sec = now.tv_sec + (usec / 1000000);
+        next.tv_nsec = (usec % 1000000) * 1000;
+
+        /* sleep until the next frame is due or we're stopped */
+        while (meter->_rendering and
+               pthread_cond_timedwait(&meter->_cond, &meter->_mutex.native(),
+                    &next) != ETIMEDOUT) ;
+
+        if (meter->_rendering)
+            meter->render();
+    }
+
+    return NULL;
 }
 /****************************************************************************/
 } // namespace util
@@ -34,7 +34,9 @@
 
 #include <string>
 #include <cstdio>
+#include <pthread.h>
 #include <herdstat/defs.hh>
+#include <herdstat/util/thread.hh>
 
 namespace herdstat {
 namespace util {
@@ -43,6 +45,11 @@ namespace util {
      * @class ProgressMeter meter.hh herdstat/util/progress/meter.hh
      * @brief Provides the abstract interface for progress meters.
      *
+     * Incrementing a meter only bumps an atomic counter; it never touches
+     * the terminal.  A renderer thread, started by start(), redraws the
+     * meter at a fixed frame rate (see set_frame_rate()).  So a meter is
+     * cheap to increment per item, and may be shared between threads.
+     *
      * @section example Example
      *
      * Below is a simple example of using the ProgressMeter interface:
@@ -51,33 +58,49 @@ namespace util {
      *
      * For examples of writing your own ProgressMeter implementation, take a
      * look at the code for the Spinner class or the PercentMeter class.
+     * Implementations must call stop() from their destructor, so that the
+     * renderer is gone before they are.
      */
 
-    class ProgressMeter
+    class ProgressMeter : private Noncopyable
     {
         public:
+            /// Default number of frames drawn per second.
+            static const unsigned default_frame_rate = 10;
+
             /// Destructor.
             virtual ~ProgressMeter() throw();
 
             /** Start progress meter.
              * @param total Total number of items that will be processed.
              * @param title Title to display before the meter (defaults to "").
+             * @exception ErrnoException
              */
             void start(unsigned total, const std::string& title = "");
 
-            /// Stop progress meter.
+            /// Stop progress meter, drawing the final frame.
             void stop();
 
             ///@{
-            /// Increment progress.
+            /// Increment progress.  Safe to call from any thread.
             inline bool operator++();
             inline bool operator++(int) { return operator++(); }
             ///@}
 
             /// Has this meter been started?
             inline bool started() const { return _started; }
-            /// Get current progress.
-            inline const float& cur() const { return _cur; }
+            /// Get current progress (percent).
+            inline float cur() const;
+
+            /** Set the number of frames drawn per second.  Takes effect on
+             * the next start().
+             * @param fps Frames per second.  0 means draw on every increment
+             * in the incrementing thread, without a renderer thread.
+             */
+            void set_frame_rate(unsigned fps) { _fps = fps; }
+
+            /// Get the number of frames drawn per second.
+            unsigned frame_rate() const { return _fps; }
 
         protected:
             /** Constructor.
@@ -98,17 +121,31 @@ namespace util {
              */
             virtual void do_stop() { }
 
-            /** Abstract interface for incrementing the progress meter,
-             * implemented by each ProgressMeter derivative.
+            /** Abstract interface for drawing a frame, implemented by each
+             * ProgressMeter derivative.  Called at most once per frame, and
+             * only if progress was made since the last one.
+             * @param cur Current progress (percent).
              */
             virtual void do_increment(int cur) = 0;
 
         private:
-            float _cur;
+            /// Draw a frame if there's been progress.  Call with _mutex held.
+            void render();
+            /// Stop and join the renderer thread.
+            void stop_renderer();
+            static void *renderer(void *meter);
+
+            volatile unsigned _count;
+            unsigned _drawn;
             float _step;
-            bool _started;
+            volatile bool _started;
             unsigned _outlen;
             const std::string _color;
+            unsigned _fps;
+            bool _rendering;
+            pthread_t _thread;
+            pthread_cond_t _cond;
+            Mutex _mutex;
     };
 
     inline bool
@@ -117,16 +154,23 @@ namespace util {
         if (not _started)
             return false;
 
-        _cur += _step;
+        __sync_fetch_and_add(&_count, 1);
 
-        std::printf("%s", _color.c_str());
-        this->do_increment(static_cast<int>(_cur));
-        std::printf("\033[00m");
+        if (_fps == 0)
+        {
+            Lock lock(_mutex);
+            this->render();
+        }
 
-        std::fflush(stdout);
         return true;
     }
 
+    inline float
+    ProgressMeter::cur() const
+    {
+        return (_count * _step);
+    }
+
 } // namespace util
 } // namespace herdstat
 
@@ -30,7 +30,7 @@ namespace herdstat {
 namespace util {
 /****************************************************************************/
 PercentMeter::PercentMeter(const std::string& color)
-    : ProgressMeter(color)
+    : ProgressMeter(color), _width(0)
 {
 }
 /****************************************************************************/
@@ -42,29 +42,29 @@ PercentMeter::~PercentMeter() throw()
 void
 PercentMeter::do_start()
 {
-    std::printf("  0%%");
+    _width = 0;
+    this->do_increment(0);
 }
 /****************************************************************************/
 void
 PercentMeter::do_stop()
 {
-    append_outlen(4);
-
     /* sometimes the user has to use an estimate as the value
      * passed to start(), so we may not have gotten to 100 yet. */
-    while (this->cur() < 100.0)
-        this->operator++();
+    if (this->cur() < 100.0)
+        this->do_increment(100);
+
+    append_outlen(_width);
 }
 /****************************************************************************/
 void
 PercentMeter::do_increment(int cur)
 {
-    if (cur < 10)
-	std::printf("\b\b%.1d%%", cur);
-    else if (cur < 100)
-	std::printf("\b\b\b%.2d%%", cur);
-    else
-	std::printf("\b\b\b\b%.3d%%", cur);
+    /* frames can skip percentages, so back up over whatever we drew last
+     * rather than assuming it was one less than cur */
+    for (int i = 0 ; i < _width ; ++i)
+        std::printf("\b");
+    _width = std::printf("%3d%%", cur);
 }
 /****************************************************************************/
 } // namespace util
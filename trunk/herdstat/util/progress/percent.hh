@@ -62,6 +62,10 @@ namespace util {
             virtual void do_stop();
             /// Increment percentage.
             virtual void do_increment(int cur);
+
+        private:
+            /// Width of the percentage currently on screen.
+            int _width;
     };
 
 } // namespace util
@@ -32,8 +32,235 @@
 #include <sys/types.h>
 #include <regex.h>
 
+#include <cstring>
+#include <climits>
+#include <deque>
+#include <algorithm>
 #include <herdstat/util/regex.hh>
 
+#define ULONG_BITS              (sizeof(unsigned long) * CHAR_BIT)
+/* RegexSet::find() keeps its candidates on the stack for up to this many
+ * words' worth of regular expressions */
+#define REGEXSET_STACK_WORDS    8
+
+namespace {
+    /* guards construction of the GlobalRegexCache() instance */
+    pthread_mutex_t global_regex_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+    /* locale-independent, so it folds patterns and input the same way */
+    inline unsigned char
+    ascii_tolower(unsigned char c)
+    {
+        return ((c >= 'A' and c <= 'Z') ? c + ('a' - 'A') : c);
+    }
+
+    inline bool
+    ascii_isalnum(unsigned char c)
+    {
+        return ((c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z') or
+                (c >= '0' and c <= '9'));
+    }
+
+    /* returns the index just past the bracket expression starting at i */
+    std::string::size_type
+    skip_bracket(const std::string& re, std::string::size_type i)
+    {
+        const std::string::size_type n = re.size();
+
+        ++i;
+        if (i < n and re[i] == '^') ++i;
+        if (i < n and re[i] == ']') ++i;
+
+        while (i < n and re[i] != ']')
+        {
+            /* [:class:], [=equiv=], [.coll.] */
+            if (re[i] == '[' and i+1 < n and
+                (re[i+1] == ':' or re[i+1] == '=' or re[i+1] == '.'))
+            {
+                const char close[3] = { re[i+1], ']', '\0' };
+                std::string::size_type pos = re.find(close, i+2);
+                i = (pos == std::string::npos ? n : pos + 2);
+            }
+            else
+                ++i;
+        }
+
+        return (i < n ? i + 1 : n);
+    }
+
+    /* is there a repetition operator at i? */
+    inline bool
+    quantifier_at(const std::string& re, std::string::size_type i, bool ere)
+    {
+        if (i < re.size() and re[i] == '*')
+            return true;
+        if (ere)
+            return (i < re.size() and std::strchr("+?{", re[i]));
+        return (i+1 < re.size() and re[i] == '\\' and
+                std::strchr("+?{", re[i+1]));
+    }
+
+    /* returns the index just past the group whose contents start at i */
+    std::string::size_type
+    skip_group(const std::string& re, std::string::size_type i, bool ere)
+    {
+        const std::string::size_type n = re.size();
+        int depth = 1;
+
+        while (i < n and depth > 0)
+        {
+            if (re[i] == '[')
+                i = skip_bracket(re, i);
+            else if (re[i] == '\\' and i+1 < n)
+            {
+                if (not ere and re[i+1] == '(') ++depth;
+                else if (not ere and re[i+1] == ')') --depth;
+                i += 2;
+            }
+            else
+            {
+                if (ere and re[i] == '(') ++depth;
+                else if (ere and re[i] == ')') --depth;
+                ++i;
+            }
+        }
+
+        return i;
+    }
+
+    /*
+     * Find the longest run of literal characters that every match of the
+     * given regular expression must contain, and whether the whole thing
+     * is just that literal (plus optional anchors).  Anything we're not
+     * sure about simply ends the current run, so the result is always
+     * safe to use as a prefilter.  Returns false if there's no such
+     * literal (ie. top-level alternation).
+     */
+    bool
+    required_literal(const std::string& re, bool ere, std::string& literal,
+                     bool& plain, bool& bol, bool& eol)
+    {
+        const std::string::size_type n = re.size();
+        std::string::size_type i = 0;
+        std::string cur;
+
+        literal.clear();
+        plain = true;
+        bol = eol = false;
+
+        if (n > 0 and re[0] == '^')
+        {
+            bol = true;
+            ++i;
+        }
+
+        while (i < n)
+        {
+            const unsigned char c = re[i];
+            bool special = true;
+            bool plus = false;
+
+            if (c == '\\')
+            {
+                if (i+1 == n)
+                    return false;
+
+                const unsigned char d = re[i+1];
+                i += 2;
+
+                if (d >= 0x80 or ascii_isalnum(d))
+                    ;   /* \w, \b, back-references, etc */
+                else if (std::strchr("<>`'", d))
+                    ;   /* GNU word/buffer anchors */
+                else if (ere or std::strchr("(){}|+?", d) == NULL)
+                {
+                    cur += d;
+                    special = false;
+                }
+                else if (d == '|')
+                    return false;
+                else if (d == '(')
+                    i = skip_group(re, i, false);
+                else if (d == '{')
+                {
+                    if (not cur.empty()) cur.erase(cur.size() - 1);
+                    std::string::size_type pos = re.find("\\}", i);
+                    i = (pos == std::string::npos ? n : pos + 2);
+                }
+                else if (d == '?')
+                {
+                    if (not cur.empty()) cur.erase(cur.size() - 1);
+                }
+                else if (d == '+')
+                    plus = true;
+                else
+                    return false;   /* unmatched \) or \} */
+            }
+            else if (c == '[')
+                i = skip_bracket(re, i);
+            else if (c == '*' or (ere and c == '?'))
+            {
+                if (not cur.empty()) cur.erase(cur.size() - 1);
+                ++i;
+            }
+            else if (ere and c == '{')
+            {
+                if (not cur.empty()) cur.erase(cur.size() - 1);
+                std::string::size_type pos = re.find('}', i);
+                i = (pos == std::string::npos ? n : pos + 1);
+            }
+            else if (ere and c == '(')
+                i = skip_group(re, i+1, true);
+            else if (ere and (c == '|' or c == ')'))
+                return false;
+            else if (c == '$' and i+1 == n)
+            {
+                eol = true;
+                ++i;
+                continue;
+            }
+            else if (ere and c == '+')
+            {
+                plus = true;
+                ++i;
+            }
+            else if (c == '.' or c == '^' or c == '$' or c >= 0x80)
+                ++i;
+            else
+            {
+                cur += c;
+                special = false;
+                ++i;
+            }
+
+            if (special)
+            {
+                /* x+ is xx*: the x is required and starts the next run */
+                unsigned char last = 0;
+                if (not cur.empty())
+                {
+                    last = cur[cur.size() - 1];
+                    if (plus and quantifier_at(re, i, ere))
+                        cur.erase(cur.size() - 1);
+                }
+
+                plain = false;
+                if (cur.size() > literal.size())
+                    literal.swap(cur);
+                cur.clear();
+
+                if (plus and last and not quantifier_at(re, i, ere))
+                    cur += last;
+            }
+        }
+
+        if (cur.size() > literal.size())
+            literal.swap(cur);
+
+        return true;
+    }
+}
+
 namespace herdstat {
 namespace util {
 /*** static members **********************************************************/
@@ -44,50 +271,197 @@ const Regex::Cflags Regex::newline = Regex::Cflags(REG_NEWLINE);
 const Regex::Eflags Regex::notbol = Regex::Eflags(REG_NOTBOL);
 const Regex::Eflags Regex::noteol = Regex::Eflags(REG_NOTEOL);
 /*****************************************************************************/
+RegexProgram::RegexProgram(const std::string& str, int cflags)
+    : _str(str), _cflags(cflags), _regex(), _refs(1)
+{
+    int ret = regcomp(&_regex, _str.c_str(), _cflags);
+    if (ret != 0)
+        throw BadRegex(ret, &_regex);
+}
+/*****************************************************************************/
+RegexProgram::~RegexProgram()
+{
+    regfree(&_regex);
+}
+/*****************************************************************************/
+const RegexProgram *
+RegexProgram::compile(const std::string& str, int cflags)
+{
+    return new RegexProgram(str, cflags);
+}
+/*****************************************************************************/
+RegexCache::RegexCache(size_type capacity)
+    : _capacity(capacity), _hits(0), _misses(0), _lru(), _map(), _mutex()
+{
+}
+/*****************************************************************************/
+RegexCache::~RegexCache()
+{
+    this->clear();
+}
+/*****************************************************************************/
+const RegexProgram *
+RegexCache::get(const std::string& str, int cflags)
+{
+    {
+        Lock lock(_mutex);
+
+        map_type::iterator i = _map.find(key_type(str, cflags));
+        if (i != _map.end())
+        {
+            ++_hits;
+            /* move to front */
+            _lru.splice(_lru.begin(), _lru, i->second);
+            _lru.front()->ref();
+            return _lru.front();
+        }
+
+        ++_misses;
+    }
+
+    /* don't hold the lock while compiling; if another thread beats us
+     * to it, we just end up using our own copy. */
+    const RegexProgram *prog = RegexProgram::compile(str, cflags);
+
+    Lock lock(_mutex);
+
+    if (_capacity == 0 or _map.count(key_type(str, cflags)))
+        return prog;
+
+    this->evict(_capacity - 1);
+
+    prog->ref();
+    _lru.push_front(prog);
+    _map.insert(map_type::value_type(key_type(str, cflags), _lru.begin()));
+
+    return prog;
+}
+/*****************************************************************************/
+void
+RegexCache::evict(size_type capacity)
+{
+    while (_lru.size() > capacity)
+    {
+        const RegexProgram *prog = _lru.back();
+        _map.erase(key_type(prog->str(), prog->cflags()));
+        _lru.pop_back();
+        prog->unref();
+    }
+}
+/*****************************************************************************/
+RegexCache::size_type
+RegexCache::capacity() const
+{
+    Lock lock(_mutex);
+    return _capacity;
+}
+/*****************************************************************************/
+void
+RegexCache::set_capacity(size_type capacity)
+{
+    Lock lock(_mutex);
+    _capacity = capacity;
+    this->evict(_capacity);
+}
+/*****************************************************************************/
+RegexCache::size_type
+RegexCache::size() const
+{
+    Lock lock(_mutex);
+    return _lru.size();
+}
+/*****************************************************************************/
+void
+RegexCache::clear()
+{
+    Lock lock(_mutex);
+    this->evict(0);
+}
+/*****************************************************************************/
+RegexCache::size_type
+RegexCache::hits() const
+{
+    Lock lock(_mutex);
+    return _hits;
+}
+/*****************************************************************************/
+RegexCache::size_type
+RegexCache::misses() const
+{
+    Lock lock(_mutex);
+    return _misses;
+}
+/*****************************************************************************/
+RegexCache&
+GlobalRegexCache()
+{
+    static RegexCache * volatile cache = NULL;
+
+    RegexCache *c = atomic_load(cache);
+    if (not c)
+    {
+        Lock lock(global_regex_cache_mutex);
+        if (not (c = atomic_load(cache)))
+        {
+            static RegexCache instance;
+            atomic_store(cache, c = &instance);
+        }
+    }
+
+    return *c;
+}
+/*****************************************************************************/
 Regex::Regex()
-    : _str(), _compiled(false), _cflags(0), _eflags(0), _regex()
+    : _str(), _cflags(0), _eflags(0), _prog(NULL)
 {
 }
 /*****************************************************************************/
 Regex::Regex(const Regex& that)
-    : _str(), _compiled(false), _cflags(0), _eflags(0), _regex()
+    : _str(that._str), _cflags(that._cflags), _eflags(that._eflags),
+      _prog(that._prog)
 {
-    *this = that;
+    if (_prog)
+        _prog->ref();
 }
 /*****************************************************************************/
 Regex::Regex(int c, int e)
-    : _str(), _compiled(false), _cflags(c), _eflags(e), _regex()
+    : _str(), _cflags(c), _eflags(e), _prog(NULL)
 {
 }
 /*****************************************************************************/
 Regex::Regex(const std::string &regex, int c, int e)
-    : _str(regex), _compiled(false), _cflags(c), _eflags(e), _regex()
+    : _str(regex), _cflags(c), _eflags(e), _prog(NULL)
 {
     this->compile();
 }
 /*****************************************************************************/
 Regex::~Regex() throw()
 {
-    if (this->_compiled)
-        this->cleanup();
+    if (_prog)
+        _prog->unref();
 }
 /*****************************************************************************/
 Regex&
 Regex::operator= (const Regex& that)
 {
-    /* compiler-generated copy constructor/assignment operator won't do
-     * since we need to free the old regex_t and compile the new one */
+    /* take the new reference first in case this == &that */
+    if (that._prog)
+        that._prog->ref();
+    if (_prog)
+        _prog->unref();
+
+    _str = that._str;
+    _cflags = that._cflags;
+    _eflags = that._eflags;
+    _prog = that._prog;
 
-    this->assign(that._str, that._cflags, that._eflags);
     return *this;
 }
 /*****************************************************************************/
 void
 Regex::assign(const std::string& regex)
 {
-    if (this->_compiled)
-        this->cleanup();
-
+    this->cleanup();
     this->_str.assign(regex);
     this->compile();
 }
@@ -95,37 +469,289 @@ Regex::assign(const std::string& regex)
 void
 Regex::assign(const std::string &regex, int c, int e)
 {
-    if (this->_compiled)
-        this->cleanup();
-
+    this->cleanup();
     this->_str.assign(regex);
     this->_cflags = c;
     this->_eflags = e;
-
     this->compile();
 }
 /*****************************************************************************/
 void
 Regex::compile()
 {
-    if (this->_compiled)
-        this->cleanup();
-
-    int ret = regcomp(&(this->_regex), this->_str.c_str(), this->_cflags);
-    if (ret != 0)
-        throw BadRegex(ret, &(this->_regex));
-
-    this->_compiled = true;
+    const RegexProgram *prog = GlobalRegexCache().get(_str, _cflags);
+    if (_prog)
+        _prog->unref();
+    _prog = prog;
 }
 /*****************************************************************************/
 void
 Regex::cleanup()
 {
-    regfree(&(this->_regex));
-    this->_compiled = false;
+    if (_prog)
+    {
+        _prog->unref();
+        _prog = NULL;
+    }
+
     this->_str.clear();
 }
 /*****************************************************************************/
+const RegexSet::size_type RegexSet::npos = static_cast<size_type>(-1);
+/*****************************************************************************/
+RegexSet::RegexSet()
+    : _res(), _entries(), _nodes(), _built(false), _mutex()
+{
+}
+/*****************************************************************************/
+RegexSet::RegexSet(const RegexSet& that)
+    : _res(that._res), _entries(), _nodes(), _built(false), _mutex()
+{
+}
+/*****************************************************************************/
+RegexSet&
+RegexSet::operator= (const RegexSet& that)
+{
+    if (this != &that)
+    {
+        Lock lock(_mutex);
+        _res = that._res;
+        _built = false;
+    }
+
+    return *this;
+}
+/*****************************************************************************/
+RegexSet::~RegexSet()
+{
+}
+/*****************************************************************************/
+void
+RegexSet::push_back(const Regex& re)
+{
+    Lock lock(_mutex);
+    _res.push_back(re);
+    _built = false;
+}
+/*****************************************************************************/
+void
+RegexSet::clear()
+{
+    Lock lock(_mutex);
+    _res.clear();
+    _built = false;
+}
+/*****************************************************************************/
+void
+RegexSet::build() const
+{
+    _entries.assign(_res.size(), Entry());
+    _nodes.assign(1, Node());
+
+    for (size_type k = 0 ; k < _res.size() ; ++k)
+    {
+        Entry& e(_entries[k]);
+        e.kind = Entry::posix;
+        e.icase = false;
+
+        const RegexProgram *prog = _res[k].program();
+        if (not prog)
+            continue;
+
+        const int cflags = prog->cflags();
+        bool plain, bol, eol;
+        if (not required_literal(prog->str(), cflags & REG_EXTENDED,
+                e.literal, plain, bol, eol))
+        {
+            e.literal.clear();
+            continue;
+        }
+
+        e.icase = cflags & REG_ICASE;
+        if (e.icase)
+            std::transform(e.literal.begin(), e.literal.end(),
+                e.literal.begin(), ascii_tolower);
+
+        /* anchors mean something else with these */
+        if (plain and not (cflags & REG_NEWLINE) and
+            not ((bol and (_res[k].eflags() & REG_NOTBOL)) or
+                 (eol and (_res[k].eflags() & REG_NOTEOL))))
+        {
+            if (bol and eol)    e.kind = Entry::exact;
+            else if (bol)       e.kind = Entry::prefix;
+            else if (eol)       e.kind = Entry::suffix;
+            else                e.kind = Entry::substr;
+        }
+
+        if (e.literal.empty())
+            continue;
+
+        /* add to trie; everything's folded to lower case */
+        size_type state = 0;
+        std::string::const_iterator i;
+        for (i = e.literal.begin() ; i != e.literal.end() ; ++i)
+        {
+            const unsigned char c = ascii_tolower(*i);
+            std::map<unsigned char, size_type>::iterator t =
+                _nodes[state].next.find(c);
+            if (t == _nodes[state].next.end())
+            {
+                _nodes.push_back(Node());
+                t = _nodes[state].next.insert(
+                    std::make_pair(c, _nodes.size() - 1)).first;
+            }
+            state = t->second;
+        }
+
+        _nodes[state].out.push_back(k);
+    }
+
+    /* fill in failure links breadth-first, merging outputs as we go */
+    std::deque<size_type> queue;
+    std::map<unsigned char, size_type>::const_iterator t;
+    for (t = _nodes[0].next.begin() ; t != _nodes[0].next.end() ; ++t)
+        queue.push_back(t->second);
+
+    while (not queue.empty())
+    {
+        const size_type state = queue.front();
+        queue.pop_front();
+
+        for (t = _nodes[state].next.begin() ;
+             t != _nodes[state].next.end() ; ++t)
+        {
+            size_type f = _nodes[state].fail;
+            while (f != 0 and _nodes[f].next.find(t->first) ==
+                    _nodes[f].next.end())
+                f = _nodes[f].fail;
+
+            std::map<unsigned char, size_type>::const_iterator ft =
+                _nodes[f].next.find(t->first);
+            Node& child(_nodes[t->second]);
+            child.fail = (ft == _nodes[f].next.end() ? 0 : ft->second);
+            child.out.insert(child.out.end(),
+                _nodes[child.fail].out.begin(), _nodes[child.fail].out.end());
+
+            queue.push_back(t->second);
+        }
+    }
+
+    _built = true;
+}
+/*****************************************************************************/
+RegexSet::size_type
+RegexSet::find(const std::string& str) const
+{
+    {
+        Lock lock(_mutex);
+        if (not _built)
+            this->build();
+    }
+
+    /* regexec() stops at the first NUL, so we do too */
+    const char * const s = str.c_str();
+    const std::string::size_type len = std::strlen(s);
+
+    /* one pass over the input marks every regex whose literal it has.
+     * one bit each; on the stack unless there are lots of them. */
+    unsigned long stack_hit[REGEXSET_STACK_WORDS];
+    std::vector<unsigned long> heap_hit;
+    const size_type words = (_entries.size() + ULONG_BITS - 1) / ULONG_BITS;
+    unsigned long *hit = stack_hit;
+    if (words > REGEXSET_STACK_WORDS)
+    {
+        heap_hit.resize(words);
+        hit = &heap_hit[0];
+    }
+    std::fill(hit, hit + words, 0UL);
+
+    bool ascii = true;
+    size_type state = 0;
+    for (std::string::size_type i = 0 ; i < len ; ++i)
+    {
+        const unsigned char c = ascii_tolower(s[i]);
+        if (c >= 0x80)
+            ascii = false;
+
+        std::map<unsigned char, size_type>::const_iterator t;
+        while ((t = _nodes[state].next.find(c)) == _nodes[state].next.end()
+                and state != 0)
+            state = _nodes[state].fail;
+        state = (t == _nodes[state].next.end() ? 0 : t->second);
+
+        const std::vector<size_type>& out(_nodes[state].out);
+        for (std::vector<size_type>::const_iterator o = out.begin() ;
+             o != out.end() ; ++o)
+            hit[*o / ULONG_BITS] |= (1UL << (*o % ULONG_BITS));
+    }
+
+    std::string folded;
+    for (size_type k = 0 ; k < _entries.size() ; ++k)
+    {
+        const Entry& e(_entries[k]);
+        const RegexProgram *prog = _res[k].program();
+        if (not prog)
+            continue;
+
+        /* case folding outside of ASCII is up to the locale */
+        if (e.icase and not ascii)
+        {
+            if (prog->match(s, _res[k].eflags()))
+                return k;
+            continue;
+        }
+
+        if (not e.literal.empty() and
+            not (hit[k / ULONG_BITS] & (1UL << (k % ULONG_BITS))))
+            continue;
+
+        if (e.kind == Entry::posix)
+        {
+            if (prog->match(s, _res[k].eflags()))
+                return k;
+            continue;
+        }
+
+        if (e.icase and folded.empty() and len > 0)
+        {
+            folded.assign(s, len);
+            std::transform(folded.begin(), folded.end(), folded.begin(),
+                ascii_tolower);
+        }
+
+        const std::string& in(e.icase ? folded : str);
+        const std::string::size_type n = e.literal.size();
+        bool matched = false;
+
+        switch (e.kind)
+        {
+            case Entry::exact:
+                matched = (len == n and in.compare(0, n, e.literal) == 0);
+                break;
+            case Entry::prefix:
+                matched = (len >= n and in.compare(0, n, e.literal) == 0);
+                break;
+            case Entry::suffix:
+                matched = (len >= n and
+                           in.compare(len - n, n, e.literal) == 0);
+                break;
+            default:
+            {
+                /* hit[k] only says it's in there when folded */
+                const std::string::size_type pos = in.find(e.literal);
+                matched = (e.icase or
+                           (pos != std::string::npos and pos + n <= len));
+                break;
+            }
+        }
+
+        if (matched)
+            return k;
+    }
+
+    return npos;
+}
+/*****************************************************************************/
 } // namespace util
 } // namespace herdstat
 
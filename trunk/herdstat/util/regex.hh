@@ -33,17 +33,162 @@
  */
 
 #include <string>
+#include <list>
+#include <map>
+#include <vector>
 #include <functional>
 #include <cstddef>
 #include <sys/types.h>
 #include <regex.h>
 
 #include <herdstat/exceptions.hh>
+#include <herdstat/noncopyable.hh>
 #include <herdstat/util/container_base.hh>
+#include <herdstat/util/thread.hh>
+
+/**
+ * @def REGEX_CACHE_SIZE
+ * @brief Default capacity of the GlobalRegexCache().
+ */
+
+#define REGEX_CACHE_SIZE        64
 
 namespace herdstat {
 namespace util {
 
+    /**
+     * @class RegexProgram regex.hh herdstat/util/regex.hh
+     * @brief An immutable, reference-counted compiled regular expression.
+     * Shared by all Regex objects compiled from the same pattern and cflags;
+     * you shouldn't need to use it directly.
+     */
+
+    class RegexProgram : private Noncopyable
+    {
+        public:
+            /** Compile a regular expression.
+             * @param str regular expression string.
+             * @param cflags CFLAGS.
+             * @exception BadRegex
+             * @returns Program with a reference count of one.
+             */
+            static const RegexProgram *compile(const std::string& str,
+                                               int cflags);
+
+            /// Take a reference.
+            inline void ref() const;
+            /// Drop a reference, destroying the program if it was the last.
+            inline void unref() const;
+
+            /// Does the program match the given string?
+            inline bool match(const char *str, int eflags) const;
+
+            /// Get regular expression string.
+            const std::string& str() const { return _str; }
+            /// Get CFLAGS.
+            int cflags() const { return _cflags; }
+
+        private:
+            RegexProgram(const std::string& str, int cflags);
+            virtual ~RegexProgram();
+
+            const std::string _str;
+            const int _cflags;
+            regex_t _regex;
+            mutable int _refs;
+    };
+
+    inline void
+    RegexProgram::ref() const
+    {
+        __sync_fetch_and_add(&_refs, 1);
+    }
+
+    inline void
+    RegexProgram::unref() const
+    {
+        if (__sync_sub_and_fetch(&_refs, 1) == 0)
+            delete this;
+    }
+
+    inline bool
+    RegexProgram::match(const char *str, int eflags) const
+    {
+        return (regexec(&_regex, str, 0, NULL, eflags) == 0);
+    }
+
+    /**
+     * @class RegexCache regex.hh herdstat/util/regex.hh
+     * @brief Bounded cache of compiled regular expressions keyed by
+     * (pattern, cflags).  When full, the least recently used program is
+     * evicted; Regex objects still using it are unaffected.
+     *
+     * All Regex objects compile through GlobalRegexCache(), so constructing
+     * the same Regex over and over (eg. for every search query) only calls
+     * regcomp() once.  The cache is safe to use from multiple threads.
+     */
+
+    class RegexCache : private Noncopyable
+    {
+        public:
+            typedef std::size_t size_type;
+
+            /** Constructor.
+             * @param capacity Maximum number of cached programs.  Zero
+             * disables caching.
+             */
+            RegexCache(size_type capacity = REGEX_CACHE_SIZE);
+
+            /// Destructor.
+            virtual ~RegexCache();
+
+            /** Get the compiled program for the given pattern, compiling
+             * it if it isn't cached.
+             * @param str regular expression string.
+             * @param cflags CFLAGS.
+             * @exception BadRegex
+             * @returns Program; the caller owns one reference to it.
+             */
+            const RegexProgram *get(const std::string& str, int cflags);
+
+            /// Get maximum number of cached programs.
+            size_type capacity() const;
+            /// Set maximum number of cached programs, evicting if needed.
+            void set_capacity(size_type capacity);
+
+            /// Get number of cached programs.
+            size_type size() const;
+            /// Drop all cached programs.
+            void clear();
+
+            /// Number of get() calls satisfied from the cache.
+            size_type hits() const;
+            /// Number of get() calls that had to compile.
+            size_type misses() const;
+
+        private:
+            typedef std::pair<std::string, int> key_type;
+            typedef std::list<const RegexProgram *> lru_type;
+            typedef std::map<key_type, lru_type::iterator> map_type;
+
+            void evict(size_type capacity);
+
+            size_type _capacity;
+            size_type _hits;
+            size_type _misses;
+            /// most recently used first.
+            lru_type _lru;
+            map_type _map;
+            mutable Mutex _mutex;
+    };
+
+    /**
+     * Sole access point to the process-wide RegexCache.
+     * @returns reference to a local static instance.
+     */
+
+    RegexCache& GlobalRegexCache();
+
     /**
      * @class Regex regex.hh herdstat/util/regex.hh
      * @brief POSIX regular expressions interface.
@@ -92,6 +237,9 @@ if (str == regex)
      * these cases you'll want to use the herdstat::util::regexMatch function
      * object in addition to an algorithm.
      * @see util::regexMatch for an example on it's usage.
+     *
+     * Copying a Regex is cheap; copies share the same compiled RegexProgram.
+     * Compiling goes through GlobalRegexCache().
      */
 
     class Regex
@@ -119,9 +267,7 @@ if (str == regex)
             /// Default constructor.
             Regex();
 
-            /** Copy constructor.
-             * @exception BadRegex
-             */
+            /// Copy constructor.
             Regex(const Regex& that);
 
             /** Constructor.
@@ -162,9 +308,7 @@ if (str == regex)
              */
             inline Regex& operator= (const std::string& s);
 
-            /** Copy assignment operator.
-             * @exception BadRegex
-             */
+            /// Copy assignment operator.
             Regex& operator= (const Regex& that);
 
             /** Determine if this regex matches the specified std::string.
@@ -228,17 +372,19 @@ if (str == regex)
             /// Set EFLAGS.
             inline void set_eflags(int eflags);
 
+            /// Get compiled program (NULL if nothing's been compiled).
+            inline const RegexProgram *program() const { return _prog; }
+
         private:
-            /// Clean up compiled regex_t
+            /// Drop compiled program.
             void cleanup();
             /// Compile regex.
             void compile();
 
             std::string _str;
-            bool        _compiled;
             int         _cflags;
             int         _eflags;
-            regex_t     _regex;
+            const RegexProgram *_prog;
     };
 
     inline Regex&
@@ -251,7 +397,7 @@ if (str == regex)
     inline bool
     Regex::operator== (const std::string& cmp) const
     {
-        return (regexec(&_regex, cmp.c_str(), 0, NULL, _eflags) == 0);
+        return (_prog and _prog->match(cmp.c_str(), _eflags));
     }
 
     inline bool
@@ -329,17 +475,149 @@ if (str == regex)
     }
     ///@}
 
+    /**
+     * @class RegexSet regex.hh herdstat/util/regex.hh
+     * @brief An ordered set of regular expressions that can be matched
+     * against a string all at once, returning the first one (in insertion
+     * order) that matches.
+     *
+     * Each pattern is scanned for the longest literal every match must
+     * contain.  The literals of all patterns are compiled into a single
+     * Aho-Corasick automaton, so one pass over the input rules out every
+     * pattern whose literal it doesn't contain.  Patterns that are plain
+     * literals (optionally anchored with ^ and/or $) are then matched with
+     * a string compare; anything else falls back to regexec().  Patterns
+     * with no usable literal (eg. top-level alternation) are always tried.
+     *
+     * The matcher is built lazily by the first find() after a change, and
+     * const member functions are safe to call from multiple threads.
+     */
+
+    class RegexSet
+    {
+        public:
+            typedef std::vector<Regex> container_type;
+            typedef container_type::size_type size_type;
+            typedef container_type::const_iterator const_iterator;
+
+            /// Returned by find() when nothing matches.
+            static const size_type npos;
+
+            /// Default constructor.
+            RegexSet();
+            /// Copy constructor.
+            RegexSet(const RegexSet& that);
+            /// Copy assignment operator.
+            RegexSet& operator= (const RegexSet& that);
+            /// Destructor.
+            ~RegexSet();
+
+            /// Append a regular expression.
+            void push_back(const Regex& re);
+            /// Remove all regular expressions.
+            void clear();
+
+            size_type size() const { return _res.size(); }
+            bool empty() const { return _res.empty(); }
+            const_iterator begin() const { return _res.begin(); }
+            const_iterator end() const { return _res.end(); }
+            const Regex& operator[](size_type n) const { return _res[n]; }
+
+            /** Find the first regular expression that matches.
+             * @param str String to match.
+             * @returns Index of the regular expression or npos.
+             */
+            size_type find(const std::string& str) const;
+
+            /** Make our contents equal the keys of the given range of
+             * (Regex, T) pairs, leaving the matcher alone if they already
+             * do.
+             * @param first Beginning of range.
+             * @param last End of range.
+             */
+            template <typename InputIterator>
+            void sync(InputIterator first, InputIterator last);
+
+        private:
+            /* what we know about each regular expression */
+            struct Entry
+            {
+                enum Kind { posix, exact, prefix, suffix, substr };
+
+                Kind kind;          /* how to match it */
+                bool icase;
+                std::string literal;/* required literal (lowercase if icase) */
+            };
+
+            /* Aho-Corasick automaton node */
+            struct Node
+            {
+                Node() : next(), fail(0), out() { }
+
+                std::map<unsigned char, size_type> next;
+                size_type fail;
+                std::vector<size_type> out;
+            };
+
+            void build() const;
+
+            container_type _res;
+            mutable std::vector<Entry> _entries;
+            mutable std::vector<Node> _nodes;
+            mutable bool _built;
+            mutable Mutex _mutex;
+    };
+
+    template <typename InputIterator>
+    void
+    RegexSet::sync(InputIterator first, InputIterator last)
+    {
+        Lock lock(_mutex);
+
+        size_type n = 0;
+        InputIterator i = first;
+        for (; i != last and n < _res.size() ; ++i, ++n)
+        {
+            if (i->first.program() != _res[n].program() or
+                i->first.eflags() != _res[n].eflags())
+                break;
+        }
+
+        if (i == last and n == _res.size())
+            return;
+
+        /* something changed; start over from the first difference */
+        _res.erase(_res.begin() + n, _res.end());
+        for (; i != last ; ++i)
+            _res.push_back(i->first);
+        _built = false;
+    }
+
     /**
      * @class RegexMap regex.hh herdstat/util/regex.hh
      * @brief Acts like an unsorted map (vector of unique pairs) with Regex
      * objects mapped to objects of type T.  Provides a few map-compatible
      * member functions such as insert(), operator[](), and find().
+     *
+     * The matcher used by find() is updated by insert(), operator[](),
+     * erase() and clear(), so add and remove keys using those (and don't
+     * modify keys through iterators).
      */
 
     template <typename T>
     class RegexMap
         : public herdstat::util::VectorBase<std::pair<Regex, T> >
     {
+        private:
+            mutable RegexSet _matcher;
+
+            /* keys were changed behind our back? */
+            inline void check() const
+            {
+                if (_matcher.size() != this->size())
+                    _matcher.sync(this->begin(), this->end());
+            }
+
         public:
             typedef herdstat::util::VectorBase<std::pair<Regex, T> > base_type;
             typedef typename base_type::container_type container_type;
@@ -354,6 +632,10 @@ if (str == regex)
             mapped_type& operator[](const key_type& k);
             std::pair<iterator, bool> insert(const value_type& v);
 
+            inline iterator erase(iterator pos);
+            inline iterator erase(iterator first, iterator last);
+            inline void clear();
+
             inline iterator find(const std::string& str);
             inline const_iterator find(const std::string& str) const;
     };
@@ -362,18 +644,18 @@ if (str == regex)
     inline typename RegexMap<T>::iterator
     RegexMap<T>::find(const std::string& str)
     {
-        for (iterator i = this->begin() ; i != this->end() ; ++i)
-            if (i->first == str) return i;
-        return this->end();
+        this->check();
+        const RegexSet::size_type n = _matcher.find(str);
+        return (n == RegexSet::npos ? this->end() : this->begin() + n);
     }
 
     template <typename T>
     inline typename RegexMap<T>::const_iterator
     RegexMap<T>::find(const std::string& str) const
     {
-        for (const_iterator i = this->begin() ; i != this->end() ; ++i)
-            if (i->first == str) return i;
-        return this->end();
+        this->check();
+        const RegexSet::size_type n = _matcher.find(str);
+        return (n == RegexSet::npos ? this->end() : this->begin() + n);
     }
 
     template <typename T>
@@ -382,7 +664,7 @@ if (str == regex)
     {
         for (iterator i = this->begin() ; i != this->end() ; ++i)
             if (i->first == k) return i->second;
-        return this->insert(this->end(), value_type(k, "")).second;
+        return this->insert(value_type(k, "")).first->second;
     }
 
     template <typename T>
@@ -392,8 +674,36 @@ if (str == regex)
         for (iterator i = this->begin() ; i != this->end() ; ++i)
             if (i->first == v.first)
                 return std::pair<iterator, bool>(this->end(), false);
-        return std::pair<iterator, bool>(
-                base_type::insert(this->end(), v), true);
+
+        const iterator i = base_type::insert(this->end(), v);
+        _matcher.push_back(v.first);
+        return std::pair<iterator, bool>(i, true);
+    }
+
+    template <typename T>
+    inline typename RegexMap<T>::iterator
+    RegexMap<T>::erase(iterator pos)
+    {
+        const iterator i = base_type::erase(pos);
+        _matcher.sync(this->begin(), this->end());
+        return i;
+    }
+
+    template <typename T>
+    inline typename RegexMap<T>::iterator
+    RegexMap<T>::erase(iterator first, iterator last)
+    {
+        const iterator i = base_type::erase(first, last);
+        _matcher.sync(this->begin(), this->end());
+        return i;
+    }
+
+    template <typename T>
+    inline void
+    RegexMap<T>::clear()
+    {
+        base_type::clear();
+        _matcher.clear();
     }
 
 } // namespace util
@@ -37,53 +37,181 @@
 namespace herdstat {
 namespace util {
 /*****************************************************************************/
-std::string
-basename(const std::string& path)
+const StringView::size_type StringView::npos =
+    static_cast<StringView::size_type>(-1);
+/*****************************************************************************/
+StringView::size_type
+StringView::find(char c, size_type pos) const
 {
-    std::string result(path);
-    std::string::size_type pos;
+    if (pos >= _size)
+        return npos;
 
-    /* chop all trailing /'s */
-    while (result[result.length() - 1] == '/' and result.length() > 1)
-	result.erase(result.length() - 1);
+    const void *p = std::memchr(_data + pos, c, _size - pos);
+    return (p ? static_cast<const char *>(p) - _data : npos);
+}
+/*****************************************************************************/
+StringView::size_type
+StringView::find(const StringView& s, size_type pos) const
+{
+    if (pos > _size or s._size > _size - pos)
+        return npos;
+    if (s.empty())
+        return pos;
 
-    if ((pos = result.rfind('/')) != std::string::npos)
-	result = result.substr(pos + 1);
+    const char * const last = _data + _size - s._size;
+    for (const char *p = _data + pos ; p <= last ; ++p)
+    {
+        p = static_cast<const char *>(std::memchr(p, s._data[0],
+                (last - p) + 1));
+        if (not p)
+            break;
+        if (std::memcmp(p, s._data, s._size) == 0)
+            return p - _data;
+    }
 
-    return ( result.empty() ? std::string("/") : result );
+    return npos;
 }
 /*****************************************************************************/
-std::string
-dirname(const std::string& path)
+StringView::size_type
+StringView::rfind(char c, size_type pos) const
 {
-    std::string result(path);
-    std::string::size_type pos;
+    if (_size == 0)
+        return npos;
+
+    for (size_type i = std::min(pos, _size - 1) + 1 ; i > 0 ; --i)
+        if (_data[i-1] == c)
+            return i - 1;
+
+    return npos;
+}
+/*****************************************************************************/
+StringView::size_type
+StringView::rfind(const StringView& s, size_type pos) const
+{
+    if (s._size > _size)
+        return npos;
+
+    for (size_type i = std::min(pos, _size - s._size) + 1 ; i > 0 ; --i)
+        if (std::memcmp(_data + i - 1, s._data, s._size) == 0)
+            return i - 1;
+
+    return npos;
+}
+/*****************************************************************************/
+StringView::size_type
+StringView::find_first_of(const StringView& s, size_type pos) const
+{
+    for (; pos < _size ; ++pos)
+        if (std::memchr(s._data, _data[pos], s._size))
+            return pos;
+
+    return npos;
+}
+/*****************************************************************************/
+StringView::size_type
+StringView::find_first_not_of(const StringView& s, size_type pos) const
+{
+    for (; pos < _size ; ++pos)
+        if (not std::memchr(s._data, _data[pos], s._size))
+            return pos;
+
+    return npos;
+}
+/*****************************************************************************/
+StringView::size_type
+StringView::find_last_not_of(const StringView& s, size_type pos) const
+{
+    if (_size == 0)
+        return npos;
+
+    for (size_type i = std::min(pos, _size - 1) + 1 ; i > 0 ; --i)
+        if (not std::memchr(s._data, _data[i-1], s._size))
+            return i - 1;
+
+    return npos;
+}
+/*****************************************************************************/
+/* chop all trailing /'s, leaving at least one character */
+static StringView
+chop_trailing_slashes(StringView path)
+{
+    while (path.size() > 1 and path[path.size() - 1] == '/')
+        path.remove_suffix(1);
+    return path;
+}
+/*****************************************************************************/
+StringView
+basename_view(const StringView& path)
+{
+    StringView result(chop_trailing_slashes(path));
+    StringView::size_type pos;
 
-    /* chop all trailing /'s */
-    while (result[result.length() - 1] == '/' and result.length() > 1)
-	result.erase(result.length() - 1);
+    if ((pos = result.rfind('/')) != StringView::npos)
+        result.remove_prefix(pos + 1);
 
-    if ((pos = result.rfind('/')) != std::string::npos)
-        result.erase(pos);
+    return ( result.empty() ? StringView("/", 1) : result );
+}
+/*****************************************************************************/
+StringView
+dirname_view(const StringView& path)
+{
+    StringView result(chop_trailing_slashes(path));
+    StringView::size_type pos;
+
+    if ((pos = result.rfind('/')) != StringView::npos)
+        result = result.substr(0, pos);
     else
-        result.assign(".");
+        result = StringView(".", 1);
 
-    return ( result.empty() ? std::string("/") : result );
+    return ( result.empty() ? StringView("/", 1) : result );
 }
 /*****************************************************************************/
-const char *
-chop_fileext(const std::string& path, unsigned short depth)
+StringView
+chop_fileext_view(const StringView& path, unsigned short depth)
 {
-    std::string result(path);
+    StringView result(path);
 
     for (; depth > 0 ; --depth)
     {
-        std::string::size_type pos = result.rfind('.');
-        if (pos != std::string::npos)
+        StringView::size_type pos = result.rfind('.');
+        if (pos != StringView::npos)
             result = result.substr(0, pos);
     }
 
-    return result.c_str();
+    return result;
+}
+/*****************************************************************************/
+StringView
+trim_view(const StringView& s)
+{
+    StringView result(s);
+
+    while (not result.empty() and
+           std::isspace(static_cast<unsigned char>(result[0])))
+        result.remove_prefix(1);
+    while (not result.empty() and
+           std::isspace(static_cast<unsigned char>(result[result.size()-1])))
+        result.remove_suffix(1);
+
+    return result;
+}
+/*****************************************************************************/
+std::string
+basename(const std::string& path)
+{
+    return basename_view(path).str();
+}
+/*****************************************************************************/
+std::string
+dirname(const std::string& path)
+{
+    return dirname_view(path).str();
+}
+/*****************************************************************************/
+std::string
+chop_fileext(const std::string& path, unsigned short depth)
+{
+    return chop_fileext_view(path, depth).str();
 }
 /*****************************************************************************/
 struct BothSpaces
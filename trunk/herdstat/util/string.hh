@@ -40,12 +40,294 @@
 #include <cerrno>
 #include <cctype>
 #include <cstring>
+#include <cstddef>
+#include <iterator>
 
 #include <herdstat/exceptions.hh>
 
 namespace herdstat {
 namespace util {
 
+    /**
+     * @class StringView string.hh herdstat/util/string.hh
+     * @brief A read-only, non-owning reference to a range of characters.
+     *
+     * Slicing and searching a StringView never allocates, which makes it
+     * suitable for tokenizing in hot paths.  The referenced characters must
+     * outlive the view (so never construct one from a temporary
+     * std::string), and views are not NUL-terminated; use str() to get a
+     * std::string.
+     *
+     * Positions passed to substr() and the find functions are clamped to
+     * size() rather than throwing.
+     */
+
+    class StringView
+    {
+        public:
+            typedef std::size_t size_type;
+            typedef const char *const_iterator;
+
+            /// Not-found return value of the find functions.
+            static const size_type npos;
+
+            //@{
+            /// Constructor.
+            StringView() : _data(""), _size(0) { }
+            StringView(const char *s) : _data(s), _size(std::strlen(s)) { }
+            StringView(const char *s, size_type n) : _data(s), _size(n) { }
+            StringView(const std::string& s)
+                : _data(s.data()), _size(s.size()) { }
+            //@}
+
+            const char *data() const { return _data; }
+            size_type size() const { return _size; }
+            size_type length() const { return _size; }
+            bool empty() const { return (_size == 0); }
+            const_iterator begin() const { return _data; }
+            const_iterator end() const { return _data + _size; }
+            char operator[](size_type n) const { return _data[n]; }
+
+            /// Copy the characters to a std::string.
+            std::string str() const { return std::string(_data, _size); }
+
+            /// Get a view of (at most) n characters starting at pos.
+            StringView substr(size_type pos, size_type n = npos) const
+            {
+                if (pos > _size) pos = _size;
+                if (n > _size - pos) n = _size - pos;
+                return StringView(_data + pos, n);
+            }
+
+            /// Drop the first n characters.
+            void remove_prefix(size_type n)
+            { if (n > _size) n = _size; _data += n; _size -= n; }
+
+            /// Drop the last n characters.
+            void remove_suffix(size_type n)
+            { _size -= (n > _size ? _size : n); }
+
+            /// Does the view begin with the given string?
+            bool starts_with(const StringView& s) const
+            {
+                return (s._size <= _size and
+                        std::memcmp(_data, s._data, s._size) == 0);
+            }
+
+            /// Does the view end with the given string?
+            bool ends_with(const StringView& s) const
+            {
+                return (s._size <= _size and
+                        std::memcmp(_data + _size - s._size, s._data,
+                                    s._size) == 0);
+            }
+
+            //@{
+            /// Search functions; same semantics as std::string's.
+            size_type find(char c, size_type pos = 0) const;
+            size_type find(const StringView& s, size_type pos = 0) const;
+            size_type rfind(char c, size_type pos = npos) const;
+            size_type rfind(const StringView& s, size_type pos = npos) const;
+            size_type find_first_of(const StringView& s,
+                                    size_type pos = 0) const;
+            size_type find_first_not_of(const StringView& s,
+                                        size_type pos = 0) const;
+            size_type find_last_not_of(const StringView& s,
+                                       size_type pos = npos) const;
+            //@}
+
+            /// Lexicographically compare (like std::string::compare).
+            int compare(const StringView& that) const
+            {
+                const int ret = std::memcmp(_data, that._data,
+                    (_size < that._size ? _size : that._size));
+                if (ret != 0)
+                    return ret;
+                return (_size < that._size ? -1 : (_size > that._size ? 1 : 0));
+            }
+
+        private:
+            const char *_data;
+            size_type _size;
+    };
+
+    inline bool
+    operator== (const StringView& a, const StringView& b)
+    {
+        return (a.size() == b.size() and
+                std::memcmp(a.data(), b.data(), a.size()) == 0);
+    }
+
+    inline bool
+    operator!= (const StringView& a, const StringView& b)
+    {
+        return not (a == b);
+    }
+
+    inline bool
+    operator< (const StringView& a, const StringView& b)
+    {
+        return (a.compare(b) < 0);
+    }
+
+    inline std::ostream&
+    operator<< (std::ostream& stream, const StringView& s)
+    {
+        return stream.write(s.data(), s.size());
+    }
+
+    /**
+     * @struct StringLess string.hh herdstat/util/string.hh
+     * @brief Transparent less-than for containers of strings.
+     *
+     * Compares anything convertible to StringView, so a FlatSetBase or
+     * FlatMapBase using it can be searched with a StringView or C string
+     * without constructing a std::string.
+     */
+
+    struct StringLess
+    {
+        typedef void is_transparent;
+
+        bool operator()(const StringView& a, const StringView& b) const
+        { return (a < b); }
+    };
+
+    /**
+     * @class SplitView string.hh herdstat/util/string.hh
+     * @brief Lazily splits a string, yielding each part as a StringView.
+     *
+     * The parts are exactly those util::split() would produce, but they're
+     * found as the iterator advances and nothing is copied.  Both the
+     * string and the delimiter must outlive the SplitView and its
+     * iterators.
+     *
+     * @section example Example
+     *
+@code
+const std::string keywords("x86 ~amd64 -sparc");
+const herdstat::util::SplitView parts(keywords);
+herdstat::util::SplitView::const_iterator i;
+for (i = parts.begin() ; i != parts.end() ; ++i)
+    std::cout << *i << std::endl;
+@endcode
+     */
+
+    class SplitView
+    {
+        public:
+            /**
+             * @class const_iterator string.hh herdstat/util/string.hh
+             * @brief Forward iterator over the parts of a SplitView.
+             */
+
+            class const_iterator
+            {
+                public:
+                    typedef std::forward_iterator_tag iterator_category;
+                    typedef StringView value_type;
+                    typedef std::ptrdiff_t difference_type;
+                    typedef const StringView *pointer;
+                    typedef const StringView& reference;
+
+                    /// Construct an end iterator.
+                    const_iterator()
+                        : _split(NULL), _part(), _next(StringView::npos) { }
+
+                    reference operator*() const { return _part; }
+                    pointer operator->() const { return &_part; }
+
+                    const_iterator& operator++()
+                    { this->advance(); return *this; }
+                    const_iterator operator++(int)
+                    { const_iterator tmp(*this); this->advance(); return tmp; }
+
+                    bool operator== (const const_iterator& that) const
+                    {
+                        /* all end iterators are equal */
+                        return (_split == that._split and
+                                (not _split or
+                                 (_part.data() == that._part.data() and
+                                  _next == that._next)));
+                    }
+                    bool operator!= (const const_iterator& that) const
+                    { return not (*this == that); }
+
+                private:
+                    friend class SplitView;
+
+                    explicit const_iterator(const SplitView *split)
+                        : _split(split), _part(), _next(0)
+                    {
+                        if (split->_str.empty())
+                            _split = NULL;
+                        else
+                            this->advance();
+                    }
+
+                    void advance();
+
+                    const SplitView *_split;
+                    StringView _part;
+                    StringView::size_type _next;
+            };
+
+            /** Constructor.
+             * @param str String to split.
+             * @param delim Delimiter (defaults to " ").
+             * @param append_empty Yield empty parts between consecutive
+             * delimiters?
+             */
+            SplitView(const StringView& str,
+                      const StringView& delim = StringView(" ", 1),
+                      bool append_empty = false)
+                : _str(str), _delim(delim), _append_empty(append_empty) { }
+
+            const_iterator begin() const { return const_iterator(this); }
+            const_iterator end() const { return const_iterator(); }
+
+        private:
+            friend class const_iterator;
+
+            const StringView _str;
+            const StringView _delim;
+            const bool _append_empty;
+    };
+
+    inline void
+    SplitView::const_iterator::advance()
+    {
+        while (_split)
+        {
+            const StringView& str(_split->_str);
+
+            if (_next == StringView::npos)
+            {
+                /* no more parts */
+                _split = NULL;
+                _part = StringView();
+                return;
+            }
+
+            const StringView::size_type pos = (_split->_delim.empty() ?
+                StringView::npos : str.find(_split->_delim, _next));
+
+            if (pos == StringView::npos)
+            {
+                /* the last part is always returned, even if empty */
+                _part = str.substr(_next);
+                _next = StringView::npos;
+                return;
+            }
+
+            _part = str.substr(_next, pos - _next);
+            _next = pos + _split->_delim.size();
+
+            if (not _part.empty() or _split->_append_empty)
+                return;
+        }
+    }
+
     /**
      * Return the basename of the given path.
      * @param path path string.
@@ -69,9 +351,52 @@ namespace util {
      * @returns Resulting string.
      */
 
-    const char *chop_fileext(const std::string& path,
+    std::string chop_fileext(const std::string& path,
                              unsigned short depth = 1);
 
+    //@{
+    /**
+     * Non-allocating counterparts of basename(), dirname() and
+     * chop_fileext().  The result refers to the characters of @a path (or
+     * to a string literal).
+     */
+    StringView basename_view(const StringView& path);
+    StringView dirname_view(const StringView& path);
+    StringView chop_fileext_view(const StringView& path,
+                                 unsigned short depth = 1);
+    //@}
+
+    /**
+     * Strip leading and trailing whitespace (without collapsing inner
+     * whitespace like tidy_whitespace() does).
+     * @param s String view.
+     * @returns View of @a s without surrounding whitespace.
+     */
+
+    StringView trim_view(const StringView& s);
+
+    /**
+     * Compare two strings, ignoring case.  Equivalent to comparing the
+     * results of lowercase(), without the copies.
+     * @param a String view.
+     * @param b String view.
+     * @returns A boolean value.
+     */
+
+    inline bool
+    iequals(const StringView& a, const StringView& b)
+    {
+        if (a.size() != b.size())
+            return false;
+
+        for (StringView::size_type i = 0 ; i < a.size() ; ++i)
+            if (std::tolower(static_cast<unsigned char>(a[i])) !=
+                std::tolower(static_cast<unsigned char>(b[i])))
+                return false;
+
+        return true;
+    }
+
     /**
      * Tidy whitespace of the given string.
      * @param s String object
@@ -162,9 +487,9 @@ std::string foo(util::join(foov.begin(), foov.end()));
     inline std::string
     lowercase(const std::string& s)
     {
-        std::string result;
-        std::transform(s.begin(), s.end(),
-            std::back_inserter(result), ::tolower);
+        std::string result(s);
+        std::transform(result.begin(), result.end(), result.begin(),
+            ::tolower);
         return result;
     }
 
@@ -0,0 +1,80 @@
+/*
+ * libherdstat -- herdstat/util/thread.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cerrno>
+#include <herdstat/exceptions.hh>
+#include <herdstat/util/thread.hh>
+
+namespace herdstat {
+namespace util {
+/****************************************************************************/
+Mutex::Mutex()
+{
+    if ((errno = pthread_mutex_init(&_mutex, NULL)) != 0)
+        throw ErrnoException("pthread_mutex_init");
+}
+/****************************************************************************/
+Mutex::~Mutex()
+{
+    pthread_mutex_destroy(&_mutex);
+}
+/****************************************************************************/
+void
+Mutex::lock()
+{
+    if ((errno = pthread_mutex_lock(&_mutex)) != 0)
+        throw ErrnoException("pthread_mutex_lock");
+}
+/****************************************************************************/
+void
+Mutex::unlock()
+{
+    pthread_mutex_unlock(&_mutex);
+}
+/****************************************************************************/
+Lock::Lock(Mutex& m)
+    : _mutex(&m.native())
+{
+    if ((errno = pthread_mutex_lock(_mutex)) != 0)
+        throw ErrnoException("pthread_mutex_lock");
+}
+/****************************************************************************/
+Lock::Lock(pthread_mutex_t& m)
+    : _mutex(&m)
+{
+    if ((errno = pthread_mutex_lock(_mutex)) != 0)
+        throw ErrnoException("pthread_mutex_lock");
+}
+/****************************************************************************/
+Lock::~Lock()
+{
+    pthread_mutex_unlock(_mutex);
+}
+/****************************************************************************/
+} // namespace util
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
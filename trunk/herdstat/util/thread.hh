@@ -0,0 +1,148 @@
+/*
+ * libherdstat -- herdstat/util/thread.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_UTIL_THREAD_HH
+#define _HAVE_UTIL_THREAD_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/util/thread.hh
+ * @brief Defines the Mutex and Lock classes and a few atomic helpers.
+ */
+
+#include <pthread.h>
+#include <herdstat/noncopyable.hh>
+
+namespace herdstat {
+namespace util {
+
+    /**
+     * @class Mutex thread.hh herdstat/util/thread.hh
+     * @brief Thin wrapper around a (non-recursive) pthread mutex.
+     *
+     * Mutexes that must be usable before static constructors have run
+     * (ie. those guarding one-time initialisation of globals) should be
+     * plain pthread_mutex_t's initialised with PTHREAD_MUTEX_INITIALIZER
+     * instead; util::Lock accepts either.
+     */
+
+    class Mutex : private Noncopyable
+    {
+        public:
+            /// Default constructor.
+            Mutex();
+            /// Destructor.
+            virtual ~Mutex();
+
+            /** Lock mutex.
+             * @exception ErrnoException
+             */
+            void lock();
+
+            /// Unlock mutex.
+            void unlock();
+
+            /// Get underlying pthread mutex.
+            inline pthread_mutex_t& native() { return _mutex; }
+
+        private:
+            pthread_mutex_t _mutex;
+    };
+
+    /**
+     * @class Lock thread.hh herdstat/util/thread.hh
+     * @brief Scoped lock.  Locks the given mutex on construction and
+     * unlocks it on destruction.
+     *
+     * @section example Example
+     *
+@code
+void
+Foo::bar()
+{
+    herdstat::util::Lock lock(_mutex);
+    ...
+}
+@endcode
+     */
+
+    class Lock : private Noncopyable
+    {
+        public:
+            //@{
+            /** Constructor.
+             * @param m Mutex to lock.
+             * @exception ErrnoException
+             */
+            explicit Lock(Mutex& m);
+            explicit Lock(pthread_mutex_t& m);
+            //@}
+
+            /// Destructor.  Unlocks the mutex.
+            virtual ~Lock();
+
+        private:
+            pthread_mutex_t * const _mutex;
+    };
+
+    /**
+     * Atomically read a pointer.  Acts as a full memory barrier, so
+     * anything written before the pointer was published with
+     * atomic_store() is visible to the caller.
+     * @param p Pointer to read.
+     * @returns Value of p.
+     */
+
+    template <typename T>
+    inline T *
+    atomic_load(T * const volatile& p)
+    {
+        return __sync_val_compare_and_swap(const_cast<T **>(&p),
+            static_cast<T *>(0), static_cast<T *>(0));
+    }
+
+    /**
+     * Atomically publish a pointer.  Everything written before the call
+     * is visible to any thread that subsequently sees the new value via
+     * atomic_load().
+     * @param p Pointer to store to.
+     * @param v Value to store.
+     */
+
+    template <typename T>
+    inline void
+    atomic_store(T * volatile& p, T *v)
+    {
+        T *old = atomic_load(p);
+        while (not __sync_bool_compare_and_swap(const_cast<T **>(&p), old, v))
+            old = atomic_load(p);
+    }
+
+} // namespace util
+} // namespace herdstat
+
+#endif /* _HAVE_UTIL_THREAD_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -31,7 +31,7 @@ namespace herdstat {
 namespace util {
 /****************************************************************************/
 Timer::Timer()
-    : _begin(), _end(), _elapsed(0), _running(false)
+    : _begin(0), _elapsed_ns(0), _elapsed(0), _running(false)
 {
 }
 /****************************************************************************/
@@ -44,7 +44,7 @@ Timer::start()
 {
     if (_running) return;
     _running = true;
-    gettimeofday(&_begin, NULL);
+    _begin = monotonic_ns();
 }
 /****************************************************************************/
 void
@@ -53,12 +53,8 @@ Timer::stop()
     if (not _running) return;
     _running = false;
 
-    gettimeofday(&_end, NULL);
-    size_type tmp(_elapsed);
-    _elapsed = _end.tv_sec - _begin.tv_sec;
-    _elapsed *= 1000;
-    _elapsed += (_end.tv_usec - _begin.tv_usec) / 1000;
-    _elapsed += tmp;
+    _elapsed_ns += monotonic_ns() - _begin;
+    _elapsed = static_cast<size_type>(_elapsed_ns / 1000000);
 }
 /****************************************************************************/
 } // namespace util
@@ -32,11 +32,29 @@
  * @brief Defines the Timer class.
  */
 
-#include <sys/time.h>
+#include <ctime>
+#include <stdint.h>
 
 namespace herdstat {
 namespace util {
 
+    /// Nanosecond counts.  Fixed width, since C++98 has no long long.
+    typedef uint64_t nsec_type;
+
+    /**
+     * Get the time from a clock that never jumps (unlike gettimeofday()).
+     * Only useful for measuring intervals.
+     * @returns Nanoseconds since some unspecified starting point.
+     */
+    inline nsec_type
+    monotonic_ns()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (static_cast<nsec_type>(ts.tv_sec) * 1000000000UL +
+                ts.tv_nsec);
+    }
+
     /**
      * @class Timer timer.hh herdstat/util/timer.hh
      * @brief Represents a timer.
@@ -83,11 +101,16 @@ std::cout << "Took " << timer.elapsed()
              */
             inline const size_type& elapsed() const;
 
+            /** Get elapsed time (in nanoseconds).
+             * @returns A nsec_type value.
+             */
+            inline nsec_type elapsed_ns() const;
+
             /// Reset elapsed value.
             inline void reset();
 
         private:
-	    timeval _begin, _end;
+	    nsec_type _begin, _elapsed_ns;
 	    size_type _elapsed;
             bool _running;
     };
@@ -104,10 +127,17 @@ std::cout << "Took " << timer.elapsed()
         return _elapsed;
     }
 
+    inline nsec_type
+    Timer::elapsed_ns() const
+    {
+        return _elapsed_ns;
+    }
+
     inline void
     Timer::reset()
     {
         _elapsed = 0;
+        _elapsed_ns = 0;
     }
 
 } // namespace util
@@ -34,12 +34,12 @@ namespace herdstat {
 namespace util {
 /****************************************************************************/
 Vars::Vars()
-    : BaseFile(), util::MapBase<std::string, std::string>(), _depth(0)
+    : BaseFile(), util::FlatMapBase<std::string, std::string>(), _depth(0)
 {
 }
 /****************************************************************************/
 Vars::Vars(const std::string& path)
-    : BaseFile(path), util::MapBase<std::string, std::string>(), _depth(0)
+    : BaseFile(path), util::FlatMapBase<std::string, std::string>(), _depth(0)
 {
     this->read();
 }
@@ -55,6 +55,13 @@ Vars::dump(std::ostream& stream) const
         stream << i->first << "=" << i->second << std::endl;
 }
 /****************************************************************************/
+MemoryUsage
+Vars::memory_usage() const
+{
+    return (FlatMapBase<std::string, std::string>::memory_usage() +
+            BaseFile::memory_usage());
+}
+/****************************************************************************/
 void
 Vars::set_defaults()
 {
@@ -127,8 +134,7 @@ Vars::perform_action_on(const std::string& str)
         else if ((pos = val.rfind('#')) != std::string::npos)
             val.erase(pos);
  
-        this->erase(key);
-        this->insert(std::make_pair(key, val));
+        (*this)[key] = val;
     }
 
     this->do_perform_action_on(line);
@@ -143,7 +149,7 @@ void
 Vars::do_read()
 {
     std::string line;
-    while (std::getline(this->stream(), line))
+    while (std::getline(this->input(), line))
         this->perform_action_on(line);
 
     this->set_defaults();
@@ -54,7 +54,7 @@ namespace util {
      */
 
     class Vars : public BaseFile,
-                 public MapBase<std::string, std::string>
+                 public FlatMapBase<std::string, std::string>
     {
         public:
             /// Default constructor.
@@ -74,6 +74,9 @@ namespace util {
              */
             virtual void dump(std::ostream &s) const;
 
+            /// Get heap bytes held by our file and variables.
+            MemoryUsage memory_usage() const;
+
         protected:
             /// Strip leading/trailing whitespace
             void strip_ws(std::string& str);
@@ -67,6 +67,14 @@ namespace xml {
             /// Get pointer to underlying handler.
             H *handler() const { return this->_handler.get(); }
 
+            /** Parse only the records selected by @a sel (if the handler
+             * supports selective parsing).  The result is marked partial().
+             * @param sel Selector.
+             * @param path Path to XML file (defaults to empty).
+             * @exception FileException, ParserException
+             */
+            void parse_selected(Selector& sel, const std::string& path = "");
+
         protected:
             /** Parse file.
              * @param path Path to XML file (defaults to empty).
@@ -85,7 +93,7 @@ namespace xml {
     Document<H>::Document(const std::string &path)
         : Parsable(path), _handler(new H())
     {
-        BacktraceContext c("herdstat::xml::Document::Document("+path+")");
+        BacktraceContext c("herdstat::xml::Document::Document(%s)", path);
 
         if (not util::is_file(path))
             throw FileException(path);
@@ -98,12 +106,35 @@ namespace xml {
     {
     }
 
+    template <typename H>
+    void
+    Document<H>::parse_selected(Selector& sel, const std::string& path)
+    {
+        if (this->parsed())
+            return;
+
+        this->_handler->set_selector(&sel);
+        this->set_partial(true);
+
+        try
+        {
+            this->parse(path);
+        }
+        catch (...)
+        {
+            this->_handler->set_selector(NULL);
+            throw;
+        }
+
+        this->_handler->set_selector(NULL);
+    }
+
     template <typename H>
     void
     Document<H>::do_parse(const std::string &path)
     {
         const std::string file(path.empty() ? this->path() : path);
-        BacktraceContext c("herdstat::xml::Document::parse("+file+")");
+        BacktraceContext c("herdstat::xml::Document::parse(%s)", file);
         SAXParser p(this->_handler.get());
         this->timer().start();
         p.parse(file);
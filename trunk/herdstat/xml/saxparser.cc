@@ -25,11 +25,22 @@
 #endif
 
 #include <herdstat/util/string.hh>
+#include <herdstat/util/profile.hh>
+#include <herdstat/probes.hh>
+#include <herdstat/io/compress.hh>
 #include <herdstat/xml/saxparser.hh>
 
+/* size of chunks fed to the parser when reading compressed input */
+#define CHUNK_SIZE 65536
+
 namespace herdstat {
 namespace xml {
 /****************************************************************************/
+SAXHandler::SAXHandler()
+    : ::xml::event_parser(), _selector(NULL), _stopped(false), _skip_to()
+{
+}
+/****************************************************************************/
 SAXHandler::~SAXHandler()
 {
 }
@@ -37,12 +48,36 @@ SAXHandler::~SAXHandler()
 bool
 SAXHandler::text(const std::string& str)
 {
-    if (not util::is_all_whitespace(str))
+    if (not util::is_all_whitespace(str) and not this->skipping())
         return do_text(str);
 
     return true;
 }
 /****************************************************************************/
+bool
+SAXHandler::parse_path(const std::string& path)
+{
+    BacktraceContext c("xml::SAXHandler::parse_path(%s)", path);
+    util::ProfileZone zone("xml::SAXHandler::parse_path()");
+
+    _stopped = false;
+    _skip_to.clear();
+
+    io::Decompressor in(path);
+    if (in.type() == io::COMPRESSION_NONE)
+        return (this->parse_file(path.c_str()) or _stopped);
+
+    char buf[CHUNK_SIZE];
+    std::size_t len;
+    while ((len = in.read(buf, sizeof(buf))) > 0)
+    {
+        if (not this->parse_chunk(buf, len))
+            return _stopped;
+    }
+
+    return this->parse_finish();
+}
+/****************************************************************************/
 SAXParser::SAXParser(SAXHandler *handler)
     : _handler(handler)
 {
@@ -55,10 +90,15 @@ SAXParser::~SAXParser() throw()
 void
 SAXParser::parse(const std::string &path)
 {
-    BacktraceContext c("xml::saxparser::parse("+path+")");
+    BacktraceContext c("xml::saxparser::parse(%s)", path);
+    LIBHERDSTAT_PROBE1(sax__parse__entry, path.c_str());
 
-    if (not this->_handler->parse_file(path.c_str()))
+    if (not this->_handler->parse_path(path))
         throw ParserException(path, this->_handler->get_error_message());
+
+    if (LIBHERDSTAT_PROBE_ENABLED(sax__parse__return))
+        LIBHERDSTAT_PROBE2(sax__parse__return, path.c_str(),
+            probes::file_size(path));
 }
 /****************************************************************************/
 } // namespace xml
@@ -35,6 +35,7 @@
 #include <xmlwrapp/event_parser.h>
 #include <herdstat/noncopyable.hh>
 #include <herdstat/xml/exceptions.hh>
+#include <herdstat/xml/selector.hh>
 
 namespace herdstat {
 namespace xml {
@@ -47,10 +48,49 @@ namespace xml {
     class SAXHandler : public ::xml::event_parser
     {
         public:
+            /// Default constructor.
+            SAXHandler();
+
             /// Destructor.
             virtual ~SAXHandler();
 
+            /** Parse file, transparently decompressing gzip, xz or zstd
+             * input (see io::Decompressor).  Uncompressed files are handed
+             * to parse_file() directly.
+             * @param path Path.
+             * @returns True on success (see get_error_message() otherwise).
+             * A parse ended early via stop() is considered a success.
+             * @exception FileException, io::CompressionException
+             */
+            bool parse_path(const std::string& path);
+
+            /** Set Selector used for selective parsing.  Handlers that
+             * support it only keep records whose key is selected.
+             * @param s Pointer to Selector (or NULL to select everything).
+             */
+            void set_selector(Selector *s) { _selector = s; }
+
+            /// Get Selector (NULL unless parsing selectively).
+            Selector *selector() const { return _selector; }
+
         protected:
+            /** Stop parsing.  Callbacks should return the result.
+             * @returns false
+             */
+            bool stop() { _stopped = true; return false; }
+
+            /** Ignore all events up to the end of the named element (the
+             * end_element() event for the element itself is not ignored).
+             * @param name Element name.
+             */
+            void skip_to_end_of(const std::string& name) { _skip_to = name; }
+
+            /** Are we currently ignoring events?  Callbacks should check this
+             * first and return true if so.
+             * @param end_name Name of element if called from end_element().
+             */
+            inline bool skipping(const std::string& end_name = "");
+
             /// Callback called upon entering an element.
             virtual bool start_element(const std::string &,
                                        const attrs_type &) = 0;
@@ -64,8 +104,28 @@ namespace xml {
 
             /// Callback called upon encountering the text of an element.
             virtual bool do_text(const std::string& str) = 0;
+
+        private:
+            Selector *_selector;
+            bool _stopped;
+            std::string _skip_to;
     };
 
+    inline bool
+    SAXHandler::skipping(const std::string& end_name)
+    {
+        if (_skip_to.empty())
+            return false;
+
+        if (end_name == _skip_to)
+        {
+            _skip_to.clear();
+            return false;
+        }
+
+        return true;
+    }
+
     /**
      * @class SAXParser saxparser.hh herdstat/xml/saxparser.hh
      * @brief SAX2 parser interface.
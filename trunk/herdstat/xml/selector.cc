@@ -0,0 +1,62 @@
+/*
+ * libherdstat -- herdstat/xml/selector.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <herdstat/xml/selector.hh>
+
+namespace herdstat {
+namespace xml {
+/****************************************************************************/
+Selector::Selector(const std::string& key)
+    : _keys(), _found(), _regex(), _use_regex(false)
+{
+    _keys.insert(key);
+}
+/****************************************************************************/
+Selector::Selector(const util::Regex& re)
+    : _keys(), _found(), _regex(re), _use_regex(true)
+{
+}
+/****************************************************************************/
+Selector::~Selector() throw()
+{
+}
+/****************************************************************************/
+bool
+Selector::operator()(const std::string& key)
+{
+    if (_use_regex ? (_regex == key) : (_keys.find(key) != _keys.end()))
+    {
+        _found.insert(key);
+        return true;
+    }
+
+    return false;
+}
+/****************************************************************************/
+} // namespace xml
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
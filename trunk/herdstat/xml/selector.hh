@@ -0,0 +1,115 @@
+/*
+ * libherdstat -- herdstat/xml/selector.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_XML_SELECTOR_HH
+#define _HAVE_XML_SELECTOR_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/xml/selector.hh
+ * @brief Defines the Selector class.
+ */
+
+#include <set>
+#include <string>
+#include <herdstat/util/regex.hh>
+
+namespace herdstat {
+namespace xml {
+
+    /**
+     * @class Selector selector.hh herdstat/xml/selector.hh
+     * @brief Describes which records a selective parse should keep.
+     *
+     * What a "key" is depends on the handler; for portage::HerdsXML it's the
+     * herd name, for portage::DevawayXML and portage::UserinfoXML it's the
+     * developer's user name.  A Selector constructed from a set of keys is
+     * complete() once all of them have been seen, allowing the parse to
+     * stop early.  A Selector constructed from a regular expression is never
+     * complete().
+     */
+
+    class Selector
+    {
+        public:
+            /** Constructor.
+             * @param key Key to select.
+             */
+            Selector(const std::string& key);
+
+            /** Constructor.
+             * @param begin Beginning of range of keys to select.
+             * @param end End of range of keys to select.
+             */
+            template <typename InputIterator>
+            Selector(InputIterator begin, InputIterator end);
+
+            /** Constructor.
+             * @param re Select all keys matching this regular expression.
+             */
+            Selector(const util::Regex& re);
+
+            /// Destructor.
+            ~Selector() throw();
+
+            /** Is the given key selected?  If so, it's recorded as found.
+             * @param key Key.
+             * @returns A boolean value.
+             */
+            bool operator()(const std::string& key);
+
+            /// Have all selected keys been found?
+            inline bool complete() const;
+
+            /// Get selected keys (empty if using a regular expression).
+            inline const std::set<std::string>& keys() const { return _keys; }
+            /// Get keys found so far.
+            inline const std::set<std::string>& found() const { return _found; }
+
+        private:
+            std::set<std::string> _keys;
+            std::set<std::string> _found;
+            util::Regex _regex;
+            bool _use_regex;
+    };
+
+    template <typename InputIterator>
+    Selector::Selector(InputIterator begin, InputIterator end)
+        : _keys(begin, end), _found(), _regex(), _use_regex(false)
+    {
+    }
+
+    inline bool
+    Selector::complete() const
+    {
+        return (not _use_regex and _found.size() == _keys.size());
+    }
+
+} // namespace xml
+} // namespace herdstat
+
+#endif /* _HAVE_XML_SELECTOR_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,176 @@
+/*
+ * libherdstat -- instrument/alloc.cc
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <new>
+#include <cstdlib>
+#include <instrument/alloc.hh>
+
+/* each block is preceded by its size; 16 bytes keeps the block aligned
+ * for anything malloc() would align it for */
+#define ALLOC_HEADER_SIZE 16
+
+namespace {
+    volatile unsigned long allocations = 0;
+    volatile unsigned long bytes = 0;
+    volatile unsigned long live = 0;
+    /* most bytes live since the program started */
+    volatile unsigned long max_live = 0;
+    /* most bytes live since the innermost AllocScope was entered */
+    volatile unsigned long peak = 0;
+
+    void
+    raise(volatile unsigned long& v, unsigned long n)
+    {
+        unsigned long old = v;
+        while (n > old and not __sync_bool_compare_and_swap(&v, old, n))
+            old = v;
+    }
+
+    void *
+    allocate(std::size_t size)
+    {
+        char *p = static_cast<char *>(std::malloc(size + ALLOC_HEADER_SIZE));
+        if (not p)
+            return NULL;
+        *reinterpret_cast<std::size_t *>(p) = size;
+
+        __sync_fetch_and_add(&allocations, 1);
+        __sync_fetch_and_add(&bytes, size);
+        const unsigned long n = __sync_add_and_fetch(&live, size);
+        raise(max_live, n);
+        raise(peak, n);
+
+        return p + ALLOC_HEADER_SIZE;
+    }
+
+    void
+    deallocate(void *p)
+    {
+        if (not p)
+            return;
+
+        char *block = static_cast<char *>(p) - ALLOC_HEADER_SIZE;
+        __sync_fetch_and_sub(&live, *reinterpret_cast<std::size_t *>(block));
+        std::free(block);
+    }
+}
+
+/****************************************************************************/
+void *
+operator new(std::size_t size) throw (std::bad_alloc)
+{
+    void *p = allocate(size);
+    if (not p)
+        throw std::bad_alloc();
+    return p;
+}
+/****************************************************************************/
+void *
+operator new[](std::size_t size) throw (std::bad_alloc)
+{
+    return operator new(size);
+}
+/****************************************************************************/
+void *
+operator new(std::size_t size, const std::nothrow_t&) throw()
+{
+    return allocate(size);
+}
+/****************************************************************************/
+void *
+operator new[](std::size_t size, const std::nothrow_t&) throw()
+{
+    return allocate(size);
+}
+/****************************************************************************/
+void
+operator delete(void *p) throw()
+{
+    deallocate(p);
+}
+/****************************************************************************/
+void
+operator delete[](void *p) throw()
+{
+    deallocate(p);
+}
+/****************************************************************************/
+void
+operator delete(void *p, const std::nothrow_t&) throw()
+{
+    deallocate(p);
+}
+/****************************************************************************/
+void
+operator delete[](void *p, const std::nothrow_t&) throw()
+{
+    deallocate(p);
+}
+/****************************************************************************/
+namespace instrument {
+/****************************************************************************/
+AllocStats
+alloc_totals()
+{
+    AllocStats stats;
+    stats.allocations = allocations;
+    stats.bytes = bytes;
+    stats.peak = max_live;
+    return stats;
+}
+/****************************************************************************/
+unsigned long
+live_bytes()
+{
+    return live;
+}
+/****************************************************************************/
+AllocScope::AllocScope()
+    : _start(alloc_totals()), _live(live), _outer_peak(peak)
+{
+    /* start measuring our own peak; the destructor folds it back into the
+     * enclosing scope's */
+    peak = _live;
+}
+/****************************************************************************/
+AllocScope::~AllocScope()
+{
+    raise(peak, _outer_peak);
+}
+/****************************************************************************/
+AllocStats
+AllocScope::stats() const
+{
+    AllocStats stats;
+    stats.allocations = allocations - _start.allocations;
+    stats.bytes = bytes - _start.bytes;
+    stats.peak = (peak > _live ? peak - _live : 0);
+    return stats;
+}
+/****************************************************************************/
+} // namespace instrument
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
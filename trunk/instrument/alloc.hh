@@ -0,0 +1,113 @@
+/*
+ * libherdstat -- instrument/alloc.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_INSTRUMENT_ALLOC_HH
+#define _HAVE_INSTRUMENT_ALLOC_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file instrument/alloc.hh
+ * @brief Defines the AllocStats and AllocScope classes.
+ *
+ * libinstrument replaces the global operator new/delete with versions
+ * that count every allocation the program makes, including those inside
+ * libherdstat and libstdc++.  It's linked into the tests and benchmarks
+ * only; never into libherdstat itself.
+ */
+
+#include <herdstat/noncopyable.hh>
+
+namespace instrument {
+
+    /**
+     * @class AllocStats alloc.hh instrument/alloc.hh
+     * @brief Allocation counts.
+     */
+
+    struct AllocStats
+    {
+        AllocStats() : allocations(0), bytes(0), peak(0) { }
+
+        /// Number of calls to operator new.
+        unsigned long allocations;
+        /// Number of bytes requested.
+        unsigned long bytes;
+        /// Most bytes live at any one time.
+        unsigned long peak;
+    };
+
+    /**
+     * Get allocation counts since the program started.
+     * @returns AllocStats object.
+     */
+    AllocStats alloc_totals();
+
+    /// Get number of bytes currently allocated.
+    unsigned long live_bytes();
+
+    /**
+     * @class AllocScope alloc.hh instrument/alloc.hh
+     * @brief Counts the allocations made during its lifetime.
+     *
+     * Scopes may be nested.  Allocations are counted for every thread, so
+     * a scope only measures what one thread does if no other thread is
+     * allocating at the time.
+     *
+     * @section example Example
+     *
+@code
+instrument::AllocScope scope;
+herdstat::portage::PackageList pkgs;
+std::cout << scope.stats().allocations << " allocations, "
+    << scope.stats().peak << " bytes at most" << std::endl;
+@endcode
+     */
+
+    class AllocScope : private herdstat::Noncopyable
+    {
+        public:
+            /// Constructor.  Starts counting.
+            AllocScope();
+
+            /// Destructor.
+            ~AllocScope();
+
+            /** Get allocation counts so far.  peak is the most bytes live
+             * at any one time, over and above what was live when the
+             * scope was entered.
+             */
+            AllocStats stats() const;
+
+        private:
+            const AllocStats _start;
+            const unsigned long _live;
+            unsigned long _outer_peak;
+    };
+
+} // namespace instrument
+
+#endif /* _HAVE_INSTRUMENT_ALLOC_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
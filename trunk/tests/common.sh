@@ -25,7 +25,7 @@ run_test() {
 
     ebegin "Testing ${name}"
 
-    if ! ${srcdir}/src/run_lhs_test ${caller} ${opts} &> ${actual} ; then
+    if ! ${TEST_WRAPPER} ${srcdir}/src/run_lhs_test ${caller} ${opts} &> ${actual} ; then
 	# if 5th arg is passed, this is an expected failure
 	[[ -z "${5}" ]] && rv=1 || rv=0
     fi
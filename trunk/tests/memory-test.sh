@@ -0,0 +1,5 @@
+#!/bin/bash
+source common.sh || exit 1
+run_test "memory usage accounting" \
+    "${TEST_DATA}/localstatedir/herds.xml ${TEST_DATA}/localstatedir/devaway.xml ${PORTDIR}/app-misc/foo" || exit 1
+indent
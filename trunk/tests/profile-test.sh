@@ -0,0 +1,5 @@
+#!/bin/bash
+source common.sh || exit 1
+run_test "profiling zones" \
+    "${TEST_DATA}/localstatedir/herds.xml ${TEST_DATA}/localstatedir/devaway.xml" || exit 1
+indent
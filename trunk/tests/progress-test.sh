@@ -0,0 +1,4 @@
+#!/bin/bash
+source common.sh || exit 1
+run_test "progress meters shared between threads" || exit 1
+indent
@@ -0,0 +1,4 @@
+#!/bin/bash
+source common.sh || exit 1
+run_test "QueryServer/QueryClient classes" \
+    "${TEST_DATA}/localstatedir/herds.xml ${TEST_DATA}/localstatedir/devaway.xml ${TEST_DATA}/localstatedir/userinfo.xml" || exit 1
@@ -0,0 +1,107 @@
+/*
+ * libherdstat -- tests/src/alloc-test.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_ALLOC_TEST_HH
+#define _HAVE_ALLOC_TEST_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <instrument/alloc.hh>
+#include "test_handler.hh"
+
+DECLARE_TEST_HANDLER(AllocTest)
+
+/* keeps the compiler from eliding new/delete pairs */
+static char * volatile alloc_test_sink = NULL;
+
+void
+AllocTest::operator()(const opts_type& null LIBHERDSTAT_UNUSED) const
+{
+    const unsigned long live = instrument::live_bytes();
+
+    {
+        const instrument::AllocScope scope;
+        alloc_test_sink = new char[100];
+        delete[] alloc_test_sink;
+        alloc_test_sink = new char[50];
+        delete[] alloc_test_sink;
+
+        const instrument::AllocStats stats(scope.stats());
+        std::cout << "allocations: " << stats.allocations << std::endl;
+        std::cout << "bytes:       " << stats.bytes << std::endl;
+        std::cout << "peak:        " << stats.peak << std::endl;
+    }
+
+    /* an inner scope's peak counts towards the outer one's */
+    {
+        const instrument::AllocScope outer;
+        alloc_test_sink = new char[10];
+        char *p = alloc_test_sink;
+
+        {
+            const instrument::AllocScope inner;
+            alloc_test_sink = new char[1000];
+            delete[] alloc_test_sink;
+            std::cout << "inner peak:  " << inner.stats().peak << std::endl;
+        }
+
+        delete[] p;
+        std::cout << "outer peak:  " << outer.stats().peak << std::endl;
+        std::cout << "outer allocations: " << outer.stats().allocations
+            << std::endl;
+    }
+
+    assert(instrument::live_bytes() == live);
+    assert(instrument::alloc_totals().peak >= 1010);
+
+    /* budgets */
+    {
+        AllocBudget budget("within budget", 2);
+        alloc_test_sink = new char[1];
+        delete[] alloc_test_sink;
+        alloc_test_sink = new char[1];
+        delete[] alloc_test_sink;
+        budget.check();
+    }
+
+    try
+    {
+        AllocBudget budget("over budget", 1);
+        for (int n = 0 ; n < 3 ; ++n)
+        {
+            alloc_test_sink = new char[1];
+            delete[] alloc_test_sink;
+        }
+        budget.check(2);
+        assert(false);
+    }
+    catch (const herdstat::Exception& e)
+    {
+        std::cout << e.what() << std::endl;
+    }
+}
+
+#endif /* _HAVE_ALLOC_TEST_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -29,7 +29,10 @@
 
 #include <vector>
 #include <unistd.h>
+#include <cstdio>
 #include <herdstat/io/binary_stream_iterator.hh>
+#include <herdstat/io/archive.hh>
+#include <herdstat/portage/serialize.hh>
 #include "test_handler.hh"
 
 DECLARE_TEST_HANDLER(BinaryIO)
@@ -127,7 +130,123 @@ BinaryIO::operator()(const opts_type& null LIBHERDSTAT_UNUSED) const
         assert(s == s2);
     }
 
+    {
+        std::cout << "Testing mapped BinaryIStream..." << std::endl;
+
+        herdstat::io::BinaryIStream stream("bar", true);
+        if (not stream)
+            throw herdstat::FileException("bar");
+        assert(stream.mapped() and stream.contiguous());
+
+        std::vector<herdstat::util::StringView> s3(
+            (herdstat::io::BinaryIStreamIterator<herdstat::util::StringView>(stream)),
+            herdstat::io::BinaryIStreamIterator<herdstat::util::StringView>());
+
+        std::cout << "s3 = '";
+        std::copy(s3.begin(), s3.end(),
+            std::ostream_iterator<herdstat::util::StringView>(std::cout, " "));
+        std::cout << "'." << std::endl;
+
+        assert(std::equal(s.begin(), s.end(), s3.begin()));
+    }
+
+    {
+        /* views need the data to stay put */
+        herdstat::io::BinaryIStream stream("bar");
+        herdstat::util::StringView view;
+        assert(not stream.contiguous());
+        stream >> view;
+        assert(not stream);
+    }
+
     unlink("bar");
+
+    herdstat::portage::Herd herd("foo", "foo@gentoo.org", "The foo herd");
+    herd.insert(herdstat::portage::Developer("bar", "bar@gentoo.org",
+                                             "Bar Baz"));
+    herd.insert(herdstat::portage::Developer("baz"));
+
+    {
+        std::cout << "Testing OArchive..." << std::endl;
+
+        herdstat::io::OArchive ar("baz", "binaryio test", 1);
+        if (not ar)
+            throw herdstat::FileException("baz");
+
+        ar << -1 << 300UL << 1.5 << herd;
+        std::cout << "wrote -1, 300, 1.5, herd '" << herd.name() << "' ("
+            << herd.size() << " devs)." << std::endl;
+    }
+
+    {
+        std::cout << "Testing IArchive..." << std::endl;
+
+        herdstat::io::IArchive ar("baz", "binaryio test", 1, true);
+        if (not ar)
+            throw herdstat::Exception(ar.error());
+        assert(ar.mapped());
+
+        int i = 0;
+        unsigned long ul = 0;
+        double d = 0;
+        herdstat::portage::Herd herd2;
+        ar >> i >> ul >> d >> herd2;
+
+        std::cout << "read " << i << ", " << ul << ", " << d << ", herd '"
+            << herd2.name() << "' (" << herd2.size() << " devs)." << std::endl;
+        assert(i == -1 and ul == 300 and d == 1.5);
+        assert(herd2.name() == herd.name() and herd2.desc() == herd.desc());
+        assert(std::equal(herd.begin(), herd.end(), herd2.begin()));
+        assert(herd2.find("bar")->name() == "Bar Baz");
+    }
+
+    {
+        /* rewriting an archive doesn't pull it out from under a reader */
+        herdstat::io::IArchive mapped("baz", "binaryio test", 1, true);
+        assert(mapped and mapped.mapped());
+        {
+            herdstat::io::OArchive ar("baz", "binaryio test", 1);
+            ar << -2 << 300UL << 1.5 << herd;
+        }
+
+        int i = 0;
+        mapped >> i;
+        assert(mapped and i == -1);
+
+        herdstat::io::IArchive ar("baz", "binaryio test", 1, true);
+        ar >> i;
+        assert(ar and i == -2);
+        std::cout << "rewritten while mapped: read " << i << "." << std::endl;
+    }
+
+    {
+        herdstat::io::IArchive ar("baz", "binaryio test", 2);
+        assert(not ar);
+        std::cout << "wrong version: " << ar.error() << std::endl;
+    }
+
+    {
+        herdstat::io::IArchive ar("baz", "something else", 1);
+        assert(not ar);
+        std::cout << "wrong tag: " << ar.error() << std::endl;
+    }
+
+    /* flip a bit in the last byte of the payload */
+    {
+        std::FILE *f = std::fopen("baz", "r+b");
+        assert(f);
+        std::fseek(f, -1, SEEK_END);
+        int c = std::fgetc(f);
+        std::fseek(f, -1, SEEK_END);
+        std::fputc(c ^ 1, f);
+        std::fclose(f);
+
+        herdstat::io::IArchive ar("baz", "binaryio test", 1);
+        assert(not ar);
+        std::cout << "corrupt: " << ar.error() << std::endl;
+    }
+
+    unlink("baz");
 }
 
 #endif /* _HAVE_SRC_BINARYIO_TEST_HH */
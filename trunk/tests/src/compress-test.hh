@@ -0,0 +1,127 @@
+/*
+ * libherdstat -- tests/src/compress-test.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_SRC_COMPRESS_TEST_HH
+#define _HAVE_SRC_COMPRESS_TEST_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <string>
+#include <unistd.h>
+#include <herdstat/io/compress.hh>
+#include <herdstat/io/exceptions.hh>
+#include <herdstat/util/file.hh>
+#include "test_handler.hh"
+
+DECLARE_TEST_HANDLER(Compress)
+
+void
+Compress::operator()(const opts_type& null LIBHERDSTAT_UNUSED) const
+{
+    const std::string data("foo\nbar\nbaz\n");
+
+    std::cout << "Testing Compressor..." << std::endl;
+    {
+        herdstat::io::Compressor out("foo.gz", herdstat::io::COMPRESSION_GZIP);
+        out.write(data);
+        out.close();
+    }
+
+    assert(herdstat::util::is_file("foo.gz"));
+    assert(herdstat::io::detect_compression("foo.gz") ==
+            herdstat::io::COMPRESSION_GZIP);
+    assert(herdstat::io::compression_from_suffix("foo.gz") ==
+            herdstat::io::COMPRESSION_GZIP);
+    std::cout << "wrote 'foo.gz'." << std::endl;
+
+    std::cout << "Testing Decompressor..." << std::endl;
+    {
+        herdstat::io::Decompressor in("foo.gz");
+        std::string s;
+        in.read_all(s);
+        assert(s == data);
+        std::cout << "read " << s.size() << " bytes." << std::endl;
+    }
+
+    std::cout << "Testing File on compressed input..." << std::endl;
+    {
+        herdstat::util::File f("foo.gz");
+        assert(f.compression() == herdstat::io::COMPRESSION_GZIP);
+        std::copy(f.begin(), f.end(),
+            std::ostream_iterator<std::string>(std::cout, " "));
+        std::cout << std::endl;
+    }
+
+    std::cout << "Testing compress_file on uncompressed input..." << std::endl;
+    {
+        herdstat::io::Compressor out("bar", herdstat::io::COMPRESSION_NONE);
+        out.write(data);
+        out.close();
+
+        assert(herdstat::io::detect_compression("bar") ==
+                herdstat::io::COMPRESSION_NONE);
+        herdstat::io::compress_file("bar", "bar.gz",
+            herdstat::io::COMPRESSION_GZIP);
+
+        herdstat::util::File f1("bar"), f2("bar.gz");
+        assert(f1 == f2);
+        std::cout << "'bar' == 'bar.gz'" << std::endl;
+    }
+
+    std::cout << "Testing truncated input..." << std::endl;
+    if (herdstat::io::compression_supported(herdstat::io::COMPRESSION_ZSTD))
+    {
+        std::string big;
+        for (int i = 0 ; i < 4096 ; ++i)
+            big += herdstat::util::sprintf("line %d\n", i);
+
+        herdstat::io::Compressor out("foo.zst", herdstat::io::COMPRESSION_ZSTD);
+        out.write(big);
+        out.close();
+
+        const off_t size = herdstat::util::Stat("foo.zst").size();
+        const int rv = truncate("foo.zst", size / 2);
+        assert(rv == 0);
+
+        try
+        {
+            std::string s;
+            herdstat::io::Decompressor("foo.zst").read_all(s);
+            assert(false);
+        }
+        catch (const herdstat::io::CompressionException&)
+        {
+        }
+
+        unlink("foo.zst");
+    }
+
+    unlink("foo.gz");
+    unlink("bar");
+    unlink("bar.gz");
+}
+
+#endif /* _HAVE_SRC_COMPRESS_TEST_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
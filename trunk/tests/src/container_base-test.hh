@@ -27,7 +27,10 @@
 # include "config.h"
 #endif
 
+#include <vector>
 #include <herdstat/util/container_base.hh>
+#include <herdstat/util/string.hh>
+#include <instrument/alloc.hh>
 #include "test_handler.hh"
 
 DECLARE_TEST_HANDLER(ContainerBaseTest)
@@ -42,6 +45,32 @@ class MySet : public herdstat::util::SetBase<std::string>
         }
 };
 
+class MyFlatSet : public herdstat::util::FlatSetBase<std::string>
+{
+    public:
+        void display()
+        {
+            for (iterator i = this->begin() ; i != this->end() ; ++i)
+                std::cout << *i << std::endl;
+        }
+};
+
+class MyStringSet
+    : public herdstat::util::FlatSetBase<std::string,
+                                         herdstat::util::StringLess>
+{
+};
+
+class MyFlatMap : public herdstat::util::FlatMapBase<std::string, int>
+{
+    public:
+        void display()
+        {
+            for (iterator i = this->begin() ; i != this->end() ; ++i)
+                std::cout << i->first << "=" << i->second << std::endl;
+        }
+};
+
 #define TRY_INSERT(x) \
     if (not m.insert(#x).second) \
         std::cout << "Failed to insert " << #x << std::endl;
@@ -57,6 +86,57 @@ ContainerBaseTest::operator()(const opts_type& null LIBHERDSTAT_UNUSED) const
     TRY_INSERT(foobarbaz);
 
     m.display();
+
+    /* the flat variants should behave the same */
+    MyFlatSet f;
+    std::vector<std::string> v;
+    v.push_back("foobarbaz");
+    v.push_back("baz");
+    v.push_back("foo");
+    v.push_back("bar");
+    v.push_back("baz");
+    f.insert(v.begin(), v.end());
+    if (not f.insert("foo").second)
+        std::cout << "Failed to insert foo" << std::endl;
+    f.insert(f.begin(), "aaa");
+    f.insert(f.begin(), "zzz");
+    assert(f.count("bar") == 1 and f.count("nope") == 0);
+    std::size_t erased = f.erase("aaa");
+    assert(erased == 1);
+    erased = f.erase("aaa");
+    assert(erased == 0);
+    f.erase(f.find("zzz"));
+    assert(f.size() == m.size());
+    assert(std::equal(f.begin(), f.end(), m.begin()));
+    f.display();
+
+    MyFlatMap fm;
+    std::vector<std::pair<std::string, int> > pairs;
+    pairs.push_back(std::make_pair("foo", 1));
+    pairs.push_back(std::make_pair("bar", 2));
+    pairs.push_back(std::make_pair("foo", 3));
+    fm["baz"] = 4;
+    fm.insert(pairs.begin(), pairs.end());
+    fm.insert(std::make_pair("bar", 5));
+    ++fm["foo"];
+    assert(fm.find("nope") == fm.end());
+    assert(fm.lower_bound("bat") == fm.find("baz"));
+    fm.display();
+
+    /* transparent comparison: lookups by StringView don't allocate */
+    MyStringSet ts;
+    ts.insert(v.begin(), v.end());
+    const std::string key("xfoobarbazx");
+    const herdstat::util::StringView view(key);
+    {
+        const instrument::AllocScope scope;
+        assert(ts.count(view.substr(1, 3)) == 1);
+        assert(ts.count(view.substr(1, 4)) == 0);
+        assert(*ts.find(view.substr(1, 9)) == "foobarbaz");
+        assert(ts.lower_bound(view.substr(4, 2)) == ts.find("bar"));
+        assert(ts.upper_bound("foo") == ts.find("foobarbaz"));
+        assert(scope.stats().allocations == 0);
+    }
 }
 
 #undef TRY_INSERT
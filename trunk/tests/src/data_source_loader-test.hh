@@ -0,0 +1,114 @@
+/*
+ * libherdstat -- tests/src/data_source_loader-test.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE__DATA_SOURCE_LOADER_TEST_HH
+#define _HAVE__DATA_SOURCE_LOADER_TEST_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <set>
+#include <herdstat/xml/init.hh>
+#include <herdstat/portage/herds_xml.hh>
+#include <herdstat/portage/devaway_xml.hh>
+#include <herdstat/portage/userinfo_xml.hh>
+#include <herdstat/portage/data_source_loader.hh>
+#include "test_handler.hh"
+
+DECLARE_TEST_HANDLER(DataSourceLoaderTest)
+
+void
+DataSourceLoaderTest::operator()(const opts_type& opts) const
+{
+    assert(opts.size() == 3);
+
+    herdstat::xml::GlobalInit();
+
+    herdstat::portage::HerdsXML herds;
+    herdstat::portage::DevawayXML devaway;
+    herdstat::portage::UserinfoXML userinfo;
+    herdstat::portage::PackageList pkgs(false);
+
+    herdstat::portage::DataSourceLoader loader;
+    std::set<const herdstat::Parsable *> added;
+    added.insert(&loader.add(herds, opts[0]));
+    added.insert(&loader.add(devaway, opts[1]));
+    added.insert(&loader.add(userinfo, opts[2]));
+    const herdstat::Parsable& pkgs_loaded(loader.add(pkgs));
+    added.insert(&pkgs_loaded);
+
+    assert(loader.size() == 4);
+    loader.start();
+
+    /* each object is handed back exactly once */
+    std::set<const herdstat::Parsable *> seen;
+    while (const herdstat::Parsable *p = loader.wait_next())
+    {
+        assert(added.count(p));
+        assert(p->parsed());
+        const bool first_time = seen.insert(p).second;
+        assert(first_time);
+    }
+
+    assert(seen == added);
+    loader.wait();
+    assert(loader.ready(herds) and loader.ready(pkgs_loaded));
+    assert(pkgs.filled());
+
+    std::cout << "Loaded " << seen.size() << " objects" << std::endl;
+    std::cout << "herds.xml:    " << herds.herds().size() << std::endl;
+    std::cout << "devaway.xml:  " << devaway.devs().size() << std::endl;
+    std::cout << "userinfo.xml: " << userinfo.devs().size() << std::endl;
+
+    /* same as loading them one after another? */
+    herdstat::portage::HerdsXML herds_seq(opts[0]);
+    herdstat::portage::DevawayXML devaway_seq(opts[1]);
+    herdstat::portage::UserinfoXML userinfo_seq(opts[2]);
+    herdstat::portage::PackageList pkgs_seq;
+
+    assert(herds.herds().size() == herds_seq.herds().size());
+    assert(devaway.devs().size() == devaway_seq.devs().size());
+    assert(userinfo.devs().size() == userinfo_seq.devs().size());
+    assert(pkgs.size() == pkgs_seq.size());
+    assert(std::equal(pkgs.begin(), pkgs.end(), pkgs_seq.begin()));
+
+    /* errors are reported by wait() */
+    herdstat::portage::HerdsXML missing;
+    herdstat::portage::DataSourceLoader failing;
+    failing.add(missing, opts[0]+".nonexistent");
+    failing.start();
+
+    try
+    {
+        failing.wait();
+        assert(false);
+    }
+    catch (const herdstat::Exception&)
+    {
+        std::cout << "Failed load reported" << std::endl;
+    }
+}
+
+#endif /* _HAVE__DATA_SOURCE_LOADER_TEST_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
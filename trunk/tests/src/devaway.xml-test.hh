@@ -67,6 +67,19 @@ DevawayXMLTest::operator()(const opts_type& opts) const
     assert(i != devs.end());
     DisplayAwayDev display;
     display(*i);
+    std::cout << std::endl;
+
+    /* selective parse */
+    herdstat::portage::DevawayXML partial;
+    herdstat::xml::Selector sel("lv");
+    partial.parse_selected(sel, path);
+    assert(partial.partial());
+    assert(sel.complete());
+
+    std::cout << "Selected developers(" << partial.devs().size() << ")"
+        << std::endl;
+    std::for_each(partial.devs().begin(), partial.devs().end(),
+        DisplayAwayDev());
 }
 
 #endif /* _HAVE__DEVAWAY.XML_TEST_HH */
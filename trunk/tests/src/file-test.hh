@@ -27,6 +27,11 @@
 # include "config.h"
 #endif
 
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <herdstat/io/compress.hh>
 #include <herdstat/util/algorithm.hh>
 #include <herdstat/util/functional.hh>
 #include <herdstat/util/file.hh>
@@ -96,6 +101,97 @@ struct ShowDirectory
     }
 };
 
+static void *
+file_test_write_fifo(void *path)
+{
+    /* blocks until the reader opens it */
+    const int fd = open(static_cast<const char *>(path), O_WRONLY);
+    if (fd != -1)
+    {
+        const ssize_t len LIBHERDSTAT_UNUSED = write(fd, "foo\nbar\n", 8);
+        close(fd);
+    }
+    return NULL;
+}
+
+static void
+file_test_read_only_file()
+{
+    const std::string data("foo\nbar\nbaz\n");
+
+    std::cout << std::endl << "Testing util::ReadOnlyFile:" << std::endl;
+    {
+        herdstat::io::Compressor out("file-test", herdstat::io::COMPRESSION_NONE);
+        out.write(data);
+        out.close();
+        herdstat::io::compress_file("file-test", "file-test.gz",
+            herdstat::io::COMPRESSION_GZIP);
+
+        const herdstat::util::ReadOnlyFile f1("file-test"), f2("file-test.gz");
+        assert(f1.compression() == herdstat::io::COMPRESSION_NONE);
+        assert(f2.compression() == herdstat::io::COMPRESSION_GZIP);
+        assert(f1 == f2);
+        assert(f1.contents() == data);
+
+        std::copy(f2.begin(), f2.end(),
+            std::ostream_iterator<herdstat::util::StringView>(std::cout, " "));
+        std::cout << std::endl;
+
+        /* same lines as File, even without a trailing newline */
+        herdstat::io::Compressor out2("file-test-nonl",
+            herdstat::io::COMPRESSION_NONE);
+        out2.write("foo\n\nbar");
+        out2.close();
+
+        const herdstat::util::File f3("file-test-nonl");
+        const herdstat::util::ReadOnlyFile f4("file-test-nonl");
+        assert(f4.size() == 3 and f3.size() == f4.size());
+        assert(std::equal(f3.begin(), f3.end(), f4.begin()));
+        assert(f4[2] == "bar" and (f4.end() - f4.begin()) == 3);
+        assert(f1 != f4);
+    }
+
+    unlink("file-test");
+    unlink("file-test.gz");
+    unlink("file-test-nonl");
+
+    /* File only maps regular, non-empty files; the rest are read */
+    std::cout << std::endl << "Testing util::File on unmappable files:"
+        << std::endl;
+    {
+        herdstat::io::Compressor out("file-test-empty",
+            herdstat::io::COMPRESSION_NONE);
+        out.close();
+        const herdstat::util::File empty("file-test-empty");
+        assert(empty.empty());
+        unlink("file-test-empty");
+        std::cout << " empty file ok" << std::endl;
+
+        char fifo[] = "file-test-fifo";
+        const int rv = mkfifo(fifo, 0600);
+        assert(rv == 0);
+
+        pthread_t writer;
+        if (pthread_create(&writer, NULL, file_test_write_fifo, fifo) != 0)
+            throw herdstat::Exception("pthread_create() failed");
+        {
+            const herdstat::util::File f(fifo);
+            assert(f.size() == 2 and f[0] == "foo" and f[1] == "bar");
+        }
+        pthread_join(writer, NULL);
+        unlink(fifo);
+        std::cout << " fifo ok" << std::endl;
+
+        /* regular, but reports a size of 0 */
+        if (herdstat::util::is_file("/proc/self/status"))
+        {
+            const herdstat::util::File f("/proc/self/status");
+            assert(not f.empty());
+        }
+        std::cout << " /proc ok" << std::endl;
+    }
+}
+
 void
 FileTest::operator()(const opts_type& opts) const 
 {
@@ -117,6 +213,8 @@ FileTest::operator()(const opts_type& opts) const
     const herdstat::util::Directory copy(dir);
     assert(copy.size() == dir.size());
     show(copy, portdir);
+
+    file_test_read_only_file();
 }
 
 #endif /* _HAVE_SRC_FILE_TEST_HH */
@@ -37,6 +37,13 @@
 
 DECLARE_TEST_HANDLER(GlobTest)
 
+struct GlobTestCounter
+{
+    GlobTestCounter() : n(0) { }
+    void operator()(const std::string& path LIBHERDSTAT_UNUSED) { ++n; }
+    std::size_t n;
+};
+
 void
 GlobTest::operator()(const opts_type& null LIBHERDSTAT_UNUSED) const
 {
@@ -64,6 +71,30 @@ GlobTest::operator()(const opts_type& null LIBHERDSTAT_UNUSED) const
     std::cout << std::endl
         << "The pattern '*foo-1.10*' appears " << n
         << " times in the output above." << std::endl;
+
+    /* test ** */
+    const std::size_t ebuilds = results.size();
+    std::cout << std::endl;
+    glob.clear_results();
+    glob("portdir/" "**" "/metadata.xml");
+    glob("portdir/" "**" "/*.diff");
+    glob("portdir/*/");
+    std::copy(glob.results().begin(), glob.results().end(),
+        std::ostream_iterator<std::string>(std::cout, "\n"));
+
+    /* test callbacks, with and without threads */
+    for (herdstat::util::Glob::size_type t = 1 ; t <= 4 ; t += 3)
+    {
+        herdstat::util::Glob walker;
+        walker.set_threads(t);
+        GlobTestCounter count = walker.for_each("portdir/" "**" "/*.ebuild",
+            GlobTestCounter());
+        if (count.n != ebuilds)
+            throw herdstat::Exception("for_each() found %d ebuilds, not %d",
+                static_cast<int>(count.n), static_cast<int>(ebuilds));
+    }
+
+    std::cout << std::endl << "for_each() found all ebuilds" << std::endl;
 }
 
 #endif /* _HAVE__GLOB_TEST_HH */
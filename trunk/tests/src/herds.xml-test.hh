@@ -27,6 +27,7 @@
 # include "config.h"
 #endif
 
+#include <vector>
 #include <herdstat/xml/init.hh>
 #include <herdstat/portage/herds_xml.hh>
 
@@ -51,9 +52,11 @@ HerdsXMLTest::operator()(const opts_type& opts) const
     herdstat::xml::GlobalInit();
 
     herdstat::portage::HerdsXML herds_xml;
+    AllocBudget budget("HerdsXML::parse()", 160);
     herds_xml.parse(opts.front());
     const herdstat::portage::Herds& herds(herds_xml.herds());
     assert(not herds.empty());
+    budget.check(herds.size());
 
     std::cout << "Size: " << herds.size() << std::endl;
 
@@ -62,6 +65,27 @@ HerdsXMLTest::operator()(const opts_type& opts) const
 
     std::cout << i->name() << "(" << i->size() << ")" << std::endl;
     std::for_each(i->begin(), i->end(), DisplayDev());
+
+    /* selective parse */
+    std::vector<std::string> wanted;
+    wanted.push_back("afterstep");
+    wanted.push_back("shell-tools");
+    herdstat::xml::Selector sel(wanted.begin(), wanted.end());
+
+    herdstat::portage::HerdsXML partial_xml;
+    partial_xml.parse_selected(sel, opts.front());
+    assert(partial_xml.partial());
+    assert(not herds_xml.partial());
+    assert(sel.complete());
+
+    const herdstat::portage::Herds& partial(partial_xml.herds());
+    std::cout << "Selective size: " << partial.size() << std::endl;
+    assert(partial.size() == wanted.size());
+
+    herdstat::portage::Herds::const_iterator p = partial.find("shell-tools");
+    assert(p != partial.end());
+    assert(p->size() == i->size());
+    assert(std::equal(p->begin(), p->end(), i->begin()));
 }
 
 #endif /* _HAVE__HERDS.XML_TEST_HH */
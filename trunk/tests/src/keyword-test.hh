@@ -27,6 +27,8 @@
 # include "config.h"
 #endif
 
+#include <fstream>
+#include <unistd.h>
 #include <herdstat/portage/keywords.hh>
 
 #include "test_handler.hh"
@@ -74,6 +76,42 @@ KeywordTest::operator()(const opts_type& opts) const
 
     display_keywords(keywords);
     std::cout << "All stable? " << keywords.all_stable() << std::endl;
+
+    std::cout << std::endl << "Testing backtrace:" << std::endl;
+    try
+    {
+        herdstat::portage::Keyword kw("!x86");
+        assert(false);
+    }
+    catch (const herdstat::BaseException& e)
+    {
+        std::cout << e.backtrace(":\n") << e.what() << std::endl;
+    }
+    assert(herdstat::BacktraceContext::backtrace().empty());
+
+    std::cout << std::endl << "Testing non-throwing construction:" << std::endl;
+    bool valid = false;
+    const herdstat::portage::Keyword good("~mips", valid);
+    std::cout << good.str() << ": " << valid << std::endl;
+    const herdstat::portage::Keyword bad("!x86", valid);
+    std::cout << "!x86: " << valid << std::endl;
+
+    std::cout << std::endl << "Testing try_assign():" << std::endl;
+    herdstat::portage::Keywords more;
+    std::cout << "Valid? " << more.try_assign(opts.front()) << std::endl;
+    assert(more.size() == 6);
+
+    /* an unknown arch only costs us that one keyword */
+    {
+        std::ofstream ebuild("unknown-arch-1.0.ebuild");
+        ebuild << "KEYWORDS=\"x86 ~notanarch ~amd64\"\n";
+    }
+
+    const bool valid_some = more.try_assign("unknown-arch-1.0.ebuild");
+    std::cout << "Valid? " << valid_some << std::endl;
+    display_keywords(more);
+
+    unlink("unknown-arch-1.0.ebuild");
 }
 
 #endif /* _HAVE__KEYWORD_TEST_HH */
@@ -0,0 +1,179 @@
+/*
+ * libherdstat -- tests/src/memory-test.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE__MEMORY_TEST_HH
+#define _HAVE__MEMORY_TEST_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <sstream>
+#include <herdstat/util/memory.hh>
+#include <herdstat/xml/init.hh>
+#include <herdstat/portage/herds_xml.hh>
+#include <herdstat/portage/devaway_xml.hh>
+#include <herdstat/portage/package_list.hh>
+#include <herdstat/portage/keywords.hh>
+#include <instrument/alloc.hh>
+#include "test_handler.hh"
+
+DECLARE_TEST_HANDLER(MemoryTest)
+
+struct MemoryTestSample
+{
+    MemoryTestSample() : allocated(0), mem() { }
+
+    /// bytes still allocated after creating the object
+    unsigned long allocated;
+    herdstat::util::MemoryUsage mem;
+};
+
+template <typename T>
+static MemoryTestSample
+memory_test_sample(T *(*make)(const std::string&), const std::string& arg)
+{
+    MemoryTestSample sample;
+    const unsigned long live = instrument::live_bytes();
+    T *p = make(arg);
+    sample.allocated = instrument::live_bytes() - live;
+    sample.mem = p->memory_usage();
+    delete p;
+    return sample;
+}
+
+template <typename T>
+static T *
+memory_test_make(const std::string& arg)
+{
+    return new T(arg);
+}
+
+template <typename T>
+static T *
+memory_test_make_empty(const std::string& arg LIBHERDSTAT_UNUSED)
+{
+    return new T();
+}
+
+static herdstat::portage::PackageList *
+memory_test_make_pkgs(const std::string& arg)
+{
+    return new herdstat::portage::PackageList(not arg.empty());
+}
+
+/* estimates are exact unless strings share buffers with strings outside
+ * the object (copy-on-write implementations), so allow for some slack. */
+static bool
+memory_test_close(unsigned long estimated, unsigned long allocated)
+{
+    const unsigned long diff = (estimated > allocated ?
+        estimated - allocated : allocated - estimated);
+    return (diff <= allocated / 10);
+}
+
+/* the difference in memory_usage() between an empty and a filled object
+ * should be what filling it allocated. */
+static void
+memory_test_check(const std::string& what, const MemoryTestSample& empty,
+                  const MemoryTestSample& full)
+{
+    const unsigned long allocated = full.allocated - empty.allocated;
+    const unsigned long estimated = full.mem.total() - empty.mem.total();
+
+    if (not memory_test_close(estimated, allocated))
+    {
+        std::ostringstream os;
+        os << full.mem;
+        throw herdstat::Exception("%s: estimated %lu bytes but %lu were "
+            "allocated (%s)", what.c_str(), estimated, allocated,
+            os.str().c_str());
+    }
+
+    std::cout << what << ": estimate matches allocations" << std::endl;
+}
+
+void
+MemoryTest::operator()(const opts_type& opts) const
+{
+    using herdstat::portage::HerdsXML;
+    using herdstat::portage::DevawayXML;
+    using herdstat::portage::KeywordsMap;
+
+    assert(opts.size() == 3);
+
+    herdstat::xml::GlobalInit();
+
+    /* strings */
+    const std::string empty;
+    const std::string large(100, 'x');
+    assert(herdstat::util::memory_usage(empty).total() == 0);
+    assert(herdstat::util::memory_usage(large).strings > large.size());
+    assert(herdstat::util::memory_usage(large).strings ==
+           herdstat::util::memory_usage(large).total());
+
+    /* containers */
+    std::vector<std::string> v(10, std::string(50, 'y'));
+    const herdstat::util::MemoryUsage vmem(herdstat::util::memory_usage(v));
+    assert(vmem.nodes == v.capacity() * sizeof(std::string));
+    assert(vmem.strings ==
+           10 * herdstat::util::memory_usage(v.front()).strings);
+    assert(vmem.caches == 0);
+
+    /* fill any global caches (portage config, arch list, ...) first */
+    delete memory_test_make_pkgs("fill");
+    delete memory_test_make<KeywordsMap>(opts[2]);
+
+    memory_test_check("HerdsXML",
+        memory_test_sample(memory_test_make_empty<HerdsXML>, ""),
+        memory_test_sample(memory_test_make<HerdsXML>, opts[0]));
+    memory_test_check("DevawayXML",
+        memory_test_sample(memory_test_make_empty<DevawayXML>, ""),
+        memory_test_sample(memory_test_make<DevawayXML>, opts[1]));
+    memory_test_check("PackageList",
+        memory_test_sample(memory_test_make_pkgs, ""),
+        memory_test_sample(memory_test_make_pkgs, "fill"));
+
+    MemoryTestSample kwmap_empty;
+    kwmap_empty.allocated = sizeof(KeywordsMap);
+    memory_test_check("KeywordsMap", kwmap_empty,
+        memory_test_sample(memory_test_make<KeywordsMap>, opts[2]));
+
+    /* lazily loaded keywords show up as a cache */
+    herdstat::portage::Package pkg("app-misc/foo");
+    const herdstat::util::MemoryUsage before(pkg.memory_usage());
+    assert(before.caches == 0);
+
+    const unsigned long live = instrument::live_bytes();
+    const KeywordsMap& kwmap(pkg.keywords());
+    const unsigned long allocated = instrument::live_bytes() - live;
+
+    const herdstat::util::MemoryUsage after(pkg.memory_usage());
+    assert(after.strings == before.strings and after.nodes == before.nodes);
+    assert(after.caches == sizeof(KeywordsMap) + kwmap.memory_usage().total());
+    assert(memory_test_close(after.caches, allocated));
+    std::cout << "Package keywords counted as a cache" << std::endl;
+}
+
+#endif /* _HAVE__MEMORY_TEST_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
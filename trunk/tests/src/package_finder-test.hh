@@ -76,6 +76,30 @@ PackageFinderTest::operator()(const opts_type& null LIBHERDSTAT_UNUSED) const
         for (i = results.begin() ; i != results.end() ; ++i)
             std::cout << "  Found " << i->full() << std::endl;
     }
+
+    {
+        std::cout << std::endl
+            << "Testing PackageFinder w/nonexistent package:" << std::endl;
+        find.clear_results();
+        bool found = find.try_find("nonexistent-pkg");
+        assert(not found);
+        found = find.try_find(herdstat::util::Regex("^nonexistent"));
+        assert(not found);
+        assert(results.empty());
+        found = find.try_find("pfft");
+        assert(found and results.size() == 1);
+
+        find.clear_results();
+        try
+        {
+            find("nonexistent-pkg");
+            assert(false);
+        }
+        catch (const herdstat::portage::NonExistentPkg& e)
+        {
+            std::cout << "  " << e.what() << std::endl;
+        }
+    }
 }
 
 #endif /* _HAVE__PACKAGE_FINDER_TEST_HH */
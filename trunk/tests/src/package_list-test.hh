@@ -39,7 +39,22 @@ DECLARE_TEST_HANDLER(PackageListTest)
 void
 PackageListTest::operator()(const opts_type& null LIBHERDSTAT_UNUSED) const
 {
+    /* the first list pays for one-time setup (GlobalConfig(), the
+     * category list, caches); only budget the one after it */
+    {
+        const herdstat::portage::PackageList warmup;
+    }
+
+    AllocBudget fill("PackageList::fill()", 10);
     herdstat::portage::PackageList pkgs;
+    fill.check(pkgs.size());
+
+    {
+        AllocBudget copy("Package copies", 2);
+        const std::vector<herdstat::portage::Package>
+            copies(pkgs.begin(), pkgs.end());
+        copy.check(copies.size());
+    }
 
     std::cout << "Package List:" << std::endl;
 
@@ -0,0 +1,164 @@
+/*
+ * libherdstat -- tests/src/profile-test.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_PROFILE_TEST_HH
+#define _HAVE_PROFILE_TEST_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <sstream>
+#include <herdstat/util/profile.hh>
+#include <herdstat/util/regex.hh>
+#include <herdstat/xml/init.hh>
+#include <herdstat/portage/herds_xml.hh>
+#include <herdstat/portage/devaway_xml.hh>
+#include <herdstat/portage/package_which.hh>
+#include <herdstat/portage/data_source_loader.hh>
+#include "test_handler.hh"
+
+DECLARE_TEST_HANDLER(ProfileTest)
+
+/* print a report without the (varying) times; the flat report is ordered
+ * by time, so sort it. */
+static void
+profile_test_report(herdstat::util::Profiler::format_type format)
+{
+    std::ostringstream os;
+    herdstat::util::GlobalProfiler().report(os, format);
+
+    std::istringstream is(os.str());
+    std::string line;
+    std::getline(is, line);
+    std::cout << line << std::endl;
+
+    std::vector<std::string> lines;
+    while (std::getline(is, line))
+    {
+        /* strip the two time columns */
+        std::string::size_type pos = line.find_last_not_of(' ');
+        for (int n = 0 ; n < 2 ; ++n)
+        {
+            pos = line.find_last_of(' ', pos);
+            pos = line.find_last_not_of(' ', pos);
+        }
+        lines.push_back(line.substr(0, pos + 1));
+    }
+
+    if (format == herdstat::util::Profiler::flat)
+        std::sort(lines.begin(), lines.end());
+    std::copy(lines.begin(), lines.end(),
+        std::ostream_iterator<std::string>(std::cout, "\n"));
+}
+
+void
+ProfileTest::operator()(const opts_type& opts) const
+{
+    assert(opts.size() == 2);
+
+    herdstat::util::Profiler& profiler(herdstat::util::GlobalProfiler());
+    assert(not profiler.enabled());
+
+    /* nothing is recorded while disabled */
+    {
+        herdstat::util::ProfileZone zone("disabled");
+    }
+
+    herdstat::xml::GlobalInit();
+    profiler.enable(true);
+    assert(profiler.enabled() and profiler.tracing());
+
+    {
+        herdstat::util::ProfileZone zone("test");
+        herdstat::portage::PackageList pkgs;
+
+        herdstat::portage::PackageFinder find(pkgs);
+        find(herdstat::util::Regex("^foo"));
+        find("libfoo");
+
+        herdstat::portage::PackageWhich which;
+        which(std::string("app-misc/foo"), pkgs.portdir());
+        which(find.results());
+    }
+
+    std::cout << "Tree:" << std::endl;
+    profile_test_report(herdstat::util::Profiler::tree);
+
+    std::ostringstream trace;
+    profiler.write_trace(trace);
+    const std::string json(trace.str());
+    assert(json.find("{\"traceEvents\":[") == 0);
+    assert(json.find("\"name\":\"portage::PackageList::fill()\"") !=
+           std::string::npos);
+
+    std::size_t events = 0, pos = 0;
+    while ((pos = json.find("\"ph\":\"X\"", pos)) != std::string::npos)
+        ++events, ++pos;
+    std::cout << "Trace events: " << events << std::endl;
+    assert(profiler.dropped_events() == 0);
+
+    /* past the limit, zones are still counted but not traced */
+    profiler.reset();
+    profiler.set_trace_limit(5);
+    for (int n = 0 ; n < 8 ; ++n)
+        herdstat::util::ProfileZone zone("limited");
+    profiler.set_trace_limit(herdstat::util::Profiler::default_trace_limit);
+
+    trace.str("");
+    profiler.write_trace(trace);
+    const std::string& limited(trace.str());
+    events = pos = 0;
+    while ((pos = limited.find("\"ph\":\"X\"", pos)) != std::string::npos)
+        ++events, ++pos;
+    assert(limited.find("\"droppedEvents\":\"3\"") != std::string::npos);
+    std::cout << "Limited trace events: " << events << ", dropped "
+        << profiler.dropped_events() << std::endl;
+    profile_test_report(herdstat::util::Profiler::tree);
+
+    /* zones entered in other threads are merged */
+    profiler.reset();
+    {
+        herdstat::portage::HerdsXML herds;
+        herdstat::portage::DevawayXML devaway;
+        herdstat::portage::DataSourceLoader loader;
+        loader.add(herds, opts[0]);
+        loader.add(devaway, opts[1]);
+        loader.start();
+        loader.wait();
+    }
+
+    profiler.disable();
+
+    std::cout << std::endl << "Flat:" << std::endl;
+    profile_test_report(herdstat::util::Profiler::flat);
+
+    profiler.reset();
+    std::ostringstream os;
+    profiler.report(os);
+    const std::string empty(os.str());
+    assert(std::count(empty.begin(), empty.end(), '\n') == 1);
+}
+
+#endif /* _HAVE_PROFILE_TEST_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,217 @@
+/*
+ * libherdstat -- tests/src/progress-test.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE__PROGRESS_TEST_HH
+#define _HAVE__PROGRESS_TEST_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstdio>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <herdstat/util/progress/percent.hh>
+#include <herdstat/util/progress/bar.hh>
+#include "test_handler.hh"
+
+#define PROGRESS_TEST_NTHREADS      4
+#define PROGRESS_TEST_INCREMENTS    10000
+
+DECLARE_TEST_HANDLER(ProgressTest)
+
+/* records what it's asked to draw instead of drawing it */
+class ProgressTestMeter : public herdstat::util::ProgressMeter
+{
+    public:
+        ProgressTestMeter(int& last, bool& stopped)
+            : _last(last), _stopped(stopped) { }
+        virtual ~ProgressTestMeter() throw() { this->stop(); }
+
+    protected:
+        virtual void do_start() { _last = 0; _stopped = false; }
+        virtual void do_stop() { _stopped = true; }
+        virtual void do_increment(int cur) { _last = cur; }
+
+    private:
+        int& _last;
+        bool& _stopped;
+};
+
+static void *
+progress_test_increment(void *data)
+{
+    herdstat::util::ProgressMeter *meter =
+        static_cast<herdstat::util::ProgressMeter *>(data);
+    for (int n = 0 ; n < PROGRESS_TEST_INCREMENTS ; ++n)
+        ++*meter;
+    return NULL;
+}
+
+/* start meter, have several threads increment it to 100%, then destroy it
+ * without calling stop() */
+static void
+progress_test_run(herdstat::util::ProgressMeter *meter, unsigned fps)
+{
+    meter->set_frame_rate(fps);
+    meter->start(PROGRESS_TEST_NTHREADS * PROGRESS_TEST_INCREMENTS);
+
+    pthread_t threads[PROGRESS_TEST_NTHREADS];
+    for (int i = 0 ; i < PROGRESS_TEST_NTHREADS ; ++i)
+        if (pthread_create(&threads[i], NULL,
+                progress_test_increment, meter) != 0)
+            throw herdstat::Exception("pthread_create() failed");
+    for (int i = 0 ; i < PROGRESS_TEST_NTHREADS ; ++i)
+        pthread_join(threads[i], NULL);
+
+    delete meter;
+}
+
+/* replay terminal output, calling check(line) each time a frame ends with
+ * the character 'end'.  returns the last line. */
+static std::string
+progress_test_replay(const std::string& out, char end,
+                     bool (*check)(const std::string&))
+{
+    std::string line;
+    std::string::size_type cursor = 0;
+
+    for (std::string::size_type i = 0 ; i < out.size() ; ++i)
+    {
+        const char c = out[i];
+        if (c == '\033')                    /* colors */
+            i = out.find('m', i);
+        else if (c == '\n')
+        {
+            line.clear();
+            cursor = 0;
+        }
+        else if (c == '\b')
+        {
+            if (cursor > 0)
+                --cursor;
+        }
+        else
+        {
+            if (cursor == line.size())
+                line += c;
+            else
+                line[cursor] = c;
+            ++cursor;
+
+            if (c == end)
+                assert(check(line.substr(0, cursor)));
+        }
+    }
+
+    return line;
+}
+
+static bool
+progress_test_percent(const std::string& line)
+{
+    /* "NNN%", right justified, and nothing left over from the last frame */
+    const std::string::size_type pos = line.find_first_not_of(' ');
+    return (line.size() == 4 and pos != std::string::npos and
+            line.find_first_not_of("0123456789", pos) == 3);
+}
+
+static bool
+progress_test_bar(const std::string& line)
+{
+    /* "[===>   ]" */
+    const std::string::size_type tip = line.find('>');
+    const std::string::size_type space = line.find(' ');
+    return (line[0] == '[' and
+            line.find_first_not_of('=', 1) == (tip == std::string::npos ?
+                1 : tip) and
+            (space == std::string::npos or
+             line.find_first_not_of(' ', space) == line.size() - 1));
+}
+
+/* run meter with stdout going to a file, returning what it wrote */
+static std::string
+progress_test_output(herdstat::util::ProgressMeter *meter, unsigned fps)
+{
+    const char * const path = "progress-test.out";
+
+    std::fflush(stdout);
+    const int saved = dup(STDOUT_FILENO);
+    const int fd = open(path, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    assert(saved != -1 and fd != -1);
+    dup2(fd, STDOUT_FILENO);
+    close(fd);
+
+    progress_test_run(meter, fps);
+
+    std::fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+
+    std::string out;
+    std::FILE *f = std::fopen(path, "r");
+    assert(f);
+    int c;
+    while ((c = std::fgetc(f)) != EOF)
+        out += static_cast<char>(c);
+    std::fclose(f);
+    unlink(path);
+
+    return out;
+}
+
+void
+ProgressTest::operator()(const opts_type& null LIBHERDSTAT_UNUSED) const
+{
+    const unsigned rates[] =
+        { herdstat::util::ProgressMeter::default_frame_rate, 0 };
+
+    for (std::size_t i = 0 ; i < (sizeof(rates) / sizeof(rates[0])) ; ++i)
+    {
+        int last = -1;
+        bool stopped = false;
+        progress_test_output(new ProgressTestMeter(last, stopped), rates[i]);
+        std::cout << "ProgressTestMeter @ " << rates[i] << "fps: last frame "
+            << last << "%, " << (stopped ? "stopped" : "not stopped")
+            << std::endl;
+
+        std::string out(progress_test_output(
+            new herdstat::util::PercentMeter(), rates[i]));
+        std::string line(progress_test_replay(out, '%',
+            progress_test_percent));
+        assert(out.find("100%") != std::string::npos);
+        std::cout << "PercentMeter @ " << rates[i] << "fps: "
+            << (line.find_first_not_of(' ') == std::string::npos ?
+                "erased" : line) << std::endl;
+
+        out = progress_test_output(new herdstat::util::ProgressBar(), rates[i]);
+        progress_test_replay(out, ']', progress_test_bar);
+        std::cout << "ProgressBar @ " << rates[i] << "fps: "
+            << (out.find("=>]") != std::string::npos ? "filled" : "not filled")
+            << std::endl;
+    }
+}
+
+#endif /* _HAVE__PROGRESS_TEST_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,221 @@
+/*
+ * libherdstat -- tests/src/query-test.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE__QUERY_TEST_HH
+#define _HAVE__QUERY_TEST_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <herdstat/util/string.hh>
+#include <herdstat/xml/init.hh>
+#include <herdstat/portage/query_server.hh>
+#include <herdstat/portage/query_client.hh>
+#include "test_handler.hh"
+
+DECLARE_TEST_HANDLER(QueryTest)
+
+static void *
+query_test_serve(void *data)
+{
+    static_cast<herdstat::portage::QueryServer *>(data)->run();
+    return NULL;
+}
+
+static void
+query_test_configure(herdstat::portage::QueryEngine& engine,
+                     const opts_type& opts)
+{
+    engine.set_herds_xml(opts[0]);
+    engine.set_devaway_xml(opts[1]);
+    engine.set_userinfo_xml(opts[2]);
+}
+
+/* ask the same questions of the client and of an in-process engine */
+static void
+query_test_compare(herdstat::portage::QueryClient& client,
+                   herdstat::portage::QueryEngine& engine, bool remote)
+{
+    bool found, found_local;
+
+    std::vector<herdstat::portage::Package> pkgs, pkgs_local;
+    found = client.find("foo", false, pkgs);
+    found_local = engine.find("foo", false, pkgs_local);
+    assert(found and found_local and client.remote() == remote);
+    assert(pkgs == pkgs_local);
+
+    pkgs.clear(); pkgs_local.clear();
+    found = client.find("^lib", true, pkgs);
+    found_local = engine.find("^lib", true, pkgs_local);
+    assert(found and found_local and client.remote() == remote);
+    assert(pkgs == pkgs_local);
+
+    std::vector<std::string> ebuilds, ebuilds_local;
+    found = client.which("foo", false, ebuilds);
+    found_local = engine.which("foo", false, ebuilds_local);
+    assert(found and found_local and client.remote() == remote);
+    assert(ebuilds == ebuilds_local);
+
+    herdstat::portage::Herd herd, herd_local;
+    found = client.herd("apache", herd);
+    found_local = engine.herd("apache", herd_local);
+    assert(found and found_local and client.remote() == remote);
+    assert(herd.name() == herd_local.name());
+    assert(herd.email() == herd_local.email());
+    assert(herd.size() == herd_local.size());
+
+    herdstat::portage::Developer dev, dev_local;
+    found = client.developer("ka0ttic", dev);
+    found_local = engine.developer("ka0ttic", dev_local);
+    assert(found and found_local and client.remote() == remote);
+    assert(dev.user() == dev_local.user());
+    assert(dev.name() == dev_local.name());
+    assert(dev.email() == dev_local.email());
+    assert(dev.herds() == dev_local.herds());
+    assert(dev.is_away() == dev_local.is_away());
+
+    /* nothing found isn't an error, and isn't answered locally either */
+    pkgs.clear(); herdstat::portage::Herd none;
+    found = client.find("nonexistent", false, pkgs);
+    assert(not found and pkgs.empty() and client.remote() == remote);
+    found = client.herd("nonexistent", none);
+    assert(not found);
+
+    /* a bad regex is reported by whoever answered */
+    try
+    {
+        client.find("[", true, pkgs);
+        assert(false);
+    }
+    catch (const herdstat::Exception&)
+    {
+        assert(client.remote() == remote);
+    }
+}
+
+void
+QueryTest::operator()(const opts_type& opts) const
+{
+    assert(opts.size() == 3);
+
+    herdstat::xml::GlobalInit();
+
+    const std::string dir(herdstat::util::sprintf("%s/query-test.%d",
+        P_tmpdir, static_cast<int>(::getpid())));
+    const std::string path(dir + "/socket");
+
+    herdstat::portage::QueryEngine engine;
+    query_test_configure(engine, opts);
+
+    {
+        herdstat::portage::QueryEngine served;
+        query_test_configure(served, opts);
+        served.load();
+
+        /* the socket's directory must be ours alone */
+        int rv = ::mkdir(dir.c_str(), S_IRWXU);
+        assert(rv == 0);
+        rv = ::chmod(dir.c_str(), S_IRWXU|S_IRGRP|S_IXGRP);
+        assert(rv == 0);
+        try
+        {
+            herdstat::portage::QueryServer(served, path).listen();
+            assert(false);
+        }
+        catch (const herdstat::Exception&)
+        {
+            std::cout << "Public directory refused" << std::endl;
+        }
+        rv = ::chmod(dir.c_str(), S_IRWXU);
+        assert(rv == 0);
+
+        herdstat::portage::QueryServer server(served, path);
+        server.listen();
+
+        /* and the socket ours alone from the start */
+        struct stat s;
+        rv = ::lstat(path.c_str(), &s);
+        assert(rv == 0 and (s.st_mode & (S_IRWXG|S_IRWXO)) == 0);
+
+        /* only one server per socket */
+        herdstat::portage::QueryServer second(served, path);
+        try
+        {
+            second.listen();
+            assert(false);
+        }
+        catch (const herdstat::Exception&)
+        {
+            std::cout << "Second server refused" << std::endl;
+        }
+
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, query_test_serve, &server) != 0)
+            throw herdstat::Exception("pthread_create() failed");
+
+        herdstat::portage::QueryClient client(path);
+        query_test_configure(client.local(), opts);
+        query_test_compare(client, engine, true);
+        std::cout << "Answered by server" << std::endl;
+
+        /* the server won't answer for a different configuration */
+        {
+            herdstat::portage::QueryClient other(path);
+            query_test_configure(other.local(), opts);
+            other.local().set_devaway_xml(opts[1] + ".nonexistent");
+
+            std::vector<herdstat::portage::Package> pkgs;
+            const bool found = other.find("foo", false, pkgs);
+            assert(found and not other.remote());
+            std::cout << "Different configuration answered locally"
+                << std::endl;
+        }
+
+        const bool reloaded = client.reload();
+        assert(reloaded);
+        herdstat::portage::Herd herd;
+        const bool found = client.herd("apache", herd);
+        assert(found and client.remote());
+
+        server.stop();
+        pthread_join(thread, NULL);
+    }
+
+    /* no server; the client answers by itself */
+    assert(::access(path.c_str(), F_OK) != 0);
+    ::rmdir(dir.c_str());
+
+    herdstat::portage::QueryClient client(path);
+    query_test_configure(client.local(), opts);
+    query_test_compare(client, engine, false);
+    const bool reloaded = client.reload();
+    assert(not reloaded);
+    std::cout << "Answered locally" << std::endl;
+}
+
+#endif /* _HAVE__QUERY_TEST_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -28,6 +28,7 @@
 #endif
 
 #include <herdstat/util/regex.hh>
+#include <instrument/alloc.hh>
 #include "test_handler.hh"
 
 DECLARE_TEST_HANDLER(RegexTest)
@@ -61,6 +62,195 @@ RegexTest::operator()(const opts_type& null LIBHERDSTAT_UNUSED) const
     std::cout << "found '" << *i << "'." << std::endl;
 
     assert(*i == word1);
+
+    std::cout << std::endl << "Testing util::Regex copies:" << std::endl;
+
+    {
+        herdstat::util::Regex copy(regex);
+        herdstat::util::Regex assigned;
+        assigned = copy;
+        assert(copy == regex and assigned == regex);
+        assert(assigned == word1 and assigned != word2);
+
+        /* reassigning one copy leaves the others alone */
+        copy.assign("^test", herdstat::util::Regex::extended);
+        assert(copy == word2 and copy != word1);
+        assert(regex == word1 and assigned == word1);
+        std::cout << "copies ok" << std::endl;
+    }
+
+    std::cout << std::endl << "Testing util::RegexCache:" << std::endl;
+
+    {
+        herdstat::util::RegexCache cache(2);
+        const herdstat::util::RegexProgram *p1 = cache.get("a+", 0);
+        const herdstat::util::RegexProgram *p2 = cache.get("a+", 0);
+        const herdstat::util::RegexProgram *p3 = cache.get("a+",
+            herdstat::util::Regex::extended);
+        assert(p1 == p2 and p1 != p3);
+        assert(p3->match("aaa", 0));
+
+        cache.get("b", 0)->unref();     /* evicts "a+", 0 */
+        const herdstat::util::RegexProgram *p4 = cache.get("a+", 0);
+        assert(p4 != p1);
+
+        std::cout << "size:   " << cache.size() << std::endl;
+        std::cout << "hits:   " << cache.hits() << std::endl;
+        std::cout << "misses: " << cache.misses() << std::endl;
+
+        p1->unref(); p2->unref(); p3->unref(); p4->unref();
+
+        try
+        {
+            cache.get("(", herdstat::util::Regex::extended);
+            assert(false);
+        }
+        catch (const herdstat::BadRegex& e)
+        {
+            assert(std::string(e.what()).length() > 0);
+            std::cout << "bad regex not cached: " << cache.size() << std::endl;
+        }
+    }
+
+    {
+        /* repeated construction doesn't recompile */
+        herdstat::util::RegexCache& cache(herdstat::util::GlobalRegexCache());
+        const herdstat::util::Regex first("^repeated query$");
+        const herdstat::util::RegexCache::size_type misses = cache.misses();
+        for (int n = 0 ; n < 100 ; ++n)
+        {
+            const herdstat::util::Regex again("^repeated query$");
+            const bool matched = (again == "repeated query");
+            assert(matched);
+        }
+        assert(cache.misses() == misses);
+        std::cout << "global cache ok" << std::endl;
+    }
+
+    std::cout << std::endl << "Testing util::RegexMap:" << std::endl;
+
+    {
+        using herdstat::util::Regex;
+        typedef herdstat::util::RegexMap<std::string> map_type;
+
+        map_type m;
+        m.insert(map_type::value_type(Regex("^app-misc/foo$"), "exact"));
+        m.insert(map_type::value_type(Regex("^dev-"), "prefix"));
+        m.insert(map_type::value_type(Regex("-9999$"), "suffix"));
+        m.insert(map_type::value_type(Regex("lala"), "substr"));
+        m.insert(map_type::value_type(Regex("x11-(libs|wm)/",
+            Regex::extended), "group"));
+        m.insert(map_type::value_type(Regex("^(kde|gnome)-base",
+            Regex::extended), "alternation"));
+        m.insert(map_type::value_type(Regex("GTK\\+", Regex::icase), "icase"));
+        m.insert(map_type::value_type(Regex("[0-9]\\{3\\}"), "interval"));
+
+        const char *inputs[] = {
+            "app-misc/foo", "app-misc/foobar", "dev-util/lala-9999",
+            "dev-util/bar", "sys-apps/baz-9999", "www-apps/lala",
+            "x11-wm/fluxbox", "x11-misc/lala", "gnome-base/gnome",
+            "media-libs/gtk+", "foo-123", "Dev-", "nothing", "", NULL
+        };
+
+        for (const char **in = inputs ; *in ; ++in)
+        {
+            /* must agree with trying each one in turn */
+            map_type::const_iterator expected = m.end();
+            for (map_type::const_iterator i = m.begin() ; i != m.end() ; ++i)
+                if (i->first == *in) { expected = i; break; }
+
+            const map_type& cm(m);
+            map_type::const_iterator i = cm.find(*in);
+            assert(i == expected);
+            std::cout << "'" << *in << "' => "
+                << (i == cm.end() ? "(none)" : i->second) << std::endl;
+        }
+
+        /* changes are picked up */
+        m.erase(m.begin());
+        map_type::iterator i = m.find("app-misc/foo");
+        assert(i == m.end());
+
+        m[Regex("^nothing$")] = "new";
+        i = m.find("nothing");
+        assert(i != m.end() and i->second == "new");
+
+        m.erase(m.begin(), m.begin() + 2);
+        i = m.find("dev-util/bar");
+        assert(i == m.end());
+        i = m.find("www-apps/lala");
+        assert(i != m.end() and i->second == "substr");
+
+        m.clear();
+        i = m.find("www-apps/lala");
+        assert(i == m.end());
+        std::cout << "updates ok" << std::endl;
+    }
+
+    {
+        using herdstat::util::Regex;
+        typedef herdstat::util::RegexMap<std::string> map_type;
+
+        map_type m;
+        m.insert(map_type::value_type(Regex("^dev-"), "prefix"));
+        m.insert(map_type::value_type(Regex("lala"), "substr"));
+        m.insert(map_type::value_type(Regex("-9999$"), "suffix"));
+
+        const std::string key1("dev-util/bar"), key2("www-apps/lala-9999");
+        map_type::const_iterator i = m.find(key1);
+
+        /* once built, lookups don't allocate */
+        const instrument::AllocScope scope;
+        i = m.find(key1);
+        assert(i != m.end() and i->second == "prefix");
+        i = m.find(key2);
+        assert(i != m.end() and i->second == "substr");
+        assert(scope.stats().allocations == 0);
+        std::cout << "lookups ok" << std::endl;
+    }
+
+    std::cout << std::endl << "Testing util::RegexSet:" << std::endl;
+
+    {
+        using herdstat::util::Regex;
+
+        /* GNU word and buffer anchors aren't literal characters */
+        const char *patterns[] = {
+            "\\<foo\\>", "^foo\\'", "\\`abc", "ab\\>", "\\<x\\'", NULL
+        };
+        const char *inputs[] = {
+            "a foo b", "foo", "abc", "<foo>", "foo'", "`abc", "cab",
+            "grab x", "x", "ab>", "", NULL
+        };
+        const int cflags[] = { 0, Regex::extended };
+
+        for (std::size_t f = 0 ; f < 2 ; ++f)
+        {
+            for (const char **p = patterns ; *p ; ++p)
+            {
+                const Regex re(*p, cflags[f]);
+                herdstat::util::RegexSet set;
+                set.push_back(re);
+
+                for (const char **in = inputs ; *in ; ++in)
+                {
+                    const bool expected = (re == *in);
+                    const bool found =
+                        (set.find(*in) != herdstat::util::RegexSet::npos);
+                    assert(found == expected);
+                }
+            }
+        }
+
+        herdstat::util::RegexSet set;
+        set.push_back(Regex("\\<foo\\>"));
+        set.push_back(Regex("\\`abc", Regex::extended));
+        std::cout << "'a foo b' => " << set.find("a foo b") << std::endl;
+        std::cout << "'abc' => " << set.find("abc") << std::endl;
+        std::cout << "'foobar' => "
+            << (set.find("foobar") == herdstat::util::RegexSet::npos ?
+                "(none)" : "match") << std::endl;
+    }
 }
 
 #endif /* _HAVE__REGEX_TEST_HH */
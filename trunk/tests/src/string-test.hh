@@ -68,6 +68,75 @@ StringTest::operator()(const opts_type& null LIBHERDSTAT_UNUSED) const
     const std::string c("This is a \033[0;31mtest\033[00m");
     std::cout << c << std::endl;
     std::cout << herdstat::util::strip_colors(c) << std::endl;
+
+    /* util::SplitView yields the same parts as util::split() */
+    const char * const inputs[] = { "Mary had a little lamb!", "  a  b ",
+        "a-b--c-", "", "-", "x86 ~amd64 -sparc", NULL };
+    const char * const delims[] = { " ", "-", "--", NULL };
+    for (const char * const *in = inputs ; *in ; ++in)
+    {
+        for (const char * const *d = delims ; *d ; ++d)
+        {
+            for (int append_empty = 0 ; append_empty < 2 ; ++append_empty)
+            {
+                const std::string str(*in), delim(*d);
+                std::vector<std::string> expected, actual;
+                herdstat::util::split(str, std::back_inserter(expected),
+                    delim, append_empty);
+
+                const herdstat::util::SplitView parts(str, delim,
+                    append_empty);
+                herdstat::util::SplitView::const_iterator p;
+                for (p = parts.begin() ; p != parts.end() ; ++p)
+                    actual.push_back(p->str());
+
+                assert(actual == expected);
+            }
+        }
+    }
+
+    {
+        const herdstat::util::SplitView parts(s);
+        herdstat::util::SplitView::const_iterator p;
+        for (p = parts.begin() ; p != parts.end() ; ++p)
+            std::cout << "'" << *p << "' ";
+        std::cout << std::endl;
+    }
+
+    /* path helpers and their views agree */
+    const char * const paths[] = { "/usr/portage/app-misc/foo/foo-1.0.ebuild",
+        "foo-1.0.tar.bz2", "/usr/", "/", "foo", "a//", "", NULL };
+    for (const char * const *path = paths ; *path ; ++path)
+    {
+        const std::string str(*path);
+        assert(herdstat::util::basename(str) ==
+               herdstat::util::basename_view(str).str());
+        assert(herdstat::util::dirname(str) ==
+               herdstat::util::dirname_view(str).str());
+        assert(herdstat::util::chop_fileext(str, 2) ==
+               herdstat::util::chop_fileext_view(str, 2).str());
+        std::cout << "'" << str << "': '"
+            << herdstat::util::dirname_view(str) << "' '"
+            << herdstat::util::basename_view(str) << "' '"
+            << herdstat::util::chop_fileext_view(
+                herdstat::util::basename_view(str)) << "'" << std::endl;
+    }
+
+    /* util::StringView */
+    const herdstat::util::StringView view(s);
+    assert(view.find("little") == s.find("little"));
+    assert(view.find('a', 2) == s.find('a', 2));
+    assert(view.rfind('a') == s.rfind('a'));
+    assert(view.rfind("a") == s.rfind("a"));
+    assert(view.find_first_of("!l") == s.find_first_of("!l"));
+    assert(view.find_last_not_of("!") == s.find_last_not_of("!"));
+    assert(view.find("nope") == herdstat::util::StringView::npos);
+    assert(view.substr(5, 3) == "had" and view.substr(100).empty());
+    assert(view.starts_with("Mary") and view.ends_with("lamb!"));
+    assert(herdstat::util::StringView("abc") < herdstat::util::StringView("abd"));
+    assert(herdstat::util::iequals("LaMb", "lamb"));
+    std::cout << "'" << herdstat::util::trim_view(" \t padded \n") << "'"
+        << std::endl;
 }
 
 #endif /* _HAVE__STRING_TEST_HH */
@@ -39,6 +39,9 @@
 #include <cstdlib>
 
 #include <herdstat/defs.hh>
+#include <herdstat/exceptions.hh>
+#include <herdstat/noncopyable.hh>
+#include <instrument/alloc.hh>
 
 typedef std::vector<std::string> opts_type;
 
@@ -57,6 +60,41 @@ class TestHandler
                 virtual void operator()(const opts_type&) const; \
     };
 
+/**
+ * @class AllocBudget
+ * @brief Fails the test if the code between its construction and check()
+ * makes more allocations than it's allowed.
+ */
+
+class AllocBudget : private herdstat::Noncopyable
+{
+    public:
+        /** Constructor.  Starts counting.
+         * @param what Description of what's being counted.
+         * @param allocations Allocations allowed per item.
+         */
+        AllocBudget(const std::string& what, unsigned long allocations)
+            : _what(what), _allocations(allocations), _scope() { }
+
+        /** Check the allocations made so far against the budget.
+         * @param items Number of items handled (defaults to 1).
+         * @exception herdstat::Exception if over budget.
+         */
+        void check(unsigned long items = 1) const
+        {
+            const unsigned long n = _scope.stats().allocations;
+            if (n > _allocations * items)
+                throw herdstat::Exception("%s: %lu allocations for %lu "
+                    "item(s); the budget is %lu per item", _what.c_str(),
+                    n, items, _allocations);
+        }
+
+    private:
+        const std::string _what;
+        const unsigned long _allocations;
+        const instrument::AllocScope _scope;
+};
+
 #endif /* _HAVE_SRC_TEST_HANDLER_HH */
 
 /* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,235 @@
+/*
+ * libherdstat -- tests/src/threads-test.hh
+ * $Id$
+ * Copyright (c) 2005 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE__THREADS_TEST_HH
+#define _HAVE__THREADS_TEST_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <pthread.h>
+#include <unistd.h>
+#include <herdstat/util/regex.hh>
+#include <herdstat/util/misc.hh>
+#include <herdstat/util/file.hh>
+#include <herdstat/io/compress.hh>
+#include <herdstat/xml/init.hh>
+#include <herdstat/portage/version.hh>
+#include <herdstat/portage/package_finder.hh>
+#include <herdstat/portage/herds_xml.hh>
+#include <herdstat/portage/devaway_xml.hh>
+#include <herdstat/portage/userinfo_xml.hh>
+#include "test_handler.hh"
+
+#define THREADS_TEST_NTHREADS       8
+#define THREADS_TEST_ITERATIONS     4
+
+DECLARE_TEST_HANDLER(ThreadsTest)
+
+struct ThreadsTestResult
+{
+    ThreadsTestResult()
+        : herds(0), devaway(0), userinfo(0), packages(),
+          version_order(false), color(), lazy(), backtrace(false),
+          error() { }
+
+    bool operator== (const ThreadsTestResult& that) const
+    {
+        return (herds == that.herds and devaway == that.devaway and
+                userinfo == that.userinfo and packages == that.packages and
+                version_order == that.version_order and color == that.color and
+                lazy == that.lazy and backtrace == that.backtrace);
+    }
+
+    herdstat::portage::Herds::size_type herds;
+    herdstat::portage::Developers::size_type devaway;
+    herdstat::portage::Developers::size_type userinfo;
+    std::vector<std::string> packages;
+    bool version_order;
+    std::string color;
+    std::string lazy;
+    bool backtrace;
+    std::string error;
+};
+
+struct ThreadsTestData
+{
+    const opts_type *opts;
+    const herdstat::portage::UserinfoXML *lazy;
+    ThreadsTestResult result;
+};
+
+static void
+threads_test_run(const opts_type& opts,
+                 const herdstat::portage::UserinfoXML& lazy,
+                 ThreadsTestResult& result)
+{
+    /* every thread loads developers into the same lazy instance; do it
+     * first thing, so that the threads do it at the same time */
+    result.lazy.clear();
+    const char * const users[] = { "ka0ttic", "mrfoo", "widowmaker", NULL };
+    for (const char * const *user = users ; *user ; ++user)
+    {
+        herdstat::portage::Developer dev(*user);
+        lazy.fill_developer(dev);
+        result.lazy += dev.name() + "/" + dev.location() + "\n";
+    }
+
+    herdstat::portage::HerdsXML herds_xml(opts[0]);
+    result.herds = herds_xml.herds().size();
+
+    herdstat::portage::DevawayXML devaway_xml(opts[1]);
+    result.devaway = devaway_xml.devs().size();
+
+    herdstat::portage::UserinfoXML userinfo_xml(opts[2]);
+    result.userinfo = userinfo_xml.devs().size();
+
+    herdstat::portage::PackageList pkgs;
+    herdstat::portage::PackageFinder find(pkgs);
+    find(herdstat::util::Regex("^foo"));
+    result.packages.clear();
+    std::vector<herdstat::portage::Package>::const_iterator i;
+    for (i = find.results().begin() ; i != find.results().end() ; ++i)
+        result.packages.push_back(i->full());
+
+    herdstat::portage::VersionString v1("foo-1.0_rc1.ebuild");
+    herdstat::portage::VersionString v2("foo-1.0_p1.ebuild");
+    result.version_order = (v1 < v2);
+
+    const herdstat::util::ColorMap cmap;
+    result.color = cmap["red"] + cmap[none];
+
+    /* contexts are per thread; an exception only sees ours */
+    const std::string id(herdstat::util::sprintf("%p",
+        static_cast<void *>(&result)));
+    herdstat::BacktraceContext c("threads_test_run(%s)", id);
+    try
+    {
+        herdstat::util::File f(opts[0] + ".nonexistent");
+    }
+    catch (const herdstat::BaseException& e)
+    {
+        const std::string bt(e.backtrace());
+        const std::string::size_type pos = bt.find("threads_test_run(");
+        result.backtrace = (bt.empty() or (pos != std::string::npos and
+            bt.compare(pos + 17, id.size(), id) == 0 and
+            bt.find("threads_test_run(", pos + 1) == std::string::npos));
+    }
+}
+
+static void *
+threads_test_main(void *arg)
+{
+    ThreadsTestData *data = static_cast<ThreadsTestData *>(arg);
+
+    try
+    {
+        threads_test_run(*data->opts, *data->lazy, data->result);
+
+        /* every subsequent iteration must yield the same thing */
+        for (int n = 1 ; n < THREADS_TEST_ITERATIONS ; ++n)
+        {
+            ThreadsTestResult result;
+            threads_test_run(*data->opts, *data->lazy, result);
+            if (not (result == data->result))
+                data->result.error = "inconsistent results";
+        }
+    }
+    catch (const herdstat::BaseException& e)
+    {
+        data->result.error = e.what();
+    }
+
+    return NULL;
+}
+
+void
+ThreadsTest::operator()(const opts_type& opts) const
+{
+    assert(opts.size() == 3);
+
+    herdstat::xml::GlobalInit();
+
+    /* a lazy UserinfoXML shared by all threads.  it's compressed and its
+     * index cached, so that the threads also race to decompress it. */
+    herdstat::io::compress_file(opts[2], "threads-userinfo.xml.gz",
+        herdstat::io::COMPRESSION_GZIP);
+    {
+        herdstat::portage::UserinfoXML build("threads-userinfo.xml.gz",
+            true, "threads-userinfo.xml.idx");
+    }
+    const herdstat::portage::UserinfoXML lazy("threads-userinfo.xml.gz",
+        true, "threads-userinfo.xml.idx");
+
+    /* don't warm up anything beforehand; the first calls to GlobalConfig()
+     * and friends should race. */
+    std::vector<ThreadsTestData> data(THREADS_TEST_NTHREADS);
+    std::vector<pthread_t> threads(THREADS_TEST_NTHREADS);
+
+    for (std::size_t n = 0 ; n < threads.size() ; ++n)
+    {
+        data[n].opts = &opts;
+        data[n].lazy = &lazy;
+        if (pthread_create(&threads[n], NULL, threads_test_main, &data[n]) != 0)
+            throw herdstat::Exception("pthread_create() failed");
+    }
+
+    for (std::size_t n = 0 ; n < threads.size() ; ++n)
+        pthread_join(threads[n], NULL);
+
+    std::cout << "Threads:    " << THREADS_TEST_NTHREADS << std::endl;
+    std::cout << "Iterations: " << THREADS_TEST_ITERATIONS << std::endl;
+
+    /* compare against a single-threaded run */
+    ThreadsTestResult expected;
+    {
+        const herdstat::portage::UserinfoXML lazy_seq(opts[2], true,
+            "threads-userinfo.xml.idx2");
+        threads_test_run(opts, lazy_seq, expected);
+    }
+    assert(expected.backtrace);
+
+    for (std::size_t n = 0 ; n < data.size() ; ++n)
+    {
+        if (not data[n].result.error.empty())
+            throw herdstat::Exception("thread %d: %s", static_cast<int>(n),
+                data[n].result.error.c_str());
+        if (not (data[n].result == expected))
+            throw herdstat::Exception("thread %d: results differ",
+                static_cast<int>(n));
+    }
+
+    std::cout << "herds.xml:     " << expected.herds << std::endl;
+    std::cout << "devaway.xml:   " << expected.devaway << std::endl;
+    std::cout << "userinfo.xml:  " << expected.userinfo << std::endl;
+    std::cout << "lazy lookups:  " << lazy.devs().size() << std::endl;
+    std::cout << "All threads agree" << std::endl;
+
+    unlink("threads-userinfo.xml.gz");
+    unlink("threads-userinfo.xml.idx");
+    unlink("threads-userinfo.xml.idx2");
+}
+
+#endif /* _HAVE__THREADS_TEST_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
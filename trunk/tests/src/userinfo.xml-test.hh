@@ -27,6 +27,8 @@
 # include "config.h"
 #endif
 
+#include <fstream>
+#include <unistd.h>
 #include <herdstat/portage/userinfo_xml.hh>
 #include "test_handler.hh"
 
@@ -59,6 +61,62 @@ UserinfoXMLTest::operator()(const opts_type& opts) const
     std::cout << "Status:     " << i->status() << std::endl;
     std::cout << "Roles:      " << i->role() << std::endl;
     std::cout << "Location:   " << i->location() << std::endl;
+
+    /* lazy mode; first run builds the index, second loads it */
+    for (int n = 0 ; n < 2 ; ++n)
+    {
+        herdstat::portage::UserinfoXML lazy(path, true, "userinfo.xml.idx");
+        assert(lazy.lazy());
+        assert(lazy.devs().empty());
+        assert(herdstat::util::is_file("userinfo.xml.idx"));
+
+        std::cout << "Lazy size: " << lazy.size() << std::endl;
+
+        herdstat::portage::Developers::const_iterator l = lazy.find(dev);
+        if (l == lazy.devs().end())
+            throw herdstat::Exception(dev + " doesn't seem to exist.");
+
+        assert(lazy.devs().size() == 1);
+        assert(l->name() == i->name());
+        assert(l->pgpkey() == i->pgpkey());
+        assert(l->joined() == i->joined());
+        assert(l->birthday() == i->birthday());
+        assert(l->status() == i->status());
+        assert(l->role() == i->role());
+        assert(l->location() == i->location());
+
+        herdstat::portage::Developer d(dev);
+        lazy.fill_developer(d);
+        assert(d.location() == i->location());
+
+        std::cout << "Lazy lookup of " << l->user() << " ok" << std::endl;
+    }
+
+    unlink("userinfo.xml.idx");
+
+    /* an empty <user/> doesn't swallow the next developer */
+    {
+        std::ofstream xml("selfclosing.xml");
+        xml << "<?xml version=\"1.0\"?>\n<userlist>\n"
+            << "  <user username=\"foo\"/>\n"
+            << "  <user username=\"bar\"><location>Here</location></user>\n"
+            << "</userlist>\n";
+    }
+
+    {
+        herdstat::portage::UserinfoXML lazy("selfclosing.xml", true,
+            "selfclosing.xml.idx");
+        assert(lazy.size() == 2);
+
+        herdstat::portage::Developers::const_iterator l = lazy.find("foo");
+        assert(l != lazy.devs().end() and l->location().empty());
+        l = lazy.find("bar");
+        assert(l != lazy.devs().end() and l->location() == "Here");
+        std::cout << "Lazy lookup of empty <user/> ok" << std::endl;
+    }
+
+    unlink("selfclosing.xml");
+    unlink("selfclosing.xml.idx");
 }
 
 #endif /* _HAVE__USERINFO.XML_TEST_HH */
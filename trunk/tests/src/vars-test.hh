@@ -53,7 +53,10 @@ VarsTest::operator()(const opts_type& opts) const
 
     std::cout << "Testing util::Vars(" << path.substr(portdir.length()+1)
         << "):" << std::endl;
+    AllocBudget budget("util::Vars", 16);
     herdstat::util::Vars vars(path);
+    budget.check(vars.size());
+
     std::for_each(vars.begin(), vars.end(), ShowVarAndVal());
 }
 
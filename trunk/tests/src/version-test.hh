@@ -67,6 +67,36 @@ VersionTest::operator()(const opts_type& opts) const
         ebuild.assign(i->ebuild());
     }
 
+    assert(versions.find(ebuild) != versions.end());
+    assert(versions.find(ebuild)->ebuild() == ebuild);
+    assert(versions.find(opts.front()+"/nope-0.ebuild") == versions.end());
+
+    /* find() is a binary search on the version, then checks the name */
+    for (i = versions.begin() ; i != versions.end() ; ++i)
+    {
+        const std::string name(herdstat::util::basename(i->ebuild()));
+        assert(versions.find(i->ebuild()) == i);
+        assert(versions.find("/elsewhere/"+name) == i);
+    }
+    assert(versions.find("/elsewhere/bar-1.2.ebuild") == versions.end());
+    assert(versions.find("/elsewhere/foo-1.2-r0.ebuild") == versions.end());
+    assert(versions.find("/elsewhere/foo-1.3.ebuild") == versions.end());
+    assert(versions.find("/elsewhere/foo.ebuild") == versions.end());
+
+    /* a version doesn't sort before itself, so it's only held once */
+    {
+        const herdstat::portage::VersionString beta("foo-1.0_beta.ebuild");
+        assert(not (beta < beta));
+
+        const herdstat::portage::VersionString v(ebuild);
+        assert(not (v < v));
+
+        herdstat::portage::Versions dups;
+        dups.insert(v);
+        const bool inserted = dups.insert(v);
+        assert(not inserted and dups.size() == 1);
+    }
+
     std::cout << std::endl
         << "Testing VersionComponents:" << std::endl;
     
@@ -0,0 +1,5 @@
+#!/bin/bash
+source common.sh || exit 1
+run_test "concurrent searches and parses" \
+    "${TEST_DATA}/localstatedir/herds.xml ${TEST_DATA}/localstatedir/devaway.xml ${TEST_DATA}/localstatedir/userinfo.xml" || exit 1
+indent